@@ -28,8 +28,6 @@ void applyCorrectScalarBC(FArrayBox&      a_state,
                           Real a_fineDx,
                           int a_comp)
 {
-  CH_TIME("BCFunctions::applyCorrectScalarBC");
-
   if (a_bcType == PhysBCUtil::Dirichlet)
   {
     ConstantDiriBC(a_state,
@@ -109,7 +107,6 @@ void ConstantDiriBC(FArrayBox&      a_state,
                     int             a_order,
                     int a_comp)
 {
-  CH_TIME("BCFunctions::ConstantDiriBC");
   int isign = sign(a_side);
 
   Box toRegion = adjCellBox(a_valid, a_dir, a_side, 1);
@@ -142,7 +139,6 @@ void ConstantNeumBC(FArrayBox&      a_state,
                     Real			a_dx,
                     int a_comp)
 {
-  CH_TIME("BCFunctions::ConstantNeumBC");
   int isign = sign(a_side);
 
   Box toRegion = adjCellBox(a_valid, a_dir, a_side, 1);
@@ -175,7 +171,6 @@ void VariableFluxBC(FArrayBox&      a_state,
                     Real                        a_dx,
                     int a_comp)
 {
-  CH_TIME("BCFunctions::VariableFluxBC");
   int isign = sign(a_side);
 
   Box toRegion = adjCellBox(a_valid, a_dir, a_side, 1);
@@ -243,7 +238,6 @@ void ExtrapBC(FArrayBox&      a_state,
               int             a_order,
               int a_comp)
 {
-  CH_TIME("BCFunctions::ExtrapBC");
   int isign = sign(a_side);
 
   Box toRegion = adjCellBox(a_valid, a_dir, a_side, 1);
@@ -304,7 +298,6 @@ void InflowOutflowBC(FArrayBox&      a_state,
                      Real fine_dx,
                      int a_comp)
 {
-  CH_TIME("BCFunctions::InflowOutflowBC");
   int isign = sign(a_side);
   Box toRegion = adjCellBox(a_valid, a_dir, a_side, 1);
   toRegion &= a_state.box();
@@ -381,8 +374,6 @@ void InflowOutflowBC(FArrayBox&      a_state,
 
   else
   {
-    CH_TIME("InflowOutflowBC::findAdvVel");
-
     DataIterator dit = a_advVel->dataIterator();
 
     const Box& stateBox = a_state.box();
@@ -456,8 +447,6 @@ void OnlyInflowBC(FArrayBox&      a_state,
                   int a_comp)
 {
 
-  CH_TIME("BCFunctions::OnlyInflowBC");
-
   // if homogeneous, apply homogeneous dirichlet BCs
   if (a_homogeneous)
   {
@@ -100,16 +100,12 @@ public:
 
   Real getBC(int a_dir, Side::LoHiSide a_side)
   {
-    CH_TIME("BCInfo::getBC");
-
     int side = int(a_side);
     return getBC(a_dir, side);
   }
 
   Real getBC(int a_dir, int a_side)
   {
-    CH_TIME("BCInfo::getBC");
-
     CH_assert(a_side == 0 || a_side == 1);
     return m_val[a_side][a_dir];
   }
@@ -638,7 +638,6 @@ public:
                   int Ccomp = 1;
 
 
-                  CH_TIME("BCFunctions::TemperatureBC");
                   int isign = sign(side);
 
                   NonlinearTemperatureBC* residual;
@@ -678,7 +677,7 @@ public:
                       break;
                   }
 
-                  residual = new NonlinearTemperatureBCRobin(m_params, m_dx,
+                  residual = new NonlinearTemperatureBCRobin(&m_params, m_dx,
                                                              a, // coefficient of dt/d(x, z)
                                                              b, // coefficient of thermal radiation term
                                                              flux, // flux
@@ -703,8 +702,6 @@ public:
 
                   for (BoxIterator bit = BoxIterator(toRegion); bit.ok(); ++bit)
                   {
-                    CH_TIME("BCFunctions::TemperatureBC::loopOverBox");
-
                     IntVect ivto = bit();
                     IntVect iv_interior = ivto - isign*BASISV(idir);
 
@@ -719,8 +716,6 @@ public:
 
                     if (bcType == PhysBCUtil::FixedTemperature && legacy_fixed_temp_bc)
                     {
-                      CH_TIME("BCFunctions::FixedTemperatureBC");
-
                       Real boundary_temperature_value;
                       Real bcVal;
 
@@ -753,8 +748,6 @@ public:
                     // if (bcType == PhysBCUtil::TemperatureFlux || bcType == PhysBCUtil::TemperatureFluxRadiation)
                     else
                     {
-                      CH_TIME("BCFunctions::TemperatureFluxBC");
-
                       if (comp == Hcomp)
                       {
 
@@ -774,8 +767,6 @@ public:
                         else
                         {
 
-                          CH_TIME("BCFunctions::FixedTempBC::nonlinearsolve");
-
                           // Compute BC valute to satisfy some boundary condition whose residual is computed by the residual object.
 
                           // Get the temperature at the interior cell (which won't change) so we can compute fluxes across the boundary
@@ -824,7 +815,6 @@ public:
                   int Slcomp = 1;
 
 
-                  CH_TIME("BCFunctions::MixedTemperatureSalinityBC");
                   int isign = sign(side);
 
                   //                                  NonlinearTemperatureBC* residual;
@@ -847,8 +837,6 @@ public:
                   for (BoxIterator bit = BoxIterator(toRegion); bit.ok(); ++bit)
                   {
                     // TODO - should write this in fortran for speed
-                    CH_TIME("BCFunctions::MixedTemperatureSalinityBC::loopOverBox");
-
                     IntVect ivto = bit();
                     IntVect iv_interior = ivto - isign*BASISV(idir);
 
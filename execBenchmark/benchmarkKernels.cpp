@@ -0,0 +1,475 @@
+#ifdef CH_LANG_CC
+/*
+ *      _______              __
+ *     / ___/ /  ___  __ _  / /  ___
+ *    / /__/ _ \/ _ \/  V \/ _ \/ _ \
+ *    \___/_//_/\___/_/_/_/_.__/\___/
+ *    Please refer to Copyright.txt, in Chombo's root directory.
+ */
+#endif
+
+// Times the Fortran kernels which dominate the cost of a mushy layer simulation, on single
+// boxes of synthetic data, so kernel optimisations and compiler flags can be compared without
+// running a full simulation.
+
+#include "ParmParse.H"
+#include "parstream.H"
+#include "FArrayBox.H"
+#include "FluxBox.H"
+#include "BoxIterator.H"
+#include "SPMD.H"
+
+#include "AMRNonLinearMultiCompOpF_F.H"
+#include "DarcyBrinkmanOpF_F.H"
+#include "EnthalpyVariablesF_F.H"
+#include "AdvectUtilF_F.H"
+#include "CellToEdge2F_F.H"
+
+#include <chrono>
+#include <fstream>
+#include <functional>
+#include <iomanip>
+#include <map>
+#include <string>
+
+#include "UsingNamespace.H"
+
+/// Phase diagram parameters (dimensionless), read from parameters.* in the inputs file
+struct PhaseDiagramParams
+{
+  Real stefan, compositionRatio, specificHeatRatio, waterDistributionCoeff, thetaEutectic, ThetaEutectic;
+};
+
+/// Synthetic data for one cubic box
+/**
+ * A mushy layer fills the bottom 60% of the box, with porosity increasing linearly from 0.2 at the bottom to 1
+ * at the mush-liquid interface, and a liquid chimney through the middle of it. The temperature follows the
+ * liquidus in the mush, and increases linearly through the liquid above. Enthalpy and bulk concentration are
+ * consistent with this, so the phase diagram kernels see a realistic mix of liquid and mushy cells.
+ */
+struct BenchmarkData
+{
+  Box box, ghostBox;
+
+  FArrayBox HC, TCl, Hs, He, Hl, porosity;
+  FArrayBox rhs2, aCoef2, lambda2, res2;
+  FluxBox bCoef2;
+
+  FArrayBox vel1, rhs1, aCoef1, cCoef1, lambda1, lhs1;
+  FluxBox bCoef1;
+
+  FArrayBox cellVel, uDelU;
+  FluxBox edgeVel, edgePorosity;
+
+  Real dx;
+
+  void define(int a_boxSize, const PhaseDiagramParams& a_params);
+};
+
+void BenchmarkData::define(int a_boxSize, const PhaseDiagramParams& a_params)
+{
+  box = Box(IntVect::Zero, (a_boxSize-1)*IntVect::Unit);
+  ghostBox = grow(box, 1);
+  dx = 1.0/a_boxSize;
+
+  HC.define(ghostBox, 2);
+  TCl.define(ghostBox, 2);
+  Hs.define(ghostBox, 1);
+  He.define(ghostBox, 1);
+  Hl.define(ghostBox, 1);
+  porosity.define(ghostBox, 1);
+
+  const int vertDir = SpaceDim-1;
+  const Real interfaceHeight = 0.6;
+  const Real chimneyHalfWidth = 1.0/16;
+
+  for (BoxIterator bit(ghostBox); bit.ok(); ++bit)
+  {
+    const IntVect& iv = bit();
+    Real z = (iv[vertDir] + 0.5)*dx;
+
+    bool inChimney = true;
+    for (int dir = 0; dir < SpaceDim-1; dir++)
+    {
+      inChimney = inChimney && std::abs((iv[dir] + 0.5)*dx - 0.5) < chimneyHalfWidth;
+    }
+
+    Real chi, T, C;
+    if (z >= interfaceHeight || inChimney)
+    {
+      // Liquid at the far field concentration, above the liquidus
+      chi = 1.0;
+      C = -1.0;
+      T = 1.0 + std::max(z - interfaceHeight, 0.0);
+    }
+    else
+    {
+      // Mush, on the liquidus (T = -Cl)
+      Real zeta = std::max(z, 0.0)/interfaceHeight;
+      chi = 0.2 + 0.8*zeta;
+      T = 0.05 + 0.95*zeta;
+      Real Cl = -T;
+      C = Cl*(chi + a_params.waterDistributionCoeff*(1-chi)) - a_params.compositionRatio*(1-chi);
+    }
+
+    porosity(iv) = chi;
+    HC(iv, 0) = a_params.stefan*chi + T*(chi + a_params.specificHeatRatio*(1-chi));
+    HC(iv, 1) = C;
+  }
+
+  FORT_CALCULATE_BOUNDING_ENERGY(CHF_CONST_FRA(HC), CHF_FRA(Hs), CHF_FRA(He), CHF_FRA(Hl),
+                                 CHF_BOX(ghostBox),
+                                 CHF_CONST_REAL(a_params.compositionRatio),
+                                 CHF_CONST_REAL(a_params.waterDistributionCoeff),
+                                 CHF_CONST_REAL(a_params.specificHeatRatio),
+                                 CHF_CONST_REAL(a_params.stefan),
+                                 CHF_CONST_REAL(a_params.thetaEutectic),
+                                 CHF_CONST_REAL(a_params.ThetaEutectic));
+
+  FORT_CALCULATE_T_CL(CHF_FRA(TCl), CHF_CONST_FRA(HC), CHF_CONST_FRA(Hs), CHF_CONST_FRA(He), CHF_CONST_FRA(Hl),
+                      CHF_BOX(ghostBox),
+                      CHF_CONST_REAL(a_params.compositionRatio),
+                      CHF_CONST_REAL(a_params.waterDistributionCoeff),
+                      CHF_CONST_REAL(a_params.specificHeatRatio),
+                      CHF_CONST_REAL(a_params.stefan),
+                      CHF_CONST_REAL(a_params.thetaEutectic),
+                      CHF_CONST_REAL(a_params.ThetaEutectic));
+
+  // Enthalpy-bulk concentration operator: diffusivity ~ porosity, small relaxation coefficient so repeated
+  // smoothing stays bounded
+  rhs2.define(box, 2);
+  rhs2.setVal(0.0);
+  aCoef2.define(box, 2);
+  aCoef2.setVal(1.0);
+  lambda2.define(box, 2);
+  lambda2.setVal(0.1*dx*dx);
+  res2.define(box, 2);
+  bCoef2.define(box, 2);
+  bCoef2.setVal(1.0);
+
+  // Darcy-Brinkman operator for one velocity component: penalisation ~ (1-porosity)^2/porosity^3
+  vel1.define(ghostBox, 1);
+  rhs1.define(box, 1);
+  rhs1.setVal(0.0);
+  aCoef1.define(box, 1);
+  aCoef1.setVal(1.0);
+  cCoef1.define(box, 1);
+  lambda1.define(box, 1);
+  lambda1.setVal(0.1*dx*dx);
+  lhs1.define(box, 1);
+  bCoef1.define(box, 1);
+  bCoef1.setVal(1.0);
+
+  for (BoxIterator bit(ghostBox); bit.ok(); ++bit)
+  {
+    const IntVect& iv = bit();
+    Real chi = porosity(iv);
+    vel1(iv) = chi*(1-chi);
+    if (box.contains(iv))
+    {
+      cCoef1(iv) = -(1-chi)*(1-chi)/(chi*chi*chi);
+    }
+  }
+
+  // Advection of velocity
+  cellVel.define(box, SpaceDim);
+  uDelU.define(box, SpaceDim);
+  edgeVel.define(box, SpaceDim);
+  edgePorosity.define(box, 1);
+  for (int dir = 0; dir < SpaceDim; dir++)
+  {
+    cellVel.copy(vel1, 0, dir, 1);
+    edgeVel[dir].setVal(0.1*(dir+1));
+  }
+}
+
+/// Run a_kernel until at least a_minTime seconds have passed, and report its throughput
+static void timeKernel(const std::string& a_name, int a_boxSize, long a_cells, Real a_bytesPerCell,
+                       Real a_minTime, std::function<void()> a_kernel, std::ofstream& a_csv)
+{
+  // Warm up the caches
+  a_kernel();
+
+  long reps = 0;
+  Real elapsed = 0.0;
+  std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+  while (elapsed < a_minTime)
+  {
+    a_kernel();
+    reps++;
+
+    std::chrono::duration<Real> sinceStart = std::chrono::steady_clock::now() - start;
+    elapsed = sinceStart.count();
+  }
+
+  Real secondsPerCall = elapsed/reps;
+  Real cellsPerSecond = a_cells/secondsPerCall;
+  Real bytesPerSecond = cellsPerSecond*a_bytesPerCell;
+
+  pout() << std::setw(28) << std::left << a_name << std::setw(8) << std::right << a_boxSize
+      << std::setw(12) << reps
+      << std::setw(14) << std::scientific << std::setprecision(3) << secondsPerCall
+      << std::setw(14) << cellsPerSecond
+      << std::setw(14) << bytesPerSecond << std::fixed << endl;
+
+  if (procID() == 0)
+  {
+    a_csv << a_name << "," << SpaceDim << "," << a_boxSize << "," << a_cells << "," << reps << ","
+        << std::scientific << std::setprecision(6) << secondsPerCall << "," << cellsPerSecond << ","
+        << bytesPerSecond << std::fixed << "\n";
+  }
+}
+
+/// Time all the kernels on a box of side a_boxSize
+/**
+ * Bytes per cell are the minimum traffic to and from memory: every array a kernel reads or writes, once per cell,
+ * in double precision.
+ */
+static void benchmarkBoxSize(int a_boxSize, const PhaseDiagramParams& a_params, Real a_minTime,
+                             const Vector<std::string>& a_kernels, std::ofstream& a_csv)
+{
+  BenchmarkData data;
+  data.define(a_boxSize, a_params);
+
+  const Box& box = data.box;
+  const long cells = box.numPts();
+  const Real dx = data.dx;
+  const Real alpha = 1.0;
+  const Real beta = -1.0;
+  const Real bytes = sizeof(Real);
+
+  std::map<std::string, bool> run;
+  for (int i = 0; i < a_kernels.size(); i++)
+  {
+    run[a_kernels[i]] = true;
+  }
+  bool runAll = (a_kernels.size() == 0);
+
+  // Phase diagram
+  if (runAll || run["CALCULATE_BOUNDING_ENERGY"])
+  {
+    timeKernel("CALCULATE_BOUNDING_ENERGY", a_boxSize, cells, 5*bytes, a_minTime, [&]()
+    {
+      FORT_CALCULATE_BOUNDING_ENERGY(CHF_CONST_FRA(data.HC), CHF_FRA(data.Hs), CHF_FRA(data.He), CHF_FRA(data.Hl),
+                                     CHF_BOX(box),
+                                     CHF_CONST_REAL(a_params.compositionRatio),
+                                     CHF_CONST_REAL(a_params.waterDistributionCoeff),
+                                     CHF_CONST_REAL(a_params.specificHeatRatio),
+                                     CHF_CONST_REAL(a_params.stefan),
+                                     CHF_CONST_REAL(a_params.thetaEutectic),
+                                     CHF_CONST_REAL(a_params.ThetaEutectic));
+    }, a_csv);
+  }
+
+  if (runAll || run["CALCULATE_T_CL"])
+  {
+    timeKernel("CALCULATE_T_CL", a_boxSize, cells, 7*bytes, a_minTime, [&]()
+    {
+      FORT_CALCULATE_T_CL(CHF_FRA(data.TCl), CHF_CONST_FRA(data.HC),
+                          CHF_CONST_FRA(data.Hs), CHF_CONST_FRA(data.He), CHF_CONST_FRA(data.Hl),
+                          CHF_BOX(box),
+                          CHF_CONST_REAL(a_params.compositionRatio),
+                          CHF_CONST_REAL(a_params.waterDistributionCoeff),
+                          CHF_CONST_REAL(a_params.specificHeatRatio),
+                          CHF_CONST_REAL(a_params.stefan),
+                          CHF_CONST_REAL(a_params.thetaEutectic),
+                          CHF_CONST_REAL(a_params.ThetaEutectic));
+    }, a_csv);
+  }
+
+  // Enthalpy-bulk concentration multigrid: a red and a black pass, and the residual
+  if (runAll || run["NONLINEARSMOOTHING"])
+  {
+    int allComps = -1;
+    timeKernel("NONLINEARSMOOTHING", a_boxSize, cells, (14 + 2*SpaceDim)*bytes, a_minTime, [&]()
+    {
+      for (int whichPass = 0; whichPass <= 1; whichPass++)
+      {
+#if CH_SPACEDIM == 2
+        FORT_NONLINEARSMOOTHING2D
+#elif CH_SPACEDIM == 3
+        FORT_NONLINEARSMOOTHING3D
+#endif
+        (CHF_FRA(data.HC), CHF_FRA(data.TCl), CHF_CONST_FRA(data.rhs2), CHF_BOX(box),
+         CHF_CONST_REAL(dx), CHF_CONST_REAL(alpha), CHF_CONST_FRA(data.aCoef2), CHF_CONST_REAL(beta),
+         D_DECL(CHF_CONST_FRA(data.bCoef2[0]), CHF_CONST_FRA(data.bCoef2[1]), CHF_CONST_FRA(data.bCoef2[2])),
+         CHF_CONST_FRA(data.lambda2), CHF_CONST_INT(whichPass), CHF_CONST_INT(allComps));
+      }
+    }, a_csv);
+  }
+
+  if (runAll || run["NLVCCOMPUTERES"])
+  {
+    timeKernel("NLVCCOMPUTERES", a_boxSize, cells, (10 + 2*SpaceDim)*bytes, a_minTime, [&]()
+    {
+#if CH_SPACEDIM == 2
+      FORT_NLVCCOMPUTERES2D
+#elif CH_SPACEDIM == 3
+      FORT_NLVCCOMPUTERES3D
+#endif
+      (CHF_FRA(data.res2), CHF_CONST_FRA(data.HC), CHF_CONST_FRA(data.TCl), CHF_CONST_FRA(data.rhs2),
+       CHF_CONST_REAL(alpha), CHF_CONST_FRA(data.aCoef2), CHF_CONST_REAL(beta),
+       D_DECL(CHF_CONST_FRA(data.bCoef2[0]), CHF_CONST_FRA(data.bCoef2[1]), CHF_CONST_FRA(data.bCoef2[2])),
+       CHF_BOX(box), CHF_CONST_REAL(dx));
+    }, a_csv);
+  }
+
+  // Darcy-Brinkman multigrid: a red and a black pass, and the operator
+  if (runAll || run["GSRBHELMHOLTZDB"])
+  {
+    timeKernel("GSRBHELMHOLTZDB", a_boxSize, cells, (6 + SpaceDim)*bytes, a_minTime, [&]()
+    {
+      for (int whichPass = 0; whichPass <= 1; whichPass++)
+      {
+#if CH_SPACEDIM == 2
+        FORT_GSRBHELMHOLTZDB2D
+#elif CH_SPACEDIM == 3
+        FORT_GSRBHELMHOLTZDB3D
+#endif
+        (CHF_FRA(data.vel1), CHF_CONST_FRA(data.rhs1), CHF_BOX(box), CHF_CONST_REAL(dx),
+         CHF_CONST_REAL(alpha), CHF_CONST_FRA(data.aCoef1), CHF_CONST_FRA(data.cCoef1), CHF_CONST_REAL(beta),
+         D_DECL(CHF_CONST_FRA(data.bCoef1[0]), CHF_CONST_FRA(data.bCoef1[1]), CHF_CONST_FRA(data.bCoef1[2])),
+         CHF_CONST_FRA(data.lambda1), CHF_CONST_INT(whichPass));
+      }
+    }, a_csv);
+  }
+
+  if (runAll || run["DBCOMPUTEOP"])
+  {
+    timeKernel("DBCOMPUTEOP", a_boxSize, cells, (4 + SpaceDim)*bytes, a_minTime, [&]()
+    {
+#if CH_SPACEDIM == 2
+      FORT_DBCOMPUTEOP2D
+#elif CH_SPACEDIM == 3
+      FORT_DBCOMPUTEOP3D
+#endif
+      (CHF_FRA(data.lhs1), CHF_CONST_FRA(data.vel1), CHF_CONST_REAL(alpha),
+       CHF_CONST_FRA(data.aCoef1), CHF_CONST_FRA(data.cCoef1), CHF_CONST_REAL(beta),
+       D_DECL(CHF_CONST_FRA(data.bCoef1[0]), CHF_CONST_FRA(data.bCoef1[1]), CHF_CONST_FRA(data.bCoef1[2])),
+       CHF_BOX(box), CHF_CONST_REAL(dx));
+    }, a_csv);
+  }
+
+  // Velocity advection, over all directions as in computeUDelU
+  if (runAll || run["UDELS"])
+  {
+    Real dxNonConst = dx;
+    timeKernel("UDELS", a_boxSize, cells, SpaceDim*(3*SpaceDim + 1)*bytes, a_minTime, [&]()
+    {
+      for (int dir = 0; dir < SpaceDim; dir++)
+      {
+        FORT_UDELS(CHF_FRA(data.uDelU), CHF_FRA(data.edgeVel[dir]), CHF_FRA(data.cellVel),
+                   CHF_BOX(box), CHF_REAL(dxNonConst), CHF_INT(dir));
+      }
+    }, a_csv);
+  }
+
+  // Face permeability/porosity, over all directions
+  if (runAll || run["CELLTOEDGEGEOMETRIC"])
+  {
+    timeKernel("CELLTOEDGEGEOMETRIC", a_boxSize, cells, 2*SpaceDim*bytes, a_minTime, [&]()
+    {
+      for (int dir = 0; dir < SpaceDim; dir++)
+      {
+        Box edgeBox = surroundingNodes(box, dir);
+        FORT_CELLTOEDGEGEOMETRIC(CHF_CONST_FRA1(data.porosity, 0), CHF_FRA1(data.edgePorosity[dir], 0),
+                                 CHF_BOX(edgeBox), CHF_CONST_INT(dir));
+      }
+    }, a_csv);
+  }
+}
+
+int main(int a_argc, char* a_argv[])
+{
+#ifdef CH_MPI
+  MPI_Init(&a_argc, &a_argv);
+#endif
+  { // scoping trick
+
+    // The inputs file is optional, everything has a default
+    char* inFile = NULL;
+    int numArgs = 0;
+    if (a_argc > 1)
+    {
+      inFile = a_argv[1];
+      numArgs = a_argc-2;
+    }
+    ParmParse pp(numArgs, a_argv+2, NULL, inFile);
+
+    ParmParse ppBench("bench");
+
+    std::vector<int> boxSizes;
+    if (ppBench.contains("box_sizes"))
+    {
+      ppBench.getarr("box_sizes", boxSizes, 0, ppBench.countval("box_sizes"));
+    }
+    else
+    {
+      boxSizes.push_back(16);
+      boxSizes.push_back(32);
+      boxSizes.push_back(64);
+      boxSizes.push_back(128);
+    }
+
+    // Minimum time to spend on each kernel, for each box size
+    Real minTime = 0.5;
+    ppBench.query("min_time", minTime);
+
+    // Only run these kernels (default is all of them)
+    Vector<std::string> kernels;
+    if (ppBench.contains("kernels"))
+    {
+      std::vector<std::string> kernelList;
+      ppBench.getarr("kernels", kernelList, 0, ppBench.countval("kernels"));
+      kernels = Vector<std::string>(kernelList);
+    }
+
+    std::string outFile = "kernelBenchmarks.csv";
+    ppBench.query("output_file", outFile);
+
+    // Defaults are for sea ice (NaCl solution, 30 ppt far field, 230 ppt eutectic)
+    PhaseDiagramParams params;
+    params.stefan = 5.0;
+    params.compositionRatio = 1.15;
+    params.specificHeatRatio = 1.0;
+    params.waterDistributionCoeff = 1e-5;
+    params.thetaEutectic = 0.0;
+    params.ThetaEutectic = 0.0;
+
+    ParmParse ppParams("parameters");
+    ppParams.query("stefan", params.stefan);
+    ppParams.query("compositionRatio", params.compositionRatio);
+    ppParams.query("specificHeatRatio", params.specificHeatRatio);
+    ppParams.query("waterDistributionCoeff", params.waterDistributionCoeff);
+
+    std::ofstream csv;
+    if (procID() == 0)
+    {
+      csv.open(outFile.c_str());
+      csv << "kernel,spaceDim,boxSize,cells,reps,secondsPerCall,cellsPerSecond,bytesPerSecond\n";
+    }
+
+    pout() << "Kernel benchmarks (" << SpaceDim << "D), at least " << minTime << "s per kernel and box size" << endl;
+    pout() << std::setw(28) << std::left << "kernel" << std::setw(8) << std::right << "box"
+        << std::setw(12) << "reps" << std::setw(14) << "s/call" << std::setw(14) << "cells/s"
+        << std::setw(14) << "bytes/s" << endl;
+
+    for (int i = 0; i < boxSizes.size(); i++)
+    {
+      benchmarkBoxSize(boxSizes[i], params, minTime, kernels, csv);
+    }
+
+    if (procID() == 0)
+    {
+      csv.close();
+      pout() << "Results written to " << outFile << endl;
+    }
+
+  } // end scoping trick
+
+#ifdef CH_MPI
+  MPI_Finalize();
+#endif
+
+  return 0;
+}
@@ -60,6 +60,11 @@ void mushyLayer(const Real& a_stopTime,
   // Also cleanup everything.
   amr.conclude();
 
+#ifdef CH_USE_HDF5
+  // Make sure the last files are complete before we exit
+  AMRLevelMushyLayer::finishAsyncOutput();
+#endif
+
 }
 /***************/
 int
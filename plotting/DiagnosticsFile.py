@@ -0,0 +1,66 @@
+# Read the diagnostics written during a simulation
+# diagnostics.bin is written when main.diagnosticsFormat=binary, otherwise diagnostics.csv
+import os
+import struct
+import numpy as np
+
+BINARY_MAGIC = b'MUSHDIAG'
+BINARY_VERSION = 1
+
+
+def read_diagnostics_binary(filename):
+    """ Read a binary diagnostics file, returning a dictionary of numpy arrays (one per diagnostic) """
+
+    with open(filename, 'rb') as f:
+        contents = f.read()
+
+    if contents[:len(BINARY_MAGIC)] != BINARY_MAGIC:
+        raise ValueError('%s is not a binary diagnostics file' % filename)
+
+    pos = len(BINARY_MAGIC)
+    version, real_size, num_diags = struct.unpack_from('<iii', contents, pos)
+    pos = pos + 12
+
+    if version != BINARY_VERSION:
+        raise ValueError('Unknown diagnostics file version %d' % version)
+
+    names = []
+    for i in range(num_diags):
+        name_len = struct.unpack_from('<i', contents, pos)[0]
+        pos = pos + 4
+        names.append(contents[pos:pos + name_len].decode('UTF-8'))
+        pos = pos + name_len
+
+    dtype = np.float64 if real_size == 8 else np.float32
+
+    # Each step is num_diags values. Ignore any partly written step at the end of the file.
+    step_size = num_diags * real_size
+    num_steps = (len(contents) - pos) // step_size
+    values = np.frombuffer(contents, dtype=dtype, count=num_steps * num_diags, offset=pos)
+    values = values.reshape((num_steps, num_diags))
+
+    return {name: values[:, i].astype(np.float64) for i, name in enumerate(names)}
+
+
+def read_diagnostics_text(filename):
+    """ Read a diagnostics.csv file, returning a dictionary of numpy arrays (one per diagnostic) """
+
+    with open(filename, 'r') as f:
+        lines = f.read().splitlines()
+
+    # The header is written again each time a simulation is restarted, so skip any repeats
+    names = lines[0].split(',')
+    rows = [line.split(',') for line in lines[1:] if line and line != lines[0]]
+    values = np.array(rows, dtype=np.float64).reshape((len(rows), len(names)))
+
+    return {name: values[:, i] for i, name in enumerate(names)}
+
+
+def read_diagnostics(folder):
+    """ Read the diagnostics for the simulation in folder, in whichever format they were written """
+
+    binary_file = os.path.join(folder, 'diagnostics.bin')
+    if os.path.exists(binary_file):
+        return read_diagnostics_binary(binary_file)
+
+    return read_diagnostics_text(os.path.join(folder, 'diagnostics.csv'))
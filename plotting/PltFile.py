@@ -312,7 +312,9 @@ class PltFile:
                 # advVel_offsets = level_group['advVel:offsets=0']
                 # advVel_atts = level_group['advVel_attributes']
 
-                data_unshaped = data[()]
+                # Data may be stored in single precision (see main.plot_single_precision_vars),
+                # so always convert to double. Compression filters are undone by h5py.
+                data_unshaped = data[()].astype(np.float64)
 
 
 
@@ -425,7 +427,7 @@ class PltFile:
 
                             num_comps = 1
 
-                        data_unshaped = data[()]
+                        data_unshaped = data[()].astype(np.float64)
 
 
 
@@ -28,18 +28,63 @@
 #include "DebugOut.H"
 #include "MushyLayerUtils.H"
 #include "EnthalpyVariablesF_F.H"
+#include "phaseDiagram.H"
+
+#include <algorithm>
+#include <chrono>
 
 #include "CoefficientInterpolatorLinear.H"
 
 #include "NamespaceHeader.H"
 
+void AMRNonLinearMultiCompOp::refreshSharedState()
+{
+  if (m_sharedState.isNull() || m_sharedState->m_version == m_stateVersion)
+  {
+    return;
+  }
+
+  CH_TIME("AMRNonLinearMultiCompOp::refreshSharedState");
+
+  m_bc = m_sharedState->m_bc;
+  m_diffusedVarBC = m_sharedState->m_derivedBC;
+
+  // Multigrid levels below the AMR level hold their own averaged copies of the coefficients
+  if (m_coarsening > 1 && !m_aCoefFine.isNull() && !m_bCoefFine.isNull())
+  {
+    CoarseAverage averager(m_aCoefFine->getBoxes(), m_aCoef->disjointBoxLayout(),
+                           m_aCoef->nComp(), m_coarsening);
+    CoarseAverageFace faceAverager(m_bCoefFine->getBoxes(), m_bCoef->nComp(), m_coarsening);
+
+    if (m_coefficient_average_type == CoarseAverage::harmonic)
+    {
+      averager.averageToCoarseHarmonic(*m_aCoef, *m_aCoefFine);
+      faceAverager.averageToCoarseHarmonic(*m_bCoef, *m_bCoefFine);
+    }
+    else
+    {
+      averager.averageToCoarse(*m_aCoef, *m_aCoefFine);
+      faceAverager.averageToCoarse(*m_bCoef, *m_bCoefFine);
+    }
+  }
+
+  m_lambdaNeedsResetting = true;
+  m_stateVersion = m_sharedState->m_version;
+}
+
 void AMRNonLinearMultiCompOp::computeDiffusedVar(LevelData<FArrayBox>& a_diffusedVar, const LevelData<FArrayBox>& a_phi, bool a_homogeneous)
 {
   CH_TIME("AMRNonLinearMultiCompOp::computeDerivedVar");
 
-  for (DataIterator dit = a_phi.dataIterator(); dit.ok(); ++dit)
+  refreshSharedState();
+
+  DataIterator dit = a_phi.dataIterator();
+  int nbox = dit.size();
+
+#pragma omp parallel for
+  for (int ibox = 0; ibox < nbox; ibox++)
   {
-    computeDiffusedVar(a_diffusedVar[dit], a_phi[dit], dit(), a_homogeneous);
+    computeDiffusedVar(a_diffusedVar[dit[ibox]], a_phi[dit[ibox]], dit[ibox], a_homogeneous);
   }
 
 
@@ -58,43 +103,100 @@ void AMRNonLinearMultiCompOp::computeDiffusedVar(FArrayBox& a_diffusedVar,
                                                  const FArrayBox& a_phi, const DataIndex dit,
                                                  bool a_homogeneous)
 {
-  // Another attempt to stop solver fails - recalculate solidus/eutectic/liquidus each time
+  computeDiffusedVarColour(a_diffusedVar, a_phi, a_diffusedVar.box(), -1, a_homogeneous);
+}
 
-  FArrayBox& Hs = (*m_enthalpySolidus)[dit];
-  FArrayBox& He = (*m_enthalpyEutectic)[dit];
-  FArrayBox& Hl = (*m_enthalpyLiquidus)[dit];
+void AMRNonLinearMultiCompOp::computeTCl(FArrayBox& a_TCl, const FArrayBox& a_HC,
+                                         const Box& a_region, int a_colour)
+{
+  if (!m_params->m_phaseDiagramTable.isNull())
+  {
+    const PhaseDiagramTable& table = *m_params->m_phaseDiagramTable;
+    int nH = table.nH();
+    int nC = table.nC();
+    Real Hmin = table.Hmin();
+    Real dH = table.dH();
+    Real Cmin = table.Cmin();
+    Real dC = table.dC();
+
+    FORT_CALCULATE_T_CL_TABLE(CHF_FRA(a_TCl),
+                              CHF_CONST_FRA(a_HC),
+                              CHF_BOX(a_region),
+                              CHF_CONST_INT(a_colour),
+                              CHF_CONST_VR(table.table()),
+                              CHF_CONST_VI(table.exactCells()),
+                              CHF_CONST_INT(nH),
+                              CHF_CONST_INT(nC),
+                              CHF_CONST_REAL(Hmin),
+                              CHF_CONST_REAL(dH),
+                              CHF_CONST_REAL(Cmin),
+                              CHF_CONST_REAL(dC),
+                              CHF_CONST_REAL(m_params->compositionRatio),
+                              CHF_CONST_REAL(m_params->waterDistributionCoeff),
+                              CHF_CONST_REAL(m_params->specificHeatRatio),
+                              CHF_CONST_REAL(m_params->stefan),
+                              CHF_CONST_REAL(m_params->thetaEutectic),
+                              CHF_CONST_REAL(m_params->ThetaEutectic));
+  }
+  else
+  {
+    FORT_CALCULATE_T_CL_FUSED(CHF_FRA(a_TCl),
+                              CHF_CONST_FRA(a_HC),
+                              CHF_BOX(a_region),
+                              CHF_CONST_INT(a_colour),
+                              CHF_CONST_REAL(m_params->compositionRatio),
+                              CHF_CONST_REAL(m_params->waterDistributionCoeff),
+                              CHF_CONST_REAL(m_params->specificHeatRatio),
+                              CHF_CONST_REAL(m_params->stefan),
+                              CHF_CONST_REAL(m_params->thetaEutectic),
+                              CHF_CONST_REAL(m_params->ThetaEutectic));
+  }
+}
 
-  Box region = a_diffusedVar.box();
-  region &= Hs.box();
-
-  FORT_CALCULATE_BOUNDING_ENERGY( CHF_CONST_FRA(a_phi),
-                       CHF_FRA(Hs),
-                       CHF_FRA(He),
-                       CHF_FRA(Hl),
-                       CHF_BOX(region),
-                       CHF_CONST_REAL(m_params->compositionRatio),
-                       CHF_CONST_REAL(m_params->waterDistributionCoeff),
-                       CHF_CONST_REAL(m_params->specificHeatRatio),
-                       CHF_CONST_REAL(m_params->stefan),
-                       CHF_CONST_REAL(m_params->thetaEutectic),
-                       CHF_CONST_REAL(m_params->ThetaEutectic));
+void AMRNonLinearMultiCompOp::computeDiffusedVarColour(FArrayBox& a_diffusedVar,
+                                                       const FArrayBox& a_phi,
+                                                       const Box& a_valid, int a_colour,
+                                                       bool a_homogeneous)
+{
+  // Another attempt to stop solver fails - recalculate solidus/eutectic/liquidus each time.
+  // These are now computed on the fly inside the same loop as T and Cl, so we
+  // only sweep through the data once.
 
   // Apply BCs to H-C, then compute T, S_l, porosity BC from these values
   // a_phi is const so can't apply BCs here - assume they're already set
 //  m_bc(a_phi, m_domain.domainBox(), m_domain, m_dx, a_homogeneous);
 
-  FORT_CALCULATE_T_CL(CHF_FRA(a_diffusedVar),
-                      CHF_CONST_FRA(a_phi),
-                      CHF_CONST_FRA(Hs),
-                      CHF_CONST_FRA(He),
-                      CHF_CONST_FRA(Hl),
-                      CHF_BOX(region),
-                      CHF_CONST_REAL(m_params->compositionRatio),
-                      CHF_CONST_REAL(m_params->waterDistributionCoeff),
-                      CHF_CONST_REAL(m_params->specificHeatRatio),
-                      CHF_CONST_REAL(m_params->stefan),
-                      CHF_CONST_REAL(m_params->thetaEutectic),
-                      CHF_CONST_REAL(m_params->ThetaEutectic));
+  Box valid = a_valid;
+  valid &= a_diffusedVar.box();
+  valid &= a_phi.box();
+
+  computeTCl(a_diffusedVar, a_phi, valid, a_colour);
+
+  computeDiffusedVarGhosts(a_diffusedVar, a_phi, valid, a_homogeneous);
+}
+
+void AMRNonLinearMultiCompOp::computeDiffusedVarGhosts(FArrayBox& a_diffusedVar,
+                                                       const FArrayBox& a_phi,
+                                                       const Box& a_valid,
+                                                       bool a_homogeneous)
+{
+  Box region = a_diffusedVar.box();
+  region &= a_phi.box();
+
+  Box valid = a_valid;
+  valid &= region;
+
+  // Ghost cells may have been changed by exchanges or BCs, so always recompute all of them
+  if (valid != region)
+  {
+    int allColours = -1;
+    Vector<Box> ghostBoxes;
+    boxShell(ghostBoxes, region, valid);
+    for (int i = 0; i < ghostBoxes.size(); i++)
+    {
+      computeTCl(a_diffusedVar, a_phi, ghostBoxes[i], allColours);
+    }
+  }
 
   if (m_apply_bcs_to_diagnostic_var)
   {
@@ -104,6 +206,20 @@ void AMRNonLinearMultiCompOp::computeDiffusedVar(FArrayBox& a_diffusedVar,
 //  this->m_bc
 }
 
+LevelData<FArrayBox>& AMRNonLinearMultiCompOp::derivedVarScratch(const LevelData<FArrayBox>& a_phi)
+{
+  if (!m_derivedVarScratch.isDefined()
+      || !(m_derivedVarScratch.disjointBoxLayout() == a_phi.disjointBoxLayout())
+      || m_derivedVarScratch.nComp() != a_phi.nComp()
+      || m_derivedVarScratch.ghostVect() != a_phi.ghostVect())
+  {
+    CH_TIME("AMRNonLinearMultiCompOp::derivedVarDefine");
+    m_derivedVarScratch.define(a_phi.disjointBoxLayout(), a_phi.nComp(), a_phi.ghostVect());
+  }
+
+  return m_derivedVarScratch;
+}
+
 void AMRNonLinearMultiCompOp::residualI(LevelData<FArrayBox>&       a_lhs,
                                         const LevelData<FArrayBox>& a_phi,
                                         const LevelData<FArrayBox>& a_rhs,
@@ -111,18 +227,22 @@ void AMRNonLinearMultiCompOp::residualI(LevelData<FArrayBox>&       a_lhs,
 {
   CH_TIME("AMRNonLinearMultiCompOp::residualI");
 
+  refreshSharedState();
+
   LevelData<FArrayBox>& phi = (LevelData<FArrayBox>&)a_phi;
-  LevelData<FArrayBox> derivedVar(phi.disjointBoxLayout(), phi.nComp(), phi.ghostVect());
+  LevelData<FArrayBox>& derivedVar = derivedVarScratch(phi);
 
   Real dx = m_dx;
   const DisjointBoxLayout& dbl = a_lhs.disjointBoxLayout();
   DataIterator dit = phi.dataIterator();
+  int nbox = dit.size();
   {
     CH_TIME("AMRNonLinearMultiCompOp::residualIBC");
 
-    for (dit.begin(); dit.ok(); ++dit)
+#pragma omp parallel for
+    for (int ibox = 0; ibox < nbox; ibox++)
     {
-      m_bc(phi[dit], dbl[dit()],m_domain, dx, a_homogeneous);
+      m_bc(phi[dit[ibox]], dbl[dit[ibox]],m_domain, dx, a_homogeneous);
     }
   }
 
@@ -131,14 +251,16 @@ void AMRNonLinearMultiCompOp::residualI(LevelData<FArrayBox>&       a_lhs,
 
   //  computeDiffusedVar(derivedVar, phi, a_homogeneous);
 
-  for (dit.begin(); dit.ok(); ++dit)
+#pragma omp parallel for
+  for (int ibox = 0; ibox < nbox; ibox++)
   {
-    const Box& region = dbl[dit()];
-    const FluxBox& thisBCoef = (*m_bCoef)[dit];
+    const DataIndex& din = dit[ibox];
+    const Box& region = dbl[din];
+    const FluxBox& thisBCoef = (*m_bCoef)[din];
 
     //FArrayBox derivedVar(phi[dit]);
     // Is this quicker than the level data version?
-    computeDiffusedVar(derivedVar[dit], phi[dit], dit(), a_homogeneous);
+    computeDiffusedVar(derivedVar[din], phi[din], din, a_homogeneous);
 
 
 
@@ -152,12 +274,12 @@ void AMRNonLinearMultiCompOp::residualI(LevelData<FArrayBox>&       a_lhs,
 #else
     //		This_will_not_compile!
 #endif
-    (CHF_FRA(a_lhs[dit]),
-     CHF_CONST_FRA(phi[dit]),
-     CHF_CONST_FRA(derivedVar[dit]),
-     CHF_CONST_FRA(a_rhs[dit]),
+    (CHF_FRA(a_lhs[din]),
+     CHF_CONST_FRA(phi[din]),
+     CHF_CONST_FRA(derivedVar[din]),
+     CHF_CONST_FRA(a_rhs[din]),
      CHF_CONST_REAL(m_alpha),
-     CHF_CONST_FRA((*m_aCoef)[dit]),
+     CHF_CONST_FRA((*m_aCoef)[din]),
      CHF_CONST_REAL(m_beta),
 #if CH_SPACEDIM >= 1
      CHF_CONST_FRA(thisBCoef[0]),
@@ -206,14 +328,19 @@ void AMRNonLinearMultiCompOp::preCond(LevelData<FArrayBox>&       a_phi,
 
   // don't need to use a Copier -- plain copy will do
   DataIterator dit = a_phi.dataIterator();
-  for (dit.begin(); dit.ok(); ++dit)
+  int nbox = dit.size();
+
+#pragma omp parallel for
+  for (int ibox = 0; ibox < nbox; ibox++)
   {
+    const DataIndex& din = dit[ibox];
+
     // also need to average and sum face-centered bCoefs to cell-centers
-    Box gridBox = a_rhs[dit].box();
+    Box gridBox = a_rhs[din].box();
 
     // approximate inverse
-    a_phi[dit].copy(a_rhs[dit]);
-    a_phi[dit].mult(m_lambda[dit], gridBox, 0, 0, ncomp);
+    a_phi[din].copy(a_rhs[din]);
+    a_phi[din].mult(m_lambda[din], gridBox, 0, 0, ncomp);
   }
 
   relax(a_phi, a_rhs, 2);
@@ -242,14 +369,18 @@ void AMRNonLinearMultiCompOp::applyOpI(LevelData<FArrayBox>&      a_lhs,
                                        bool                        a_homogeneous )
 {
   CH_TIME("AMRNonLinearMultiCompOp::applyOpI");
+
+  refreshSharedState();
   LevelData<FArrayBox>& phi = (LevelData<FArrayBox>&)a_phi;
   Real dx = m_dx;
   const DisjointBoxLayout& dbl = a_lhs.disjointBoxLayout();
   DataIterator dit = phi.dataIterator();
+  int nbox = dit.size();
 
-  for (dit.begin(); dit.ok(); ++dit)
+#pragma omp parallel for
+  for (int ibox = 0; ibox < nbox; ibox++)
   {
-    m_bc(phi[dit], dbl[dit()],m_domain, dx, a_homogeneous);
+    m_bc(phi[dit[ibox]], dbl[dit[ibox]],m_domain, dx, a_homogeneous);
   }
 
   applyOpNoBoundary2(a_lhs, a_phi,a_homogeneous );
@@ -261,9 +392,11 @@ void AMRNonLinearMultiCompOp::applyOpNoBoundary2(LevelData<FArrayBox>&      a_lh
 {
   CH_TIME("AMRNonLinearMultiCompOp::applyOpNoBoundary");
 
+  refreshSharedState();
+
   LevelData<FArrayBox>& phi = (LevelData<FArrayBox>&)a_phi;
 
-  LevelData<FArrayBox> derivedVar(phi.disjointBoxLayout(), phi.nComp(), phi.ghostVect());
+  LevelData<FArrayBox>& derivedVar = derivedVarScratch(phi);
 
   const DisjointBoxLayout& dbl = a_lhs.disjointBoxLayout();
   DataIterator dit = phi.dataIterator();
@@ -272,10 +405,14 @@ void AMRNonLinearMultiCompOp::applyOpNoBoundary2(LevelData<FArrayBox>&      a_lh
 
   computeDiffusedVar(derivedVar, phi, a_homogeneous);
 
-  for (dit.begin(); dit.ok(); ++dit)
+  int nbox = dit.size();
+
+#pragma omp parallel for
+  for (int ibox = 0; ibox < nbox; ibox++)
   {
-    const Box& region = dbl[dit()];
-    const FluxBox& thisBCoef = (*m_bCoef)[dit];
+    const DataIndex& din = dit[ibox];
+    const Box& region = dbl[din];
+    const FluxBox& thisBCoef = (*m_bCoef)[din];
 
 #if CH_SPACEDIM == 1
     FORT_NLVCCOMPUTEOP1D
@@ -287,11 +424,11 @@ void AMRNonLinearMultiCompOp::applyOpNoBoundary2(LevelData<FArrayBox>&      a_lh
 #else
     //		This_will_not_compile!
 #endif
-    (CHF_FRA(a_lhs[dit]),
-     CHF_CONST_FRA(phi[dit]),
-     CHF_CONST_FRA(derivedVar[dit]),
+    (CHF_FRA(a_lhs[din]),
+     CHF_CONST_FRA(phi[din]),
+     CHF_CONST_FRA(derivedVar[din]),
      CHF_CONST_REAL(m_alpha),
-     CHF_CONST_FRA((*m_aCoef)[dit]),
+     CHF_CONST_FRA((*m_aCoef)[din]),
      CHF_CONST_REAL(m_beta),
 #if CH_SPACEDIM >= 1
      CHF_CONST_FRA(thisBCoef[0]),
@@ -317,9 +454,11 @@ void AMRNonLinearMultiCompOp::applyOpNoBoundary(LevelData<FArrayBox>&      a_lhs
 {
   CH_TIME("AMRNonLinearMultiCompOp::applyOpNoBoundary");
 
+  refreshSharedState();
+
   LevelData<FArrayBox>& phi = (LevelData<FArrayBox>&)a_phi;
 
-  LevelData<FArrayBox> derivedVar(phi.disjointBoxLayout(), phi.nComp(), phi.ghostVect());
+  LevelData<FArrayBox>& derivedVar = derivedVarScratch(phi);
 
   const DisjointBoxLayout& dbl = a_lhs.disjointBoxLayout();
   DataIterator dit = phi.dataIterator();
@@ -328,10 +467,14 @@ void AMRNonLinearMultiCompOp::applyOpNoBoundary(LevelData<FArrayBox>&      a_lhs
 
   computeDiffusedVar(derivedVar, phi);
 
-  for (dit.begin(); dit.ok(); ++dit)
+  int nbox = dit.size();
+
+#pragma omp parallel for
+  for (int ibox = 0; ibox < nbox; ibox++)
   {
-    const Box& region = dbl[dit()];
-    const FluxBox& thisBCoef = (*m_bCoef)[dit];
+    const DataIndex& din = dit[ibox];
+    const Box& region = dbl[din];
+    const FluxBox& thisBCoef = (*m_bCoef)[din];
 
 #if CH_SPACEDIM == 1
     FORT_NLVCCOMPUTEOP1D
@@ -343,11 +486,11 @@ void AMRNonLinearMultiCompOp::applyOpNoBoundary(LevelData<FArrayBox>&      a_lhs
 #else
     //		This_will_not_compile!
 #endif
-    (CHF_FRA(a_lhs[dit]),
-     CHF_CONST_FRA(phi[dit]),
-     CHF_CONST_FRA(derivedVar[dit]),
+    (CHF_FRA(a_lhs[din]),
+     CHF_CONST_FRA(phi[din]),
+     CHF_CONST_FRA(derivedVar[din]),
      CHF_CONST_REAL(m_alpha),
-     CHF_CONST_FRA((*m_aCoef)[dit]),
+     CHF_CONST_FRA((*m_aCoef)[din]),
      CHF_CONST_REAL(m_beta),
 #if CH_SPACEDIM >= 1
      CHF_CONST_FRA(thisBCoef[0]),
@@ -366,6 +509,138 @@ void AMRNonLinearMultiCompOp::applyOpNoBoundary(LevelData<FArrayBox>&      a_lhs
   } // end loop over boxes
 }
 
+void AMRNonLinearMultiCompOp::computePhaseDiagramJacobian(LevelData<FArrayBox>& a_jacobian,
+                                                          const LevelData<FArrayBox>& a_phi)
+{
+  CH_TIME("AMRNonLinearMultiCompOp::computePhaseDiagramJacobian");
+
+  CH_assert(a_jacobian.nComp() == 4);
+  CH_assert(a_phi.nComp() == 2);
+
+  const PhaseDiagramTable* table = NULL;
+  if (!m_params->m_phaseDiagramTable.isNull())
+  {
+    table = &(*m_params->m_phaseDiagramTable);
+  }
+
+  DataIterator dit = a_phi.dataIterator();
+  int nbox = dit.size();
+
+#pragma omp parallel for
+  for (int ibox = 0; ibox < nbox; ibox++)
+  {
+    const DataIndex& din = dit[ibox];
+    const FArrayBox& phi = a_phi[din];
+    FArrayBox& jacobian = a_jacobian[din];
+
+    Box region = phi.box();
+    region &= jacobian.box();
+
+    for (BoxIterator bit(region); bit.ok(); ++bit)
+    {
+      const IntVect& iv = bit();
+      computeTClJacobian(phi(iv, 0), phi(iv, 1),
+                         jacobian(iv, 0), jacobian(iv, 1), jacobian(iv, 2), jacobian(iv, 3),
+                         m_params->compositionRatio, m_params->specificHeatRatio,
+                         m_params->stefan, m_params->waterDistributionCoeff,
+                         m_params->thetaEutectic, m_params->ThetaEutectic);
+
+      // Where the residual uses the lookup table (see computeTCl), differentiate that instead
+      if (table != NULL)
+      {
+        table->bilinearDerivatives(phi(iv, 0), phi(iv, 1), PhaseDiagramTable::m_temperature,
+                                   jacobian(iv, 0), jacobian(iv, 1));
+        table->bilinearDerivatives(phi(iv, 0), phi(iv, 1), PhaseDiagramTable::m_liquidConcentration,
+                                   jacobian(iv, 2), jacobian(iv, 3));
+      }
+    }
+  }
+}
+
+void AMRNonLinearMultiCompOp::applyJacobian(LevelData<FArrayBox>&       a_lhs,
+                                            const LevelData<FArrayBox>& a_v,
+                                            const LevelData<FArrayBox>& a_jacobian)
+{
+  CH_TIME("AMRNonLinearMultiCompOp::applyJacobian");
+
+  refreshSharedState();
+
+  LevelData<FArrayBox>& v = (LevelData<FArrayBox>&)a_v;
+  const DisjointBoxLayout& dbl = a_lhs.disjointBoxLayout();
+  DataIterator dit = v.dataIterator();
+  int nbox = dit.size();
+
+  homogeneousCFInterp(v);
+
+#pragma omp parallel for
+  for (int ibox = 0; ibox < nbox; ibox++)
+  {
+    m_bc(v[dit[ibox]], dbl[dit[ibox]], m_domain, m_dx, true);
+  }
+
+  v.exchange(v.interval(), m_exchangeCopier);
+
+  // Linearised temperature and liquid concentration
+  LevelData<FArrayBox>& derivedVar = derivedVarScratch(v);
+
+#pragma omp parallel for
+  for (int ibox = 0; ibox < nbox; ibox++)
+  {
+    const DataIndex& din = dit[ibox];
+    const FArrayBox& thisV = v[din];
+    const FArrayBox& jacobian = a_jacobian[din];
+    FArrayBox& thisDerivedVar = derivedVar[din];
+
+    Box region = thisDerivedVar.box();
+    region &= jacobian.box();
+
+    for (BoxIterator bit(region); bit.ok(); ++bit)
+    {
+      const IntVect& iv = bit();
+      thisDerivedVar(iv, 0) = jacobian(iv, 0)*thisV(iv, 0) + jacobian(iv, 1)*thisV(iv, 1);
+      thisDerivedVar(iv, 1) = jacobian(iv, 2)*thisV(iv, 0) + jacobian(iv, 3)*thisV(iv, 1);
+    }
+
+    if (m_apply_bcs_to_diagnostic_var)
+    {
+      m_diffusedVarBC(thisDerivedVar, m_domain.domainBox(), m_domain, m_dx, true);
+    }
+
+    const Box& validRegion = dbl[din];
+    const FluxBox& thisBCoef = (*m_bCoef)[din];
+
+#if CH_SPACEDIM == 1
+    FORT_NLVCCOMPUTEOP1D
+#elif CH_SPACEDIM == 2
+    FORT_NLVCCOMPUTEOP2D
+#elif CH_SPACEDIM == 3
+    FORT_NLVCCOMPUTEOP3D
+#else
+    //		This_will_not_compile!
+#endif
+    (CHF_FRA(a_lhs[din]),
+     CHF_CONST_FRA(thisV),
+     CHF_CONST_FRA(thisDerivedVar),
+     CHF_CONST_REAL(m_alpha),
+     CHF_CONST_FRA((*m_aCoef)[din]),
+     CHF_CONST_REAL(m_beta),
+#if CH_SPACEDIM >= 1
+     CHF_CONST_FRA(thisBCoef[0]),
+#endif
+#if CH_SPACEDIM >= 2
+     CHF_CONST_FRA(thisBCoef[1]),
+#endif
+#if CH_SPACEDIM >= 3
+     CHF_CONST_FRA(thisBCoef[2]),
+#endif
+#if CH_SPACEDIM >= 4
+     This_will_not_compile!
+#endif
+     CHF_BOX(validRegion),
+     CHF_CONST_REAL(m_dx));
+  }
+}
+
 // Re implement here in a slightly different way to AMRPoissonOp
 void AMRNonLinearMultiCompOp::createCoarser(LevelData<FArrayBox>&       a_coarse,
                                             const LevelData<FArrayBox>& a_fine,
@@ -393,6 +668,8 @@ void AMRNonLinearMultiCompOp::restrictResidual(LevelData<FArrayBox>& a_resCoarse
 {
   CH_TIME("AMRNonLinearMultiCompOp::restrictResidual");
 
+  refreshSharedState();
+
   if (m_FAS)
   {
     if (a_phiCoarse != NULL)
@@ -408,28 +685,34 @@ void AMRNonLinearMultiCompOp::restrictResidual(LevelData<FArrayBox>& a_resCoarse
 
 
   const DisjointBoxLayout& dblFine = a_phiFine.disjointBoxLayout();
-  for (DataIterator dit = a_phiFine.dataIterator(); dit.ok(); ++dit)
+  DataIterator dit = a_phiFine.dataIterator();
+  int nbox = dit.size();
+
+#pragma omp parallel for
+  for (int ibox = 0; ibox < nbox; ibox++)
   {
-    FArrayBox& phi = a_phiFine[dit];
-    m_bc(phi, dblFine[dit()], m_domain, m_dx, homogeneous);
+    FArrayBox& phi = a_phiFine[dit[ibox]];
+    m_bc(phi, dblFine[dit[ibox]], m_domain, m_dx, homogeneous);
   }
 
   a_phiFine.exchange(a_phiFine.interval(), m_exchangeCopier);
 
-  LevelData<FArrayBox> derivedVar(a_phiFine.disjointBoxLayout(), a_phiFine.nComp(), a_phiFine.ghostVect());
+  LevelData<FArrayBox>& derivedVar = derivedVarScratch(a_phiFine);
   computeDiffusedVar(derivedVar, a_phiFine, homogeneous);
 
-  for (DataIterator dit = a_phiFine.dataIterator(); dit.ok(); ++dit)
+#pragma omp parallel for
+  for (int ibox = 0; ibox < nbox; ibox++)
   {
-    FArrayBox&       phi = a_phiFine[dit];
-    FArrayBox&       Cl = derivedVar[dit];
-    const FArrayBox& rhs = a_rhsFine[dit];
-    FArrayBox&       res = a_resCoarse[dit];
+    const DataIndex& din = dit[ibox];
+    FArrayBox&       phi = a_phiFine[din];
+    FArrayBox&       Cl = derivedVar[din];
+    const FArrayBox& rhs = a_rhsFine[din];
+    FArrayBox&       res = a_resCoarse[din];
 
-    const FArrayBox& thisACoef = (*m_aCoef)[dit];
-    const FluxBox&   thisBCoef = (*m_bCoef)[dit];
+    const FArrayBox& thisACoef = (*m_aCoef)[din];
+    const FluxBox&   thisBCoef = (*m_bCoef)[din];
 
-    Box region = dblFine.get(dit());
+    Box region = dblFine.get(din);
     const IntVect& iv = region.smallEnd();
     IntVect civ = coarsen(iv, 2);
 
@@ -517,12 +800,16 @@ void AMRNonLinearMultiCompOp::restrictR(LevelData<FArrayBox>& a_phiCoarse,
 
   const DisjointBoxLayout& dblFine = a_phiFine.disjointBoxLayout();
 
-  for (DataIterator dit = a_phiFine.dataIterator(); dit.ok(); ++dit)
+  DataIterator dit = a_phiFine.dataIterator();
+  int nbox = dit.size();
+
+#pragma omp parallel for
+  for (int ibox = 0; ibox < nbox; ibox++)
   {
-    const FArrayBox&       phiFine = a_phiFine[dit];
-    FArrayBox&       phiCoarse = a_phiCoarse[dit];
+    const FArrayBox&       phiFine = a_phiFine[dit[ibox]];
+    FArrayBox&       phiCoarse = a_phiCoarse[dit[ibox]];
 
-    Box region = dblFine.get(dit());
+    Box region = dblFine.get(dit[ibox]);
     const IntVect& iv = region.smallEnd();
     IntVect civ = coarsen(iv, 2);
 
@@ -564,16 +851,23 @@ void AMRNonLinearMultiCompOp::setCoefs(const RefCountedPtr<LevelData<FArrayBox>
 void AMRNonLinearMultiCompOp::resetLambda()
 {
   CH_TIME("AMRNonLinearMultiCompOp::resetLambda");
+
+  refreshSharedState();
+
   if (m_lambdaNeedsResetting)
   {
     Real scale = 1.0 / (m_dx*m_dx);
 
     // Compute it box by box, point by point
-    for (DataIterator dit = m_lambda.dataIterator(); dit.ok(); ++dit)
+    DataIterator dit = m_lambda.dataIterator();
+    int nbox = dit.size();
+
+#pragma omp parallel for
+    for (int ibox = 0; ibox < nbox; ibox++)
     {
-      FArrayBox&       lambdaFab = m_lambda[dit];
-      const FArrayBox& aCoefFab  = (*m_aCoef)[dit];
-      const FluxBox&   bCoefFab  = (*m_bCoef)[dit];
+      FArrayBox&       lambdaFab = m_lambda[dit[ibox]];
+      const FArrayBox& aCoefFab  = (*m_aCoef)[dit[ibox]];
+      const FluxBox&   bCoefFab  = (*m_bCoef)[dit[ibox]];
       const Box& curBox = lambdaFab.box();
 
       // Compute the diagonal term
@@ -597,6 +891,7 @@ void AMRNonLinearMultiCompOp::resetLambda()
 
     // Lambda is reset.
     m_lambdaNeedsResetting = false;
+    m_haloCoefsNeedResetting = true;
   }
 }
 
@@ -634,6 +929,8 @@ void AMRNonLinearMultiCompOp::reflux(const LevelData<FArrayBox>&        a_phiFin
 {
   CH_TIMERS("AMRNonLinearMultiCompOp::reflux");
 
+  refreshSharedState();
+
   m_levfluxreg.setToZero();
   Interval interv(0,a_phi.nComp()-1);
 
@@ -669,6 +966,7 @@ void AMRNonLinearMultiCompOp::reflux(const LevelData<FArrayBox>&        a_phiFin
   LevelData<FArrayBox>& phiFineRef = ( LevelData<FArrayBox>&)a_phiFine;
 
   AMRNonLinearMultiCompOp* finerAMRPOp = (AMRNonLinearMultiCompOp*) a_finerOp;
+  finerAMRPOp->refreshSharedState();
   QuadCFInterp& quadCFI = finerAMRPOp->m_interpWithCoarser;
 
   quadCFI.coarseFineInterp(phiFineRef, a_phi);
@@ -729,6 +1027,8 @@ void AMRNonLinearMultiCompOp::reflux(const LevelData<FArrayBox>&        a_phiFin
 {
   CH_TIME("AMRNonLinearMultiCompOp::reflux");
 
+  refreshSharedState();
+
   int ncomp = 1;
   ProblemDomain fineDomain = refine(m_domain, m_refToFiner);
   LevelFluxRegister levfluxreg(a_phiFine.disjointBoxLayout(),
@@ -763,6 +1063,7 @@ void AMRNonLinearMultiCompOp::reflux(const LevelData<FArrayBox>&        a_phiFin
   // has to be its own object because the finer operator
   // owns an interpolator and we have no way of getting to it
   AMRNonLinearMultiCompOp* finerAMRPOp = (AMRNonLinearMultiCompOp*) a_finerOp;
+  finerAMRPOp->refreshSharedState();
   QuadCFInterp& quadCFI = finerAMRPOp->m_interpWithCoarser;
 
   quadCFI.coarseFineInterp(p, a_phi);
@@ -847,6 +1148,17 @@ void AMRNonLinearMultiCompOp::levelGSRB(LevelData<FArrayBox>&       a_phi,
 {
   CH_TIME("AMRNonLinearMultiCompOp::levelGSRB");
 
+  // if we are super optimised, only exchange on the first pass (this is dodgy but saves some time).
+  // deepHaloGSRB() saves exchanges without changing the result.
+  gsrbPasses(a_phi, a_rhs, !m_superOptimised);
+}
+
+void AMRNonLinearMultiCompOp::gsrbPasses(LevelData<FArrayBox>&       a_phi,
+                                         const LevelData<FArrayBox>& a_rhs,
+                                         bool                        a_exchangeEachPass)
+{
+  refreshSharedState();
+
   // Going to need these more than once
   int nComp = a_phi.nComp();
   IntVect phiGhostVect = a_phi.ghostVect();
@@ -858,14 +1170,9 @@ void AMRNonLinearMultiCompOp::levelGSRB(LevelData<FArrayBox>&       a_phi,
 
   const DisjointBoxLayout& dbl = a_phi.disjointBoxLayout();
 
-  // This define is possibly taking an awfully long time
-  // However I don't think there's a quicker way.
-  // It's certainly quicker than defining FABs all the time
-  LevelData<FArrayBox> derivedVar;
-  {
-    CH_TIME("AMRNonLinearMultiCompOp::derivedVarDefine");
-    derivedVar.define(dbl, nComp,phiGhostVect);
-  }
+  // Defining this every time used to take an awfully long time,
+  // so keep it around between smoother calls
+  LevelData<FArrayBox>& derivedVar = derivedVarScratch(a_phi);
 
   DataIterator dit = a_phi.dataIterator();
 
@@ -875,6 +1182,16 @@ void AMRNonLinearMultiCompOp::levelGSRB(LevelData<FArrayBox>&       a_phi,
   Vector<int> compsList;
   compsList.push_back(-1); // do both comps in one fortran routine
 
+  // Record how long each box takes, if asked to (for load balancing)
+  Real* boxTimes = NULL;
+  int* boxPasses = NULL;
+  if (!m_sharedState.isNull() && dbl == m_sharedState->m_timedGrids
+      && m_sharedState->m_boxTimes.size() == dit.size())
+  {
+    boxTimes = &m_sharedState->m_boxTimes[0];
+    boxPasses = &m_sharedState->m_boxPasses[0];
+  }
+
   // do first red, then black passes
   for (int comps_i = 0; comps_i < compsList.size(); comps_i++)
   {
@@ -886,9 +1203,7 @@ void AMRNonLinearMultiCompOp::levelGSRB(LevelData<FArrayBox>&       a_phi,
       CH_TIMERS("AMRNonLinearMultiCompOp::levelGSRB::Compute");
 
       // fill in intersection of ghostcells and a_phi's boxes
-      // if we're not super optimised always fill ghost cells.
-      // if we are super optimised, only do this on first pass (this is dodgy but saves some time)
-      if (!m_superOptimised || whichPass == 0)
+      if (a_exchangeEachPass || whichPass == 0)
       {
         {
           CH_TIME("AMRNonLinearMultiCompOp::levelGSRB::homogeneousCFInterp");
@@ -914,86 +1229,150 @@ void AMRNonLinearMultiCompOp::levelGSRB(LevelData<FArrayBox>&       a_phi,
       resetLambda();
 
       {
-        for (dit.begin(); dit.ok(); ++dit)
+        // Timers aren't thread safe, so time the whole threaded loop rather than anything in it
+        CH_TIME("AMRNonLinearMultiCompOp::levelGSRB::smooth");
+
+        // Each box only updates its own valid and ghost cells, so boxes can be smoothed concurrently
+        int nbox = dit.size();
+
+#pragma omp parallel for
+        for (int ibox = 0; ibox < nbox; ibox++)
         {
-          const Box& region = dbl.get(dit());
-          const FluxBox& thisBCoef  = (*m_bCoef)[dit];
-          FArrayBox& thisPhi = a_phi[dit];
-          FArrayBox& thisDerivedVar = derivedVar[dit];
+          const DataIndex& din = dit[ibox];
+          const Box& region = dbl.get(din);
+          FArrayBox& thisPhi = a_phi[din];
+          FArrayBox& thisDerivedVar = derivedVar[din];
+
+          std::chrono::steady_clock::time_point boxStart = std::chrono::steady_clock::now();
+
+          m_bc(thisPhi, region, m_domain, m_dx, homogeneous);
 
+          // Need to do this every pass or convergence is very slow.
+          // On the first pass recompute everywhere, after that only cells changed by the previous pass
+          int changedColour = (whichPass == 0) ? -1 : whichPass - 1;
+          computeDiffusedVarColour(thisDerivedVar, thisPhi, region, changedColour, homogeneous);
 
+          smoothRegion(thisPhi, thisDerivedVar, a_rhs[din], din, region, whichPass, whichComponent);
+
+          if (boxTimes)
           {
-            CH_TIME("AMRNonLinearMultiCompOp::levelGSRB::BCs");
-            m_bc(thisPhi, region, m_domain, m_dx, homogeneous);
-//            m_bc(thisPhi, region., m_domain, m_dx, homogeneous);
+            std::chrono::duration<Real> boxTime = std::chrono::steady_clock::now() - boxStart;
+            boxTimes[ibox] += boxTime.count();
+            boxPasses[ibox]++;
           }
-//        }
-//
-//        a_phi.exchange(a_phi.interval(), m_exchangeCopier);
-//
-//        for (dit.begin(); dit.ok(); ++dit)
-//                {
-//                  const Box& region = dbl.get(dit());
-//                  const FluxBox& thisBCoef  = (*m_bCoef)[dit];
-//                  FArrayBox& thisPhi = a_phi[dit];
-//                  FArrayBox& thisDerivedVar = derivedVar[dit];
 
+        } // end loop through grids
+
+      }
+    } // end loop through red-black
+
+  } // end loop over components
 
+}
 
-          // Need to do this every pass or convergence is very slow
-//          if (!m_superOptimised || whichPass == 0)
-//          {
-            computeDiffusedVar(thisDerivedVar, thisPhi, dit(), homogeneous);
-//          }
+void AMRNonLinearMultiCompOp::smoothRegion(FArrayBox&       a_phi,
+                                           FArrayBox&       a_derivedVar,
+                                           const FArrayBox& a_rhs,
+                                           const DataIndex& a_din,
+                                           const Box&       a_region,
+                                           int              a_whichPass,
+                                           int              a_whichComponent)
+{
+  smoothRegion(a_phi, a_derivedVar, a_rhs, (*m_aCoef)[a_din], (*m_bCoef)[a_din], m_lambda[a_din],
+               a_region, a_whichPass, a_whichComponent);
+}
 
+void AMRNonLinearMultiCompOp::smoothRegion(FArrayBox&       a_phi,
+                                           FArrayBox&       a_derivedVar,
+                                           const FArrayBox& a_rhs,
+                                           const FArrayBox& a_aCoef,
+                                           const FluxBox&   a_bCoef,
+                                           const FArrayBox& a_lambda,
+                                           const Box&       a_region,
+                                           int              a_whichPass,
+                                           int              a_whichComponent)
+{
 #if CH_SPACEDIM == 1
-          FORT_NONLINEARSMOOTHING1D
+  FORT_NONLINEARSMOOTHING1D
 #elif CH_SPACEDIM == 2
-          FORT_NONLINEARSMOOTHING2D
+  FORT_NONLINEARSMOOTHING2D
 #elif CH_SPACEDIM == 3
-          FORT_NONLINEARSMOOTHING3D
+  FORT_NONLINEARSMOOTHING3D
 #else
-          //				This_will_not_compile!
+  //				This_will_not_compile!
 #endif
-          (CHF_FRA(thisPhi),
-           CHF_FRA(thisDerivedVar),
-           CHF_CONST_FRA(a_rhs[dit]),
-           CHF_BOX(region),
-           CHF_CONST_REAL(m_dx),
-           CHF_CONST_REAL(m_alpha),
-           CHF_CONST_FRA((*m_aCoef)[dit]),
-           CHF_CONST_REAL(m_beta),
+  (CHF_FRA(a_phi),
+   CHF_FRA(a_derivedVar),
+   CHF_CONST_FRA(a_rhs),
+   CHF_BOX(a_region),
+   CHF_CONST_REAL(m_dx),
+   CHF_CONST_REAL(m_alpha),
+   CHF_CONST_FRA(a_aCoef),
+   CHF_CONST_REAL(m_beta),
 #if CH_SPACEDIM >= 1
-           CHF_CONST_FRA(thisBCoef[0]),
+   CHF_CONST_FRA(a_bCoef[0]),
 #endif
 #if CH_SPACEDIM >= 2
-           CHF_CONST_FRA(thisBCoef[1]),
+   CHF_CONST_FRA(a_bCoef[1]),
 #endif
 #if CH_SPACEDIM >= 3
-           CHF_CONST_FRA(thisBCoef[2]),
+   CHF_CONST_FRA(a_bCoef[2]),
 #endif
 #if CH_SPACEDIM >= 4
-           This_will_not_compile!
+   This_will_not_compile!
 #endif
-           CHF_CONST_FRA(m_lambda[dit]),
-           CHF_CONST_INT(whichPass),
-           CHF_CONST_INT(whichComponent));
-
-
-        } // end loop through grids
-
-      }
-    } // end loop through red-black
+   CHF_CONST_FRA(a_lambda),
+   CHF_CONST_INT(a_whichPass),
+   CHF_CONST_INT(a_whichComponent));
+}
 
-  } // end loop over components
+void AMRNonLinearMultiCompOp::relax(LevelData<FArrayBox>&       a_e,
+                                    const LevelData<FArrayBox>& a_residual,
+                                    int                         a_iterations)
+{
+  // Groups the sweeps together, so needs to know how many there are
+  if (m_relaxMode == 6)
+  {
+    deepHaloGSRB(a_e, a_residual, a_iterations);
+    return;
+  }
 
+  for (int i = 0; i < a_iterations; i++)
+  {
+    switch (m_relaxMode)
+    {
+      case 0:
+        looseGSRB(a_e, a_residual);
+        break;
+      case 1:
+        levelGSRB(a_e, a_residual);
+        break;
+      case 2:
+        overlapGSRB(a_e, a_residual);
+        break;
+      case 3:
+        levelGSRBLazy(a_e, a_residual);
+        break;
+      case 4:
+        levelJacobi(a_e, a_residual);
+        break;
+      case 5:
+        levelMultiColor(a_e, a_residual);
+        break;
+      default:
+        MayDay::Abort("AMRNonLinearMultiCompOp::relax - unrecognized relaxation mode");
+    }
+  }
 }
 
 void AMRNonLinearMultiCompOp::levelMultiColor(LevelData<FArrayBox>&       a_phi,
                                               const LevelData<FArrayBox>& a_rhs)
 {
   CH_TIME("AMRNonLinearMultiCompOp::levelMultiColor");
-  MayDay::Abort("AMRNonLinearMultiCompOp::levelMultiColor - Not implemented");
+
+  // Our stencil only couples each cell to its face neighbours, so the 2^SpaceDim colours of a
+  // multicolour sweep collapse to red and black: it's the same iteration as GSRB.
+  overlapGSRB(a_phi, a_rhs);
 }
 
 void AMRNonLinearMultiCompOp::looseGSRB(LevelData<FArrayBox>&       a_phi,
@@ -1113,14 +1492,338 @@ void AMRNonLinearMultiCompOp::overlapGSRB(LevelData<FArrayBox>&       a_phi,
                                           const LevelData<FArrayBox>& a_rhs)
 {
   CH_TIME("AMRNonLinearMultiCompOp::overlapGSRB");
-  MayDay::Abort("AMRNonLinearMultiCompOp::overlapGSRB - Not implemented");
+
+  refreshSharedState();
+
+  CH_assert(a_phi.isDefined());
+  CH_assert(a_rhs.isDefined());
+  CH_assert(a_phi.ghostVect() >= IntVect::Unit);
+  CH_assert(a_phi.nComp() == a_rhs.nComp());
+
+  const DisjointBoxLayout& dbl = a_phi.disjointBoxLayout();
+  LevelData<FArrayBox>& derivedVar = derivedVarScratch(a_phi);
+
+  DataIterator dit = a_phi.dataIterator();
+  int nbox = dit.size();
+
+  // Should never be homogeneous as non linear!
+  bool homogeneous = false;
+  int allComps = -1;
+
+  resetLambda();
+
+  // Record how long each box takes, if asked to (for load balancing)
+  Real* boxTimes = NULL;
+  int* boxPasses = NULL;
+  if (!m_sharedState.isNull() && dbl == m_sharedState->m_timedGrids
+      && m_sharedState->m_boxTimes.size() == nbox)
+  {
+    boxTimes = &m_sharedState->m_boxTimes[0];
+    boxPasses = &m_sharedState->m_boxPasses[0];
+  }
+
+  // This does the same updates as levelGSRB, but smooths the interior of each box while the
+  // exchange is in flight, then finishes the cells next to the box edges once it has arrived
+  for (int whichPass = 0; whichPass <= 1; whichPass++)
+  {
+    // Physical BCs only fill ghost cells outside the domain, which the exchange doesn't touch
+    {
+      CH_TIME("AMRNonLinearMultiCompOp::overlapGSRB::BCs");
+#pragma omp parallel for
+      for (int ibox = 0; ibox < nbox; ibox++)
+      {
+        const DataIndex& din = dit[ibox];
+        m_bc(a_phi[din], dbl[din], m_domain, m_dx, homogeneous);
+      }
+    }
+
+    {
+      CH_TIME("AMRNonLinearMultiCompOp::overlapGSRB::exchangeBegin");
+      a_phi.exchangeBegin(m_exchangeCopier);
+    }
+
+    // On the first pass recompute everywhere, after that only cells changed by the previous pass
+    int changedColour = (whichPass == 0) ? -1 : whichPass - 1;
+
+    {
+      CH_TIME("AMRNonLinearMultiCompOp::overlapGSRB::interior");
+#pragma omp parallel for
+      for (int ibox = 0; ibox < nbox; ibox++)
+      {
+        const DataIndex& din = dit[ibox];
+        const Box& region = dbl[din];
+
+        std::chrono::steady_clock::time_point boxStart = std::chrono::steady_clock::now();
+
+        // Only valid cells - ghost cells are still being filled
+        computeTCl(derivedVar[din], a_phi[din], region, changedColour);
+
+        Box interior = grow(region, -1);
+        if (!interior.isEmpty())
+        {
+          smoothRegion(a_phi[din], derivedVar[din], a_rhs[din], din, interior, whichPass, allComps);
+        }
+
+        if (boxTimes)
+        {
+          std::chrono::duration<Real> boxTime = std::chrono::steady_clock::now() - boxStart;
+          boxTimes[ibox] += boxTime.count();
+        }
+      }
+    }
+
+    {
+      CH_TIME("AMRNonLinearMultiCompOp::overlapGSRB::exchangeEnd");
+      a_phi.exchangeEnd();
+    }
+
+    {
+      CH_TIME("AMRNonLinearMultiCompOp::overlapGSRB::boundary");
+#pragma omp parallel for
+      for (int ibox = 0; ibox < nbox; ibox++)
+      {
+        const DataIndex& din = dit[ibox];
+        const Box& region = dbl[din];
+
+        std::chrono::steady_clock::time_point boxStart = std::chrono::steady_clock::now();
+
+        computeDiffusedVarGhosts(derivedVar[din], a_phi[din], region, homogeneous);
+
+        Vector<Box> edgeBoxes;
+        boxShell(edgeBoxes, region, grow(region, -1));
+        for (int i = 0; i < edgeBoxes.size(); i++)
+        {
+          smoothRegion(a_phi[din], derivedVar[din], a_rhs[din], din, edgeBoxes[i], whichPass, allComps);
+        }
+
+        // The interior and the edges together make one pass over the box
+        if (boxTimes)
+        {
+          std::chrono::duration<Real> boxTime = std::chrono::steady_clock::now() - boxStart;
+          boxTimes[ibox] += boxTime.count();
+          boxPasses[ibox]++;
+        }
+      }
+    }
+  }
 }
 
 void AMRNonLinearMultiCompOp::levelGSRBLazy(LevelData<FArrayBox>&       a_phi,
                                             const LevelData<FArrayBox>& a_rhs)
 {
   CH_TIME("AMRNonLinearMultiCompOp::levelGSRBLazy");
-  MayDay::Abort("AMRNonLinearMultiCompOp::levelGSRBLazy - Not implemented");
+
+  // Only exchange before the red pass, so the black pass sees red ghost values from before this sweep
+  gsrbPasses(a_phi, a_rhs, false);
+}
+
+void AMRNonLinearMultiCompOp::defineHalo(const LevelData<FArrayBox>& a_phi)
+{
+  const DisjointBoxLayout& dbl = a_phi.disjointBoxLayout();
+  int nComp = a_phi.nComp();
+  IntVect haloGhost = 2*m_sweepsPerExchange*IntVect::Unit;
+
+  if (m_haloGrids == dbl
+      && (!m_haloUsable || (m_haloState.nComp() == 2*nComp && m_haloState.ghostVect() == haloGhost)))
+  {
+    return;
+  }
+
+  CH_TIME("AMRNonLinearMultiCompOp::defineHalo");
+
+  m_haloGrids = dbl;
+
+  // Every rank knows the whole layout, so they all agree on this without communicating
+  long long numCells = 0;
+  int smallestSide = m_domain.domainBox().size(0);
+  for (LayoutIterator lit = dbl.layoutIterator(); lit.ok(); ++lit)
+  {
+    const Box& b = dbl[lit()];
+    numCells += b.numPts();
+    for (int dir = 0; dir < SpaceDim; dir++)
+    {
+      smallestSide = std::min(smallestSide, b.size(dir));
+    }
+  }
+
+  // Halos deeper than a box reach past its neighbours, which we don't rely on
+  m_haloUsable = (numCells == m_domain.domainBox().numPts()) && (2*m_sweepsPerExchange <= smallestSide);
+
+  if (!m_haloUsable)
+  {
+    return;
+  }
+
+  m_haloCopier.exchangeDefine(dbl, haloGhost);
+
+  m_haloState.define(dbl, 2*nComp, haloGhost);
+  m_haloDerivedVar.define(dbl, nComp, haloGhost);
+  m_haloACoef.define(dbl, m_aCoef->nComp(), haloGhost);
+  m_haloLambda.define(dbl, m_lambda.nComp(), haloGhost);
+  m_haloBCoef.define(dbl, m_bCoef->nComp(), haloGhost);
+
+  // Ghost cells outside the domain beyond those filled by the BCs are never used, but make sure they're not garbage
+  DataIterator dit = dbl.dataIterator();
+  int nbox = dit.size();
+
+#pragma omp parallel for
+  for (int ibox = 0; ibox < nbox; ibox++)
+  {
+    m_haloState[dit[ibox]].setVal(0.0);
+    m_haloDerivedVar[dit[ibox]].setVal(0.0);
+  }
+
+  m_haloCoefsNeedResetting = true;
+}
+
+void AMRNonLinearMultiCompOp::deepHaloGSRB(LevelData<FArrayBox>&       a_phi,
+                                           const LevelData<FArrayBox>& a_rhs,
+                                           int                         a_iterations)
+{
+  CH_TIME("AMRNonLinearMultiCompOp::deepHaloGSRB");
+
+  refreshSharedState();
+
+  CH_assert(a_phi.isDefined());
+  CH_assert(a_rhs.isDefined());
+  CH_assert(a_phi.nComp() == a_rhs.nComp());
+  CH_assert(m_sweepsPerExchange >= 1);
+
+  // Recompute the relaxation coefficient, before we copy it
+  resetLambda();
+
+  defineHalo(a_phi);
+
+  if (!m_haloUsable)
+  {
+    for (int i = 0; i < a_iterations; i++)
+    {
+      levelGSRB(a_phi, a_rhs);
+    }
+    return;
+  }
+
+  if (m_haloCoefsNeedResetting)
+  {
+    CH_TIME("AMRNonLinearMultiCompOp::deepHaloGSRB::coefficients");
+    m_aCoef->copyTo(m_haloACoef);
+    m_bCoef->copyTo(m_haloBCoef);
+    m_lambda.copyTo(m_haloLambda);
+
+    m_haloACoef.exchange(m_haloCopier);
+    m_haloBCoef.exchange(m_haloCopier);
+    m_haloLambda.exchange(m_haloCopier);
+
+    m_haloCoefsNeedResetting = false;
+  }
+
+  const DisjointBoxLayout& dbl = a_phi.disjointBoxLayout();
+  DataIterator dit = a_phi.dataIterator();
+  int nbox = dit.size();
+
+  int nComp = a_phi.nComp();
+  Interval phiComps(0, nComp-1);
+  Interval rhsComps(nComp, 2*nComp-1);
+
+  // Should never be homogeneous as non linear!
+  bool homogeneous = false;
+  int allComps = -1;
+  int allColours = -1;
+
+  // Record how long each box takes, if asked to (for load balancing)
+  Real* boxTimes = NULL;
+  int* boxPasses = NULL;
+  if (!m_sharedState.isNull() && dbl == m_sharedState->m_timedGrids
+      && m_sharedState->m_boxTimes.size() == nbox)
+  {
+    boxTimes = &m_sharedState->m_boxTimes[0];
+    boxPasses = &m_sharedState->m_boxPasses[0];
+  }
+
+#pragma omp parallel for
+  for (int ibox = 0; ibox < nbox; ibox++)
+  {
+    const DataIndex& din = dit[ibox];
+    const Box& valid = dbl[din];
+    m_haloState[din].copy(a_phi[din], valid, 0, valid, 0, nComp);
+    m_haloState[din].copy(a_rhs[din], valid, 0, valid, nComp, nComp);
+  }
+
+  for (int sweep = 0; sweep < a_iterations; sweep += m_sweepsPerExchange)
+  {
+    {
+      CH_TIME("AMRNonLinearMultiCompOp::deepHaloGSRB::exchange");
+      // The right hand side doesn't change, so only send it the first time
+      m_haloState.exchange(sweep == 0 ? m_haloState.interval() : phiComps, m_haloCopier);
+    }
+
+    int numPasses = 2*std::min(m_sweepsPerExchange, a_iterations - sweep);
+
+    CH_TIME("AMRNonLinearMultiCompOp::deepHaloGSRB::smooth");
+
+#pragma omp parallel for
+    for (int ibox = 0; ibox < nbox; ibox++)
+    {
+      const DataIndex& din = dit[ibox];
+      const Box& valid = dbl[din];
+
+      FArrayBox phi(phiComps, m_haloState[din]);
+      FArrayBox rhs(rhsComps, m_haloState[din]);
+      FArrayBox& derivedVar = m_haloDerivedVar[din];
+
+      std::chrono::steady_clock::time_point boxStart = std::chrono::steady_clock::now();
+
+      for (int pass = 0; pass < numPasses; pass++)
+      {
+        int whichPass = pass % 2;
+
+        // Cells we can update correctly shrink by one layer each pass, ending with just the valid cells
+        Box region = grow(valid, numPasses - 1 - pass);
+        region &= m_domain;
+
+        m_bc(phi, region, m_domain, m_dx, homogeneous);
+
+        // T and Cl are needed in region and the cells next to it. On the first pass compute them everywhere,
+        // after that only where the previous pass changed H and C, plus the ghost cells just filled by the BCs.
+        Box needed = grow(region, 1);
+        Box neededInDomain = needed;
+        neededInDomain &= m_domain;
+
+        int changedColour = (pass == 0) ? allColours : (pass - 1) % 2;
+        computeTCl(derivedVar, phi, neededInDomain, changedColour);
+
+        Vector<Box> ghostBoxes;
+        boxShell(ghostBoxes, needed, neededInDomain);
+        for (int i = 0; i < ghostBoxes.size(); i++)
+        {
+          computeTCl(derivedVar, phi, ghostBoxes[i], allColours);
+        }
+
+        if (m_apply_bcs_to_diagnostic_var)
+        {
+          m_diffusedVarBC(derivedVar, m_domain.domainBox(), m_domain, m_dx, homogeneous);
+        }
+
+        smoothRegion(phi, derivedVar, rhs, m_haloACoef[din], m_haloBCoef[din], m_haloLambda[din],
+                     region, whichPass, allComps);
+      }
+
+      if (boxTimes)
+      {
+        std::chrono::duration<Real> boxTime = std::chrono::steady_clock::now() - boxStart;
+        boxTimes[ibox] += boxTime.count();
+        boxPasses[ibox] += numPasses;
+      }
+    }
+  }
+
+#pragma omp parallel for
+  for (int ibox = 0; ibox < nbox; ibox++)
+  {
+    const DataIndex& din = dit[ibox];
+    const Box& valid = dbl[din];
+    a_phi[din].copy(m_haloState[din], valid, 0, valid, 0, nComp);
+  }
 }
 
 void AMRNonLinearMultiCompOp::levelJacobi(LevelData<FArrayBox>&       a_phi,
@@ -1138,9 +1841,12 @@ void AMRNonLinearMultiCompOp::levelJacobi(LevelData<FArrayBox>&       a_phi,
 
   // Multiply by the weights
   DataIterator dit = m_lambda.dataIterator();
-  for (dit.begin(); dit.ok(); ++dit)
+  int nbox = dit.size();
+
+#pragma omp parallel for
+  for (int ibox = 0; ibox < nbox; ibox++)
   {
-    resid[dit].mult(m_lambda[dit]);
+    resid[dit[ibox]].mult(m_lambda[dit[ibox]]);
   }
 
   // Do the Jacobi relaxation
@@ -1257,9 +1963,6 @@ void AMRNonLinearMultiCompOpFactory::define(const ProblemDomain& a_coarseDomain,
                                             Vector<RefCountedPtr<LevelData<FArrayBox> > >& a_aCoef,
                                             const Real&                                    a_beta,
                                             Vector<RefCountedPtr<LevelData<FluxBox> > >&   a_bCoef,
-                                            Vector<RefCountedPtr<LevelData<FArrayBox> > >& a_enthalpySolidus,
-                                            Vector<RefCountedPtr<LevelData<FArrayBox> > >& a_enthalpyLiquidus,
-                                            Vector<RefCountedPtr<LevelData<FArrayBox> > >& a_enthalpyEutectic,
                                             MushyLayerParams*			   a_params,
                                             BCHolder  a_derivedVarBC,
                                             int a_relaxMode,
@@ -1313,10 +2016,6 @@ void AMRNonLinearMultiCompOpFactory::define(const ProblemDomain& a_coarseDomain,
   m_beta  = a_beta;
   m_bCoef = a_bCoef;
 
-  m_enthalpySolidus = a_enthalpySolidus;
-  m_enthalpyLiquidus = a_enthalpyLiquidus;
-  m_enthalpyEutectic = a_enthalpyEutectic;
-
   //  m_FAS = false;
   m_FAS = true;
   ParmParse ppMG("amrmultigrid");
@@ -1328,6 +2027,47 @@ void AMRNonLinearMultiCompOpFactory::define(const ProblemDomain& a_coarseDomain,
 
   m_superOptimised = false;
 
+  m_sharedState = RefCountedPtr<SharedOpState>(new SharedOpState());
+  m_sharedState->m_bc = m_bc;
+  m_sharedState->m_derivedBC = m_diffusedVarBC;
+
+}
+
+void AMRNonLinearMultiCompOpFactory::coefficientsChanged(BCHolder a_bc, BCHolder a_derivedVarBC)
+{
+  CH_assert(!m_sharedState.isNull());
+
+  m_bc = a_bc;
+  m_diffusedVarBC = a_derivedVarBC;
+
+  m_sharedState->m_bc = m_bc;
+  m_sharedState->m_derivedBC = m_diffusedVarBC;
+  m_sharedState->m_version++;
+}
+
+void AMRNonLinearMultiCompOpFactory::timeSmoothing(const DisjointBoxLayout& a_grids)
+{
+  CH_assert(!m_sharedState.isNull());
+
+  m_sharedState->m_timedGrids = a_grids;
+  m_sharedState->m_boxTimes.resize(a_grids.dataIterator().size());
+  m_sharedState->m_boxTimes.assign(0.0);
+  m_sharedState->m_boxPasses.resize(a_grids.dataIterator().size());
+  m_sharedState->m_boxPasses.assign(0);
+}
+
+void AMRNonLinearMultiCompOpFactory::smoothingTimes(Vector<Real>& a_times) const
+{
+  CH_assert(!m_sharedState.isNull());
+
+  const Vector<Real>& boxTimes = m_sharedState->m_boxTimes;
+  const Vector<int>& boxPasses = m_sharedState->m_boxPasses;
+
+  a_times.resize(boxTimes.size());
+  for (int ibox = 0; ibox < boxTimes.size(); ibox++)
+  {
+    a_times[ibox] = (boxPasses[ibox] > 0) ? boxTimes[ibox]/boxPasses[ibox] : 0.0;
+  }
 }
 
 void AMRNonLinearMultiCompOpFactory::setSuperOptimised(bool a_val)
@@ -1335,6 +2075,16 @@ void AMRNonLinearMultiCompOpFactory::setSuperOptimised(bool a_val)
   m_superOptimised = a_val;
 }
 
+void AMRNonLinearMultiCompOpFactory::setSweepsPerExchange(int a_sweeps)
+{
+  if (a_sweeps < 1)
+  {
+    MayDay::Error("AMRNonLinearMultiCompOpFactory::setSweepsPerExchange - need at least one sweep per exchange");
+  }
+
+  m_sweepsPerExchange = a_sweeps;
+}
+
 void AMRNonLinearMultiCompOpFactory::setBC(BCHolder& a_bc)
 {
   m_bc = a_bc;
@@ -1454,10 +2204,15 @@ MGLevelOp<LevelData<FArrayBox> >* AMRNonLinearMultiCompOpFactory::MGnewOp(const
 
   newOp->m_superOptimised = m_superOptimised;
 
-  newOp->s_relaxMode = m_relaxMode; // 4 is for jacobi, 1 is for GSRB
+  newOp->m_relaxMode = m_relaxMode; // 4 is for jacobi, 1 is for GSRB
+  newOp->m_sweepsPerExchange = m_sweepsPerExchange;
 
   newOp->m_FAS = m_FAS;
 
+  newOp->m_sharedState = m_sharedState;
+  newOp->m_stateVersion = m_sharedState->m_version;
+  newOp->m_coefficient_average_type = m_coefficient_average_type;
+
   RefCountedPtr<CoefficientInterpolatorLinear> aCoefInterpolator;
   RefCountedPtr<CoefficientInterpolatorLinearFace> bCoefInterpolator;
 
@@ -1475,33 +2230,14 @@ MGLevelOp<LevelData<FArrayBox> >* AMRNonLinearMultiCompOpFactory::MGnewOp(const
     // don't need to coarsen anything for this
     newOp->m_aCoef = m_aCoef[ref];
     newOp->m_bCoef = m_bCoef[ref];
-
-    newOp->m_enthalpySolidus = m_enthalpySolidus[ref];
-    newOp->m_enthalpyLiquidus = m_enthalpyLiquidus[ref];
-    newOp->m_enthalpyEutectic = m_enthalpyEutectic[ref];
-
-
-
-    //    if ()
-
   }
   else
   {
     // need to coarsen coefficients
     RefCountedPtr<LevelData<FArrayBox> > aCoef( new LevelData<FArrayBox> );
     RefCountedPtr<LevelData<FluxBox> > bCoef( new LevelData<FluxBox> );
-    RefCountedPtr<LevelData<FArrayBox> > enthalpy( new LevelData<FArrayBox> );
-    RefCountedPtr<LevelData<FArrayBox> > enthalpySolidus( new LevelData<FArrayBox> );
-    RefCountedPtr<LevelData<FArrayBox> > enthalpyLiquidus( new LevelData<FArrayBox> );
-    RefCountedPtr<LevelData<FArrayBox> > enthalpyEutectic( new LevelData<FArrayBox> );
-
 
     aCoef->define(layout, m_aCoef[ref]->nComp(), m_aCoef[ref]->ghostVect());
-
-    enthalpySolidus->define(layout, m_enthalpySolidus[ref]->nComp(), m_enthalpySolidus[ref]->ghostVect());
-    enthalpyLiquidus->define(layout, m_enthalpyLiquidus[ref]->nComp(), m_enthalpyLiquidus[ref]->ghostVect());
-    enthalpyEutectic->define(layout, m_enthalpyEutectic[ref]->nComp(), m_enthalpyEutectic[ref]->ghostVect());
-
     bCoef->define(layout, m_bCoef[ref]->nComp(), m_bCoef[ref]->ghostVect());
 
 
@@ -1511,10 +2247,6 @@ MGLevelOp<LevelData<FArrayBox> >* AMRNonLinearMultiCompOpFactory::MGnewOp(const
     CoarseAverage averager(m_aCoef[ref]->getBoxes(),
                            layout, aCoef->nComp(), coarsening);
 
-    /// Different number of components for these
-    CoarseAverage averagerBoundingEnergies(m_aCoef[ref]->getBoxes(),
-                               layout, enthalpySolidus->nComp(), coarsening);
-
     CoarseAverageFace faceAverager(m_bCoef[ref]->getBoxes(),
                                    bCoef->nComp(), coarsening);
 
@@ -1522,23 +2254,11 @@ MGLevelOp<LevelData<FArrayBox> >* AMRNonLinearMultiCompOpFactory::MGnewOp(const
     {
       averager.averageToCoarse(*aCoef, *(m_aCoef[ref]));
       faceAverager.averageToCoarse(*bCoef, *(m_bCoef[ref]));
-
-      averagerBoundingEnergies.averageToCoarse(*enthalpySolidus, *(m_enthalpySolidus[ref]));
-      averagerBoundingEnergies.averageToCoarse(*enthalpyLiquidus, *(m_enthalpyLiquidus[ref]));
-      averagerBoundingEnergies.averageToCoarse(*enthalpyEutectic, *(m_enthalpyEutectic[ref]));
-
-
-
     }
     else if (m_coefficient_average_type == CoarseAverage::harmonic)
     {
       averager.averageToCoarseHarmonic(*aCoef, *(m_aCoef[ref]));
       faceAverager.averageToCoarseHarmonic(*bCoef, *(m_bCoef[ref]));
-
-      averagerBoundingEnergies.averageToCoarseHarmonic(*enthalpySolidus, *(m_enthalpySolidus[ref]));
-      averagerBoundingEnergies.averageToCoarseHarmonic(*enthalpyLiquidus, *(m_enthalpyLiquidus[ref]));
-      averagerBoundingEnergies.averageToCoarseHarmonic(*enthalpyEutectic, *(m_enthalpyEutectic[ref]));
-
     }
     else
     {
@@ -1548,11 +2268,10 @@ MGLevelOp<LevelData<FArrayBox> >* AMRNonLinearMultiCompOpFactory::MGnewOp(const
     newOp->m_aCoef = aCoef;
     newOp->m_bCoef = bCoef;
 
-    newOp->m_enthalpySolidus = enthalpySolidus;
-    newOp->m_enthalpyLiquidus = enthalpyLiquidus;
-    newOp->m_enthalpyEutectic = enthalpyEutectic;
-
-
+    // Keep hold of the finer coefficients so we can re-average them if they change
+    newOp->m_aCoefFine = m_aCoef[ref];
+    newOp->m_bCoefFine = m_bCoef[ref];
+    newOp->m_coarsening = coarsening;
   }
 
   newOp->computeLambda();
@@ -1640,10 +2359,6 @@ AMRLevelOp<LevelData<FArrayBox> >* AMRNonLinearMultiCompOpFactory::AMRnewOp(cons
   newOp->m_aCoef = m_aCoef[ref];
   newOp->m_bCoef = m_bCoef[ref];
 
-  newOp->m_enthalpySolidus = m_enthalpySolidus[ref];
-  newOp->m_enthalpyLiquidus = m_enthalpyLiquidus[ref];
-  newOp->m_enthalpyEutectic = m_enthalpyEutectic[ref];
-
   newOp->m_params = m_params;
   //  newOp->m_calcEnthalpyVar = m_calcEnthalpyVar;
   newOp->m_diffusedVarBC = m_diffusedVarBC;
@@ -1656,11 +2371,15 @@ AMRLevelOp<LevelData<FArrayBox> >* AMRNonLinearMultiCompOpFactory::AMRnewOp(cons
 
   newOp->m_FAS = m_FAS;
 
+  newOp->m_sharedState = m_sharedState;
+  newOp->m_stateVersion = m_sharedState->m_version;
+
   newOp->computeLambda();
 
   newOp->m_dxCrse = dxCrse;
 
-  newOp->s_relaxMode = m_relaxMode; // 4 is for jacobi, 1 is for GSRB
+  newOp->m_relaxMode = m_relaxMode; // 4 is for jacobi, 1 is for GSRB
+  newOp->m_sweepsPerExchange = m_sweepsPerExchange;
 
   return (AMRLevelOp<LevelData<FArrayBox> >*)newOp;
 }
@@ -1697,6 +2416,7 @@ void AMRNonLinearMultiCompOpFactory::setDefaultValues()
   m_coefficient_average_type = CoarseAverage::arithmetic;
 
   m_superOptimised = false;
+  m_sweepsPerExchange = 2;
 }
 //-----------------------------------------------------------------------
 
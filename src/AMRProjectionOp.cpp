@@ -27,13 +27,98 @@
 
 AMRProjectionOp::AMRProjectionOp ()
 {
-
+  m_stateVersion = 0;
+  m_coarsening = 1;
+  m_coefficient_average_type = CoarseAverage::arithmetic;
 }
 
 AMRProjectionOp::~AMRProjectionOp ()
 {
 }
 
+void AMRProjectionOp::refreshSharedState()
+{
+  if (m_sharedState.isNull() || m_sharedState->m_version == m_stateVersion)
+  {
+    return;
+  }
+
+  CH_TIME("AMRProjectionOp::refreshSharedState");
+
+  m_bc = m_sharedState->m_bc;
+
+  // Multigrid levels below the AMR level hold their own averaged copies of the coefficients
+  if (m_coarsening > 1 && !m_aCoefFine.isNull() && !m_bCoefFine.isNull())
+  {
+    CoarseAverage averager(m_aCoefFine->getBoxes(), m_aCoef->disjointBoxLayout(),
+                           m_aCoef->nComp(), m_coarsening);
+    CoarseAverageFace faceAverager(m_bCoefFine->getBoxes(), m_bCoef->nComp(), m_coarsening);
+
+    if (m_coefficient_average_type == CoarseAverage::harmonic)
+    {
+      averager.averageToCoarseHarmonic(*m_aCoef, *m_aCoefFine);
+      faceAverager.averageToCoarseHarmonic(*m_bCoef, *m_bCoefFine);
+    }
+#ifdef CH_FORK
+    else if (m_coefficient_average_type == CoarseAverage::geometric)
+    {
+      averager.averageToCoarseGeometric(*m_aCoef, *m_aCoefFine);
+      faceAverager.averageToCoarseGeometric(*m_bCoef, *m_bCoefFine);
+    }
+#endif
+    else
+    {
+      averager.averageToCoarse(*m_aCoef, *m_aCoefFine);
+      faceAverager.averageToCoarse(*m_bCoef, *m_bCoefFine);
+    }
+  }
+
+  m_lambdaNeedsResetting = true;
+  resetLambda();
+
+  m_stateVersion = m_sharedState->m_version;
+}
+
+void AMRProjectionOp::residualI(LevelData<FArrayBox>&       a_lhs,
+                                const LevelData<FArrayBox>& a_phi,
+                                const LevelData<FArrayBox>& a_rhs,
+                                bool                        a_homogeneous)
+{
+  refreshSharedState();
+  VCAMRPoissonOp2::residualI(a_lhs, a_phi, a_rhs, a_homogeneous);
+}
+
+void AMRProjectionOp::applyOpI(LevelData<FArrayBox>&       a_lhs,
+                               const LevelData<FArrayBox>& a_phi,
+                               bool                        a_homogeneous)
+{
+  refreshSharedState();
+  VCAMRPoissonOp2::applyOpI(a_lhs, a_phi, a_homogeneous);
+}
+
+void AMRProjectionOp::preCond(LevelData<FArrayBox>&       a_correction,
+                              const LevelData<FArrayBox>& a_residual)
+{
+  refreshSharedState();
+  VCAMRPoissonOp2::preCond(a_correction, a_residual);
+}
+
+void AMRProjectionOp::relax(LevelData<FArrayBox>&       a_e,
+                            const LevelData<FArrayBox>& a_residual,
+                            int                         a_iterations)
+{
+  refreshSharedState();
+  VCAMRPoissonOp2::relax(a_e, a_residual, a_iterations);
+}
+
+void AMRProjectionOp::restrictResidual(LevelData<FArrayBox>&       a_resCoarse,
+                                       LevelData<FArrayBox>&       a_phiFine,
+                                       const LevelData<FArrayBox>& a_rhsFine)
+{
+  refreshSharedState();
+  VCAMRPoissonOp2::restrictResidual(a_resCoarse, a_phiFine, a_rhsFine);
+}
+
 void AMRProjectionOp::resetLambda()
 {
   if (m_lambdaNeedsResetting)
@@ -181,6 +266,18 @@ void AMRProjectionOpFactory::define(const ProblemDomain&
   m_bCoef = a_bCoef;
 
   m_coefficient_average_type = a_averaging_type;
+
+  m_sharedState = RefCountedPtr<SharedOpState>(new SharedOpState());
+  m_sharedState->m_bc = m_bc;
+}
+
+void AMRProjectionOpFactory::coefficientsChanged(BCHolder a_bc)
+{
+  CH_assert(!m_sharedState.isNull());
+
+  m_bc = a_bc;
+  m_sharedState->m_bc = a_bc;
+  m_sharedState->m_version++;
 }
 //-----------------------------------------------------------------------
 
@@ -331,8 +428,16 @@ MGLevelOp<LevelData<FArrayBox> >* AMRProjectionOpFactory::MGnewOp(const ProblemD
 
       newOp->m_aCoef = aCoef;
       newOp->m_bCoef = bCoef;
+
+      newOp->m_aCoefFine = m_aCoef[ref];
+      newOp->m_bCoefFine = m_bCoef[ref];
+      newOp->m_coarsening = coarsening;
     }
 
+  newOp->m_coefficient_average_type = m_coefficient_average_type;
+  newOp->m_sharedState = m_sharedState;
+  newOp->m_stateVersion = m_sharedState->m_version;
+
   newOp->computeLambda();
 
   newOp->m_dxCrse = dxCrse;
@@ -431,6 +536,10 @@ AMRLevelOp<LevelData<FArrayBox> >* AMRProjectionOpFactory::AMRnewOp(const Proble
   newOp->m_aCoef = m_aCoef[ref];
   newOp->m_bCoef = m_bCoef[ref];
 
+  newOp->m_coefficient_average_type = m_coefficient_average_type;
+  newOp->m_sharedState = m_sharedState;
+  newOp->m_stateVersion = m_sharedState->m_version;
+
   if (newOp->m_aCoef != NULL)
   {
     newOp->computeLambda();
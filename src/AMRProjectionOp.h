@@ -10,6 +10,7 @@
 
 #include "VCAMRPoissonOp2.H"
 #include "CoarseAverage.H"
+#include "SharedOpState.H"
 
 #include "NamespaceHeader.H"
 
@@ -33,6 +34,52 @@ public:
 
   /// Reset the relaxation coefficient
   virtual void resetLambda();
+
+  ///
+  virtual void residualI(LevelData<FArrayBox>&       a_lhs,
+                         const LevelData<FArrayBox>& a_phi,
+                         const LevelData<FArrayBox>& a_rhs,
+                         bool                        a_homogeneous = false);
+
+  ///
+  virtual void applyOpI(LevelData<FArrayBox>&       a_lhs,
+                        const LevelData<FArrayBox>& a_phi,
+                        bool                        a_homogeneous = false);
+
+  ///
+  virtual void preCond(LevelData<FArrayBox>&       a_correction,
+                       const LevelData<FArrayBox>& a_residual);
+
+  ///
+  virtual void relax(LevelData<FArrayBox>&       a_e,
+                     const LevelData<FArrayBox>& a_residual,
+                     int                         a_iterations);
+
+  ///
+  virtual void restrictResidual(LevelData<FArrayBox>&       a_resCoarse,
+                                LevelData<FArrayBox>&       a_phiFine,
+                                const LevelData<FArrayBox>& a_rhsFine);
+
+  /// Pick up any coefficients which have been updated in place by the factory
+  void refreshSharedState();
+
+  /// State shared with the factory which made us
+  RefCountedPtr<SharedOpState> m_sharedState;
+
+  /// Version of m_sharedState we last picked up
+  int m_stateVersion;
+
+  /// For multigrid levels below the AMR level, the coefficients we average ours from
+  RefCountedPtr<LevelData<FArrayBox> > m_aCoefFine;
+
+  ///
+  RefCountedPtr<LevelData<FluxBox> > m_bCoefFine;
+
+  /// Coarsening from m_aCoefFine and m_bCoefFine to our coefficients
+  int m_coarsening;
+
+  /// How to average coefficients (arithmetic, harmonic, etc.)
+  int m_coefficient_average_type;
 };
 
 /// Factory for creating AMRProjectionOp's
@@ -107,6 +154,13 @@ public:
   /// Returns the refinement ratio to the next finer level
   virtual int refToFiner(const ProblemDomain& a_domain) const;
 
+  /// The coefficients have been updated in place, so operators should re-average them and recompute lambda
+  /**
+   * Lets us keep the multigrid hierarchy (and the bottom solver) between solves on the same grids,
+   * rather than defining a new one every time the coefficients change.
+   */
+  void coefficientsChanged(BCHolder a_bc);
+
   /// How to do coefficient averaging (arithmetic, harmonic, etc. )
   int m_coefficient_average_type;
 
@@ -154,6 +208,9 @@ private:
   /// Objects that represents the edge region around disjoint box layouts
   Vector<CFRegion> m_cfregion;
 
+  /// State shared with all the operators we've made
+  RefCountedPtr<SharedOpState> m_sharedState;
+
 
 };
 
@@ -0,0 +1,196 @@
+#ifdef CH_LANG_CC
+/*
+ *      _______              __
+ *     / ___/ /  ___  __ _  / /  ___
+ *    / /__/ _ \/ _ \/  V \/ _ \/ _ \
+ *    \___/_//_/\___/_/_/_/_.__/\___/
+ *    Please refer to Copyright.txt, in Chombo's root directory.
+ */
+#endif
+
+#ifdef CH_USE_HDF5
+
+#include "AsyncHDF5Writer.H"
+#include "CH_Timer.H"
+#include "MayDay.H"
+#include "SPMD.H"
+
+#include "NamespaceHeader.H"
+
+AsyncHDF5Writer::AsyncHDF5Writer()
+{
+}
+
+AsyncHDF5Writer::~AsyncHDF5Writer()
+{
+  wait();
+}
+
+bool AsyncHDF5Writer::supported(std::string& a_reason)
+{
+#ifndef H5_HAVE_THREADSAFE
+  a_reason = "HDF5 library was not built thread-safe";
+  return false;
+#endif
+
+  if (numProc() > 1)
+  {
+    a_reason = "parallel HDF5 writes are collective so can't run alongside the solver";
+    return false;
+  }
+
+  a_reason = "";
+  return true;
+}
+
+std::string AsyncHDF5Writer::filename(const HDF5Handle& a_handle)
+{
+  ssize_t len = H5Fget_name(a_handle.fileID(), NULL, 0);
+  if (len < 0)
+  {
+    MayDay::Error("AsyncHDF5Writer::filename - couldn't get file name");
+  }
+
+  std::string name(len + 1, '\0');
+  H5Fget_name(a_handle.fileID(), &name[0], len + 1);
+  name.resize(len);
+
+  return name;
+}
+
+void AsyncHDF5Writer::stageCopy(HDF5Handle& a_handle, const std::string& a_group, const std::string& a_name,
+                                const LevelData<FArrayBox>& a_data,
+                                const HDF5Compression& a_compression)
+{
+  CH_TIME("AsyncHDF5Writer::stageCopy");
+
+  m_staged.push_back(StagedData());
+  StagedData& staged = m_staged.back();
+  staged.filename = filename(a_handle);
+  staged.group = a_group;
+  staged.name = a_name;
+  staged.compression = a_compression;
+
+  packLevelData(staged.data, a_data);
+
+  // The file is still open here, so write the attributes now rather than on the background thread
+  writeLevelDataAttributes(a_handle, a_name, staged.data);
+}
+
+void AsyncHDF5Writer::stageCopy(HDF5Handle& a_handle, const std::string& a_group, const std::string& a_name,
+                                const LevelData<FluxBox>& a_data)
+{
+  CH_TIME("AsyncHDF5Writer::stageCopy");
+
+  m_staged.push_back(StagedData());
+  StagedData& staged = m_staged.back();
+  staged.filename = filename(a_handle);
+  staged.group = a_group;
+  staged.name = a_name;
+
+  packLevelData(staged.data, a_data);
+
+  writeLevelDataAttributes(a_handle, a_name, staged.data);
+}
+
+int AsyncHDF5Writer::numStaged() const
+{
+  return m_staged.size();
+}
+
+void AsyncHDF5Writer::start()
+{
+  CH_TIME("AsyncHDF5Writer::start");
+
+  wait();
+
+  if (m_staged.size() == 0)
+  {
+    return;
+  }
+
+  // Swap buffers, then the background thread has sole use of m_writing
+  m_writing.swap(m_staged);
+  m_staged.resize(0);
+
+  m_thread = std::thread(&AsyncHDF5Writer::writeStaged, this);
+}
+
+void AsyncHDF5Writer::wait()
+{
+  CH_TIME("AsyncHDF5Writer::wait");
+
+  if (m_thread.joinable())
+  {
+    m_thread.join();
+  }
+
+  // Free the snapshots on this thread
+  m_writing.resize(0);
+
+  if (!m_error.empty())
+  {
+    MayDay::Error(("AsyncHDF5Writer - " + m_error).c_str());
+  }
+}
+
+void AsyncHDF5Writer::finish()
+{
+  start();
+  wait();
+}
+
+void AsyncHDF5Writer::writeStaged()
+{
+  // Only plain HDF5 calls in here: no Chombo objects, timers, pout() or MayDay
+
+  hid_t file = -1;
+  std::string openFile = "";
+
+  for (int i = 0; i < m_writing.size(); i++)
+  {
+    const StagedData& staged = m_writing[i];
+
+    // Consecutive datasets usually go in the same file, so only reopen when it changes
+    if (staged.filename != openFile)
+    {
+      if (file >= 0)
+      {
+        H5Fclose(file);
+      }
+
+      file = H5Fopen(staged.filename.c_str(), H5F_ACC_RDWR, H5P_DEFAULT);
+      if (file < 0)
+      {
+        m_error = "couldn't reopen " + staged.filename;
+        return;
+      }
+      openFile = staged.filename;
+    }
+
+    hid_t group = H5Gopen2(file, staged.group.c_str(), H5P_DEFAULT);
+    if (group < 0)
+    {
+      m_error = "couldn't open group " + staged.group + " in " + staged.filename;
+      break;
+    }
+
+    int err = writePacked(group, staged.name, staged.data, staged.compression, false);
+    H5Gclose(group);
+
+    if (err < 0)
+    {
+      m_error = "couldn't write " + staged.name + " to " + staged.filename;
+      break;
+    }
+  }
+
+  if (file >= 0)
+  {
+    H5Fclose(file);
+  }
+}
+
+#include "NamespaceFooter.H"
+
+#endif
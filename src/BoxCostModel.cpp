@@ -0,0 +1,307 @@
+#ifdef CH_LANG_CC
+/*
+ *      _______              __
+ *     / ___/ /  ___  __ _  / /  ___
+ *    / /__/ _ \/ _ \/  V \/ _ \/ _ \
+ *    \___/_//_/\___/_/_/_/_.__/\___/
+ *    Please refer to Copyright.txt, in Chombo's root directory.
+ */
+#endif
+
+#include "BoxCostModel.H"
+#include "BoxIterator.H"
+#include "CH_Timer.H"
+#include "MayDay.H"
+#include "SPMD.H"
+
+#include <algorithm>
+#include <cmath>
+
+#include "NamespaceHeader.H"
+
+BoxCostModel::BoxCostModel()
+{
+  m_defined = false;
+  m_solidPorosity = 0.0;
+  m_numSamples = 0;
+
+  for (int i = 0; i < numCellTypes; i++)
+  {
+    m_cost[i] = 1.0;
+    m_normalRhs[i] = 0.0;
+    m_sampledCells[i] = 0.0;
+    for (int j = 0; j < numCellTypes; j++)
+    {
+      m_normalMatrix[i][j] = 0.0;
+    }
+  }
+}
+
+BoxCostModel::~BoxCostModel()
+{
+}
+
+void BoxCostModel::define(Real a_mushyCost, Real a_solidCost, Real a_solidPorosity)
+{
+  m_cost[liquid] = 1.0;
+  m_cost[mushy] = a_mushyCost;
+  m_cost[solid] = a_solidCost;
+  m_solidPorosity = a_solidPorosity;
+
+  m_defined = true;
+}
+
+bool BoxCostModel::isDefined() const
+{
+  return m_defined;
+}
+
+Real BoxCostModel::cost(int a_type) const
+{
+  CH_assert(a_type >= 0 && a_type < numCellTypes);
+  return m_cost[a_type];
+}
+
+void BoxCostModel::countCells(Real a_counts[numCellTypes], const FArrayBox& a_porosity, const Box& a_box) const
+{
+  for (BoxIterator bit(a_box); bit.ok(); ++bit)
+  {
+    Real porosity = a_porosity(bit());
+    if (porosity >= 1.0)
+    {
+      a_counts[liquid] += 1;
+    }
+    else if (porosity < m_solidPorosity)
+    {
+      a_counts[solid] += 1;
+    }
+    else
+    {
+      a_counts[mushy] += 1;
+    }
+  }
+}
+
+void BoxCostModel::addSample(Real a_seconds, const Real a_counts[numCellTypes])
+{
+  for (int i = 0; i < numCellTypes; i++)
+  {
+    for (int j = 0; j < numCellTypes; j++)
+    {
+      m_normalMatrix[i][j] += a_counts[i]*a_counts[j];
+    }
+    m_normalRhs[i] += a_counts[i]*a_seconds;
+    m_sampledCells[i] += a_counts[i];
+  }
+
+  m_numSamples++;
+}
+
+bool BoxCostModel::calibrate()
+{
+  CH_TIME("BoxCostModel::calibrate");
+
+  // Pack everything into one buffer so we only need a single reduction
+  const int n = numCellTypes;
+  Vector<Real> sums(n*n + 2*n + 1, 0.0);
+  for (int i = 0; i < n; i++)
+  {
+    for (int j = 0; j < n; j++)
+    {
+      sums[i*n + j] = m_normalMatrix[i][j];
+    }
+    sums[n*n + i] = m_normalRhs[i];
+    sums[n*n + n + i] = m_sampledCells[i];
+  }
+  sums[n*n + 2*n] = m_numSamples;
+
+#ifdef CH_MPI
+  Vector<Real> localSums(sums);
+  int result = MPI_Allreduce(&localSums[0], &sums[0], sums.size(), MPI_CH_REAL,
+                             MPI_SUM, Chombo_MPI::comm);
+  if (result != MPI_SUCCESS)
+  {
+    MayDay::Error("Sorry, but I had a communication error in BoxCostModel::calibrate");
+  }
+#endif
+
+  Real totalCells = 0.0;
+  for (int i = 0; i < n; i++)
+  {
+    totalCells += sums[n*n + n + i];
+  }
+
+  // Need a few samples per unknown for the fit to mean anything
+  if (sums[n*n + 2*n] < 4*n || sums[n*n + n + liquid] < 0.01*totalCells)
+  {
+    return false;
+  }
+
+  // Types with too few samples are lumped in with liquid cells, using their current relative cost,
+  // i.e. the unknowns are the costs per cell of liquid and each well sampled type
+  Vector<int> fitted;
+  Real transform[numCellTypes][numCellTypes];
+  for (int i = 0; i < n; i++)
+  {
+    for (int j = 0; j < n; j++)
+    {
+      transform[i][j] = 0.0;
+    }
+  }
+
+  for (int i = 0; i < n; i++)
+  {
+    if (i == liquid || sums[n*n + n + i] >= 0.01*totalCells)
+    {
+      transform[i][fitted.size()] = 1.0;
+      fitted.push_back(i);
+    }
+  }
+  for (int i = 0; i < n; i++)
+  {
+    if (i != liquid && sums[n*n + n + i] < 0.01*totalCells)
+    {
+      transform[i][0] = m_cost[i]/m_cost[liquid];
+    }
+  }
+
+  // Reduced normal equations, transform^T N transform x = transform^T b, solved by Gaussian elimination
+  const int m = fitted.size();
+  Real A[numCellTypes][numCellTypes+1];
+  for (int a = 0; a < m; a++)
+  {
+    for (int b = 0; b < m; b++)
+    {
+      A[a][b] = 0.0;
+      for (int i = 0; i < n; i++)
+      {
+        for (int j = 0; j < n; j++)
+        {
+          A[a][b] += transform[i][a]*sums[i*n + j]*transform[j][b];
+        }
+      }
+    }
+
+    A[a][m] = 0.0;
+    for (int i = 0; i < n; i++)
+    {
+      A[a][m] += transform[i][a]*sums[n*n + i];
+    }
+  }
+
+  for (int col = 0; col < m; col++)
+  {
+    int pivot = col;
+    for (int row = col+1; row < m; row++)
+    {
+      if (std::abs(A[row][col]) > std::abs(A[pivot][col]))
+      {
+        pivot = row;
+      }
+    }
+
+    if (std::abs(A[pivot][col]) <= 1e-12*std::abs(A[0][0]))
+    {
+      // Singular - e.g. every box has the same mix of cell types
+      return false;
+    }
+
+    for (int k = 0; k <= m; k++)
+    {
+      std::swap(A[col][k], A[pivot][k]);
+    }
+
+    for (int row = 0; row < m; row++)
+    {
+      if (row != col)
+      {
+        Real factor = A[row][col]/A[col][col];
+        for (int k = col; k <= m; k++)
+        {
+          A[row][k] -= factor*A[col][k];
+        }
+      }
+    }
+  }
+
+  Real liquidSeconds = A[0][m]/A[0][0];
+  if (liquidSeconds <= 0)
+  {
+    return false;
+  }
+
+  // Keep the costs within a sensible range, in case the timings are noisy
+  for (int a = 1; a < m; a++)
+  {
+    Real relativeCost = (A[a][m]/A[a][a])/liquidSeconds;
+    m_cost[fitted[a]] = std::min(std::max(relativeCost, 0.1), 100.0);
+  }
+
+  return true;
+}
+
+void BoxCostModel::computeLoads(Vector<long long>& a_loads, const Vector<Box>& a_boxes,
+                                const LevelData<FArrayBox>& a_crsePorosity, int a_refRatio) const
+{
+  CH_TIME("BoxCostModel::computeLoads");
+
+  const int numBoxes = a_boxes.size();
+  Vector<Real> counts(numBoxes*numCellTypes, 0.0);
+
+  Vector<Box> crseBoxes(numBoxes);
+  for (int i = 0; i < numBoxes; i++)
+  {
+    crseBoxes[i] = coarsen(a_boxes[i], a_refRatio);
+  }
+
+  // Count the coarse cells under each box, from the coarse data on this rank
+  const DisjointBoxLayout& crseGrids = a_crsePorosity.disjointBoxLayout();
+  for (DataIterator dit = crseGrids.dataIterator(); dit.ok(); ++dit)
+  {
+    const Box& crseGridBox = crseGrids[dit];
+    for (int i = 0; i < numBoxes; i++)
+    {
+      Box overlap = crseBoxes[i] & crseGridBox;
+      if (!overlap.isEmpty())
+      {
+        countCells(&counts[i*numCellTypes], a_crsePorosity[dit], overlap);
+      }
+    }
+  }
+
+#ifdef CH_MPI
+  Vector<Real> localCounts(counts);
+  int result = MPI_Allreduce(&localCounts[0], &counts[0], counts.size(), MPI_CH_REAL,
+                             MPI_SUM, Chombo_MPI::comm);
+  if (result != MPI_SUCCESS)
+  {
+    MayDay::Error("Sorry, but I had a communication error in BoxCostModel::computeLoads");
+  }
+#endif
+
+  // Loads are integers, so scale them up to keep the fractional costs
+  const Real loadScale = 100.0;
+  Real fineCellsPerCrseCell = pow(a_refRatio, SpaceDim);
+
+  a_loads.resize(numBoxes);
+  for (int i = 0; i < numBoxes; i++)
+  {
+    // Any part of the box not covered by coarse data is assumed to be liquid
+    Real countedCells = 0.0;
+    for (int type = 0; type < numCellTypes; type++)
+    {
+      countedCells += counts[i*numCellTypes + type];
+    }
+    counts[i*numCellTypes + liquid] += std::max(crseBoxes[i].numPts() - countedCells, 0.0);
+
+    Real load = 0.0;
+    for (int type = 0; type < numCellTypes; type++)
+    {
+      load += m_cost[type]*counts[i*numCellTypes + type]*fineCellsPerCrseCell;
+    }
+
+    a_loads[i] = std::max((long long)llround(loadScale*load), 1LL);
+  }
+}
+
+#include "NamespaceFooter.H"
@@ -0,0 +1,675 @@
+#ifdef CH_LANG_CC
+/*
+ *      _______              __
+ *     / ___/ /  ___  __ _  / /  ___
+ *    / /__/ _ \/ _ \/  V \/ _ \/ _ \
+ *    \___/_//_/\___/_/_/_/_.__/\___/
+ *    Please refer to Copyright.txt, in Chombo's root directory.
+ */
+#endif
+
+#include "ChimneyLabeller.H"
+#include "BoxIterator.H"
+#include "CH_Timer.H"
+#include "MayDay.H"
+#include "SPMD.H"
+
+#include <algorithm>
+#include <cmath>
+
+#include "NamespaceHeader.H"
+
+// Gather a_data from every rank onto every rank, in rank order
+#ifdef CH_MPI
+template <class T>
+static void allGather(std::vector<T>& a_data, MPI_Datatype a_type)
+{
+  int localSize = a_data.size();
+  std::vector<int> sizes(numProc()), offsets(numProc(), 0);
+  MPI_Allgather(&localSize, 1, MPI_INT, &sizes[0], 1, MPI_INT, Chombo_MPI::comm);
+
+  for (int i = 1; i < numProc(); i++)
+  {
+    offsets[i] = offsets[i-1] + sizes[i-1];
+  }
+
+  std::vector<T> allData(std::max(offsets.back() + sizes.back(), 1));
+  std::vector<T> localData(a_data);
+  localData.resize(std::max(localSize, 1));
+
+  int result = MPI_Allgatherv(&localData[0], localSize, a_type,
+                              &allData[0], &sizes[0], &offsets[0], a_type, Chombo_MPI::comm);
+  if (result != MPI_SUCCESS)
+  {
+    MayDay::Error("Sorry, but I had a communication error in ChimneyLabeller");
+  }
+
+  allData.resize(offsets.back() + sizes.back());
+  a_data.swap(allData);
+}
+#endif
+
+ChimneyLabeller::RowStats::RowStats()
+{
+  count = 0;
+  sumIndex = RealVect::Zero;
+  sumCos = RealVect::Zero;
+  sumSin = RealVect::Zero;
+}
+
+ChimneyLabeller::ChimneyLabeller()
+{
+  m_dx = 0;
+}
+
+ChimneyLabeller::~ChimneyLabeller()
+{
+}
+
+void ChimneyLabeller::define(const LevelData<FArrayBox>& a_porosity, const ProblemDomain& a_domain, Real a_dx)
+{
+  CH_TIME("ChimneyLabeller::define");
+
+  m_domain = a_domain;
+  m_dx = a_dx;
+  m_parents.clear();
+  m_widths.resize(0);
+  m_depths.resize(0);
+  m_locations.resize(0);
+
+  const DisjointBoxLayout& grids = a_porosity.disjointBoxLayout();
+
+  LevelData<FArrayBox> labels(grids, 1, IntVect::Unit);
+  std::vector<int> interfaceRows;
+  findInterface(interfaceRows, a_porosity);
+  labelBoxes(labels, a_porosity, interfaceRows);
+  mergeLabels(labels);
+
+  std::map<long, std::map<int, RowStats> > regions;
+  sumRows(regions, labels);
+  measure(regions);
+}
+
+long ChimneyLabeller::cellIndex(const IntVect& a_iv) const
+{
+  const Box& domBox = m_domain.domainBox();
+
+  long index = 0;
+  for (int dir = SpaceDim-1; dir >= 0; dir--)
+  {
+    index = index*domBox.size(dir) + (a_iv[dir] - domBox.smallEnd(dir));
+  }
+
+  return index;
+}
+
+int ChimneyLabeller::columnIndex(const IntVect& a_iv) const
+{
+  const Box& domBox = m_domain.domainBox();
+
+  int index = 0;
+  for (int dir = SpaceDim-2; dir >= 0; dir--)
+  {
+    index = index*domBox.size(dir) + (a_iv[dir] - domBox.smallEnd(dir));
+  }
+
+  return index;
+}
+
+void ChimneyLabeller::findInterface(std::vector<int>& a_interface, const LevelData<FArrayBox>& a_porosity) const
+{
+  CH_TIME("ChimneyLabeller::findInterface");
+
+  int vertDir = SpaceDim-1;
+  const Box& domBox = m_domain.domainBox();
+  const DisjointBoxLayout& grids = a_porosity.disjointBoxLayout();
+
+  int numColumns = 1;
+  for (int dir = 0; dir < SpaceDim-1; dir++)
+  {
+    numColumns *= domBox.size(dir);
+  }
+
+  // Lowest mushy cell in each column, or above the domain if there isn't one
+  std::vector<int> lowestMush(numColumns, domBox.bigEnd(vertDir) + 1);
+  for (DataIterator dit = a_porosity.dataIterator(); dit.ok(); ++dit)
+  {
+    const FArrayBox& porosity = a_porosity[dit];
+    for (BoxIterator bit(grids[dit]); bit.ok(); ++bit)
+    {
+      IntVect iv = bit();
+      // Liquid is porosity >= 1 rather than == 1, as rounding errors can give porosities slightly above 1
+      if (porosity(iv) < 1.0)
+      {
+        int column = columnIndex(iv);
+        lowestMush[column] = std::min(lowestMush[column], iv[vertDir]);
+      }
+    }
+  }
+
+  a_interface.resize(numColumns);
+#ifdef CH_MPI
+  MPI_Allreduce(&lowestMush[0], &a_interface[0], numColumns, MPI_INT, MPI_MIN, Chombo_MPI::comm);
+#else
+  a_interface = lowestMush;
+#endif
+
+  // A chimney has no mush beneath it, so in its own columns it looks like liquid under the mush. First find
+  // the lowest interface plus horizontal distance (in cells) from each column, with a distance transform along
+  // each horizontal direction in turn.
+  std::vector<int> strides(SpaceDim-1, 1);
+  for (int dir = 1; dir < SpaceDim-1; dir++)
+  {
+    strides[dir] = strides[dir-1]*domBox.size(dir-1);
+  }
+
+  std::vector<int> reach(a_interface);
+  for (int dir = 0; dir < SpaceDim-1; dir++)
+  {
+    int n = domBox.size(dir);
+    int stride = strides[dir];
+
+    // Periodic domains need going round twice, so the low end sees the high end
+    int numSteps = m_domain.isPeriodic(dir) ? 2*n : n;
+
+    for (int column = 0; column < numColumns; column++)
+    {
+      // Start from the low end of each line along this direction
+      if ((column/stride) % n != 0)
+      {
+        continue;
+      }
+
+      for (int step = 1; step < numSteps; step++)
+      {
+        int i = step % n;
+        int prev = (i + n - 1) % n;
+        reach[column + i*stride] = std::min(reach[column + i*stride], reach[column + prev*stride] + 1);
+      }
+
+      for (int step = 1; step < numSteps; step++)
+      {
+        int i = n - 1 - (step % n);
+        int next = (i + 1) % n;
+        reach[column + i*stride] = std::min(reach[column + i*stride], reach[column + next*stride] + 1);
+      }
+    }
+  }
+
+  // Then lower each column's interface to that of its neighbours, so the columns next to the mush either
+  // side of a chimney get the interface height of that mush, and those further in are at most one row
+  // higher per cell. Interfaces which slope by less than one cell per cell are left alone.
+  for (int column = 0; column < numColumns; column++)
+  {
+    for (int dir = 0; dir < SpaceDim-1; dir++)
+    {
+      int n = domBox.size(dir);
+      int stride = strides[dir];
+      int i = (column/stride) % n;
+
+      if (i > 0 || m_domain.isPeriodic(dir))
+      {
+        int neighbour = column + (((i + n - 1) % n) - i)*stride;
+        a_interface[column] = std::min(a_interface[column], reach[neighbour]);
+      }
+
+      if (i < n - 1 || m_domain.isPeriodic(dir))
+      {
+        int neighbour = column + (((i + 1) % n) - i)*stride;
+        a_interface[column] = std::min(a_interface[column], reach[neighbour]);
+      }
+    }
+  }
+}
+
+void ChimneyLabeller::labelBoxes(LevelData<FArrayBox>& a_labels, const LevelData<FArrayBox>& a_porosity,
+                                 const std::vector<int>& a_interface) const
+{
+  CH_TIME("ChimneyLabeller::labelBoxes");
+
+  int vertDir = SpaceDim-1;
+  const DisjointBoxLayout& grids = a_labels.disjointBoxLayout();
+
+  for (DataIterator dit = a_labels.dataIterator(); dit.ok(); ++dit)
+  {
+    FArrayBox& labels = a_labels[dit];
+    const FArrayBox& porosity = a_porosity[dit];
+    const Box& box = grids[dit];
+
+    // Ghost cells stay unlabelled unless another box fills them
+    labels.setVal(-1);
+
+    // Union-find over the cells of this box, indexed in the same order as the data
+    int numCells = box.numPts();
+    std::vector<int> parents(numCells, -1);
+
+    IntVect strides;
+    strides[0] = 1;
+    for (int dir = 1; dir < SpaceDim; dir++)
+    {
+      strides[dir] = strides[dir-1]*box.size(dir-1);
+    }
+
+    for (BoxIterator bit(box); bit.ok(); ++bit)
+    {
+      IntVect iv = bit();
+      // Everything below the row beneath the interface is the liquid under the mushy layer
+      if (porosity(iv) < 1.0 || iv[vertDir] < a_interface[columnIndex(iv)])
+      {
+        continue;
+      }
+
+      int cell = 0;
+      for (int dir = 0; dir < SpaceDim; dir++)
+      {
+        cell += (iv[dir] - box.smallEnd(dir))*strides[dir];
+      }
+      parents[cell] = cell;
+
+      // Join with the neighbours we've already visited
+      for (int dir = 0; dir < SpaceDim; dir++)
+      {
+        if (iv[dir] == box.smallEnd(dir))
+        {
+          continue;
+        }
+
+        int neighbour = cell - strides[dir];
+        if (parents[neighbour] < 0)
+        {
+          continue;
+        }
+
+        int root = cell;
+        while (parents[root] != root)
+        {
+          root = parents[root];
+        }
+        int neighbourRoot = neighbour;
+        while (parents[neighbourRoot] != neighbourRoot)
+        {
+          neighbourRoot = parents[neighbourRoot];
+        }
+
+        parents[std::max(root, neighbourRoot)] = std::min(root, neighbourRoot);
+        parents[cell] = std::min(root, neighbourRoot);
+      }
+    }
+
+    // Label each cell with the domain index of its root
+    for (BoxIterator bit(box); bit.ok(); ++bit)
+    {
+      IntVect iv = bit();
+      int cell = 0;
+      for (int dir = 0; dir < SpaceDim; dir++)
+      {
+        cell += (iv[dir] - box.smallEnd(dir))*strides[dir];
+      }
+
+      if (parents[cell] < 0)
+      {
+        continue;
+      }
+
+      int root = cell;
+      while (parents[root] != root)
+      {
+        root = parents[root];
+      }
+      parents[cell] = root;
+
+      IntVect rootIV = box.smallEnd();
+      for (int dir = SpaceDim-1; dir >= 0; dir--)
+      {
+        rootIV[dir] += root/strides[dir];
+        root = root % strides[dir];
+      }
+
+      labels(iv) = cellIndex(rootIV);
+    }
+  }
+}
+
+void ChimneyLabeller::mergeLabels(LevelData<FArrayBox>& a_labels)
+{
+  CH_TIME("ChimneyLabeller::mergeLabels");
+
+  // Fills ghost cells from neighbouring boxes, including across periodic boundaries
+  a_labels.exchange();
+
+  // Pairs of labels which meet across the low side of each box (the high side is the low side of another box)
+  const DisjointBoxLayout& grids = a_labels.disjointBoxLayout();
+  std::vector<long> pairs;
+  for (DataIterator dit = a_labels.dataIterator(); dit.ok(); ++dit)
+  {
+    const FArrayBox& labels = a_labels[dit];
+    const Box& box = grids[dit];
+
+    for (int dir = 0; dir < SpaceDim; dir++)
+    {
+      Box loFace = adjCellLo(box, dir, -1);
+      for (BoxIterator bit(loFace); bit.ok(); ++bit)
+      {
+        IntVect iv = bit();
+        IntVect ivNeighbour = iv - BASISV(dir);
+
+        if (labels(iv) >= 0 && labels(ivNeighbour) >= 0 && labels(iv) != labels(ivNeighbour))
+        {
+          pairs.push_back(long(labels(iv)));
+          pairs.push_back(long(labels(ivNeighbour)));
+        }
+      }
+    }
+  }
+
+#ifdef CH_MPI
+  allGather(pairs, MPI_LONG);
+#endif
+
+  // Every rank now has every pair, so resolves them the same way
+  for (int i = 0; i + 1 < pairs.size(); i += 2)
+  {
+    join(pairs[i], pairs[i+1]);
+  }
+
+  for (DataIterator dit = a_labels.dataIterator(); dit.ok(); ++dit)
+  {
+    FArrayBox& labels = a_labels[dit];
+    for (BoxIterator bit(grids[dit]); bit.ok(); ++bit)
+    {
+      IntVect iv = bit();
+      if (labels(iv) >= 0 && m_parents.count(long(labels(iv))) > 0)
+      {
+        labels(iv) = findRoot(long(labels(iv)));
+      }
+    }
+  }
+}
+
+void ChimneyLabeller::sumRows(std::map<long, std::map<int, RowStats> >& a_regions,
+                              const LevelData<FArrayBox>& a_labels) const
+{
+  CH_TIME("ChimneyLabeller::sumRows");
+
+  int vertDir = SpaceDim-1;
+  const DisjointBoxLayout& grids = a_labels.disjointBoxLayout();
+  const Box& domBox = m_domain.domainBox();
+
+  std::map<long, std::map<int, RowStats> > localRegions;
+  for (DataIterator dit = a_labels.dataIterator(); dit.ok(); ++dit)
+  {
+    const FArrayBox& labels = a_labels[dit];
+    for (BoxIterator bit(grids[dit]); bit.ok(); ++bit)
+    {
+      IntVect iv = bit();
+      if (labels(iv) < 0)
+      {
+        continue;
+      }
+
+      RowStats& row = localRegions[long(labels(iv))][iv[vertDir]];
+      row.count += 1;
+      for (int dir = 0; dir < SpaceDim-1; dir++)
+      {
+        Real angle = 2*M_PI*(iv[dir] - domBox.smallEnd(dir))/domBox.size(dir);
+        row.sumIndex[dir] += iv[dir];
+        row.sumCos[dir] += cos(angle);
+        row.sumSin[dir] += sin(angle);
+      }
+    }
+  }
+
+  // Pack as (label, row, count, sums...) and share with all ranks
+  int recordSize = 3 + 3*(SpaceDim-1);
+  std::vector<Real> records;
+  for (std::map<long, std::map<int, RowStats> >::const_iterator region = localRegions.begin();
+      region != localRegions.end(); ++region)
+  {
+    for (std::map<int, RowStats>::const_iterator row = region->second.begin(); row != region->second.end(); ++row)
+    {
+      records.push_back(region->first);
+      records.push_back(row->first);
+      records.push_back(row->second.count);
+      for (int dir = 0; dir < SpaceDim-1; dir++)
+      {
+        records.push_back(row->second.sumIndex[dir]);
+        records.push_back(row->second.sumCos[dir]);
+        records.push_back(row->second.sumSin[dir]);
+      }
+    }
+  }
+
+#ifdef CH_MPI
+  allGather(records, MPI_CH_REAL);
+#endif
+
+  a_regions.clear();
+  for (int i = 0; i + recordSize <= records.size(); i += recordSize)
+  {
+    RowStats& row = a_regions[long(records[i])][int(records[i+1])];
+    row.count += records[i+2];
+    for (int dir = 0; dir < SpaceDim-1; dir++)
+    {
+      row.sumIndex[dir] += records[i+3+3*dir];
+      row.sumCos[dir] += records[i+4+3*dir];
+      row.sumSin[dir] += records[i+5+3*dir];
+    }
+  }
+}
+
+void ChimneyLabeller::measure(const std::map<long, std::map<int, RowStats> >& a_regions)
+{
+  for (std::map<long, std::map<int, RowStats> >::const_iterator region = a_regions.begin();
+      region != a_regions.end(); ++region)
+  {
+    const std::map<int, RowStats>& rows = region->second;
+
+    // Go down from the top, until the region widens out into the liquid below
+    int top = rows.rbegin()->first;
+    int bottom = top;
+    Real sumWidths = 0, numRows = 0, prevWidth = 0;
+    RowStats chimney;
+
+    for (std::map<int, RowStats>::const_reverse_iterator row = rows.rbegin(); row != rows.rend(); ++row)
+    {
+      Real width = rowWidth(row->second.count);
+      if (row->first < bottom - 1 || (prevWidth > 0 && width > 3*prevWidth))
+      {
+        break;
+      }
+
+      bottom = row->first;
+      sumWidths += width;
+      numRows += 1;
+      prevWidth = width;
+      chimney.count += row->second.count;
+      chimney.sumIndex += row->second.sumIndex;
+      chimney.sumCos += row->second.sumCos;
+      chimney.sumSin += row->second.sumSin;
+    }
+
+    Real averageWidth = sumWidths/numRows;
+    Real depth = (top - bottom)*m_dx;
+
+    // Only keep regions which are deeper than they are wide
+    if (averageWidth < depth)
+    {
+      m_widths.push_back(averageWidth);
+      m_depths.push_back(depth);
+      m_locations.push_back(averageLocation(chimney));
+    }
+  }
+}
+
+Real ChimneyLabeller::rowWidth(Real a_count) const
+{
+  if (SpaceDim == 2)
+  {
+    return a_count*m_dx;
+  }
+
+  return sqrt(a_count)*m_dx;
+}
+
+RealVect ChimneyLabeller::averageLocation(const RowStats& a_stats) const
+{
+  const Box& domBox = m_domain.domainBox();
+
+  RealVect location = a_stats.sumIndex/a_stats.count;
+  for (int dir = 0; dir < SpaceDim-1; dir++)
+  {
+    // Chimneys can straddle periodic boundaries, so take the average angle instead
+    if (m_domain.isPeriodic(dir))
+    {
+      Real angle = atan2(a_stats.sumSin[dir], a_stats.sumCos[dir]);
+      if (angle < 0)
+      {
+        angle += 2*M_PI;
+      }
+      location[dir] = domBox.smallEnd(dir) + angle*domBox.size(dir)/(2*M_PI);
+    }
+  }
+
+  return location;
+}
+
+long ChimneyLabeller::findRoot(long a_label)
+{
+  std::map<long, long>::iterator it = m_parents.find(a_label);
+  if (it == m_parents.end())
+  {
+    m_parents[a_label] = a_label;
+    return a_label;
+  }
+
+  if (it->second != a_label)
+  {
+    it->second = findRoot(it->second);
+  }
+
+  return it->second;
+}
+
+void ChimneyLabeller::join(long a_label1, long a_label2)
+{
+  long root1 = findRoot(a_label1);
+  long root2 = findRoot(a_label2);
+
+  m_parents[std::max(root1, root2)] = std::min(root1, root2);
+}
+
+int ChimneyLabeller::numChimneys() const
+{
+  return m_widths.size();
+}
+
+Real ChimneyLabeller::averageWidth() const
+{
+  if (m_widths.size() == 0)
+  {
+    return 0.0;
+  }
+
+  Real sum = 0;
+  for (int i = 0; i < m_widths.size(); i++)
+  {
+    sum += m_widths[i];
+  }
+
+  return sum/m_widths.size();
+}
+
+Real ChimneyLabeller::averageDepth() const
+{
+  if (m_depths.size() == 0)
+  {
+    return 0.0;
+  }
+
+  Real sum = 0;
+  for (int i = 0; i < m_depths.size(); i++)
+  {
+    sum += m_depths[i];
+  }
+
+  return sum/m_depths.size();
+}
+
+Real ChimneyLabeller::averageSpacing() const
+{
+  int numChimneys = m_locations.size();
+  const Box& domBox = m_domain.domainBox();
+
+  if (SpaceDim == 2)
+  {
+    // Distances between neighbouring chimneys, plus the one across the boundary if periodic
+    std::vector<Real> x(numChimneys);
+    for (int i = 0; i < numChimneys; i++)
+    {
+      x[i] = m_locations[i][0];
+    }
+    std::sort(x.begin(), x.end());
+
+    Real sum = 0;
+    int numSpacings = 0;
+    for (int i = 0; i + 1 < numChimneys; i++)
+    {
+      sum += x[i+1] - x[i];
+      numSpacings++;
+    }
+
+    if (m_domain.isPeriodic(0) && numChimneys > 0)
+    {
+      sum += domBox.size(0) - (x.back() - x.front());
+      numSpacings++;
+    }
+
+    return numSpacings > 0 ? sum*m_dx/numSpacings : 0.0;
+  }
+
+  // Distance to the nearest other chimney, allowing for periodic boundaries
+  if (numChimneys < 2)
+  {
+    return 0.0;
+  }
+
+  Real sum = 0;
+  for (int i = 0; i < numChimneys; i++)
+  {
+    Real nearest = -1;
+    for (int j = 0; j < numChimneys; j++)
+    {
+      if (i == j)
+      {
+        continue;
+      }
+
+      Real dist2 = 0;
+      for (int dir = 0; dir < SpaceDim-1; dir++)
+      {
+        Real d = std::abs(m_locations[i][dir] - m_locations[j][dir]);
+        if (m_domain.isPeriodic(dir))
+        {
+          d = std::min(d, domBox.size(dir) - d);
+        }
+        dist2 += d*d;
+      }
+
+      if (nearest < 0 || dist2 < nearest)
+      {
+        nearest = dist2;
+      }
+    }
+
+    sum += sqrt(nearest);
+  }
+
+  return sum*m_dx/numChimneys;
+}
+
+const Vector<RealVect>& ChimneyLabeller::locations() const
+{
+  return m_locations;
+}
+
+#include "NamespaceFooter.H"
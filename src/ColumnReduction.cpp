@@ -0,0 +1,166 @@
+#ifdef CH_LANG_CC
+/*
+ *      _______              __
+ *     / ___/ /  ___  __ _  / /  ___
+ *    / /__/ _ \/ _ \/  V \/ _ \/ _ \
+ *    \___/_//_/\___/_/_/_/_.__/\___/
+ *    Please refer to Copyright.txt, in Chombo's root directory.
+ */
+#endif
+
+#include "ColumnReduction.H"
+#include "BoxIterator.H"
+#include "CH_Timer.H"
+#include "MayDay.H"
+#include "SPMD.H"
+
+#include <algorithm>
+
+#include "NamespaceHeader.H"
+
+void ColumnReduction::sumPlanes(Vector<Real>& a_sums, const LevelData<FArrayBox>& a_phi, const ProblemDomain& a_domain)
+{
+  CH_TIME("ColumnReduction::sumPlanes");
+
+  const Box& domBox = a_domain.domainBox();
+  int zLo = domBox.smallEnd(SpaceDim-1);
+  int nz = domBox.size(SpaceDim-1);
+
+  a_sums.resize(a_phi.nComp()*nz);
+  a_sums.assign(0.0);
+
+  const DisjointBoxLayout& grids = a_phi.disjointBoxLayout();
+  for (DataIterator dit = a_phi.dataIterator(); dit.ok(); ++dit)
+  {
+    Box region = grids[dit];
+    region &= domBox;
+    addRowSums(a_sums, a_phi[dit], region, nz, zLo);
+  }
+
+  allReduce(a_sums);
+}
+
+void ColumnReduction::sumPlanes(Vector<Real>& a_sums, const LevelData<FluxBox>& a_phi, const ProblemDomain& a_domain)
+{
+  CH_TIME("ColumnReduction::sumPlanes");
+
+  int vertDir = SpaceDim-1;
+  const Box& domBox = a_domain.domainBox();
+  int zLo = domBox.smallEnd(vertDir);
+  int zHi = domBox.bigEnd(vertDir);
+  int nz = domBox.size(vertDir) + 1;
+
+  a_sums.resize(a_phi.nComp()*nz);
+  a_sums.assign(0.0);
+
+  const DisjointBoxLayout& grids = a_phi.disjointBoxLayout();
+  for (DataIterator dit = a_phi.dataIterator(); dit.ok(); ++dit)
+  {
+    Box cells = grids[dit];
+    cells &= domBox;
+
+    // Each box owns the faces below its cells, so faces shared by boxes are only counted once.
+    // Boxes at the top of the domain also own the top face.
+    Box region = surroundingNodes(cells, vertDir);
+    if (cells.bigEnd(vertDir) < zHi)
+    {
+      region.growDir(vertDir, Side::Hi, -1);
+    }
+
+    addRowSums(a_sums, a_phi[dit][vertDir], region, nz, zLo);
+  }
+
+  allReduce(a_sums);
+}
+
+void ColumnReduction::setFromProfile(LevelData<FArrayBox>& a_phi, const Vector<Real>& a_profile, int a_nz,
+                                     const ProblemDomain& a_domain, int a_shift)
+{
+  CH_TIME("ColumnReduction::setFromProfile");
+
+  int vertDir = SpaceDim-1;
+  const Box& domBox = a_domain.domainBox();
+  int zLo = domBox.smallEnd(vertDir);
+  int numComp = std::min(a_phi.nComp(), int(a_profile.size())/a_nz);
+
+  for (DataIterator dit = a_phi.dataIterator(); dit.ok(); ++dit)
+  {
+    FArrayBox& fab = a_phi[dit];
+
+    // Only cells inside the domain vertically have a value
+    Box region = fab.box();
+    region.setSmall(vertDir, std::max(region.smallEnd(vertDir), domBox.smallEnd(vertDir)));
+    region.setBig(vertDir, std::min(region.bigEnd(vertDir), domBox.bigEnd(vertDir)));
+    if (region.isEmpty())
+    {
+      continue;
+    }
+
+    for (int comp = 0; comp < numComp; comp++)
+    {
+      for (BoxIterator bit(region); bit.ok(); ++bit)
+      {
+        IntVect iv = bit();
+        int k = std::min(iv[vertDir] - zLo + a_shift, a_nz - 1);
+        fab(iv, comp) = a_profile[comp*a_nz + k];
+      }
+    }
+  }
+}
+
+void ColumnReduction::addRowSums(Vector<Real>& a_sums, const FArrayBox& a_fab, const Box& a_region, int a_nz, int a_zLo)
+{
+  if (a_region.isEmpty())
+  {
+    return;
+  }
+
+  CH_assert(a_fab.box().contains(a_region));
+
+  // Iterate over the start of each row in the first direction, which is contiguous in memory
+  Box rowStarts = a_region;
+  rowStarts.setBig(0, a_region.smallEnd(0));
+  int rowLength = a_region.size(0);
+
+  for (int comp = 0; comp < a_fab.nComp(); comp++)
+  {
+    Real* sums = &a_sums[comp*a_nz];
+
+    for (BoxIterator bit(rowStarts); bit.ok(); ++bit)
+    {
+      IntVect iv = bit();
+      const Real* row = &a_fab(iv, comp);
+
+      Real rowSum = 0.0;
+      for (int i = 0; i < rowLength; i++)
+      {
+        rowSum += row[i];
+      }
+
+      sums[iv[SpaceDim-1] - a_zLo] += rowSum;
+    }
+  }
+}
+
+void ColumnReduction::allReduce(Vector<Real>& a_sums)
+{
+#ifdef CH_MPI
+  CH_TIME("ColumnReduction::allReduce");
+
+  if (a_sums.size() == 0)
+  {
+    return;
+  }
+
+  Vector<Real> localSums(a_sums);
+  int result = MPI_Allreduce(&localSums[0], &a_sums[0], a_sums.size(), MPI_CH_REAL,
+                             MPI_SUM, Chombo_MPI::comm);
+
+  if (result != MPI_SUCCESS)
+  {
+    MayDay::Error("Sorry, but I had a communication error in ColumnReduction::allReduce");
+  }
+#endif
+}
+
+#include "NamespaceFooter.H"
@@ -0,0 +1,238 @@
+#ifdef CH_LANG_CC
+/*
+ *      _______              __
+ *     / ___/ /  ___  __ _  / /  ___
+ *    / /__/ _ \/ _ \/  V \/ _ \/ _ \
+ *    \___/_//_/\___/_/_/_/_.__/\___/
+ *    Please refer to Copyright.txt, in Chombo's root directory.
+ */
+#endif
+
+#include "ColumnScan.H"
+#include "BoxIterator.H"
+#include "LayoutIterator.H"
+#include "CH_Timer.H"
+#include "MayDay.H"
+#include "SPMD.H"
+
+#include <algorithm>
+#include <map>
+#include <utility>
+
+#include "NamespaceHeader.H"
+
+ColumnScan::ColumnScan()
+{
+}
+
+ColumnScan::~ColumnScan()
+{
+}
+
+bool ColumnScan::isDefined(const DisjointBoxLayout& a_grids) const
+{
+  return m_grids.isClosed() && m_grids == a_grids;
+}
+
+void ColumnScan::define(const DisjointBoxLayout& a_grids)
+{
+  CH_TIME("ColumnScan::define");
+
+  int vertDir = SpaceDim-1;
+  int myProc = procID();
+
+  m_grids = a_grids;
+  m_order.resize(0);
+  m_linksAbove.resize(0);
+  m_linksBelow.resize(0);
+
+  // All the boxes, and which of them have their bottom on each row
+  int numBoxes = a_grids.size();
+  std::vector<Box> boxes(numBoxes);
+  std::vector<int> procs(numBoxes);
+  std::map<int, std::vector<int> > boxesStartingOnRow;
+  for (LayoutIterator lit = a_grids.layoutIterator(); lit.ok(); ++lit)
+  {
+    int index = a_grids.index(lit());
+    boxes[index] = a_grids[lit()];
+    procs[index] = a_grids.procID(lit());
+  }
+  for (int index = 0; index < numBoxes; index++)
+  {
+    boxesStartingOnRow[boxes[index].smallEnd(vertDir)].push_back(index);
+  }
+
+  m_dataIndex.assign(numBoxes, DataIndex());
+  std::vector<std::pair<int, int> > localBoxes;
+  for (DataIterator dit = a_grids.dataIterator(); dit.ok(); ++dit)
+  {
+    int index = a_grids.index(dit());
+    m_dataIndex[index] = dit();
+    localBoxes.push_back(std::make_pair(-boxes[index].bigEnd(vertDir), index));
+  }
+  std::sort(localBoxes.begin(), localBoxes.end());
+
+  std::map<int, int> position;
+  for (int i = 0; i < localBoxes.size(); i++)
+  {
+    m_order.push_back(localBoxes[i].second);
+    position[localBoxes[i].second] = i;
+  }
+  m_linksAbove.resize(m_order.size());
+  m_linksBelow.resize(m_order.size());
+
+  // Every rank goes through the links in the same order, so agrees on the tags. Tags only need to be unique
+  // between a pair of ranks, and are kept below the smallest upper bound MPI allows.
+  const int maxTag = 32767;
+  std::map<std::pair<int, int>, int> numLinks;
+
+  for (int below = 0; below < numBoxes; below++)
+  {
+    std::map<int, std::vector<int> >::const_iterator candidates = boxesStartingOnRow.find(boxes[below].bigEnd(vertDir) + 1);
+    if (candidates == boxesStartingOnRow.end())
+    {
+      continue;
+    }
+
+    Box topRow = boxes[below];
+    topRow.setSmall(vertDir, topRow.bigEnd(vertDir));
+
+    for (int i = 0; i < candidates->second.size(); i++)
+    {
+      int above = candidates->second[i];
+
+      Box columns = topRow;
+      columns.shift(vertDir, 1);
+      columns &= boxes[above];
+      if (columns.isEmpty())
+      {
+        continue;
+      }
+      columns.shift(vertDir, -1);
+
+      Link link;
+      link.above = above;
+      link.below = below;
+      link.procAbove = procs[above];
+      link.procBelow = procs[below];
+      link.columns = columns;
+      link.tag = numLinks[std::make_pair(link.procAbove, link.procBelow)]++ % maxTag;
+
+      if (link.procBelow == myProc)
+      {
+        m_linksAbove[position[below]].push_back(link);
+      }
+      if (link.procAbove == myProc && link.procBelow != myProc)
+      {
+        m_linksBelow[position[above]].push_back(link);
+      }
+    }
+  }
+}
+
+void ColumnScan::sumDown(LevelData<FArrayBox>& a_sum, const LevelData<FArrayBox>& a_values,
+                         const LevelData<FArrayBox>& a_above) const
+{
+  CH_TIME("ColumnScan::sumDown");
+
+  CH_assert(isDefined(a_sum.disjointBoxLayout()));
+
+  int vertDir = SpaceDim-1;
+  int myProc = procID();
+
+#ifdef CH_MPI
+  // Sends stay in flight until the end, so no rank waits on another whilst holding up the ranks below it
+  int numSends = 0;
+  for (int k = 0; k < m_linksBelow.size(); k++)
+  {
+    numSends += m_linksBelow[k].size();
+  }
+  std::vector<std::vector<Real> > sendBuffers(numSends);
+  std::vector<MPI_Request> requests(numSends);
+  int send = 0;
+#endif
+
+  for (int k = 0; k < m_order.size(); k++)
+  {
+    const DataIndex& dit = m_dataIndex[m_order[k]];
+    const Box& box = m_grids[dit];
+    FArrayBox& sum = a_sum[dit];
+    const FArrayBox& values = a_values[dit];
+
+    Box topRow = box;
+    topRow.setSmall(vertDir, box.bigEnd(vertDir));
+
+    // Sums above the top of this box, from the boxes on top of it where there are any
+    FArrayBox start(topRow, 1);
+    start.copy(a_above[dit], topRow);
+
+    for (int i = 0; i < m_linksAbove[k].size(); i++)
+    {
+      const Link& link = m_linksAbove[k][i];
+      Box bottomOfAbove = link.columns;
+      bottomOfAbove.shift(vertDir, 1);
+
+      if (link.procAbove == myProc)
+      {
+        start.copy(a_sum[m_dataIndex[link.above]], bottomOfAbove, 0, link.columns, 0, 1);
+      }
+#ifdef CH_MPI
+      else
+      {
+        std::vector<Real> buffer(link.columns.numPts());
+        int result = MPI_Recv(&buffer[0], buffer.size(), MPI_CH_REAL, link.procAbove, link.tag,
+                              Chombo_MPI::comm, MPI_STATUS_IGNORE);
+        if (result != MPI_SUCCESS)
+        {
+          MayDay::Error("Sorry, but I had a communication error in ColumnScan::sumDown");
+        }
+
+        FArrayBox received(link.columns, 1, &buffer[0]);
+        start.copy(received, link.columns);
+      }
+#endif
+    }
+
+    for (BoxIterator bit(topRow); bit.ok(); ++bit)
+    {
+      IntVect iv = bit();
+      Real colSum = start(iv);
+      for (iv[vertDir] = box.bigEnd(vertDir); iv[vertDir] >= box.smallEnd(vertDir); iv[vertDir]--)
+      {
+        colSum += values(iv);
+        sum(iv) = colSum;
+      }
+    }
+
+#ifdef CH_MPI
+    for (int i = 0; i < m_linksBelow[k].size(); i++)
+    {
+      const Link& link = m_linksBelow[k][i];
+      Box bottomRow = link.columns;
+      bottomRow.shift(vertDir, 1);
+
+      std::vector<Real>& buffer = sendBuffers[send];
+      buffer.resize(link.columns.numPts());
+      FArrayBox toSend(link.columns, 1, &buffer[0]);
+      toSend.copy(sum, bottomRow, 0, link.columns, 0, 1);
+
+      int result = MPI_Isend(&buffer[0], buffer.size(), MPI_CH_REAL, link.procBelow, link.tag,
+                             Chombo_MPI::comm, &requests[send]);
+      if (result != MPI_SUCCESS)
+      {
+        MayDay::Error("Sorry, but I had a communication error in ColumnScan::sumDown");
+      }
+      send++;
+    }
+#endif
+  }
+
+#ifdef CH_MPI
+  if (numSends > 0)
+  {
+    MPI_Waitall(numSends, &requests[0], MPI_STATUSES_IGNORE);
+  }
+#endif
+}
+
+#include "NamespaceFooter.H"
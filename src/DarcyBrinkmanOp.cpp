@@ -25,9 +25,46 @@
 #include "DarcyBrinkmanOp.H"
 #include "DarcyBrinkmanOpF_F.H"
 #include "DebugOut.H"
+#include "MushyLayerUtils.H"
 
 #include "NamespaceHeader.H"
 
+void DarcyBrinkmanOp::refreshSharedState()
+{
+  if (m_sharedState.isNull() || m_sharedState->m_version == m_stateVersion)
+  {
+    return;
+  }
+
+  CH_TIME("DarcyBrinkmanOp::refreshSharedState");
+
+  m_bc = m_sharedState->m_bc;
+
+  // Multigrid levels below the AMR level hold their own averaged copies of the coefficients
+  if (m_coarsening > 1 && !m_aCoefFine.isNull() && !m_bCoefFine.isNull() && !m_cCoefFine.isNull())
+  {
+    CoarseAverage averager(m_aCoefFine->getBoxes(), m_aCoef->disjointBoxLayout(),
+                           m_aCoef->nComp(), m_coarsening);
+    CoarseAverageFace faceAverager(m_bCoefFine->getBoxes(), m_bCoef->nComp(), m_coarsening);
+
+    if (m_coefficient_average_type == CoarseAverage::harmonic)
+    {
+      averager.averageToCoarseHarmonic(*m_aCoef, *m_aCoefFine);
+      averager.averageToCoarseHarmonic(*m_cCoef, *m_cCoefFine);
+      faceAverager.averageToCoarseHarmonic(*m_bCoef, *m_bCoefFine);
+    }
+    else
+    {
+      averager.averageToCoarse(*m_aCoef, *m_aCoefFine);
+      averager.averageToCoarse(*m_cCoef, *m_cCoefFine);
+      faceAverager.averageToCoarse(*m_bCoef, *m_bCoefFine);
+    }
+  }
+
+  m_lambdaNeedsResetting = true;
+  m_stateVersion = m_sharedState->m_version;
+}
+
 void DarcyBrinkmanOp::residualI(LevelData<FArrayBox>&       a_lhs,
                                 const LevelData<FArrayBox>& a_phi,
                                 const LevelData<FArrayBox>& a_rhs,
@@ -35,25 +72,32 @@ void DarcyBrinkmanOp::residualI(LevelData<FArrayBox>&       a_lhs,
 {
   CH_TIME("DarcyBrinkmanOp::residualI");
 
+  refreshSharedState();
+
   LevelData<FArrayBox>& phi = (LevelData<FArrayBox>&)a_phi;
   Real dx = m_dx;
   const DisjointBoxLayout& dbl = a_lhs.disjointBoxLayout();
   DataIterator dit = phi.dataIterator();
+  int nbox = dit.size();
   {
     CH_TIME("DarcyBrinkmanOp::residualIBC");
 
-    for (dit.begin(); dit.ok(); ++dit)
+#pragma omp parallel for
+    for (int ibox = 0; ibox < nbox; ibox++)
     {
-      m_bc(phi[dit], dbl[dit()],m_domain, dx, a_homogeneous);
+      const DataIndex& din = dit[ibox];
+      m_bc(phi[din], dbl[din],m_domain, dx, a_homogeneous);
     }
   }
 
   phi.exchange(phi.interval(), m_exchangeCopier);
 
-  for (dit.begin(); dit.ok(); ++dit)
+#pragma omp parallel for
+  for (int ibox = 0; ibox < nbox; ibox++)
   {
-    const Box& region = dbl[dit()];
-    const FluxBox& thisBCoef = (*m_bCoef)[dit];
+    const DataIndex& din = dit[ibox];
+    const Box& region = dbl[din];
+    const FluxBox& thisBCoef = (*m_bCoef)[din];
 
 #if CH_SPACEDIM == 1
     FORT_DBCOMPUTERES1D
@@ -64,12 +108,12 @@ void DarcyBrinkmanOp::residualI(LevelData<FArrayBox>&       a_lhs,
 #else
     //		This_will_not_compile!
 #endif
-    (CHF_FRA(a_lhs[dit]),
-     CHF_CONST_FRA(phi[dit]),
-     CHF_CONST_FRA(a_rhs[dit]),
+    (CHF_FRA(a_lhs[din]),
+     CHF_CONST_FRA(phi[din]),
+     CHF_CONST_FRA(a_rhs[din]),
      CHF_CONST_REAL(m_alpha),
-     CHF_CONST_FRA((*m_aCoef)[dit]),
-     CHF_CONST_FRA((*m_cCoef)[dit]),
+     CHF_CONST_FRA((*m_aCoef)[din]),
+     CHF_CONST_FRA((*m_cCoef)[din]),
      CHF_CONST_REAL(m_beta),
 #if CH_SPACEDIM >= 1
      CHF_CONST_FRA(thisBCoef[0]),
@@ -115,14 +159,18 @@ void DarcyBrinkmanOp::preCond(LevelData<FArrayBox>&       a_phi,
 
   // don't need to use a Copier -- plain copy will do
   DataIterator dit = a_phi.dataIterator();
-  for (dit.begin(); dit.ok(); ++dit)
+  int nbox = dit.size();
+
+#pragma omp parallel for
+  for (int ibox = 0; ibox < nbox; ibox++)
   {
+    const DataIndex& din = dit[ibox];
     // also need to average and sum face-centered bCoefs to cell-centers
-    Box gridBox = a_rhs[dit].box();
+    Box gridBox = a_rhs[din].box();
 
     // approximate inverse
-    a_phi[dit].copy(a_rhs[dit]);
-    a_phi[dit].mult(m_lambda[dit], gridBox, 0, 0, ncomp);
+    a_phi[din].copy(a_rhs[din]);
+    a_phi[din].mult(m_lambda[din], gridBox, 0, 0, ncomp);
   }
 
   relax(a_phi, a_rhs, 2);
@@ -133,14 +181,20 @@ void DarcyBrinkmanOp::applyOpI(LevelData<FArrayBox>&      a_lhs,
                                bool                        a_homogeneous )
 {
   CH_TIME("DarcyBrinkmanOp::applyOpI");
+
+  refreshSharedState();
   LevelData<FArrayBox>& phi = (LevelData<FArrayBox>&)a_phi;
   Real dx = m_dx;
   const DisjointBoxLayout& dbl = a_lhs.disjointBoxLayout();
   DataIterator dit = phi.dataIterator();
 
-  for (dit.begin(); dit.ok(); ++dit)
+  int nbox = dit.size();
+
+#pragma omp parallel for
+  for (int ibox = 0; ibox < nbox; ibox++)
   {
-    m_bc(phi[dit], dbl[dit()],m_domain, dx, a_homogeneous);
+    const DataIndex& din = dit[ibox];
+    m_bc(phi[din], dbl[din],m_domain, dx, a_homogeneous);
   }
 
   applyOpNoBoundary(a_lhs, a_phi);
@@ -151,6 +205,8 @@ void DarcyBrinkmanOp::applyOpNoBoundary(LevelData<FArrayBox>&      a_lhs,
 {
   CH_TIME("DarcyBrinkmanOp::applyOpNoBoundary");
 
+  refreshSharedState();
+
   LevelData<FArrayBox>& phi = (LevelData<FArrayBox>&)a_phi;
 
   const DisjointBoxLayout& dbl = a_lhs.disjointBoxLayout();
@@ -158,10 +214,14 @@ void DarcyBrinkmanOp::applyOpNoBoundary(LevelData<FArrayBox>&      a_lhs,
 
   phi.exchange(phi.interval(), m_exchangeCopier);
 
-  for (dit.begin(); dit.ok(); ++dit)
+  int nbox = dit.size();
+
+#pragma omp parallel for
+  for (int ibox = 0; ibox < nbox; ibox++)
   {
-    const Box& region = dbl[dit()];
-    const FluxBox& thisBCoef = (*m_bCoef)[dit];
+    const DataIndex& din = dit[ibox];
+    const Box& region = dbl[din];
+    const FluxBox& thisBCoef = (*m_bCoef)[din];
 
 #if CH_SPACEDIM == 1
     FORT_DBCOMPUTEOP1D
@@ -172,11 +232,11 @@ void DarcyBrinkmanOp::applyOpNoBoundary(LevelData<FArrayBox>&      a_lhs,
 #else
     //		This_will_not_compile!
 #endif
-    (CHF_FRA(a_lhs[dit]),
-     CHF_CONST_FRA(phi[dit]),
+    (CHF_FRA(a_lhs[din]),
+     CHF_CONST_FRA(phi[din]),
      CHF_CONST_REAL(m_alpha),
-     CHF_CONST_FRA((*m_aCoef)[dit]),
-     CHF_CONST_FRA((*m_cCoef)[dit]),
+     CHF_CONST_FRA((*m_aCoef)[din]),
+     CHF_CONST_FRA((*m_cCoef)[din]),
      CHF_CONST_REAL(m_beta),
 #if CH_SPACEDIM >= 1
      CHF_CONST_FRA(thisBCoef[0]),
@@ -201,27 +261,36 @@ void DarcyBrinkmanOp::restrictResidual(LevelData<FArrayBox>&       a_resCoarse,
 {
   CH_TIME("DarcyBrinkmanOp::restrictResidual");
 
+  refreshSharedState();
+
   homogeneousCFInterp(a_phiFine);
   const DisjointBoxLayout& dblFine = a_phiFine.disjointBoxLayout();
-  for (DataIterator dit = a_phiFine.dataIterator(); dit.ok(); ++dit)
+  DataIterator dit = a_phiFine.dataIterator();
+  int nbox = dit.size();
+
+#pragma omp parallel for
+  for (int ibox = 0; ibox < nbox; ibox++)
   {
-    FArrayBox& phi = a_phiFine[dit];
-    m_bc(phi, dblFine[dit()], m_domain, m_dx, true);
+    const DataIndex& din = dit[ibox];
+    FArrayBox& phi = a_phiFine[din];
+    m_bc(phi, dblFine[din], m_domain, m_dx, true);
   }
 
   a_phiFine.exchange(a_phiFine.interval(), m_exchangeCopier);
 
-  for (DataIterator dit = a_phiFine.dataIterator(); dit.ok(); ++dit)
+#pragma omp parallel for
+  for (int ibox = 0; ibox < nbox; ibox++)
   {
-    FArrayBox&       phi = a_phiFine[dit];
-    const FArrayBox& rhs = a_rhsFine[dit];
-    FArrayBox&       res = a_resCoarse[dit];
+    const DataIndex& din = dit[ibox];
+    FArrayBox&       phi = a_phiFine[din];
+    const FArrayBox& rhs = a_rhsFine[din];
+    FArrayBox&       res = a_resCoarse[din];
 
-    const FArrayBox& thisACoef = (*m_aCoef)[dit];
-    const FArrayBox& thisCCoef = (*m_cCoef)[dit];
-    const FluxBox&   thisBCoef = (*m_bCoef)[dit];
+    const FArrayBox& thisACoef = (*m_aCoef)[din];
+    const FArrayBox& thisCCoef = (*m_cCoef)[din];
+    const FluxBox&   thisBCoef = (*m_bCoef)[din];
 
-    Box region = dblFine.get(dit());
+    Box region = dblFine.get(din);
     const IntVect& iv = region.smallEnd();
     IntVect civ = coarsen(iv, 2);
 
@@ -289,17 +358,24 @@ void DarcyBrinkmanOp::setCoefs(const RefCountedPtr<LevelData<FArrayBox> >& a_aCo
 
 void DarcyBrinkmanOp::resetLambda()
 {
+  refreshSharedState();
+
   if (m_lambdaNeedsResetting)
   {
     Real scale = 1.0 / (m_dx*m_dx);
 
     // Compute it box by box, point by point
-    for (DataIterator dit = m_lambda.dataIterator(); dit.ok(); ++dit)
+    DataIterator dit = m_lambda.dataIterator();
+    int nbox = dit.size();
+
+#pragma omp parallel for
+    for (int ibox = 0; ibox < nbox; ibox++)
     {
-      FArrayBox&       lambdaFab = m_lambda[dit];
-      const FArrayBox& aCoefFab  = (*m_aCoef)[dit];
-      const FArrayBox& cCoefFab  = (*m_cCoef)[dit];
-      const FluxBox&   bCoefFab  = (*m_bCoef)[dit];
+      const DataIndex& din = dit[ibox];
+      FArrayBox&       lambdaFab = m_lambda[din];
+      const FArrayBox& aCoefFab  = (*m_aCoef)[din];
+      const FArrayBox& cCoefFab  = (*m_cCoef)[din];
+      const FluxBox&   bCoefFab  = (*m_bCoef)[din];
       const Box& curBox = lambdaFab.box();
 
       // Compute the diagonal term
@@ -353,6 +429,8 @@ void DarcyBrinkmanOp::reflux(const LevelData<FArrayBox>&        a_phiFine,
 {
   CH_TIMERS("DarcyBrinkmanOp::reflux");
 
+  refreshSharedState();
+
   m_levfluxreg.setToZero();
   Interval interv(0,a_phi.nComp()-1);
 
@@ -561,6 +639,15 @@ void DarcyBrinkmanOp::levelGSRB(LevelData<FArrayBox>&       a_phi,
 {
   CH_TIME("DarcyBrinkmanOp::levelGSRB");
 
+  gsrbPasses(a_phi, a_rhs, true);
+}
+
+void DarcyBrinkmanOp::gsrbPasses(LevelData<FArrayBox>&       a_phi,
+                                 const LevelData<FArrayBox>& a_rhs,
+                                 bool                        a_exchangeEachPass)
+{
+  refreshSharedState();
+
   CH_assert(a_phi.isDefined());
   CH_assert(a_rhs.isDefined());
   CH_assert(a_phi.ghostVect() >= IntVect::Unit);
@@ -572,78 +659,129 @@ void DarcyBrinkmanOp::levelGSRB(LevelData<FArrayBox>&       a_phi,
   const DisjointBoxLayout& dbl = a_phi.disjointBoxLayout();
 
   DataIterator dit = a_phi.dataIterator();
+  int nbox = dit.size();
 
   // do first red, then black passes
   for (int whichPass = 0; whichPass <= 1; whichPass++)
   {
     CH_TIMERS("DarcyBrinkmanOp::levelGSRB::Compute");
 
-    // fill in intersection of ghostcells and a_phi's boxes
+    if (a_exchangeEachPass || whichPass == 0)
     {
-      CH_TIME("DarcyBrinkmanOp::levelGSRB::homogeneousCFInterp");
-      homogeneousCFInterp(a_phi);
-    }
+      // fill in intersection of ghostcells and a_phi's boxes
+      {
+        CH_TIME("DarcyBrinkmanOp::levelGSRB::homogeneousCFInterp");
+        homogeneousCFInterp(a_phi);
+      }
 
-    {
-      CH_TIME("DarcyBrinkmanOp::levelGSRB::exchange");
-      a_phi.exchange(a_phi.interval(), m_exchangeCopier);
+      {
+        CH_TIME("DarcyBrinkmanOp::levelGSRB::exchange");
+        a_phi.exchange(a_phi.interval(), m_exchangeCopier);
+      }
     }
 
     {
       CH_TIME("DarcyBrinkmanOp::levelGSRB::BCs");
       // now step through grids...
-      for (dit.begin(); dit.ok(); ++dit)
+#pragma omp parallel for
+      for (int ibox = 0; ibox < nbox; ibox++)
       {
+        const DataIndex& din = dit[ibox];
         // invoke physical BC's where necessary
-        m_bc(a_phi[dit], dbl[dit()], m_domain, m_dx, true);
+        m_bc(a_phi[din], dbl[din], m_domain, m_dx, true);
       }
     }
 
-    for (dit.begin(); dit.ok(); ++dit)
+    // Each box only updates its own cells, so boxes can be smoothed concurrently
+#pragma omp parallel for
+    for (int ibox = 0; ibox < nbox; ibox++)
     {
-      const Box& region = dbl.get(dit());
-      const FluxBox& thisBCoef  = (*m_bCoef)[dit];
+      const DataIndex& din = dit[ibox];
+      smoothRegion(a_phi[din], a_rhs[din], din, dbl[din], whichPass);
+    } // end loop through grids
+  } // end loop through red-black
+}
+
+void DarcyBrinkmanOp::smoothRegion(FArrayBox&       a_phi,
+                                   const FArrayBox& a_rhs,
+                                   const DataIndex& a_din,
+                                   const Box&       a_region,
+                                   int              a_whichPass)
+{
+  const FluxBox& thisBCoef  = (*m_bCoef)[a_din];
 
 #if CH_SPACEDIM == 1
-      FORT_GSRBHELMHOLTZDB1D
+  FORT_GSRBHELMHOLTZDB1D
 #elif CH_SPACEDIM == 2
-      FORT_GSRBHELMHOLTZDB2D
+  FORT_GSRBHELMHOLTZDB2D
 #elif CH_SPACEDIM == 3
-      FORT_GSRBHELMHOLTZDB3D
+  FORT_GSRBHELMHOLTZDB3D
 #else
-      //			This_will_not_compile!
+  //			This_will_not_compile!
 #endif
-      (CHF_FRA(a_phi[dit]),
-       CHF_CONST_FRA(a_rhs[dit]),
-       CHF_BOX(region),
-       CHF_CONST_REAL(m_dx),
-       CHF_CONST_REAL(m_alpha),
-       CHF_CONST_FRA((*m_aCoef)[dit]),
-       CHF_CONST_FRA((*m_cCoef)[dit]),
-       CHF_CONST_REAL(m_beta),
+  (CHF_FRA(a_phi),
+   CHF_CONST_FRA(a_rhs),
+   CHF_BOX(a_region),
+   CHF_CONST_REAL(m_dx),
+   CHF_CONST_REAL(m_alpha),
+   CHF_CONST_FRA((*m_aCoef)[a_din]),
+   CHF_CONST_FRA((*m_cCoef)[a_din]),
+   CHF_CONST_REAL(m_beta),
 #if CH_SPACEDIM >= 1
-       CHF_CONST_FRA(thisBCoef[0]),
+   CHF_CONST_FRA(thisBCoef[0]),
 #endif
 #if CH_SPACEDIM >= 2
-       CHF_CONST_FRA(thisBCoef[1]),
+   CHF_CONST_FRA(thisBCoef[1]),
 #endif
 #if CH_SPACEDIM >= 3
-       CHF_CONST_FRA(thisBCoef[2]),
+   CHF_CONST_FRA(thisBCoef[2]),
 #endif
 #if CH_SPACEDIM >= 4
-       This_will_not_compile!
+   This_will_not_compile!
 #endif
-       CHF_CONST_FRA(m_lambda[dit]),
-       CHF_CONST_INT(whichPass));
-    } // end loop through grids
-  } // end loop through red-black
+   CHF_CONST_FRA(m_lambda[a_din]),
+   CHF_CONST_INT(a_whichPass));
+}
+
+void DarcyBrinkmanOp::relax(LevelData<FArrayBox>&       a_e,
+                            const LevelData<FArrayBox>& a_residual,
+                            int                         a_iterations)
+{
+  for (int i = 0; i < a_iterations; i++)
+  {
+    switch (m_relaxMode)
+    {
+      case 0:
+        looseGSRB(a_e, a_residual);
+        break;
+      case 1:
+        levelGSRB(a_e, a_residual);
+        break;
+      case 2:
+        overlapGSRB(a_e, a_residual);
+        break;
+      case 3:
+        levelGSRBLazy(a_e, a_residual);
+        break;
+      case 4:
+        levelJacobi(a_e, a_residual);
+        break;
+      case 5:
+        levelMultiColor(a_e, a_residual);
+        break;
+      default:
+        MayDay::Abort("DarcyBrinkmanOp::relax - unrecognized relaxation mode");
+    }
+  }
 }
 
 void DarcyBrinkmanOp::levelMultiColor(LevelData<FArrayBox>&       a_phi,
                                       const LevelData<FArrayBox>& a_rhs)
 {
   CH_TIME("DarcyBrinkmanOp::levelMultiColor");
-  MayDay::Abort("DarcyBrinkmanOp::levelMultiColor - Not implemented");
+
+  // With a five (seven) point stencil the multicolour ordering is the same iteration as red-black
+  overlapGSRB(a_phi, a_rhs);
 }
 
 void DarcyBrinkmanOp::looseGSRB(LevelData<FArrayBox>&       a_phi,
@@ -763,14 +901,91 @@ void DarcyBrinkmanOp::overlapGSRB(LevelData<FArrayBox>&       a_phi,
                                   const LevelData<FArrayBox>& a_rhs)
 {
   CH_TIME("DarcyBrinkmanOp::overlapGSRB");
-  MayDay::Abort("DarcyBrinkmanOp::overlapGSRB - Not implemented");
+
+  refreshSharedState();
+
+  CH_assert(a_phi.isDefined());
+  CH_assert(a_rhs.isDefined());
+  CH_assert(a_phi.ghostVect() >= IntVect::Unit);
+  CH_assert(a_phi.nComp() == a_rhs.nComp());
+
+  // Recompute the relaxation coefficient if needed.
+  resetLambda();
+
+  const DisjointBoxLayout& dbl = a_phi.disjointBoxLayout();
+
+  DataIterator dit = a_phi.dataIterator();
+  int nbox = dit.size();
+
+  // Same updates as levelGSRB, but the interior of each box is smoothed while the exchange is in flight
+  for (int whichPass = 0; whichPass <= 1; whichPass++)
+  {
+    // Coarse-fine and physical ghost cells aren't touched by the exchange, so fill them first
+    {
+      CH_TIME("DarcyBrinkmanOp::overlapGSRB::homogeneousCFInterp");
+      homogeneousCFInterp(a_phi);
+    }
+
+    {
+      CH_TIME("DarcyBrinkmanOp::overlapGSRB::BCs");
+#pragma omp parallel for
+      for (int ibox = 0; ibox < nbox; ibox++)
+      {
+        const DataIndex& din = dit[ibox];
+        m_bc(a_phi[din], dbl[din], m_domain, m_dx, true);
+      }
+    }
+
+    {
+      CH_TIME("DarcyBrinkmanOp::overlapGSRB::exchangeBegin");
+      a_phi.exchangeBegin(m_exchangeCopier);
+    }
+
+    {
+      CH_TIME("DarcyBrinkmanOp::overlapGSRB::interior");
+#pragma omp parallel for
+      for (int ibox = 0; ibox < nbox; ibox++)
+      {
+        const DataIndex& din = dit[ibox];
+        Box interior = grow(dbl[din], -1);
+        if (!interior.isEmpty())
+        {
+          smoothRegion(a_phi[din], a_rhs[din], din, interior, whichPass);
+        }
+      }
+    }
+
+    {
+      CH_TIME("DarcyBrinkmanOp::overlapGSRB::exchangeEnd");
+      a_phi.exchangeEnd();
+    }
+
+    {
+      CH_TIME("DarcyBrinkmanOp::overlapGSRB::boundary");
+#pragma omp parallel for
+      for (int ibox = 0; ibox < nbox; ibox++)
+      {
+        const DataIndex& din = dit[ibox];
+        const Box& region = dbl[din];
+
+        Vector<Box> edgeBoxes;
+        boxShell(edgeBoxes, region, grow(region, -1));
+        for (int i = 0; i < edgeBoxes.size(); i++)
+        {
+          smoothRegion(a_phi[din], a_rhs[din], din, edgeBoxes[i], whichPass);
+        }
+      }
+    }
+  }
 }
 
 void DarcyBrinkmanOp::levelGSRBLazy(LevelData<FArrayBox>&       a_phi,
                                     const LevelData<FArrayBox>& a_rhs)
 {
   CH_TIME("DarcyBrinkmanOp::levelGSRBLazy");
-  MayDay::Abort("DarcyBrinkmanOp::levelGSRBLazy - Not implemented");
+
+  // Only exchange before the red pass, so the black pass sees red ghost values from before this sweep
+  gsrbPasses(a_phi, a_rhs, false);
 }
 
 void DarcyBrinkmanOp::levelJacobi(LevelData<FArrayBox>&       a_phi,
@@ -789,9 +1004,13 @@ void DarcyBrinkmanOp::levelJacobi(LevelData<FArrayBox>&       a_phi,
 
   // Multiply by the weights
   DataIterator dit = m_lambda.dataIterator();
-  for (dit.begin(); dit.ok(); ++dit)
+  int nbox = dit.size();
+
+#pragma omp parallel for
+  for (int ibox = 0; ibox < nbox; ibox++)
   {
-    resid[dit].mult(m_lambda[dit]);
+    const DataIndex& din = dit[ibox];
+    resid[din].mult(m_lambda[din]);
   }
 
   // Do the Jacobi relaxation
@@ -944,6 +1163,9 @@ void DarcyBrinkmanOpFactory::define(const ProblemDomain&
   m_bCoef = a_bCoef;
 
   m_cCoef = a_cCoef;
+
+  m_sharedState = RefCountedPtr<SharedOpState>(new SharedOpState);
+  m_sharedState->m_bc = m_bc;
 }
 //-----------------------------------------------------------------------
 
@@ -1134,8 +1356,19 @@ MGLevelOp<LevelData<FArrayBox> >* DarcyBrinkmanOpFactory::MGnewOp(const ProblemD
     newOp->m_aCoef = aCoef;
     newOp->m_bCoef = bCoef;
     newOp->m_cCoef = cCoef;
+
+    // Keep hold of the finer coefficients so we can re-average if they change
+    newOp->m_aCoefFine = m_aCoef[ref];
+    newOp->m_bCoefFine = m_bCoef[ref];
+    newOp->m_cCoefFine = m_cCoef[ref];
+    newOp->m_coarsening = coarsening;
   }
 
+  newOp->m_coefficient_average_type = m_coefficient_average_type;
+  newOp->m_relaxMode = m_relaxMode;
+  newOp->m_sharedState = m_sharedState;
+  newOp->m_stateVersion = m_sharedState->m_version;
+
   newOp->computeLambda();
 
   newOp->m_dxCrse = dxCrse;
@@ -1214,6 +1447,10 @@ AMRLevelOp<LevelData<FArrayBox> >* DarcyBrinkmanOpFactory::AMRnewOp(const Proble
   newOp->m_bCoef = m_bCoef[ref];
   newOp->m_cCoef = m_cCoef[ref];
 
+  newOp->m_relaxMode = m_relaxMode;
+  newOp->m_sharedState = m_sharedState;
+  newOp->m_stateVersion = m_sharedState->m_version;
+
   newOp->computeLambda();
 
   newOp->m_dxCrse = dxCrse;
@@ -1221,6 +1458,15 @@ AMRLevelOp<LevelData<FArrayBox> >* DarcyBrinkmanOpFactory::AMRnewOp(const Proble
   return (AMRLevelOp<LevelData<FArrayBox> >*)newOp;
 }
 
+void DarcyBrinkmanOpFactory::coefficientsChanged(BCHolder a_bc)
+{
+  CH_assert(!m_sharedState.isNull());
+
+  m_bc = a_bc;
+  m_sharedState->m_bc = a_bc;
+  m_sharedState->m_version++;
+}
+
 int DarcyBrinkmanOpFactory::refToFiner(const ProblemDomain& a_domain) const
 {
   int retval = -1;
@@ -1251,6 +1497,8 @@ void DarcyBrinkmanOpFactory::setDefaultValues()
   m_beta = -1.0;
 
   m_coefficient_average_type = CoarseAverage::arithmetic;
+
+  m_relaxMode = 1;
 }
 //-----------------------------------------------------------------------
 
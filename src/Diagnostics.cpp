@@ -7,17 +7,25 @@
 
 #include "Diagnostics.h"
 #include <iostream>
+#include <cmath>
+#include <unistd.h>
 #include "NamespaceHeader.H"
 
 
+const char* Diagnostics::s_binaryMagic = "MUSHDIAG";
+
 Diagnostics::Diagnostics ()
 {
-  m_diagnostics.resize(numDiagnostics, NULL);
+  m_capacity = s_minHistory;
+  m_numSteps = 0;
+  m_firstTime = 0;
+  m_times.resize(m_capacity, 0);
+  m_diagnostics.resize(numDiagnostics*m_capacity, std::nan("1"));
+
   m_diagnosticNames.resize(numDiagnostics);
 
   for (int i = 0; i < numDiagnostics; i++)
   {
-    m_diagnostics[i] = new Vector<Real>;
     m_diagnosticNames[i] = "";
   }
 
@@ -47,6 +55,8 @@ Diagnostics::Diagnostics ()
   m_diagnosticNames[DiagnosticNames::diag_heatFluxTop] = "Fh_top";
   m_diagnosticNames[DiagnosticNames::diag_chimneySpacing] = "chimneySpacing";
   m_diagnosticNames[DiagnosticNames::diag_chimneyWidth] = "chimneyWidth";
+  m_diagnosticNames[DiagnosticNames::diag_numChimneys] = "numChimneys";
+  m_diagnosticNames[DiagnosticNames::diag_chimneyDepth] = "chimneyDepth";
 
   m_diagnosticNames[DiagnosticNames::diag_heatFluxAbsMismatch] = "Fh_abs_mismatch";
   m_diagnosticNames[DiagnosticNames::diag_saltFluxAbsMismatch] = "Fs_abs_mismatch";
@@ -95,19 +105,37 @@ Diagnostics::Diagnostics ()
   movingAverageTimescale = 0;
   m_verbosity = 0;
   m_convergenceCriteria = 1e-4;
+  m_format = diagFormat_text;
+  m_flushInterval = 100;
+  m_lastBufferedTime = 0;
 
 
   m_defined = false;
 
 }
 
-void Diagnostics::define(Real a_movingAverageTimescale, int a_verbosity, Real a_convCrit)
+void Diagnostics::define(Real a_movingAverageTimescale, int a_verbosity, Real a_convCrit,
+                         int a_format, int a_flushInterval)
 {
   movingAverageTimescale = a_movingAverageTimescale;
   m_verbosity = a_verbosity;
   m_convergenceCriteria = a_convCrit;
+  m_format = a_format;
+  m_flushInterval = std::max(a_flushInterval, 1);
 
-  m_diagnosticsFile.open("diagnostics.csv", std::ios_base::app);
+  // The binary file is opened when we first write to it, so only the process which writes diagnostics touches it
+  if (m_format == diagFormat_text)
+  {
+    m_diagnosticsFile.open("diagnostics.csv", std::ios_base::app);
+  }
+
+  // Moving averages needed by movingAverageHasConverged()
+  m_windows.resize(0);
+  if (movingAverageTimescale > 0)
+  {
+    addMovingWindow(movingAverageTimescale);
+    addMovingWindow(2*movingAverageTimescale);
+  }
 
 
   if (m_verbosity > 2)
@@ -120,64 +148,61 @@ void Diagnostics::define(Real a_movingAverageTimescale, int a_verbosity, Real a_
 
 Diagnostics::~Diagnostics ()
 {
-  // trying to solve memory leak
-  for (int i = 0; i < numDiagnostics; i++)
-    {
-      delete m_diagnostics[i];
-      m_diagnostics[i] = NULL;
-    }
+  flush();
 }
 
-void Diagnostics::addDiagnostic(DiagnosticNames a_diagnostic, Real a_time, Real value)
+void Diagnostics::addDiagnostic(DiagnosticNames a_diagnostic, Real a_time, Real a_value)
 {
-  int index = getIndex(a_time);
+  long step = getIndex(a_time);
 
   // Add this time if we haven't already
-  if (index == -1)
+  if (step == -1)
   {
-    m_times.push_back(a_time);
-    index = m_times.size() - 1;
-    (*m_diagnostics[diag_time]).push_back(a_time);
+    step = addStep(a_time);
+    addDiagnostic(diag_time, a_time, a_time);
   }
 
-  // Check if we've already added a value for this diagnostic at this time
-  if (index < m_diagnostics[a_diagnostic]->size())
-  {
-    (*m_diagnostics[a_diagnostic])[index] = value;
+  // Replace any value we already had for this diagnostic at this time
+  Real& storedValue = value(a_diagnostic, step);
 
-  }
-  else
+  for (int w = 0; w < m_windows.size(); w++)
   {
-    // Just in case we've got out of sync, add NaN entries to get vectors up to size
-    while (index > m_diagnostics[a_diagnostic]->size())
+    MovingWindow& window = m_windows[w];
+    if (step >= window.start)
     {
-      Real NaN;
-      m_diagnostics[a_diagnostic]->push_back(NaN);
+      if (!std::isnan(storedValue))
+      {
+        window.sum[a_diagnostic] -= storedValue;
+        window.count[a_diagnostic]--;
+      }
+      if (!std::isnan(a_value))
+      {
+        window.sum[a_diagnostic] += a_value;
+        window.count[a_diagnostic]++;
+      }
     }
-
-    m_diagnostics[a_diagnostic]->push_back(value);
-
   }
 
+  storedValue = a_value;
 }
 
 Real Diagnostics::getDiagnostic(DiagnosticNames a_diagnostic, Real a_time, int timestepOffset)
 {
   Real val = 1.0e200;
 
-  int index = getIndex(a_time);
-
-  index = index + timestepOffset;
+  long step = getIndex(a_time);
 
-  if (index > -1)
+  if (step > -1)
   {
-    if (m_diagnostics[a_diagnostic]->size() <= index)
+    step = step + timestepOffset;
+
+    if (step < oldestStep() || step >= m_numSteps)
     {
       val = std::nan("1");
     }
     else
     {
-      val = (*m_diagnostics[a_diagnostic])[index];
+      val = value(a_diagnostic, step);
     }
   }
 
@@ -186,16 +211,35 @@ Real Diagnostics::getDiagnostic(DiagnosticNames a_diagnostic, Real a_time, int t
 
 Real Diagnostics::getMovingAverage(DiagnosticNames a_diagnostic, Real a_endTime, Real a_timeSpan)
 {
-  Real movingAverage = 0;
+  long endStep = getIndex(a_endTime);
 
-  int endIndex = getIndex(a_endTime);
+  // Usually we want the average up to the latest step, over one of the windows we keep running sums for
+  if (endStep > -1 && endStep == m_numSteps - 1)
+  {
+    for (int w = 0; w < m_windows.size(); w++)
+    {
+      if (m_windows[w].span == a_timeSpan)
+      {
+        return m_windows[w].sum[a_diagnostic]/m_windows[w].count[a_diagnostic];
+      }
+    }
+  }
+
+  // Otherwise add up the stored values
+  Real movingAverage = 0;
   int Ntimesteps = 0;
 
-  for (int k = endIndex; k >= 0; k--)
+  for (long k = endStep; k >= 0 && k >= oldestStep(); k--)
   {
-    if ((a_endTime - m_times[k]) < a_timeSpan)
+    if ((a_endTime - stepTime(k)) >= a_timeSpan)
+    {
+      break;
+    }
+
+    Real val = value(a_diagnostic, k);
+    if (!std::isnan(val))
     {
-      movingAverage += (*m_diagnostics[a_diagnostic])[k];
+      movingAverage += val;
       Ntimesteps++;
     }
   }
@@ -209,13 +253,11 @@ Real Diagnostics::getRateOfChange(DiagnosticNames a_diagnostic, Real a_endTime,
 {
   Real rateOfChange = 1.0e200;
 
-  int index = getIndex(a_endTime);
+  long step = getIndex(a_endTime);
 
-  Vector<Real> thisDiag = *m_diagnostics[a_diagnostic];
-
-  if (thisDiag.size() > index && index > 0)
+  if (step > oldestStep())
   {
-    rateOfChange = (thisDiag[index] - thisDiag[index-1])/a_dt;
+    rateOfChange = (value(a_diagnostic, step) - value(a_diagnostic, step-1))/a_dt;
   }
 
   return rateOfChange;
@@ -225,13 +267,11 @@ Real Diagnostics::getSecondRateOfChange(DiagnosticNames a_diagnostic, Real a_end
 {
   Real rateOfChange = 1.0e200;
 
-  int index = getIndex(a_endTime);
-
-  Vector<Real> thisDiag = *m_diagnostics[a_diagnostic];
+  long step = getIndex(a_endTime);
 
-  if (thisDiag.size() > index && index > 1)
+  if (step > oldestStep() + 1)
   {
-    rateOfChange = (thisDiag[index] + thisDiag[index-2] - thisDiag[index-1])/(a_dt*a_dt);
+    rateOfChange = (value(a_diagnostic, step) + value(a_diagnostic, step-2) - value(a_diagnostic, step-1))/(a_dt*a_dt);
   }
 
   return rateOfChange;
@@ -241,7 +281,7 @@ bool Diagnostics::movingAverageHasConverged(DiagnosticNames a_diagnostic, Real a
 {
 
   // Consider the moving average
-  if( (a_time - m_times[0]) > 2*movingAverageTimescale)
+  if( m_numSteps > 0 && (a_time - m_firstTime) > 2*movingAverageTimescale)
   {
     Real movingAverageDiff = std::abs(getMovingAverage(a_diagnostic, a_time, movingAverageTimescale) - getMovingAverage(a_diagnostic, a_time, 2*movingAverageTimescale));
 
@@ -281,6 +321,12 @@ bool Diagnostics::diagnosticIsIncluded(const DiagnosticNames a_diag)
 
 void Diagnostics::printHeader()
 {
+  // Binary files have their own header, written when they're opened
+  if (m_format == diagFormat_binary)
+  {
+    return;
+  }
+
   printHeader(m_diagnosticsFile);
 }
 
@@ -307,6 +353,28 @@ void Diagnostics::printDiagnostics(Real a_time)
 {
   CH_TIME("Diagnostics::printDiagnostics");
 
+  if (m_format == diagFormat_binary)
+  {
+    if (!m_diagnosticsFile.is_open())
+    {
+      openBinaryFile();
+    }
+
+    // Buffer every diagnostic, and only write to disk every m_flushInterval steps
+    for (int d = 0; d < numDiagnostics; d++)
+    {
+      m_binaryBuffer.push_back(getDiagnostic(DiagnosticNames(d), a_time));
+    }
+    m_lastBufferedTime = a_time;
+
+    if (m_binaryBuffer.size() >= m_flushInterval*numDiagnostics)
+    {
+      flush();
+    }
+
+    return;
+  }
+
   printDiagnostics(a_time, m_diagnosticsFile);
 
   // Open latest diags file and delete contents, then rewrite
@@ -338,19 +406,240 @@ void Diagnostics::printDiagnostics(Real a_time, std::ofstream& a_file)
 }
 
 
-int Diagnostics::getIndex(Real a_time)
+void Diagnostics::flush()
+{
+  if (m_format != diagFormat_binary || m_binaryBuffer.size() == 0)
+  {
+    return;
+  }
+
+  CH_TIME("Diagnostics::flush");
+
+  m_diagnosticsFile.write(reinterpret_cast<const char*>(&m_binaryBuffer[0]), m_binaryBuffer.size()*sizeof(Real));
+  m_diagnosticsFile.flush();
+  m_binaryBuffer.clear();
+
+  // Keep the latest values somewhere easy to look at, but only update them when we flush
+  m_diagnosticsFileLatest.open("diagnosticsLatest.csv", std::ofstream::out | std::ofstream::trunc);
+  printHeader(m_diagnosticsFileLatest);
+  printDiagnostics(m_lastBufferedTime, m_diagnosticsFileLatest);
+  m_diagnosticsFileLatest.close();
+}
+
+void Diagnostics::openBinaryFile()
+{
+  // Header: magic string, format version, size of each value, number of diagnostics, then each
+  // diagnostic's name (length followed by characters). After this, each step is numDiagnostics values.
+  std::string header(s_binaryMagic);
+  int ints[3] = {s_binaryVersion, (int) sizeof(Real), numDiagnostics};
+  header.append(reinterpret_cast<const char*>(ints), sizeof(ints));
+  for (int d = 0; d < numDiagnostics; d++)
+  {
+    int len = m_diagnosticNames[d].size();
+    header.append(reinterpret_cast<const char*>(&len), sizeof(len));
+    header.append(m_diagnosticNames[d]);
+  }
+
+  const char* filename = "diagnostics.bin";
+
+  // If we're restarting, carry on with the existing file as long as it has the same diagnostics
+  bool append = false;
+  std::ifstream existing(filename, std::ios::binary | std::ios::ate);
+  if (existing.is_open())
+  {
+    long fileSize = existing.tellg();
+    std::string existingHeader(header.size(), '\0');
+    existing.seekg(0);
+    existing.read(&existingHeader[0], header.size());
+
+    if (existing.gcount() == (long) header.size() && existingHeader == header)
+    {
+      append = true;
+
+      // Drop any partly written step (e.g. if we crashed whilst writing)
+      long stepSize = numDiagnostics*sizeof(Real);
+      long partial = (fileSize - (long) header.size()) % stepSize;
+      if (partial > 0 && truncate(filename, fileSize - partial) != 0)
+      {
+        append = false;
+      }
+    }
+    else if (fileSize > 0)
+    {
+      pout() << "Diagnostics - " << filename << " was written with different diagnostics, starting it again" << std::endl;
+    }
+    existing.close();
+  }
+
+  if (append)
+  {
+    m_diagnosticsFile.open(filename, std::ios::binary | std::ios::app);
+  }
+  else
+  {
+    m_diagnosticsFile.open(filename, std::ios::binary | std::ios::trunc);
+    m_diagnosticsFile.write(header.c_str(), header.size());
+  }
+
+  if (!m_diagnosticsFile.is_open())
+  {
+    MayDay::Error("Diagnostics::openBinaryFile - couldn't open diagnostics.bin");
+  }
+}
+
+long Diagnostics::getIndex(Real a_time)
+{
+  // Search backwards, as we usually want the latest time
+  for (long k = m_numSteps - 1; k >= oldestStep(); k--)
+  {
+    if (stepTime(k) == a_time)
+    {
+      return k;
+    }
+  }
+
+  return -1;
+}
+
+long Diagnostics::oldestStep() const
+{
+  return std::max(m_numSteps - m_capacity, 0L);
+}
+
+Real& Diagnostics::value(int a_diagnostic, long a_step)
+{
+  return m_diagnostics[a_diagnostic*m_capacity + a_step % m_capacity];
+}
+
+Real Diagnostics::stepTime(long a_step) const
+{
+  return m_times[a_step % m_capacity];
+}
+
+long Diagnostics::addStep(Real a_time)
+{
+  long step = m_numSteps;
+
+  // Remove steps which have dropped out of each moving window
+  long oldestNeeded = step;
+  for (int w = 0; w < m_windows.size(); w++)
+  {
+    MovingWindow& window = m_windows[w];
+    while (window.start < step && a_time - stepTime(window.start) >= window.span)
+    {
+      for (int d = 0; d < numDiagnostics; d++)
+      {
+        Real val = value(d, window.start);
+        if (!std::isnan(val))
+        {
+          window.sum[d] -= val;
+          window.count[d]--;
+        }
+      }
+      window.start++;
+    }
+
+    oldestNeeded = std::min(oldestNeeded, window.start);
+  }
+
+  // Only grow the buffers if a moving window needs more steps than we can store
+  reserve(step + 1 - oldestNeeded);
+
+  if (m_numSteps == 0)
+  {
+    m_firstTime = a_time;
+  }
+
+  m_numSteps++;
+  m_times[step % m_capacity] = a_time;
+  for (int d = 0; d < numDiagnostics; d++)
+  {
+    value(d, step) = std::nan("1");
+  }
+
+  // Every so often, recompute the running sums so round off doesn't build up over long runs
+  for (int w = 0; w < m_windows.size(); w++)
+  {
+    m_windows[w].stepsSinceRecompute++;
+    if (m_windows[w].stepsSinceRecompute >= m_capacity)
+    {
+      recomputeWindow(m_windows[w]);
+    }
+  }
+
+  return step;
+}
+
+void Diagnostics::reserve(long a_numSteps)
+{
+  if (a_numSteps <= m_capacity)
+  {
+    return;
+  }
+
+  int newCapacity = std::max(2*m_capacity, (int) a_numSteps);
+
+  if (m_verbosity > 2)
+  {
+    pout() << "Diagnostics::reserve - storing " << newCapacity << " steps" << std::endl;
+  }
+
+  Vector<Real> times(newCapacity, 0);
+  Vector<Real> diagnostics(numDiagnostics*newCapacity, std::nan("1"));
+
+  for (long k = oldestStep(); k < m_numSteps; k++)
+  {
+    times[k % newCapacity] = stepTime(k);
+    for (int d = 0; d < numDiagnostics; d++)
+    {
+      diagnostics[d*newCapacity + k % newCapacity] = value(d, k);
+    }
+  }
+
+  m_times = times;
+  m_diagnostics = diagnostics;
+  m_capacity = newCapacity;
+}
+
+void Diagnostics::addMovingWindow(Real a_span)
+{
+  MovingWindow window;
+  window.span = a_span;
+  window.start = oldestStep();
+
+  if (m_numSteps > 0)
+  {
+    Real latestTime = stepTime(m_numSteps - 1);
+    while (window.start < m_numSteps - 1 && latestTime - stepTime(window.start) >= a_span)
+    {
+      window.start++;
+    }
+  }
+
+  recomputeWindow(window);
+
+  m_windows.push_back(window);
+}
+
+void Diagnostics::recomputeWindow(MovingWindow& a_window)
 {
-  Real index = -1;
+  a_window.sum = Vector<Real>(numDiagnostics, 0.0);
+  a_window.count = Vector<int>(numDiagnostics, 0);
 
-  for (int i = 0; i < m_times.size(); i++)
+  for (long k = std::max(a_window.start, oldestStep()); k < m_numSteps; k++)
   {
-    if (m_times[i] == a_time)
+    for (int d = 0; d < numDiagnostics; d++)
     {
-      return i;
+      Real val = value(d, k);
+      if (!std::isnan(val))
+      {
+        a_window.sum[d] += val;
+        a_window.count[d]++;
+      }
     }
   }
 
-  return index;
+  a_window.stepsSinceRecompute = 0;
 }
 
 void Diagnostics::setPrintDiags(Vector<DiagnosticNames> a_diagsToPrint)
@@ -52,6 +52,8 @@ enum DiagnosticNames{
   diag_dTdt,
   diag_chimneySpacing,
   diag_chimneyWidth,
+  diag_numChimneys,
+  diag_chimneyDepth,
   diag_HorizAvSalinity0,
   diag_HorizAvSalinity20,
   diag_HorizAvSalinity40,
@@ -80,9 +82,23 @@ enum DiagnosticNames{
   numDiagnostics
 };
 
+/// Formats in which diagnostics can be written out
+enum DiagnosticFormats{
+  /// diagnostics.csv, a line per step, and diagnosticsLatest.csv rewritten every step
+  diagFormat_text,
+
+  /// diagnostics.bin, every diagnostic at every step, buffered and written in blocks (read with plotting/DiagnosticsFile.py)
+  diagFormat_binary
+};
+
 /// Class to contain diagnostics
 /**
  * This class manages various diagnostics that we want to track during simulations
+ *
+ * Only a recent window of history is kept, in ring buffers, so memory doesn't grow with the
+ * length of the run. Moving averages over the timescales used to check for convergence
+ * (see define()) are kept as running sums, so these, along with looking up the latest
+ * values and rates of change, cost the same however many steps we've taken.
  */
 class Diagnostics
 {
@@ -91,18 +107,25 @@ public:
   Diagnostics ();
 
   /// Define object
-  void define (Real a_movingAverageTimescale, int a_verbosity, Real a_convCrit);
+  /**
+   * a_format is one of DiagnosticFormats. For binary output, steps are written every a_flushInterval steps.
+   */
+  void define (Real a_movingAverageTimescale, int a_verbosity, Real a_convCrit,
+               int a_format = diagFormat_text, int a_flushInterval = 100);
 
   /// Destructor
   virtual  ~Diagnostics ();
 
   /// Add a diagnostic
-  void addDiagnostic(DiagnosticNames a_diagnostic, Real a_time, Real value);
+  void addDiagnostic(DiagnosticNames a_diagnostic, Real a_time, Real a_value);
 
   /// Get the value of a diagnostic, \f$ \alpha \f$
   Real getDiagnostic(DiagnosticNames a_diagnostic, Real a_time, int timestepOffset = 0);
 
   /// Get the moving average of a diagnostic
+  /**
+   * Values which haven't been set (NaN) are left out of the average.
+   */
   Real getMovingAverage(DiagnosticNames a_diagnostic, Real a_endTime, Real a_timeSpan);
 
   /// Get \f$ \frac{d \alpha}{d t} \f$
@@ -126,6 +149,9 @@ public:
   /// Print diagnostics at given time to a certain file
   void printDiagnostics(Real a_time, std::ofstream& a_file);
 
+  /// Write out any buffered binary diagnostics
+  void flush();
+
   /// Returns whether or not the specified diagnostic is one that's in one list of diagnostics to print
   bool diagnosticIsIncluded(const DiagnosticNames a_diag);
 
@@ -136,11 +162,45 @@ public:
 
 private:
 
-  /// Times at which diagnostics have been calculated
+  /// Running sums of each diagnostic over the most recent a_span of time
+  struct MovingWindow
+  {
+    /// Length of time covered by the window
+    Real span;
+
+    /// Oldest step in the window
+    long start;
+
+    /// Sum of the (non NaN) values of each diagnostic in the window
+    Vector<Real> sum;
+
+    /// Number of values in each sum
+    Vector<int> count;
+
+    /// Steps added since the sums were last recomputed from scratch
+    int stepsSinceRecompute;
+  };
+
+  /// Times at which diagnostics have been calculated, step k is stored in m_times[k % m_capacity]
   Vector<Real> m_times;
 
-  /// Diagnostics at each time
-  Vector<Vector<Real>* > m_diagnostics;
+  /// Diagnostics at each time, diagnostic d at step k is stored in m_diagnostics[d*m_capacity + k % m_capacity]
+  Vector<Real> m_diagnostics;
+
+  /// Number of steps which the ring buffers can hold
+  int m_capacity;
+
+  /// Number of steps added so far (including those no longer stored)
+  long m_numSteps;
+
+  /// Time of the first step added
+  Real m_firstTime;
+
+  /// Windows over which we keep running sums for moving averages
+  Vector<MovingWindow> m_windows;
+
+  /// Least number of steps to keep, whether or not the moving windows need them
+  static const int s_minHistory = 1024;
 
   /// Names of diagnostics
   Vector<string> m_diagnosticNames;
@@ -166,8 +226,50 @@ private:
   /// File to which the latest the diagnostics are written
   m_diagnosticsFileLatest;
 
-  /// Get the index for a certain timestep
-  int getIndex(Real a_time);
+  /// Format to write diagnostics in (one of DiagnosticFormats)
+  int m_format;
+
+  /// For binary output, number of steps to buffer before writing them
+  int m_flushInterval;
+
+  /// Time of the last step buffered for binary output
+  Real m_lastBufferedTime;
+
+  /// Binary output waiting to be written, numDiagnostics values per step
+  std::vector<Real> m_binaryBuffer;
+
+  /// Open diagnostics.bin, appending if it was written with the same diagnostics, otherwise starting again
+  void openBinaryFile();
+
+  /// Identifies binary diagnostics files
+  static const char* s_binaryMagic;
+
+  /// Version of the binary format
+  static const int s_binaryVersion = 1;
+
+  /// Get the step at a certain time, or -1 if we don't have it (any more)
+  long getIndex(Real a_time);
+
+  /// Oldest step still stored
+  long oldestStep() const;
+
+  /// Value of a diagnostic at a (stored) step
+  Real& value(int a_diagnostic, long a_step);
+
+  /// Time of a (stored) step
+  Real stepTime(long a_step) const;
+
+  /// Add a new step at time a_time, with all diagnostics unset (NaN)
+  long addStep(Real a_time);
+
+  /// Make sure we can store at least a_numSteps steps, keeping those we have
+  void reserve(long a_numSteps);
+
+  /// Start tracking a moving average over a_span
+  void addMovingWindow(Real a_span);
+
+  /// Recompute the sums in a moving window from the stored values, which removes any accumulated round off
+  void recomputeWindow(MovingWindow& a_window);
 
 
 
@@ -0,0 +1,668 @@
+#ifdef CH_LANG_CC
+/*
+ *      _______              __
+ *     / ___/ /  ___  __ _  / /  ___
+ *    / /__/ _ \/ _ \/  V \/ _ \/ _ \
+ *    \___/_//_/\___/_/_/_/_.__/\___/
+ *    Please refer to Copyright.txt, in Chombo's root directory.
+ */
+#endif
+
+#include "DirectBottomSolver.H"
+#include "BoxIterator.H"
+#include "CH_Timer.H"
+#include "MayDay.H"
+#include "SPMD.H"
+#include "parstream.H"
+
+#include <algorithm>
+#include <cfloat>
+#include <cmath>
+
+#include "NamespaceHeader.H"
+
+DirectBottomSolver::DirectBottomSolver()
+{
+  m_op = NULL;
+  m_fallback = NULL;
+  m_homogeneous = false;
+  m_nonlinear = false;
+  m_factorised = false;
+  m_failed = false;
+
+  m_imax = 5;
+  m_eps = 1e-10;
+  m_normThresh = 1e-30;
+  m_convergenceMetric = 0.0;
+  m_refactorRate = 0.5;
+  m_maxBandEntries = 100000000;
+  m_verbosity = 0;
+
+  m_rootProc = uniqueProc(SerialTask::compute);
+  m_nComp = 0;
+  m_numUnknowns = 0;
+  m_lowerBand = 0;
+  m_upperBand = 0;
+  m_bandWidth = 0;
+  m_numFixed = 0;
+}
+
+DirectBottomSolver::~DirectBottomSolver()
+{
+}
+
+void DirectBottomSolver::setHomogeneous(bool a_homogeneous)
+{
+  m_homogeneous = a_homogeneous;
+}
+
+void DirectBottomSolver::define(LinearOp<LevelData<FArrayBox> >* a_operator, bool a_homogeneous)
+{
+  m_op = a_operator;
+  m_homogeneous = a_homogeneous;
+  resetFactorisation();
+}
+
+void DirectBottomSolver::setConvergenceMetrics(Real a_metric, Real a_tolerance)
+{
+  m_convergenceMetric = a_metric;
+  m_eps = a_tolerance;
+}
+
+void DirectBottomSolver::setNonlinear(bool a_nonlinear)
+{
+  m_nonlinear = a_nonlinear;
+}
+
+void DirectBottomSolver::resetFactorisation()
+{
+  m_factorised = false;
+  m_failed = false;
+}
+
+void DirectBottomSolver::setFallback(LinearSolver<LevelData<FArrayBox> >* a_fallback)
+{
+  m_fallback = a_fallback;
+}
+
+bool DirectBottomSolver::tooLarge() const
+{
+  return (long long)m_numUnknowns*m_bandWidth > m_maxBandEntries;
+}
+
+void DirectBottomSolver::solve(LevelData<FArrayBox>& a_phi, const LevelData<FArrayBox>& a_rhs)
+{
+  CH_TIME("DirectBottomSolver::solve");
+  CH_assert(m_op != NULL);
+
+  if (!(a_phi.disjointBoxLayout() == m_grids) || a_phi.nComp() != m_nComp)
+  {
+    defineNumbering(a_phi.disjointBoxLayout(), a_phi.nComp());
+    m_factorised = false;
+    m_failed = false;
+  }
+
+  if (tooLarge() || m_failed)
+  {
+    solveWithFallback(a_phi, a_rhs);
+    return;
+  }
+
+  LevelData<FArrayBox> resid, correction;
+  m_op->create(resid, a_rhs);
+  m_op->create(correction, a_phi);
+
+  m_op->residual(resid, a_phi, a_rhs, m_homogeneous);
+  Real initialNorm = m_op->norm(resid, 0);
+  Real norm = initialNorm;
+
+  Real target = (m_convergenceMetric > 0) ? m_eps*m_convergenceMetric : m_eps*initialNorm;
+  target = max(target, m_normThresh);
+
+  if (m_verbosity >= 5)
+  {
+    pout() << "    DirectBottomSolver::solve - initial residual = " << initialNorm << endl;
+  }
+
+  LevelData<FArrayBox> gathered;
+  Vector<Real> x;
+
+  int iter = 0;
+  while (iter < m_imax && norm > target)
+  {
+    bool newFactorisation = false;
+    if (!m_factorised || !(a_phi.disjointBoxLayout() == m_grids))
+    {
+      if (!factorise(a_phi))
+      {
+        solveWithFallback(a_phi, a_rhs);
+        return;
+      }
+      newFactorisation = true;
+    }
+
+    // Gather the residual, solve for the correction, then scatter it back again
+    gathered.define(m_gatheredGrids, m_nComp);
+    resid.copyTo(resid.interval(), gathered, gathered.interval());
+
+    if (procID() == m_rootProc)
+    {
+      x.resize(m_numUnknowns);
+      for (DataIterator dit = m_gatheredGrids.dataIterator(); dit.ok(); ++dit)
+      {
+        for (BoxIterator bit(m_gatheredGrids[dit]); bit.ok(); ++bit)
+        {
+          int cell = m_cellIndex(bit());
+          for (int comp = 0; comp < m_nComp; comp++)
+          {
+            x[cell*m_nComp + comp] = gathered[dit](bit(), comp);
+          }
+        }
+      }
+
+      solveBand(x);
+
+      for (DataIterator dit = m_gatheredGrids.dataIterator(); dit.ok(); ++dit)
+      {
+        for (BoxIterator bit(m_gatheredGrids[dit]); bit.ok(); ++bit)
+        {
+          int cell = m_cellIndex(bit());
+          for (int comp = 0; comp < m_nComp; comp++)
+          {
+            gathered[dit](bit(), comp) = x[cell*m_nComp + comp];
+          }
+        }
+      }
+    }
+
+    m_op->setToZero(correction);
+    gathered.copyTo(gathered.interval(), correction, correction.interval());
+    m_op->incr(a_phi, correction, 1.0);
+
+    Real oldNorm = norm;
+    m_op->residual(resid, a_phi, a_rhs, m_homogeneous);
+    norm = m_op->norm(resid, 0);
+    iter++;
+
+    if (m_verbosity >= 5)
+    {
+      pout() << "    DirectBottomSolver::solve - iteration " << iter << ", residual = " << norm << endl;
+    }
+
+    // The Jacobian of a nonlinear operator changes with phi, so get a new one if it's no longer doing its job
+    if (m_nonlinear && !newFactorisation && norm > m_refactorRate*oldNorm)
+    {
+      m_factorised = false;
+    }
+  }
+
+  if (m_verbosity >= 4)
+  {
+    pout() << "    DirectBottomSolver::solve - residual " << initialNorm << " -> " << norm
+        << " in " << iter << " iterations" << endl;
+  }
+}
+
+void DirectBottomSolver::solveWithFallback(LevelData<FArrayBox>& a_phi, const LevelData<FArrayBox>& a_rhs)
+{
+  CH_TIME("DirectBottomSolver::solveWithFallback");
+
+  if (m_fallback == NULL)
+  {
+    MayDay::Error("DirectBottomSolver - can't factorise the bottom level, allow more multigrid coarsening or use an iterative bottom solver");
+  }
+
+  // Define it now rather than in define(), as it may have been used by another solver since
+  m_fallback->define(m_op, m_homogeneous);
+  m_fallback->setConvergenceMetrics(m_convergenceMetric, m_eps);
+  m_fallback->solve(a_phi, a_rhs);
+}
+
+int DirectBottomSolver::numColours(const ProblemDomain& a_domain, int a_dir) const
+{
+  // Around periodic boundaries, the colours must still differ between neighbours
+  if (a_domain.isPeriodic(a_dir))
+  {
+    int n = a_domain.domainBox().size(a_dir);
+    for (int colours = 3; colours <= n; colours++)
+    {
+      if (n % colours == 0)
+      {
+        return colours;
+      }
+    }
+    return n;
+  }
+
+  return 3;
+}
+
+void DirectBottomSolver::defineNumbering(const DisjointBoxLayout& a_grids, int a_nComp)
+{
+  CH_TIME("DirectBottomSolver::defineNumbering");
+
+  m_grids = a_grids;
+  m_nComp = a_nComp;
+
+  const ProblemDomain& domain = a_grids.physDomain();
+  const Box& domainBox = domain.domainBox();
+
+  Vector<Box> boxes;
+  Box boundingBox;
+  for (LayoutIterator lit = a_grids.layoutIterator(); lit.ok(); ++lit)
+  {
+    boxes.push_back(a_grids[lit]);
+    boundingBox = boundingBox.isEmpty() ? a_grids[lit] : minBox(boundingBox, a_grids[lit]);
+  }
+
+  Vector<int> procs(boxes.size(), m_rootProc);
+  m_gatheredGrids = DisjointBoxLayout(boxes, procs, domain);
+
+  // Number cells lexicographically over the bounding box, to keep the bandwidth down
+  m_cellIndex.define(boundingBox, 1);
+  m_cellIndex.setVal(-1);
+  for (int i = 0; i < boxes.size(); i++)
+  {
+    m_cellIndex.setVal(0, boxes[i], 0);
+  }
+
+  int numCells = 0;
+  for (BoxIterator bit(boundingBox); bit.ok(); ++bit)
+  {
+    if (m_cellIndex(bit()) == 0)
+    {
+      m_cellIndex(bit()) = numCells;
+      numCells++;
+    }
+  }
+  m_numUnknowns = numCells*m_nComp;
+
+  // Furthest (in numbering) neighbouring cells
+  int maxUp = 0, maxDown = 0;
+  Box neighbours(-IntVect::Unit, IntVect::Unit);
+  for (int i = 0; i < boxes.size(); i++)
+  {
+    for (BoxIterator bit(boxes[i]); bit.ok(); ++bit)
+    {
+      for (BoxIterator nit(neighbours); nit.ok(); ++nit)
+      {
+        IntVect neighbour = bit() + nit();
+        for (int dir = 0; dir < SpaceDim; dir++)
+        {
+          if (domain.isPeriodic(dir))
+          {
+            int n = domainBox.size(dir);
+            neighbour[dir] = domainBox.smallEnd(dir) + ((neighbour[dir] - domainBox.smallEnd(dir)) % n + n) % n;
+          }
+        }
+
+        if (boundingBox.contains(neighbour) && m_cellIndex(neighbour) >= 0)
+        {
+          int distance = m_cellIndex(neighbour) - m_cellIndex(bit());
+          maxUp = max(maxUp, distance);
+          maxDown = max(maxDown, -distance);
+        }
+      }
+    }
+  }
+
+  // Partial pivoting can fill in another m_lowerBand super diagonals
+  m_lowerBand = maxDown*m_nComp + m_nComp - 1;
+  m_upperBand = maxUp*m_nComp + m_nComp - 1 + m_lowerBand;
+  m_bandWidth = m_lowerBand + m_upperBand + 1;
+
+  if (m_verbosity >= 3)
+  {
+    pout() << "  DirectBottomSolver - " << m_numUnknowns << " unknowns, bandwidth " << m_bandWidth << endl;
+  }
+
+  // Only warn when the grids change, rather than for every bottom solve
+  if (tooLarge())
+  {
+    pout() << "DirectBottomSolver - " << m_numUnknowns << " unknowns with bandwidth " << m_bandWidth
+        << " is too large to factorise" << (m_fallback != NULL ? ", using the iterative bottom solver instead" : "") << endl;
+    MayDay::Warning("DirectBottomSolver - bottom level too large to factorise, allow more multigrid coarsening");
+  }
+}
+
+bool DirectBottomSolver::factorise(const LevelData<FArrayBox>& a_phi)
+{
+  CH_TIME("DirectBottomSolver::factorise");
+
+  const DisjointBoxLayout& grids = a_phi.disjointBoxLayout();
+  if (!(grids == m_grids) || a_phi.nComp() != m_nComp)
+  {
+    defineNumbering(grids, a_phi.nComp());
+  }
+
+  CH_assert(!tooLarge());
+
+  if (procID() == m_rootProc)
+  {
+    m_band.resize(0);
+    m_band.resize(m_numUnknowns*m_bandWidth, 0.0);
+  }
+
+  const ProblemDomain& domain = grids.physDomain();
+  const IntVect& domainLo = domain.domainBox().smallEnd();
+  IntVect colours;
+  for (int dir = 0; dir < SpaceDim; dir++)
+  {
+    colours[dir] = numColours(domain, dir);
+  }
+
+  LevelData<FArrayBox> probe, response, base, perturbed;
+  m_op->create(probe, a_phi);
+  m_op->create(response, a_phi);
+
+  // Finite difference Jacobian for nonlinear operators, with a perturbation for each component
+  Vector<Real> perturbation(m_nComp, 0.0);
+  if (m_nonlinear)
+  {
+    m_op->create(base, a_phi);
+    m_op->create(perturbed, a_phi);
+    m_op->applyOp(base, a_phi, m_homogeneous);
+
+    for (int comp = 0; comp < m_nComp; comp++)
+    {
+      Real maxPhi = 0.0;
+      for (DataIterator dit = grids.dataIterator(); dit.ok(); ++dit)
+      {
+        maxPhi = max(maxPhi, a_phi[dit].norm(grids[dit], 0, comp, 1));
+      }
+#ifdef CH_MPI
+      Real localMaxPhi = maxPhi;
+      int result = MPI_Allreduce(&localMaxPhi, &maxPhi, 1, MPI_CH_REAL, MPI_MAX, Chombo_MPI::comm);
+      if (result != MPI_SUCCESS)
+      {
+        MayDay::Error("Sorry, but I had a communication error in DirectBottomSolver::factorise");
+      }
+#endif
+      perturbation[comp] = sqrt(DBL_EPSILON)*(1.0 + maxPhi);
+    }
+  }
+
+  LevelData<FArrayBox> gatheredResponse(m_gatheredGrids, m_nComp);
+  Box colourBox(IntVect::Zero, colours - IntVect::Unit);
+
+  for (int comp = 0; comp < m_nComp; comp++)
+  {
+    for (BoxIterator colourIt(colourBox); colourIt.ok(); ++colourIt)
+    {
+      const IntVect& colour = colourIt();
+
+      m_op->setToZero(probe);
+      for (DataIterator dit = grids.dataIterator(); dit.ok(); ++dit)
+      {
+        for (BoxIterator bit(grids[dit]); bit.ok(); ++bit)
+        {
+          bool probed = true;
+          for (int dir = 0; dir < SpaceDim; dir++)
+          {
+            probed = probed && ((bit()[dir] - domainLo[dir]) % colours[dir] + colours[dir]) % colours[dir] == colour[dir];
+          }
+          if (probed)
+          {
+            probe[dit](bit(), comp) = 1.0;
+          }
+        }
+      }
+
+      if (m_nonlinear)
+      {
+        m_op->assign(perturbed, a_phi);
+        m_op->incr(perturbed, probe, perturbation[comp]);
+        m_op->applyOp(response, perturbed, m_homogeneous);
+        m_op->incr(response, base, -1.0);
+        m_op->scale(response, 1.0/perturbation[comp]);
+      }
+      else
+      {
+        m_op->applyOp(response, probe, true);
+      }
+
+      response.copyTo(response.interval(), gatheredResponse, gatheredResponse.interval());
+
+      if (procID() == m_rootProc)
+      {
+        addResponse(gatheredResponse, comp, colour);
+      }
+    }
+  }
+
+  int success = 1;
+  if (procID() == m_rootProc)
+  {
+    success = factoriseBand() ? 1 : 0;
+
+    if (m_verbosity >= 3 && m_numFixed > 0)
+    {
+      pout() << "  DirectBottomSolver - matrix is singular, fixed " << m_numFixed << " unknowns" << endl;
+    }
+  }
+  broadcast(success, m_rootProc);
+
+  if (!success)
+  {
+    pout() << "DirectBottomSolver - zero pivot in an unexpectedly singular matrix"
+        << (m_fallback != NULL ? ", using the iterative bottom solver instead" : "") << endl;
+    MayDay::Warning("DirectBottomSolver - bottom level matrix is singular");
+    m_failed = true;
+    return false;
+  }
+
+  m_factorised = true;
+  return true;
+}
+
+void DirectBottomSolver::addResponse(const LevelData<FArrayBox>& a_response, int a_comp, const IntVect& a_colour)
+{
+  const ProblemDomain& domain = m_grids.physDomain();
+  const Box& domainBox = domain.domainBox();
+  const Box& indexBox = m_cellIndex.box();
+
+  IntVect colours;
+  for (int dir = 0; dir < SpaceDim; dir++)
+  {
+    colours[dir] = numColours(domain, dir);
+  }
+
+  for (DataIterator dit = m_gatheredGrids.dataIterator(); dit.ok(); ++dit)
+  {
+    const FArrayBox& response = a_response[dit];
+
+    for (BoxIterator bit(m_gatheredGrids[dit]); bit.ok(); ++bit)
+    {
+      const IntVect& iv = bit();
+
+      // The only probed neighbour of this cell
+      IntVect source;
+      bool found = true;
+      for (int dir = 0; dir < SpaceDim && found; dir++)
+      {
+        found = false;
+        for (int offset = -1; offset <= 1 && !found; offset++)
+        {
+          int index = iv[dir] + offset;
+          int n = domainBox.size(dir);
+          if (domain.isPeriodic(dir))
+          {
+            index = domainBox.smallEnd(dir) + ((index - domainBox.smallEnd(dir)) % n + n) % n;
+          }
+          else if (index < domainBox.smallEnd(dir) || index > domainBox.bigEnd(dir))
+          {
+            continue;
+          }
+
+          if (((index - domainBox.smallEnd(dir)) % colours[dir] + colours[dir]) % colours[dir] == a_colour[dir])
+          {
+            source[dir] = index;
+            found = true;
+          }
+        }
+      }
+
+      if (!found || !indexBox.contains(source) || m_cellIndex(source) < 0)
+      {
+        continue;
+      }
+
+      int col = m_cellIndex(source)*m_nComp + a_comp;
+      for (int comp = 0; comp < m_nComp; comp++)
+      {
+        Real value = response(iv, comp);
+        if (value != 0.0)
+        {
+          int row = m_cellIndex(iv)*m_nComp + comp;
+          CH_assert(col - row <= m_upperBand - m_lowerBand && row - col <= m_lowerBand);
+          band(row, col) = value;
+        }
+      }
+    }
+  }
+}
+
+bool DirectBottomSolver::factoriseBand()
+{
+  CH_TIME("DirectBottomSolver::factoriseBand");
+
+  const int n = m_numUnknowns;
+  m_pivots.resize(n);
+  m_fixed.resize(0);
+  m_numFixed = 0;
+
+  // Size of each row, to judge its pivot by
+  Vector<Real> rowScale(n, 0.0);
+  for (int row = 0; row < n; row++)
+  {
+    int firstCol = max(0, row - m_lowerBand);
+    int lastCol = min(n-1, row + m_upperBand);
+    for (int col = firstCol; col <= lastCol; col++)
+    {
+      rowScale[row] = max(rowScale[row], std::abs(band(row, col)));
+    }
+  }
+
+  // A component which can be shifted by a constant (e.g. Poisson's equation with Neumann or periodic boundaries
+  // all round) makes the matrix singular, so fix that component in the first cell. For a compatible right hand
+  // side, the equation we lose follows from the others.
+  for (int comp = 0; comp < m_nComp && comp < n; comp++)
+  {
+    bool constantNullSpace = true;
+    for (int row = 0; row < n && constantNullSpace; row++)
+    {
+      Real rowSum = 0.0;
+      int firstCol = max(0, row - m_lowerBand);
+      int lastCol = min(n-1, row + m_upperBand);
+      for (int col = firstCol; col <= lastCol; col++)
+      {
+        if (col % m_nComp == comp)
+        {
+          rowSum += band(row, col);
+        }
+      }
+      constantNullSpace = std::abs(rowSum) <= 1e-10*rowScale[row];
+    }
+
+    if (constantNullSpace)
+    {
+      int fixedRow = comp;
+      int lastCol = min(n-1, fixedRow + m_upperBand);
+      for (int col = 0; col <= lastCol; col++)
+      {
+        band(fixedRow, col) = 0.0;
+      }
+      band(fixedRow, fixedRow) = (rowScale[fixedRow] > 0.0) ? rowScale[fixedRow] : 1.0;
+      rowScale[fixedRow] = std::abs(band(fixedRow, fixedRow));
+
+      m_fixed.push_back(fixedRow);
+      m_numFixed++;
+    }
+  }
+
+  for (int k = 0; k < n; k++)
+  {
+    int lastRow = min(n-1, k + m_lowerBand);
+    int lastCol = min(n-1, k + m_upperBand);
+
+    int pivot = k;
+    for (int row = k+1; row <= lastRow; row++)
+    {
+      if (std::abs(band(row, k)) > std::abs(band(pivot, k)))
+      {
+        pivot = row;
+      }
+    }
+    m_pivots[k] = pivot;
+
+    if (pivot != k)
+    {
+      for (int col = k; col <= lastCol; col++)
+      {
+        std::swap(band(k, col), band(pivot, col));
+      }
+      std::swap(rowScale[k], rowScale[pivot]);
+    }
+
+    // Nothing left in this column, relative to the row it came from: singular in some way we didn't expect
+    if (!(std::abs(band(k, k)) > 1e-12*rowScale[k]))
+    {
+      return false;
+    }
+
+    Real diag = band(k, k);
+    for (int row = k+1; row <= lastRow; row++)
+    {
+      Real factor = band(row, k)/diag;
+      band(row, k) = factor;
+      if (factor != 0.0)
+      {
+        for (int col = k+1; col <= lastCol; col++)
+        {
+          band(row, col) -= factor*band(k, col);
+        }
+      }
+    }
+  }
+
+  return true;
+}
+
+void DirectBottomSolver::solveBand(Vector<Real>& a_x) const
+{
+  CH_TIME("DirectBottomSolver::solveBand");
+
+  const int n = m_numUnknowns;
+
+  // Fixed unknowns are zero
+  for (int i = 0; i < m_fixed.size(); i++)
+  {
+    a_x[m_fixed[i]] = 0.0;
+  }
+
+  // Replay the row swaps and elimination on the right hand side
+  for (int k = 0; k < n; k++)
+  {
+    std::swap(a_x[k], a_x[m_pivots[k]]);
+
+    int lastRow = min(n-1, k + m_lowerBand);
+    for (int row = k+1; row <= lastRow; row++)
+    {
+      a_x[row] -= band(row, k)*a_x[k];
+    }
+  }
+
+  // Back substitution
+  for (int k = n-1; k >= 0; k--)
+  {
+    int lastCol = min(n-1, k + m_upperBand);
+    Real sum = a_x[k];
+    for (int col = k+1; col <= lastCol; col++)
+    {
+      sum -= band(k, col)*a_x[col];
+    }
+    a_x[k] = sum/band(k, k);
+  }
+}
+
+#include "NamespaceFooter.H"
@@ -0,0 +1,327 @@
+#ifdef CH_LANG_CC
+/*
+ *      _______              __
+ *     / ___/ /  ___  __ _  / /  ___
+ *    / /__/ _ \/ _ \/  V \/ _ \/ _ \
+ *    \___/_//_/\___/_/_/_/_.__/\___/
+ *    Please refer to Copyright.txt, in Chombo's root directory.
+ */
+#endif
+
+#ifdef CH_USE_HDF5
+
+#include "HDF5Compression.H"
+#include "MayDay.H"
+#include "SPMD.H"
+
+#include <algorithm>
+#include <utility>
+#include <vector>
+
+#include "NamespaceHeader.H"
+
+HDF5Compression::HDF5Compression()
+{
+  filter = m_none;
+  level = 4;
+  shuffle = true;
+  lossyDigits = -1;
+  singlePrecision = false;
+  chunkSize = 65536;
+}
+
+bool HDF5Compression::active() const
+{
+  return filter != m_none || lossyDigits >= 0 || singlePrecision;
+}
+
+bool HDF5Compression::check(std::string& a_reason)
+{
+  a_reason = "";
+
+  if (filter == m_zstd && H5Zfilter_avail(s_zstdFilterID) <= 0)
+  {
+    a_reason = "zstd filter isn't available (is HDF5_PLUGIN_PATH set?), using deflate instead";
+    filter = m_deflate;
+  }
+
+  if (filter == m_deflate && H5Zfilter_avail(H5Z_FILTER_DEFLATE) <= 0)
+  {
+    a_reason = "HDF5 wasn't built with deflate, writing uncompressed data";
+    filter = m_none;
+  }
+
+  if (lossyDigits >= 0 && H5Zfilter_avail(H5Z_FILTER_SCALEOFFSET) <= 0)
+  {
+    a_reason = "HDF5 doesn't have the scale-offset filter, writing data without loss";
+    lossyDigits = -1;
+  }
+
+  return a_reason.empty();
+}
+
+int HDF5Compression::filterFromName(const std::string& a_name)
+{
+  if (a_name == "none")
+  {
+    return m_none;
+  }
+  else if (a_name == "deflate")
+  {
+    return m_deflate;
+  }
+  else if (a_name == "zstd")
+  {
+    return m_zstd;
+  }
+
+  return -1;
+}
+
+// Our boxes, sorted by their position in the dataset
+static std::vector<std::pair<int, DataIndex> > sortedLocalBoxes(const DisjointBoxLayout& a_grids)
+{
+  std::vector<std::pair<int, DataIndex> > localBoxes;
+  for (DataIterator dit = a_grids.dataIterator(); dit.ok(); ++dit)
+  {
+    localBoxes.push_back(std::make_pair(a_grids.index(dit()), dit()));
+  }
+  std::sort(localBoxes.begin(), localBoxes.end());
+
+  return localBoxes;
+}
+
+void packLevelData(PackedLevelData& a_packed, const LevelData<FArrayBox>& a_data)
+{
+  const DisjointBoxLayout& grids = a_data.disjointBoxLayout();
+  int nComp = a_data.nComp();
+
+  a_packed.nComp = nComp;
+  a_packed.ghost = a_data.ghostVect();
+  FArrayBox dummy;
+  a_packed.objectType = name(dummy);
+  a_packed.writeOffsets = (procID() == 0);
+
+  a_packed.offsets.assign(1, 0);
+  for (LayoutIterator lit = grids.layoutIterator(); lit.ok(); ++lit)
+  {
+    a_packed.offsets.push_back(a_packed.offsets.back() + grids[lit()].numPts()*nComp);
+  }
+
+  std::vector<std::pair<int, DataIndex> > localBoxes = sortedLocalBoxes(grids);
+
+  a_packed.buffer.resize(0);
+  a_packed.ranges.resize(0);
+  for (int i = 0; i < localBoxes.size(); i++)
+  {
+    int index = localBoxes[i].first;
+    const Box& box = grids[localBoxes[i].second];
+    size_t start = a_packed.buffer.size();
+    a_packed.buffer.resize(start + box.numPts()*nComp);
+
+    FArrayBox alias(box, nComp, &a_packed.buffer[start]);
+    alias.copy(a_data[localBoxes[i].second], box);
+
+    a_packed.ranges.push_back(std::make_pair((hsize_t) a_packed.offsets[index],
+                                             (hsize_t) (a_packed.offsets[index+1] - a_packed.offsets[index])));
+  }
+}
+
+void packLevelData(PackedLevelData& a_packed, const LevelData<FluxBox>& a_data)
+{
+  const DisjointBoxLayout& grids = a_data.disjointBoxLayout();
+  int nComp = a_data.nComp();
+
+  a_packed.nComp = nComp;
+  a_packed.ghost = a_data.ghostVect();
+  FluxBox dummy;
+  a_packed.objectType = name(dummy);
+  a_packed.writeOffsets = (procID() == 0);
+
+  a_packed.offsets.assign(1, 0);
+  for (LayoutIterator lit = grids.layoutIterator(); lit.ok(); ++lit)
+  {
+    long long boxSize = 0;
+    for (int dir = 0; dir < SpaceDim; dir++)
+    {
+      boxSize += surroundingNodes(grids[lit()], dir).numPts()*nComp;
+    }
+    a_packed.offsets.push_back(a_packed.offsets.back() + boxSize);
+  }
+
+  std::vector<std::pair<int, DataIndex> > localBoxes = sortedLocalBoxes(grids);
+
+  a_packed.buffer.resize(0);
+  a_packed.ranges.resize(0);
+  for (int i = 0; i < localBoxes.size(); i++)
+  {
+    int index = localBoxes[i].first;
+    const Box& box = grids[localBoxes[i].second];
+
+    for (int dir = 0; dir < SpaceDim; dir++)
+    {
+      Box faceBox = surroundingNodes(box, dir);
+      size_t start = a_packed.buffer.size();
+      a_packed.buffer.resize(start + faceBox.numPts()*nComp);
+
+      FArrayBox alias(faceBox, nComp, &a_packed.buffer[start]);
+      alias.copy(a_data[localBoxes[i].second][dir], faceBox);
+    }
+
+    a_packed.ranges.push_back(std::make_pair((hsize_t) a_packed.offsets[index],
+                                             (hsize_t) (a_packed.offsets[index+1] - a_packed.offsets[index])));
+  }
+}
+
+void writeLevelDataAttributes(HDF5Handle& a_handle, const std::string& a_name, const PackedLevelData& a_packed)
+{
+  // Same attributes as write()
+  HDF5HeaderData info;
+  info.m_intvect["ghost"] = a_packed.ghost;
+  info.m_intvect["outputGhost"] = IntVect::Zero;
+  info.m_int["comps"] = a_packed.nComp;
+  info.m_string["objectType"] = a_packed.objectType;
+
+  std::string group = a_handle.getGroup();
+  a_handle.setGroup(group + "/" + a_name + "_attributes");
+  info.writeToFile(a_handle);
+  a_handle.setGroup(group);
+}
+
+int writePacked(hid_t a_group, const std::string& a_name, const PackedLevelData& a_packed,
+                const HDF5Compression& a_compression, bool a_collective)
+{
+  // Only HDF5 calls in here, as this is also called from AsyncHDF5Writer's background thread
+
+  hsize_t totalSize = a_packed.offsets.back();
+
+  // Dataset creation properties, with filters applied chunk by chunk
+  hid_t dcpl = H5Pcreate(H5P_DATASET_CREATE);
+  if (totalSize > 0 && a_compression.active())
+  {
+    hsize_t chunk = std::min(totalSize, (hsize_t) a_compression.chunkSize);
+    H5Pset_chunk(dcpl, 1, &chunk);
+
+    if (a_compression.lossyDigits >= 0)
+    {
+      H5Pset_scaleoffset(dcpl, H5Z_SO_FLOAT_DSCALE, a_compression.lossyDigits);
+    }
+
+    if (a_compression.filter != HDF5Compression::m_none && a_compression.shuffle)
+    {
+      H5Pset_shuffle(dcpl);
+    }
+
+    if (a_compression.filter == HDF5Compression::m_deflate)
+    {
+      H5Pset_deflate(dcpl, a_compression.level);
+    }
+    else if (a_compression.filter == HDF5Compression::m_zstd)
+    {
+      unsigned int zstdLevel = a_compression.level;
+      H5Pset_filter(dcpl, HDF5Compression::s_zstdFilterID, H5Z_FLAG_MANDATORY, 1, &zstdLevel);
+    }
+  }
+
+  // The cast from Real to the file type (if different) is done by H5Dwrite
+  hid_t fileType = a_compression.singlePrecision ? H5T_NATIVE_FLOAT : H5T_NATIVE_REAL;
+
+  std::string dataName = a_name + ":datatype=0";
+  hid_t dataSpace = H5Screate_simple(1, &totalSize, NULL);
+  hid_t dataSet = H5Dcreate2(a_group, dataName.c_str(), fileType, dataSpace,
+                             H5P_DEFAULT, dcpl, H5P_DEFAULT);
+  H5Pclose(dcpl);
+  if (dataSet < 0)
+  {
+    H5Sclose(dataSpace);
+    return -1;
+  }
+
+  // Select where our boxes go in the file
+  if (a_packed.ranges.size() == 0)
+  {
+    H5Sselect_none(dataSpace);
+  }
+  for (int i = 0; i < a_packed.ranges.size(); i++)
+  {
+    hsize_t start = a_packed.ranges[i].first;
+    hsize_t count = a_packed.ranges[i].second;
+    H5Sselect_hyperslab(dataSpace, i == 0 ? H5S_SELECT_SET : H5S_SELECT_OR, &start, NULL, &count, NULL);
+  }
+
+  Real empty = 0;
+  const Real* buffer = a_packed.buffer.size() > 0 ? &a_packed.buffer[0] : &empty;
+  hsize_t memSize = std::max(a_packed.buffer.size(), (size_t) 1);
+  hid_t memSpace = H5Screate_simple(1, &memSize, NULL);
+  if (a_packed.buffer.size() == 0)
+  {
+    H5Sselect_none(memSpace);
+  }
+
+  hid_t dxpl = H5Pcreate(H5P_DATASET_XFER);
+#ifdef CH_MPI
+  // Parallel writes to filtered datasets must be collective
+  if (a_collective)
+  {
+    H5Pset_dxpl_mpio(dxpl, H5FD_MPIO_COLLECTIVE);
+  }
+#endif
+
+  herr_t err = H5Dwrite(dataSet, H5T_NATIVE_REAL, memSpace, dataSpace, dxpl, buffer);
+
+  H5Pclose(dxpl);
+  H5Sclose(memSpace);
+  H5Sclose(dataSpace);
+  H5Dclose(dataSet);
+
+  if (err < 0)
+  {
+    return -1;
+  }
+
+  // Box offsets, which every process knows so only one needs to write
+  std::string offsetName = a_name + ":offsets=0";
+  hsize_t numOffsets = a_packed.offsets.size();
+  hid_t offsetSpace = H5Screate_simple(1, &numOffsets, NULL);
+  hid_t offsetSet = H5Dcreate2(a_group, offsetName.c_str(), H5T_NATIVE_LLONG, offsetSpace,
+                               H5P_DEFAULT, H5P_DEFAULT, H5P_DEFAULT);
+  if (offsetSet < 0)
+  {
+    H5Sclose(offsetSpace);
+    return -1;
+  }
+  if (a_packed.writeOffsets)
+  {
+    err = H5Dwrite(offsetSet, H5T_NATIVE_LLONG, H5S_ALL, H5S_ALL, H5P_DEFAULT, &a_packed.offsets[0]);
+  }
+  H5Sclose(offsetSpace);
+  H5Dclose(offsetSet);
+
+  return err < 0 ? -1 : 0;
+}
+
+int writeCompressed(HDF5Handle& a_handle, const LevelData<FArrayBox>& a_data, const std::string& a_name,
+                    const HDF5Compression& a_compression)
+{
+  PackedLevelData packed;
+  packLevelData(packed, a_data);
+
+#ifdef CH_MPI
+  bool collective = true;
+#else
+  bool collective = false;
+#endif
+
+  if (writePacked(a_handle.groupID(), a_name, packed, a_compression, collective) < 0)
+  {
+    MayDay::Error("writeCompressed - couldn't write dataset");
+  }
+
+  writeLevelDataAttributes(a_handle, a_name, packed);
+
+  return 0;
+}
+
+#include "NamespaceFooter.H"
+
+#endif
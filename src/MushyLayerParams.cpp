@@ -648,6 +648,8 @@ void MushyLayerParams::getParameters()
   // Now do defaults for the other boundary values
   computeDerivedBCs();
 
+  definePhaseDiagramTable();
+
 
   // Now BC values
 
@@ -1230,9 +1232,14 @@ string MushyLayerParams::getTimescale() const
 // Utility function
 Real MushyLayerParams::computePorosity(Real H, Real C)
 {
-  CH_TIME("MushyLayerParams::computePorosity");
+  Real porosity;
+  if (!m_phaseDiagramTable.isNull()
+      && m_phaseDiagramTable->interpolate(H, C, PhaseDiagramTable::m_porosity, porosity))
+  {
+    return porosity;
+  }
 
-  Real porosity = ::computePorosity(H, C, compositionRatio,  specificHeatRatio,
+  porosity = ::computePorosity(H, C, compositionRatio,  specificHeatRatio,
                                   stefan,  waterDistributionCoeff,  specificHeatRatio,
                                   thetaEutectic,  ThetaEutectic);
 
@@ -1241,38 +1248,15 @@ Real MushyLayerParams::computePorosity(Real H, Real C)
 
 Real MushyLayerParams::compute_dHdT(Real H, Real C)
 {
-  Real H_e, H_s, H_l, dHdT;
-  H_e = std::nan("1");
-  H_s = std::nan("1");
-  H_l = std::nan("1");
-
-
-  ::computeBoundingEnergy(H_e, C, H_s, H_l, H_e, specificHeatRatio, stefan, compositionRatio, waterDistributionCoeff, thetaEutectic, ThetaEutectic);
-
-  if (H <= H_s)
-    {
-      dHdT = 1/specificHeatRatio;
-    }
-    else if (H > H_s && H <= H_e)
-    {
-      dHdT = 0;
-    }
-    else if (H > H_e && H < H_l)
-    {
-      Real porosity = computePorosityMushyLayer( H,  C,  compositionRatio,  specificHeatRatio,
-                                                 stefan,  waterDistributionCoeff);
-//      theta = - (C + compositionRatio*(1-porosity)) / (porosity + waterDistributionCoeff*(1-porosity));
-      Real A = compositionRatio*(specificHeatRatio-1) - stefan;
-      Real B = H + compositionRatio*(1-2*specificHeatRatio) - C*(specificHeatRatio-1);
-      Real Cc = specificHeatRatio*(compositionRatio + C);
+  Real dHdT;
+  if (!m_phaseDiagramTable.isNull()
+      && m_phaseDiagramTable->interpolate(H, C, PhaseDiagramTable::m_dHdT, dHdT))
+  {
+    return dHdT;
+  }
 
-
-      dHdT = pow(porosity,2) * (C+compositionRatio)*(-2*A)/(1 + B/sqrt(pow(B,2) - 4*A*Cc));
-    }
-    else
-    {
-      dHdT = 1;
-    }
+  dHdT = ::compute_dHdT(H, C, compositionRatio, specificHeatRatio, stefan,
+                        waterDistributionCoeff, thetaEutectic, ThetaEutectic);
 
   return dHdT;
 
@@ -1280,15 +1264,91 @@ Real MushyLayerParams::compute_dHdT(Real H, Real C)
 
 Real MushyLayerParams::computeTemperature(Real H, Real C)
 {
-  CH_TIME("MushyLayerParams::computeTemperature");
+  Real temperature;
+  if (!m_phaseDiagramTable.isNull()
+      && m_phaseDiagramTable->interpolate(H, C, PhaseDiagramTable::m_temperature, temperature))
+  {
+    return temperature;
+  }
 
-  Real temperature = ::computeTemperature(H, C, compositionRatio,  specificHeatRatio,
+  temperature = ::computeTemperature(H, C, compositionRatio,  specificHeatRatio,
                                   stefan,  waterDistributionCoeff,  specificHeatRatio,
                                   thetaEutectic,  ThetaEutectic);
 
   return temperature;
 }
 
+void MushyLayerParams::definePhaseDiagramTable()
+{
+  CH_TIME("MushyLayerParams::definePhaseDiagramTable");
+
+  ParmParse ppParams("parameters");
+
+  bool useTable = false;
+  ppParams.query("phaseDiagramTable", useTable);
+
+  if (!useTable)
+  {
+    m_phaseDiagramTable = RefCountedPtr<PhaseDiagramTable>();
+    return;
+  }
+
+  // Default range covers the boundary and initial values, with a margin either side
+  Real Hlo = min(Hinitial, thetaEutectic*specificHeatRatio);
+  Real Hhi = max(Hinitial, stefan + thetaEutectic + ThetaEutectic);
+  Real Clo = min(ThetaInitial, ThetaEutectic);
+  Real Chi = max(ThetaInitial, -compositionRatio);
+  for (int dir = 0; dir < SpaceDim; dir++)
+  {
+    Hlo = min(Hlo, min(bcValEnthalpyLo[dir], bcValEnthalpyHi[dir]));
+    Hhi = max(Hhi, max(bcValEnthalpyLo[dir], bcValEnthalpyHi[dir]));
+    Clo = min(Clo, min(bcValBulkConcentrationLo[dir], bcValBulkConcentrationHi[dir]));
+    Chi = max(Chi, max(bcValBulkConcentrationLo[dir], bcValBulkConcentrationHi[dir]));
+  }
+
+  Real margin = 0.25;
+  ppParams.query("phaseDiagramTableMargin", margin);
+  Real Hmargin = margin*max(Hhi - Hlo, 1.0);
+  Real Cmargin = margin*max(Chi - Clo, 1.0);
+  Hlo -= Hmargin;
+  Hhi += Hmargin;
+  Clo -= Cmargin;
+  Chi += Cmargin;
+
+  if (ppParams.contains("phaseDiagramTableHRange"))
+  {
+    std::vector<Real> temp = std::vector<Real>();
+    ppParams.getarr("phaseDiagramTableHRange", temp, 0, 2);
+    Hlo = temp[0]; Hhi = temp[1];
+  }
+  if (ppParams.contains("phaseDiagramTableCRange"))
+  {
+    std::vector<Real> temp = std::vector<Real>();
+    ppParams.getarr("phaseDiagramTableCRange", temp, 0, 2);
+    Clo = temp[0]; Chi = temp[1];
+  }
+
+  int nH = 512;
+  int nC = 256;
+  ppParams.query("phaseDiagramTableNumH", nH);
+  ppParams.query("phaseDiagramTableNumC", nC);
+
+  Real tolerance = 1e-6;
+  ppParams.query("phaseDiagramTableTolerance", tolerance);
+
+  int method = PhaseDiagramTable::m_bilinear;
+  ppParams.query("phaseDiagramTableMethod", method);
+
+  m_phaseDiagramTable = RefCountedPtr<PhaseDiagramTable>(new PhaseDiagramTable());
+  m_phaseDiagramTable->define(Hlo, Hhi, nH, Clo, Chi, nC, tolerance, method,
+                              compositionRatio, specificHeatRatio, stefan,
+                              waterDistributionCoeff, thetaEutectic, ThetaEutectic);
+
+  pout() << "Phase diagram table: H in [" << Hlo << ", " << Hhi << "], C in [" << Clo << ", " << Chi
+      << "], " << nH << "x" << nC << " points, exact calculation in "
+      << 100*m_phaseDiagramTable->exactFraction() << "% of cells" << endl;
+}
+
 void MushyLayerParams::computeDiagnosticVars(Real H, Real C, Real T, Real porosity, Real Cl, Real Cs)
 {
   Real H_s, H_l, H_e;
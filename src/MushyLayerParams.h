@@ -16,6 +16,8 @@
 #include "RealVect.H"
 #include "CH_HDF5.H"
 #include "BCInfo.h"
+#include "RefCountedPtr.H"
+#include "PhaseDiagramTable.H"
 
 // Comment below ensures that enums doxygen generates documentation for enums declared in this file
 /*!
@@ -781,6 +783,17 @@ public:
 
 	/// Compute boundary conditions for fields which can be found from the enthalpy and salinity via the phase diagram
 	void computeDerivedBCs ();
+
+	/// Optional lookup table for the phase diagram
+	/**
+	 * Null unless parameters.phaseDiagramTable = true. Shared between copies of this object,
+	 * as the table is only built once (in getParameters()). The reference count isn't
+	 * thread safe, so don't copy this object inside threaded box loops.
+	 */
+	RefCountedPtr<PhaseDiagramTable> m_phaseDiagramTable;
+
+	/// Build the phase diagram lookup table, if requested in the inputs file
+	void definePhaseDiagramTable();
 };
 
 #endif /* SRC_MUSHYLAYERPARAMS_H_ */
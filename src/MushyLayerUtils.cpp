@@ -26,6 +26,7 @@
 #include <stdexcept>
 #include <string>
 #include <array>
+#include <algorithm>
 
 
 #include "NamespaceHeader.H"
@@ -547,6 +548,23 @@ void getVarNames(Vector<string>& varNames,
   }
 }
 
+int findVarName(const string& a_name, const Vector<string>& a_varNames)
+{
+  // Names can't contain spaces in inputs files, so allow underscores instead
+  string name = a_name;
+  std::replace(name.begin(), name.end(), '_', ' ');
+
+  for (int var = 0; var < a_varNames.size(); var++)
+  {
+    if (a_varNames[var] == name || a_varNames[var] == a_name)
+    {
+      return var;
+    }
+  }
+
+  return -1;
+}
+
 void printRepoVersion()
 {
   // Get current code revision and write it out so we
@@ -705,6 +723,42 @@ Real stokesDarcyInit(Real x, Real y, int dir, MushyLayerParams params)
 
 }
 
+void boxShell(Vector<Box>& a_shell, const Box& a_outer, const Box& a_inner)
+{
+  a_shell.resize(0);
+
+  if (a_inner.isEmpty())
+  {
+    a_shell.push_back(a_outer);
+    return;
+  }
+
+  CH_assert(a_outer.contains(a_inner));
+
+  // Peel off the low and high sides in each direction in turn
+  Box remaining = a_outer;
+  for (int idir = 0; idir < SpaceDim; idir++)
+  {
+    Box loSide = remaining;
+    loSide.setBig(idir, a_inner.smallEnd(idir) - 1);
+
+    Box hiSide = remaining;
+    hiSide.setSmall(idir, a_inner.bigEnd(idir) + 1);
+
+    if (!loSide.isEmpty())
+    {
+      a_shell.push_back(loSide);
+    }
+    if (!hiSide.isEmpty())
+    {
+      a_shell.push_back(hiSide);
+    }
+
+    remaining.setSmall(idir, a_inner.smallEnd(idir));
+    remaining.setBig(idir, a_inner.bigEnd(idir));
+  }
+}
+
 
 #include "NamespaceFooter.H"
 
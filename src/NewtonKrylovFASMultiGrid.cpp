@@ -0,0 +1,388 @@
+#ifdef CH_LANG_CC
+/*
+ *      _______              __
+ *     / ___/ /  ___  __ _  / /  ___
+ *    / /__/ _ \/ _ \/  V \/ _ \/ _ \
+ *    \___/_//_/\___/_/_/_/_.__/\___/
+ *    Please refer to Copyright.txt, in Chombo's root directory.
+ */
+#endif
+
+#include "NewtonKrylovFASMultiGrid.H"
+#include "CH_Timer.H"
+#include "parstream.H"
+
+#include <cmath>
+
+#include "NamespaceHeader.H"
+
+NewtonKrylovFASMultiGrid::NewtonKrylovFASMultiGrid() : AMRFASMultiGrid<LevelData<FArrayBox> >()
+{
+  m_newtonMaxIter = 10;
+  m_krylovMaxIter = 20;
+  m_etaMax = 0.1;
+  m_maxLineSearch = 4;
+  m_newtonIterations = 0;
+  m_krylovIterations = 0;
+  m_numVCycles = 0;
+  m_finalResidual = 0;
+  m_didNewtonSolve = false;
+}
+
+NewtonKrylovFASMultiGrid::~NewtonKrylovFASMultiGrid()
+{
+}
+
+void NewtonKrylovFASMultiGrid::resetStatistics()
+{
+  m_numVCycles = 0;
+  m_finalResidual = 0;
+  m_didNewtonSolve = false;
+}
+
+void NewtonKrylovFASMultiGrid::solve(Vector<LevelData<FArrayBox>* >&       a_phi,
+                                     const Vector<LevelData<FArrayBox>* >& a_rhs,
+                                     int                                   l_max,
+                                     int                                   l_base,
+                                     bool                                  a_zeroPhi,
+                                     bool                                  a_forceHomogeneous)
+{
+  AMRNonLinearMultiCompOp* op = NULL;
+  if (l_max == l_base && !a_forceHomogeneous)
+  {
+    op = dynamic_cast<AMRNonLinearMultiCompOp*>(getAMROperators()[l_max]);
+  }
+
+  if (op == NULL)
+  {
+    AMRFASMultiGrid<LevelData<FArrayBox> >::solve(a_phi, a_rhs, l_max, l_base, a_zeroPhi, a_forceHomogeneous);
+    return;
+  }
+
+  CH_TIME("NewtonKrylovFASMultiGrid::solve");
+
+  int level = l_max;
+  LevelData<FArrayBox>& phi = *a_phi[level];
+  const LevelData<FArrayBox>& rhs = *a_rhs[level];
+  const LevelData<FArrayBox>* phiCoarse = (level > 0) ? a_phi[level-1] : NULL;
+
+  if (a_zeroPhi)
+  {
+    op->setToZero(phi);
+  }
+
+  LevelData<FArrayBox> resid, delta, trial, trialResid, jacobian;
+  op->create(resid, rhs);
+  op->create(trialResid, rhs);
+  op->create(delta, phi);
+  op->create(trial, phi);
+  jacobian.define(phi.disjointBoxLayout(), 4, phi.ghostVect());
+
+  m_newtonIterations = 0;
+  m_krylovIterations = 0;
+  m_didNewtonSolve = true;
+
+  Real initialNorm = -1, norm = 0, norm2 = 0, oldNorm2 = 0;
+  Real eta = m_etaMax;
+  bool converged = false, stalled = false;
+
+  while (true)
+  {
+    // This also fills phi's ghost cells, which the Jacobian needs
+    nonlinearResidual(resid, phi, phiCoarse, rhs, op);
+    norm = op->norm(resid, 0);
+    oldNorm2 = norm2;
+    norm2 = sqrt(op->dotProduct(resid, resid));
+
+    if (initialNorm < 0)
+    {
+      initialNorm = norm;
+    }
+
+    if (m_verbosity >= 3)
+    {
+      pout() << "    NewtonKrylovFASMultiGrid - Newton iteration " << m_newtonIterations
+          << ", residual = " << norm << endl;
+    }
+
+    converged = (norm <= m_eps*initialNorm || norm <= m_normThresh);
+    if (converged || m_newtonIterations >= m_newtonMaxIter)
+    {
+      break;
+    }
+
+    // Eisenstat-Walker forcing term (choice 2), without solving more accurately than we need to converge
+    if (m_newtonIterations > 0)
+    {
+      Real etaOld = eta;
+      eta = 0.9*pow(norm2/oldNorm2, 2);
+      if (0.9*etaOld*etaOld > 0.1)
+      {
+        eta = max(eta, 0.9*etaOld*etaOld);
+      }
+      eta = min(eta, m_etaMax);
+    }
+    eta = max(eta, 0.5*m_eps*initialNorm/norm);
+
+    op->computePhaseDiagramJacobian(jacobian, phi);
+
+    op->setToZero(delta);
+    m_krylovIterations += fgmres(delta, resid, eta, jacobian, a_phi, a_rhs, level, op);
+    m_newtonIterations++;
+
+    // Backtrack until the residual decreases
+    Real lambda = 1.0;
+    bool accepted = false;
+    for (int i = 0; i <= m_maxLineSearch && !accepted; i++)
+    {
+      op->assign(trial, phi);
+      op->incr(trial, delta, lambda);
+      nonlinearResidual(trialResid, trial, phiCoarse, rhs, op);
+      Real trialNorm2 = sqrt(op->dotProduct(trialResid, trialResid));
+
+      if (trialNorm2 <= (1 - 1e-4*lambda)*norm2)
+      {
+        accepted = true;
+      }
+      else
+      {
+        lambda *= 0.5;
+      }
+    }
+
+    if (!accepted)
+    {
+      stalled = true;
+      break;
+    }
+
+    op->assign(phi, trial);
+  }
+
+  if (m_verbosity >= 2)
+  {
+    pout() << "    NewtonKrylovFASMultiGrid - residual " << initialNorm << " -> " << norm << " in "
+        << m_newtonIterations << " Newton and " << m_krylovIterations << " GMRES iterations" << endl;
+  }
+
+  if (!converged)
+  {
+    if (m_verbosity >= 1)
+    {
+      pout() << "    NewtonKrylovFASMultiGrid - Newton " << (stalled ? "stalled" : "didn't converge")
+          << ", continuing with FAS multigrid" << endl;
+    }
+
+    // One V-cycle at a time, so we know how many were needed and where the residual ended up
+    int iterMax = m_iterMax;
+    int verbosity = m_verbosity;
+    m_iterMax = 1;
+    m_verbosity = 0;
+
+    m_exitStatus = 4;
+    for (int iter = 0; iter < iterMax; iter++)
+    {
+      Real oldNorm = norm;
+      AMRFASMultiGrid<LevelData<FArrayBox> >::solve(a_phi, a_rhs, l_max, l_base, false, a_forceHomogeneous);
+      m_numVCycles++;
+
+      nonlinearResidual(resid, phi, phiCoarse, rhs, op);
+      norm = op->norm(resid, 0);
+
+      if (norm <= m_eps*initialNorm || norm <= m_normThresh)
+      {
+        m_exitStatus = 1;
+        break;
+      }
+      if (norm > (1.0 - m_hang)*oldNorm)
+      {
+        m_exitStatus = 2;
+        break;
+      }
+    }
+
+    m_iterMax = iterMax;
+    m_verbosity = verbosity;
+
+    if (m_verbosity >= 2)
+    {
+      pout() << "    NewtonKrylovFASMultiGrid - residual " << norm << " after FAS multigrid, exit status "
+          << m_exitStatus << endl;
+    }
+  }
+  else
+  {
+    // As for AMRMultiGrid: converged
+    m_exitStatus = 1;
+  }
+
+  m_finalResidual = norm;
+}
+
+void NewtonKrylovFASMultiGrid::nonlinearResidual(LevelData<FArrayBox>&       a_resid,
+                                                 LevelData<FArrayBox>&       a_phi,
+                                                 const LevelData<FArrayBox>* a_phiCoarse,
+                                                 const LevelData<FArrayBox>& a_rhs,
+                                                 AMRNonLinearMultiCompOp*    a_op)
+{
+  if (a_phiCoarse != NULL)
+  {
+    a_op->AMRResidualNF(a_resid, a_phi, *a_phiCoarse, a_rhs, false);
+  }
+  else
+  {
+    a_op->residual(a_resid, a_phi, a_rhs, false);
+  }
+}
+
+int NewtonKrylovFASMultiGrid::fgmres(LevelData<FArrayBox>&                 a_delta,
+                                     const LevelData<FArrayBox>&           a_resid,
+                                     Real                                  a_eta,
+                                     const LevelData<FArrayBox>&           a_jacobian,
+                                     Vector<LevelData<FArrayBox>* >&       a_phi,
+                                     const Vector<LevelData<FArrayBox>* >& a_rhs,
+                                     int                                   a_level,
+                                     AMRNonLinearMultiCompOp*              a_op)
+{
+  CH_TIME("NewtonKrylovFASMultiGrid::fgmres");
+
+  const int m = m_krylovMaxIter;
+
+  Real beta = sqrt(a_op->dotProduct(a_resid, a_resid));
+  if (beta == 0.0)
+  {
+    return 0;
+  }
+  Real target = a_eta*beta;
+
+  // Krylov basis, and the preconditioned basis vectors (which differ from iteration to iteration)
+  Vector<RefCountedPtr<LevelData<FArrayBox> > > V(m+1), Z(m);
+  V[0] = RefCountedPtr<LevelData<FArrayBox> >(new LevelData<FArrayBox>);
+  a_op->create(*V[0], a_resid);
+  a_op->assign(*V[0], a_resid);
+  a_op->scale(*V[0], 1.0/beta);
+
+  // Hessenberg matrix (column by column), reduced to upper triangular by Givens rotations as we go
+  Vector<Vector<Real> > H(m, Vector<Real>(m+1, 0.0));
+  Vector<Real> cs(m, 0.0), sn(m, 0.0), g(m+1, 0.0);
+  g[0] = beta;
+
+  int k = 0;
+  for (int j = 0; j < m; j++)
+  {
+    Z[j] = RefCountedPtr<LevelData<FArrayBox> >(new LevelData<FArrayBox>);
+    a_op->create(*Z[j], a_delta);
+    precondition(*Z[j], *V[j], beta, a_resid, a_phi, a_rhs, a_level, a_op);
+
+    V[j+1] = RefCountedPtr<LevelData<FArrayBox> >(new LevelData<FArrayBox>);
+    LevelData<FArrayBox>& w = *V[j+1];
+    a_op->create(w, a_resid);
+    a_op->applyJacobian(w, *Z[j], a_jacobian);
+
+    // Modified Gram-Schmidt
+    for (int i = 0; i <= j; i++)
+    {
+      H[j][i] = a_op->dotProduct(w, *V[i]);
+      a_op->incr(w, *V[i], -H[j][i]);
+    }
+    H[j][j+1] = sqrt(a_op->dotProduct(w, w));
+    bool breakdown = (H[j][j+1] == 0.0);
+    if (!breakdown)
+    {
+      a_op->scale(w, 1.0/H[j][j+1]);
+    }
+
+    for (int i = 0; i < j; i++)
+    {
+      Real temp = cs[i]*H[j][i] + sn[i]*H[j][i+1];
+      H[j][i+1] = -sn[i]*H[j][i] + cs[i]*H[j][i+1];
+      H[j][i] = temp;
+    }
+
+    Real denominator = sqrt(H[j][j]*H[j][j] + H[j][j+1]*H[j][j+1]);
+    cs[j] = (denominator > 0) ? H[j][j]/denominator : 1.0;
+    sn[j] = (denominator > 0) ? H[j][j+1]/denominator : 0.0;
+    H[j][j] = denominator;
+    H[j][j+1] = 0.0;
+    g[j+1] = -sn[j]*g[j];
+    g[j] = cs[j]*g[j];
+
+    k = j+1;
+
+    if (m_verbosity >= 4)
+    {
+      pout() << "      NewtonKrylovFASMultiGrid - GMRES iteration " << k << ", residual = " << std::abs(g[j+1]) << endl;
+    }
+
+    if (std::abs(g[j+1]) <= target || breakdown)
+    {
+      break;
+    }
+  }
+
+  // Least squares solution in the Krylov space, then the step is a combination of the preconditioned vectors
+  Vector<Real> y(k, 0.0);
+  for (int i = k-1; i >= 0; i--)
+  {
+    Real sum = g[i];
+    for (int l = i+1; l < k; l++)
+    {
+      sum -= H[l][i]*y[l];
+    }
+    y[i] = (H[i][i] != 0.0) ? sum/H[i][i] : 0.0;
+  }
+
+  for (int i = 0; i < k; i++)
+  {
+    a_op->incr(a_delta, *Z[i], y[i]);
+  }
+
+  return k;
+}
+
+void NewtonKrylovFASMultiGrid::precondition(LevelData<FArrayBox>&                 a_z,
+                                            const LevelData<FArrayBox>&           a_v,
+                                            Real                                  a_scale,
+                                            const LevelData<FArrayBox>&           a_resid,
+                                            Vector<LevelData<FArrayBox>* >&       a_phi,
+                                            const Vector<LevelData<FArrayBox>* >& a_rhs,
+                                            int                                   a_level,
+                                            AMRNonLinearMultiCompOp*              a_op)
+{
+  CH_TIME("NewtonKrylovFASMultiGrid::precondition");
+
+  const LevelData<FArrayBox>& phi = *a_phi[a_level];
+
+  // L(phi) + scale*v = rhs - resid + scale*v
+  LevelData<FArrayBox> rhs, perturbedPhi;
+  a_op->create(rhs, *a_rhs[a_level]);
+  a_op->assign(rhs, *a_rhs[a_level]);
+  a_op->incr(rhs, a_resid, -1.0);
+  a_op->incr(rhs, a_v, a_scale);
+
+  a_op->create(perturbedPhi, phi);
+  a_op->assign(perturbedPhi, phi);
+
+  Vector<LevelData<FArrayBox>* > phiVect(a_phi);
+  Vector<LevelData<FArrayBox>* > rhsVect(a_rhs);
+  phiVect[a_level] = &perturbedPhi;
+  rhsVect[a_level] = &rhs;
+
+  // Just one V-cycle, quietly
+  int iterMax = m_iterMax;
+  int verbosity = m_verbosity;
+  m_iterMax = 1;
+  m_verbosity = 0;
+
+  AMRFASMultiGrid<LevelData<FArrayBox> >::solve(phiVect, rhsVect, a_level, a_level, false, false);
+  m_numVCycles++;
+
+  m_iterMax = iterMax;
+  m_verbosity = verbosity;
+
+  a_op->assign(a_z, perturbedPhi);
+  a_op->incr(a_z, phi, -1.0);
+  a_op->scale(a_z, 1.0/a_scale);
+}
+
+#include "NamespaceFooter.H"
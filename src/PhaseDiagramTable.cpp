@@ -0,0 +1,329 @@
+#ifdef CH_LANG_CC
+/*
+ *      _______              __
+ *     / ___/ /  ___  __ _  / /  ___
+ *    / /__/ _ \/ _ \/  V \/ _ \/ _ \
+ *    \___/_//_/\___/_/_/_/_.__/\___/
+ *    Please refer to Copyright.txt, in Chombo's root directory.
+ */
+#endif
+
+#include "PhaseDiagramTable.H"
+#include "phaseDiagram.H"
+#include "CH_Timer.H"
+#include "MayDay.H"
+
+#include <cmath>
+
+#include "NamespaceHeader.H"
+
+PhaseDiagramTable::PhaseDiagramTable()
+{
+  m_defined = false;
+  m_nH = 0;
+  m_nC = 0;
+  m_method = m_bilinear;
+  m_Hmin = 0;
+  m_dH = 0;
+  m_Cmin = 0;
+  m_dC = 0;
+  m_tolerance = 0;
+
+  m_compositionRatio = 0;
+  m_specificHeatRatio = 0;
+  m_stefan = 0;
+  m_waterDistributionCoeff = 0;
+  m_thetaEutectic = 0;
+  m_ThetaEutectic = 0;
+}
+
+PhaseDiagramTable::~PhaseDiagramTable()
+{
+}
+
+void PhaseDiagramTable::define(Real a_Hmin, Real a_Hmax, int a_nH,
+                               Real a_Cmin, Real a_Cmax, int a_nC,
+                               Real a_tolerance, int a_method,
+                               Real a_compositionRatio, Real a_specificHeatRatio,
+                               Real a_stefan, Real a_waterDistributionCoeff,
+                               Real a_thetaEutectic, Real a_ThetaEutectic)
+{
+  CH_TIME("PhaseDiagramTable::define");
+
+  if (a_nH < 2 || a_nC < 2)
+  {
+    MayDay::Error("PhaseDiagramTable::define - need at least 2 points in each direction");
+  }
+  if (a_Hmax <= a_Hmin || a_Cmax <= a_Cmin)
+  {
+    MayDay::Error("PhaseDiagramTable::define - empty range of H or C");
+  }
+
+  m_nH = a_nH;
+  m_nC = a_nC;
+  m_Hmin = a_Hmin;
+  m_Cmin = a_Cmin;
+  m_dH = (a_Hmax - a_Hmin)/(m_nH - 1);
+  m_dC = (a_Cmax - a_Cmin)/(m_nC - 1);
+  m_tolerance = a_tolerance;
+  m_method = a_method;
+
+  m_compositionRatio = a_compositionRatio;
+  m_specificHeatRatio = a_specificHeatRatio;
+  m_stefan = a_stefan;
+  m_waterDistributionCoeff = a_waterDistributionCoeff;
+  m_thetaEutectic = a_thetaEutectic;
+  m_ThetaEutectic = a_ThetaEutectic;
+
+  // Tabulate the exact values at the nodes, and which phase region each node is in
+  m_table.resize(m_nH*m_nC*m_numVars);
+  Vector<int> nodeRegions(m_nH*m_nC);
+  Real values[m_numVars];
+  for (int iC = 0; iC < m_nC; iC++)
+  {
+    Real C = m_Cmin + iC*m_dC;
+    for (int iH = 0; iH < m_nH; iH++)
+    {
+      Real H = m_Hmin + iH*m_dH;
+      exactValues(H, C, values);
+      for (int var = 0; var < m_numVars; var++)
+      {
+        m_table[index(iH, iC, var)] = values[var];
+      }
+      nodeRegions[iH + m_nH*iC] = phaseRegion(H, C);
+    }
+  }
+
+  if (m_method == m_spline)
+  {
+    std::vector<Real> Hpoints(m_nH), Vpoints(m_nH);
+    for (int iH = 0; iH < m_nH; iH++)
+    {
+      Hpoints[iH] = m_Hmin + iH*m_dH;
+    }
+
+    m_splines.resize(m_nC*m_numVars);
+    for (int var = 0; var < m_numVars; var++)
+    {
+      for (int iC = 0; iC < m_nC; iC++)
+      {
+        for (int iH = 0; iH < m_nH; iH++)
+        {
+          Vpoints[iH] = m_table[index(iH, iC, var)];
+        }
+        m_splines[iC + m_nC*var].set_points(Hpoints, Vpoints);
+      }
+    }
+  }
+  else
+  {
+    m_splines.resize(0);
+  }
+
+  // Flag table cells which a phase boundary crosses, or where interpolation doesn't meet the tolerance.
+  // A kink in a cell can miss its centre, so compare the phase regions at the corners and the centre.
+  // Away from the kinks the phase diagram is smooth, and interpolation errors are largest at the centre.
+  m_exactCells.resize((m_nH-1)*(m_nC-1));
+  for (int iC = 0; iC < m_nC - 1; iC++)
+  {
+    for (int iH = 0; iH < m_nH - 1; iH++)
+    {
+      Real H = m_Hmin + (iH + 0.5)*m_dH;
+      Real C = m_Cmin + (iC + 0.5)*m_dC;
+
+      int region = phaseRegion(H, C);
+      int exact = (nodeRegions[iH + m_nH*iC] != region
+                   || nodeRegions[iH + 1 + m_nH*iC] != region
+                   || nodeRegions[iH + m_nH*(iC + 1)] != region
+                   || nodeRegions[iH + 1 + m_nH*(iC + 1)] != region) ? 1 : 0;
+
+      if (exact)
+      {
+        m_exactCells[iH + (m_nH-1)*iC] = exact;
+        continue;
+      }
+
+      exactValues(H, C, values);
+
+      // The Fortran kernels always interpolate bilinearly, so check that as well as m_method
+      for (int var = 0; var < m_numVars; var++)
+      {
+        Real bilinear = interpolateCell(iH, iC, 0.5, 0.5, var, m_bilinear);
+        Real interpolated = interpolateCell(iH, iC, 0.5, 0.5, var, m_method);
+        if (std::isnan(values[var]) || std::isnan(bilinear) || std::isnan(interpolated)
+            || std::abs(bilinear - values[var]) > m_tolerance
+            || std::abs(interpolated - values[var]) > m_tolerance)
+        {
+          exact = 1;
+        }
+      }
+
+      m_exactCells[iH + (m_nH-1)*iC] = exact;
+    }
+  }
+
+  m_defined = true;
+}
+
+bool PhaseDiagramTable::isDefined() const
+{
+  return m_defined;
+}
+
+Real PhaseDiagramTable::exactFraction() const
+{
+  if (m_exactCells.size() == 0)
+  {
+    return 1.0;
+  }
+
+  int numExact = 0;
+  for (int i = 0; i < m_exactCells.size(); i++)
+  {
+    numExact += m_exactCells[i];
+  }
+  return Real(numExact)/Real(m_exactCells.size());
+}
+
+int PhaseDiagramTable::phaseRegion(Real a_H, Real a_C) const
+{
+  Real H_s, H_l, H_e;
+
+  ::computeBoundingEnergy(a_H, a_C, H_s, H_l, H_e, m_specificHeatRatio, m_stefan,
+                          m_compositionRatio, m_waterDistributionCoeff,
+                          m_thetaEutectic, m_ThetaEutectic);
+
+  // Same tests as computeEnthalpyVars()
+  if (a_H <= H_s)
+  {
+    return 0;
+  }
+  else if (a_H <= H_e)
+  {
+    return 1;
+  }
+  else if (a_H < H_l)
+  {
+    return 2;
+  }
+
+  return 3;
+}
+
+void PhaseDiagramTable::exactValues(Real a_H, Real a_C, Real* a_values) const
+{
+  Real H_s, H_l, H_e, porosity, theta, C_l, C_s;
+
+  ::computeBoundingEnergy(a_H, a_C, H_s, H_l, H_e, m_specificHeatRatio, m_stefan,
+                          m_compositionRatio, m_waterDistributionCoeff,
+                          m_thetaEutectic, m_ThetaEutectic);
+
+  ::computeEnthalpyVars(a_H, a_C, porosity, theta, C_l, C_s, H_s, H_l, H_e,
+                        m_specificHeatRatio, m_stefan, m_compositionRatio,
+                        m_waterDistributionCoeff, m_thetaEutectic, m_ThetaEutectic);
+
+  // The Fortran kernels set the liquid concentration to the eutectic value in the solid
+  // (rather than zero), which is what we want when computing fluxes across the solid
+  if (a_H <= H_s)
+  {
+    C_l = m_ThetaEutectic;
+  }
+
+  a_values[m_temperature] = theta;
+  a_values[m_liquidConcentration] = C_l;
+  a_values[m_porosity] = porosity;
+  a_values[m_dHdT] = ::compute_dHdT(a_H, a_C, m_compositionRatio, m_specificHeatRatio,
+                                    m_stefan, m_waterDistributionCoeff,
+                                    m_thetaEutectic, m_ThetaEutectic);
+}
+
+bool PhaseDiagramTable::findCell(Real a_H, Real a_C, int& a_iH, int& a_iC,
+                                 Real& a_fH, Real& a_fC) const
+{
+  Real xH = (a_H - m_Hmin)/m_dH;
+  Real xC = (a_C - m_Cmin)/m_dC;
+
+  // Also catches NaNs
+  if (!(xH >= 0 && xH <= m_nH - 1 && xC >= 0 && xC <= m_nC - 1))
+  {
+    return false;
+  }
+
+  a_iH = std::min(int(xH), m_nH - 2);
+  a_iC = std::min(int(xC), m_nC - 2);
+  a_fH = xH - a_iH;
+  a_fC = xC - a_iC;
+
+  return true;
+}
+
+Real PhaseDiagramTable::interpolateCell(int a_iH, int a_iC, Real a_fH, Real a_fC,
+                                        int a_var, int a_method) const
+{
+  Real lower, upper;
+
+  if (a_method == m_spline)
+  {
+    Real H = m_Hmin + (a_iH + a_fH)*m_dH;
+    lower = m_splines[a_iC + m_nC*a_var](H);
+    upper = m_splines[a_iC + 1 + m_nC*a_var](H);
+  }
+  else
+  {
+    lower = (1 - a_fH)*m_table[index(a_iH, a_iC, a_var)]
+          + a_fH*m_table[index(a_iH + 1, a_iC, a_var)];
+    upper = (1 - a_fH)*m_table[index(a_iH, a_iC + 1, a_var)]
+          + a_fH*m_table[index(a_iH + 1, a_iC + 1, a_var)];
+  }
+
+  return (1 - a_fC)*lower + a_fC*upper;
+}
+
+bool PhaseDiagramTable::interpolate(Real a_H, Real a_C, int a_var, Real& a_value) const
+{
+  int iH, iC;
+  Real fH, fC;
+
+  if (!m_defined || !findCell(a_H, a_C, iH, iC, fH, fC))
+  {
+    return false;
+  }
+
+  if (m_exactCells[iH + (m_nH-1)*iC])
+  {
+    return false;
+  }
+
+  a_value = interpolateCell(iH, iC, fH, fC, a_var, m_method);
+
+  return true;
+}
+
+bool PhaseDiagramTable::bilinearDerivatives(Real a_H, Real a_C, int a_var,
+                                            Real& a_dVardH, Real& a_dVardC) const
+{
+  int iH, iC;
+  Real fH, fC;
+
+  if (!m_defined || !findCell(a_H, a_C, iH, iC, fH, fC))
+  {
+    return false;
+  }
+
+  if (m_exactCells[iH + (m_nH-1)*iC])
+  {
+    return false;
+  }
+
+  Real v00 = m_table[index(iH, iC, a_var)];
+  Real v10 = m_table[index(iH + 1, iC, a_var)];
+  Real v01 = m_table[index(iH, iC + 1, a_var)];
+  Real v11 = m_table[index(iH + 1, iC + 1, a_var)];
+
+  a_dVardH = ((1 - fC)*(v10 - v00) + fC*(v11 - v01))/m_dH;
+  a_dVardC = ((1 - fH)*(v01 - v00) + fH*(v11 - v10))/m_dC;
+
+  return true;
+}
+
+#include "NamespaceFooter.H"
@@ -0,0 +1,113 @@
+#ifdef CH_LANG_CC
+/*
+ *      _______              __
+ *     / ___/ /  ___  __ _  / /  ___
+ *    / /__/ _ \/ _ \/  V \/ _ \/ _ \
+ *    \___/_//_/\___/_/_/_/_.__/\___/
+ *    Please refer to Copyright.txt, in Chombo's root directory.
+ */
+#endif
+
+#include "TimestepController.H"
+#include "MayDay.H"
+
+#include <cmath>
+#include <algorithm>
+
+#include "NamespaceHeader.H"
+
+TimestepController::TimestepController()
+{
+  m_defined = false;
+  m_targetIterations = 10;
+  m_kI = 0.3;
+  m_kP = 0.2;
+  m_minFactor = 0.5;
+  m_maxFactor = 1.1;
+  m_prevError = 1.0;
+  m_maxIterations = 0;
+  m_solveFailed = false;
+  m_newStep = false;
+  m_lastFactor = 1.0;
+}
+
+TimestepController::~TimestepController()
+{
+}
+
+void TimestepController::define(Real a_targetIterations, Real a_kI, Real a_kP, Real a_minFactor, Real a_maxFactor)
+{
+  if (a_targetIterations <= 0 || a_minFactor <= 0 || a_minFactor > 1 || a_maxFactor < 1)
+  {
+    MayDay::Error("TimestepController::define - invalid parameters");
+  }
+
+  m_targetIterations = a_targetIterations;
+  m_kI = a_kI;
+  m_kP = a_kP;
+  m_minFactor = a_minFactor;
+  m_maxFactor = a_maxFactor;
+
+  m_prevError = 1.0;
+  m_lastFactor = 1.0;
+
+  m_defined = true;
+}
+
+bool TimestepController::isDefined() const
+{
+  return m_defined;
+}
+
+void TimestepController::startStep()
+{
+  m_maxIterations = 0;
+  m_solveFailed = false;
+  m_newStep = true;
+}
+
+void TimestepController::addSolve(int a_numIterations, bool a_converged)
+{
+  m_maxIterations = std::max(m_maxIterations, a_numIterations);
+  m_solveFailed = m_solveFailed || !a_converged;
+}
+
+void TimestepController::rejectStep()
+{
+  // Act as if the rejected step had twice the target error, so growth resumes gradually
+  m_prevError = std::max(m_prevError, 2.0);
+  m_lastFactor = std::min(m_lastFactor, 1.0);
+  m_newStep = false;
+}
+
+Real TimestepController::dtFactor(Real a_cflRatio)
+{
+  if (!m_newStep)
+  {
+    return m_lastFactor;
+  }
+  m_newStep = false;
+
+  Real error = std::max(a_cflRatio, 1e-10);
+
+  if (m_maxIterations > 0)
+  {
+    error = std::max(error, m_maxIterations/m_targetIterations);
+  }
+
+  // A solve which didn't converge was at least twice as hard as we'd like, even if we don't know how many iterations it took
+  if (m_solveFailed)
+  {
+    error = std::max(error, 2.0);
+  }
+
+  Real factor = pow(1.0/error, m_kI) * pow(m_prevError/error, m_kP);
+  factor = std::max(m_minFactor, std::min(m_maxFactor, factor));
+
+  m_prevError = error;
+  m_lastFactor = factor;
+
+  return factor;
+}
+
+#include "NamespaceFooter.H"
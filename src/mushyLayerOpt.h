@@ -334,6 +334,47 @@ struct MushyLayerOptions {
   /// Prefix for plot files
   string plotfile_prefix;
 
+  /// Write plot and checkpoint data on a background thread whilst the solver continues
+  /**
+   * Data is snapshotted when AMR asks for it, then written once the next timestep starts. Needs a
+   * thread-safe HDF5 library and a single MPI rank, otherwise we fall back to synchronous output.
+   */
+  bool asyncOutput;
+
+  /// Scalar fields to write to plot files (spaces in names replaced by underscores). Empty for the defaults.
+  Vector<string> plotScalarVars;
+
+  /// How often (in timesteps) to write each of plotScalarVars. Empty to write them in every plot file.
+  Vector<int> plotScalarIntervals;
+
+  /// Vector fields to write to plot files (spaces in names replaced by underscores). Empty for the defaults.
+  Vector<string> plotVectorVars;
+
+  /// How often (in timesteps) to write each of plotVectorVars. Empty to write them in every plot file.
+  Vector<int> plotVectorIntervals;
+
+  /// Write each plot file field as its own dataset, directly from the level data
+  /**
+   * Avoids building an interleaved copy of every field. The layout is the same as checkpoint files,
+   * which plotting/PltFile.py and the patched VisIt reader in VisitPatch/ can read.
+   */
+  bool plotSeparateFields;
+
+  /// Lossless compression for plot file datasets (an HDF5Compression::Filters value)
+  int plotCompression;
+
+  /// Compression level for plotCompression
+  int plotCompressionLevel;
+
+  /// Decimal digits to keep when compressing plot files with loss, or -1 to compress without loss
+  int plotLossyDigits;
+
+  /// Plot file fields to store in single precision (spaces in names replaced by underscores), or "all"
+  /**
+   * With interleaved plot files, the data is only stored in single precision if every field in it is listed.
+   */
+  Vector<string> plotSinglePrecisionVars;
+
   /// Turn on to only produce a minimal ammount of output
   bool minimalOutput;
 
@@ -370,6 +411,21 @@ struct MushyLayerOptions {
   /// Maximum allowed fractional increase in dt from one timestep to the next
   Real max_dt_growth;
 
+  /// Choose dt with a PI controller driven by the multigrid iteration counts and CFL number (see TimestepController)
+  bool adaptiveDt;
+
+  /// Number of multigrid iterations per implicit solve which the adaptive dt controller aims for
+  Real adaptiveDtTargetIterations;
+
+  /// Integral gain for the adaptive dt controller
+  Real adaptiveDtKI;
+
+  /// Proportional gain for the adaptive dt controller
+  Real adaptiveDtKP;
+
+  /// Smallest factor the adaptive dt controller may reduce dt by in one step
+  Real adaptiveDtMinFactor;
+
   /// Multiply the dt computed during initialisation procedures by this factor before using it
   /**
    * Useful for using a smaller dt initially for stability
@@ -562,6 +618,18 @@ struct MushyLayerOptions {
   /// Number of cells to add around tagged cells before computing new meshes
   int tagBufferSize;
 
+  /// Load balance boxes by their estimated cost, from the number of mushy, liquid and solid cells, rather than their size
+  bool loadBalanceCostModel;
+
+  /// Initial cost of a mushy cell relative to a liquid cell, for load balancing
+  Real loadBalanceMushyCost;
+
+  /// Initial cost of a solid cell (porosity < solidPorosity) relative to a liquid cell, for load balancing
+  Real loadBalanceSolidCost;
+
+  /// Refit the relative costs of cells at each regrid, from how long the enthalpy-bulk concentration smoother takes on each box
+  bool loadBalanceCalibrate;
+
   /// Refinement threshold
   Real refineThresh;
 
@@ -827,6 +895,9 @@ struct MushyLayerOptions {
   /// Max number of multigrid iterations
   int VelMGMaxIter;
 
+  /// How to do relaxation in the Darcy-Brinkman solves, same options as HCMultigridRelaxMode
+  int velMGRelaxMode;
+
   /// Multigrid for the coupled enthalpy-bulk concentration solve: number of smooths on each up sweep
   int HCMultigridNumSmoothUp;
 
@@ -856,17 +927,43 @@ struct MushyLayerOptions {
 
   /// How to do relaxation
   /**
-   * See AMRPoissonOp::relax in Chombo for the various options.
-   * In particular, 1 = Gauss-Seidel Red-Black, 4 = Jacobi
+   * Numbered as for AMRPoissonOp::relax in Chombo: 1 = Gauss-Seidel Red-Black, 2 = GSRB which smooths
+   * box interiors while the ghost cell exchange is in flight, 3 = GSRB with one exchange per sweep,
+   * 4 = Jacobi, 5 = multicolour (the same as 2 for our stencils), 6 = GSRB with deep ghost cells which are
+   * only exchanged every HCMultigridSweepsPerExchange sweeps (enthalpy-bulk concentration solve only)
    */
   int HCMultigridRelaxMode;
 
+  /// Number of red-black sweeps between ghost cell exchanges when HCMultigridRelaxMode = 6
+  int HCMultigridSweepsPerExchange;
+
   /// Whether to use a relaxation scheme as the bottom solve
   /**
    * We use this here as it treats the nonlinearity more sensibly than linear solvers like BiCGStab
    */
   bool HCMultigridUseRelaxBottomSolverForHC;
 
+  /// Whether to gather the bottom level onto one rank and solve it with a (cached) LU factorisation
+  /**
+   * Takes precedence over HCMultigridUseRelaxBottomSolverForHC. The nonlinearity is handled by refactorising
+   * the Jacobian whenever the solution stops converging quickly, for up to HCMultigridBottomSolveIterations iterations.
+   */
+  bool HCMultigridDirectBottomSolver;
+
+  /// Whether to solve for the enthalpy-bulk concentration on each level with Newton-Krylov iterations
+  /**
+   * Each Newton step is found with GMRES, preconditioned by a V-cycle of the FAS multigrid solver above,
+   * with Jacobian-vector products from the analytic phase diagram derivatives. Falls back to FAS multigrid if
+   * Newton doesn't converge.
+   */
+  bool HCMultigridNewtonKrylov;
+
+  /// Max number of Newton iterations per solve when HCMultigridNewtonKrylov = true
+  int HCMultigridNewtonMaxIter;
+
+  /// Max number of GMRES iterations per Newton iteration when HCMultigridNewtonKrylov = true
+  int HCMultigridKrylovMaxIter;
+
 
   /// Order of the normal predictor for velocity advection solves
   int velAdvNormalPredOrder;
@@ -1039,6 +1136,15 @@ struct MushyLayerOptions {
   /// Time period between successive diagnostic reports
   Real diagnostics_period;
 
+  /// Format to write diagnostics in (a DiagnosticFormats value)
+  int diagnosticsFormat;
+
+  /// For binary diagnostics, how many reports to buffer before writing them to disk
+  int diagnosticsFlushInterval;
+
+  /// Find the chimneys in the mushy layer each step, and record their number, width, spacing and depth
+  bool chimneyDiagnostics;
+
   /// Some custom options for initial data
   int customInitData;
 
@@ -302,13 +302,111 @@ Real computePorosity(Real H, Real C, Real compositionRatio, Real specificHeatRat
   return porosity;
 }
 
+Real compute_dHdT(Real H, Real C, Real compositionRatio, Real specificHeatRatio,
+                  Real stefan, Real waterDistributionCoeff,
+                  Real thetaEutectic, Real ThetaEutectic)
+{
+  Real H_e, H_s, H_l, dHdT;
+  H_e = std::nan("1");
+  H_s = std::nan("1");
+  H_l = std::nan("1");
+
+  ::computeBoundingEnergy(H_e, C, H_s, H_l, H_e, specificHeatRatio, stefan, compositionRatio, waterDistributionCoeff, thetaEutectic, ThetaEutectic);
+
+  if (H <= H_s)
+  {
+    dHdT = 1/specificHeatRatio;
+  }
+  else if (H > H_s && H <= H_e)
+  {
+    dHdT = 0;
+  }
+  else if (H > H_e && H < H_l)
+  {
+    Real porosity = computePorosityMushyLayer( H,  C,  compositionRatio,  specificHeatRatio,
+                                               stefan,  waterDistributionCoeff);
+    Real A = compositionRatio*(specificHeatRatio-1) - stefan;
+    Real B = H + compositionRatio*(1-2*specificHeatRatio) - C*(specificHeatRatio-1);
+    Real Cc = specificHeatRatio*(compositionRatio + C);
+
+    dHdT = pow(porosity,2) * (C+compositionRatio)*(-2*A)/(1 + B/sqrt(pow(B,2) - 4*A*Cc));
+  }
+  else
+  {
+    dHdT = 1;
+  }
+
+  return dHdT;
+}
+
+// Derivatives of T and Cl region by region, for the Newton-Krylov Jacobian
+void computeTClJacobian(Real H, Real C, Real& dTdH, Real& dTdC, Real& dCldH, Real& dCldC,
+                        Real compositionRatio, Real specificHeatRatio,
+                        Real stefan, Real waterDistributionCoeff,
+                        Real thetaEutectic, Real ThetaEutectic)
+{
+  Real H_s, H_l, H_e;
+  ::computeBoundingEnergy(H, C, H_s, H_l, H_e, specificHeatRatio, stefan, compositionRatio,
+                          waterDistributionCoeff, thetaEutectic, ThetaEutectic);
+
+  if (H <= H_s)
+  {
+    // T = H/c_p, and Cl is constant (0 in computeEnthalpyVars, Theta_e in CALCULATE_T_CL_FUSED)
+    dTdH = 1/specificHeatRatio;
+    dTdC = 0;
+    dCldH = 0;
+    dCldC = 0;
+  }
+  else if (H <= H_e)
+  {
+    // T = theta_e, Cl = Theta_e
+    dTdH = 0;
+    dTdC = 0;
+    dCldH = 0;
+    dCldC = 0;
+  }
+  else if (H < H_l)
+  {
+    // Cl = -T = (C + Cr(1-chi))/(chi + k(1-chi)), where the porosity chi solves a chi^2 + b chi + c = 0
+    Real porosity = computePorosityMushyLayer(H, C, compositionRatio, specificHeatRatio,
+                                              stefan, waterDistributionCoeff);
+    Real dChidH = 0;
+    Real dChidC = 0;
+    if (stefan != 0)
+    {
+      Real a = compositionRatio*(specificHeatRatio -1) + stefan * (waterDistributionCoeff-1);
+      Real b = compositionRatio * (1-2*specificHeatRatio) + H*(1-waterDistributionCoeff)
+                                          - C * (specificHeatRatio-1) - waterDistributionCoeff * stefan;
+
+      // Implicit differentiation of the quadratic
+      Real dQuadraticdChi = 2*a*porosity + b;
+      dChidH = -(porosity*(1-waterDistributionCoeff) + waterDistributionCoeff)/dQuadraticdChi;
+      dChidC = -(specificHeatRatio - porosity*(specificHeatRatio-1))/dQuadraticdChi;
+    }
+
+    Real numerator = C + compositionRatio*(1-porosity);
+    Real denominator = porosity + waterDistributionCoeff*(1-porosity);
+    Real dCldChi = (-compositionRatio*denominator - numerator*(1-waterDistributionCoeff))/(denominator*denominator);
+
+    dCldH = dCldChi*dChidH;
+    dCldC = 1/denominator + dCldChi*dChidC;
+    dTdH = -dCldH;
+    dTdC = -dCldC;
+  }
+  else
+  {
+    // T = H - St, Cl = C
+    dTdH = 1;
+    dTdC = 0;
+    dCldH = 0;
+    dCldC = 1;
+  }
+}
 
 // Refactored this out so I can reuse it elsewhere
 Real computePorosityMushyLayer(Real H, Real a_C, Real compositionRatio, Real specificHeatRatio,
                                Real stefan, Real waterDistributionCoeff)
 {
-  CH_TIME("MushyLayerUtils::computePorosityMushyLayer");
-
   Real porosity;
 
   if (stefan == 0)
@@ -1325,8 +1325,6 @@ amrMushyLayer::setupMultigrid(Vector<DisjointBoxLayout>& activeGrids)
   AMRNonLinearMultiCompOpFactory* HCop = new AMRNonLinearMultiCompOpFactory();
   HCop->define(m_amrDomains[0], activeGrids, m_refinement_ratios, m_amrDx[0], HC_BC,
                alpha, aCoef, beta, bCoef,
-               m_scalarNew[ScalarVars::m_enthalpySolidus], m_scalarNew[ScalarVars::m_enthalpyLiquidus],
-               m_scalarNew[ScalarVars::m_enthalpyEutectic],
                mlParamsPtr, temperature_Sl_BC,
                relaxMode, porosityEdgeBC);
 
@@ -35,8 +35,9 @@
 #include "utils_F.H"
 
 #include "AMRLevelMushyLayer.H"
-#include "Channel.h"
+#include "ChimneyLabeller.H"
 #include "MushyLayerUtils.H"
+#include "ColumnReduction.H"
 
 
 #include "NamespaceHeader.H"
@@ -44,6 +45,10 @@
 BiCGStabSolver<LevelData<FArrayBox> > AMRLevelMushyLayer::s_botSolverUStar;
 RelaxSolver<LevelData<FArrayBox> > AMRLevelMushyLayer::s_botSolverHC;
 
+#ifdef CH_USE_HDF5
+AsyncHDF5Writer AMRLevelMushyLayer::s_asyncWriter;
+#endif
+
 /*******/
 AMRLevelMushyLayer::~AMRLevelMushyLayer()
 {
@@ -295,18 +300,22 @@ void AMRLevelMushyLayer::compute_d_dt(const int a_var, LevelData<FArrayBox>& dif
   }
 
   DataIterator dit(m_grids);
-  for (dit.reset(); dit.ok(); ++dit)
+  int nbox = dit.size();
+
+#pragma omp parallel for
+  for (int ibox = 0; ibox < nbox; ibox++)
   {
+    const DataIndex& din = dit[ibox];
     if (vector)
     {
-      diff[dit] -= (*m_vectorOld[a_var])[dit];
+      diff[din] -= (*m_vectorOld[a_var])[din];
     }
     else
     {
-      diff[dit] -= (*m_scalarOld[a_var])[dit];
+      diff[din] -= (*m_scalarOld[a_var])[din];
     }
 
-    diff[dit] /= m_dt;
+    diff[din] /= m_dt;
     //    diff[dit] /= max;
   }
 
@@ -498,6 +507,11 @@ void AMRLevelMushyLayer::copyNewToOldStates()
   // Old now contains values at n, new will contain values at n+1 eventually
   for (int a_scalarVar = 0; a_scalarVar < m_numScalarVars; a_scalarVar++)
   {
+    if (m_scalarOld[a_scalarVar].isNull())
+    {
+      continue;
+    }
+
     m_scalarNew[a_scalarVar]->copyTo(m_scalarNew[a_scalarVar]->interval(),
                                      *m_scalarOld[a_scalarVar],
                                      m_scalarOld[a_scalarVar]->interval());
@@ -505,6 +519,11 @@ void AMRLevelMushyLayer::copyNewToOldStates()
   }
   for (int vectorVar = 0; vectorVar < m_numVectorVars; vectorVar++)
   {
+    if (m_vectorOld[vectorVar].isNull())
+    {
+      continue;
+    }
+
     m_vectorNew[vectorVar]->copyTo(m_vectorNew[vectorVar]->interval(),
                                    *m_vectorOld[vectorVar],
                                    m_vectorOld[vectorVar]->interval());
@@ -520,6 +539,7 @@ void AMRLevelMushyLayer::copyNewToOldStates()
 /*******/
 Real AMRLevelMushyLayer::advance()
 {
+  CH_TIME("AMRLevelMushyLayer::advance");
 
   ///////////////////////////////////////////////////////////////
   // This method advances the solution by one timestep on a level.
@@ -533,6 +553,8 @@ Real AMRLevelMushyLayer::advance()
     m_dtReduction = -1;
   }
 
+  m_dtController.startStep();
+
   // Get the coarser level, so we can work out later if this is in fact the coarsest level
   AMRLevelMushyLayer *amrMLcrse = NULL;
   if (m_level > 0)
@@ -582,6 +604,15 @@ Real AMRLevelMushyLayer::advance()
 
       amrMLptr = amrMLptr->getFinerLevel();
     }
+
+#ifdef CH_USE_HDF5
+    // Any plot/checkpoint files written since the last timestep have now been closed by AMR,
+    // so we can start filling them in the background while we advance
+    if (m_opt.asyncOutput)
+    {
+      s_asyncWriter.start();
+    }
+#endif
   }
 
 
@@ -648,11 +679,16 @@ Real AMRLevelMushyLayer::advance()
   fillScalars(oldPorosity, m_time-m_dt, m_porosity, true, true);
   fillScalars(newPorosity, m_time, m_porosity, true, true);
 
-  for (DataIterator dit = m_dPorosity_dt.dataIterator(); dit.ok(); ++dit)
+  DataIterator dit(m_grids);
+  int nbox = dit.size();
+
+#pragma omp parallel for
+  for (int ibox = 0; ibox < nbox; ibox++)
   {
-    m_dPorosity_dt[dit].copy(newPorosity[dit]);
-    m_dPorosity_dt[dit].minus(oldPorosity[dit]);
-    m_dPorosity_dt[dit].divide(m_dt);
+    const DataIndex& din = dit[ibox];
+    m_dPorosity_dt[din].copy(newPorosity[din]);
+    m_dPorosity_dt[din].minus(oldPorosity[din]);
+    m_dPorosity_dt[din].divide(m_dt);
   }
 
   // The 'new' variables have been calculated at the end of the previous timestep,
@@ -668,7 +704,6 @@ Real AMRLevelMushyLayer::advance()
 //  }
 
   // Some useful things to have around
-  DataIterator dit(m_grids);
   IntVect ivGhost = m_numGhost * IntVect::Unit;
   IntVect advectionGhost = m_numGhostAdvection * IntVect::Unit;
 
@@ -822,9 +857,13 @@ Real AMRLevelMushyLayer::advance()
     if (!doAdvectiveSrc)
     {
       DataIterator dit = m_vectorNew[VectorVars::m_UdelU]->dataIterator();
-      for (dit.reset(); dit.ok(); ++dit)
+      int nbox = dit.size();
+
+#pragma omp parallel for
+      for (int ibox = 0; ibox < nbox; ibox++)
       {
-        (*m_vectorNew[VectorVars::m_UdelU])[dit].setVal(0.0);
+        const DataIndex& din = dit[ibox];
+        (*m_vectorNew[VectorVars::m_UdelU])[din].setVal(0.0);
       }
     }
 
@@ -864,15 +903,20 @@ void AMRLevelMushyLayer::addHeatSource(LevelData<FArrayBox>& src)
 
       if (gaussian_heat_source_size != 0.0)
       {
-        for (DataIterator dit = m_grids.dataIterator(); dit.ok(); ++dit)
+        DataIterator dit = m_grids.dataIterator();
+        int nbox = dit.size();
+
+#pragma omp parallel for
+        for (int ibox = 0; ibox < nbox; ibox++)
         {
-          for (BoxIterator bit = BoxIterator(m_grids[dit]); bit.ok(); ++bit)
+          const DataIndex& din = dit[ibox];
+          for (BoxIterator bit = BoxIterator(m_grids[din]); bit.ok(); ++bit)
           {
             IntVect iv = bit();
             RealVect loc;
             ::getLocation(iv, loc, m_dx);
 
-            src[dit](iv, Hcomp) = gaussian_heat_source_size/(gaussian_heat_source_width*sqrt(2*M_PI))
+            src[din](iv, Hcomp) = gaussian_heat_source_size/(gaussian_heat_source_width*sqrt(2*M_PI))
                 * exp(-0.5*pow((loc[0]-gaussian_heat_source_xpos)/gaussian_heat_source_width, 2))
                 * 0.5*(1 + tanh(10*(loc[1]-(m_domainHeight-gaussian_heat_source_depth) ) ));
 
@@ -941,9 +985,14 @@ void AMRLevelMushyLayer::setVelZero(LevelData<FArrayBox>& a_vel, Real a_limit, i
     a_limit = m_opt.solidPorosity;
   }
 
-  for (DataIterator dit = a_vel.dataIterator(); dit.ok(); ++dit)
+  DataIterator dit = a_vel.dataIterator();
+  int nbox = dit.size();
+
+#pragma omp parallel for
+  for (int ibox = 0; ibox < nbox; ibox++)
   {
-    setVelZero(a_vel[dit], (*m_scalarNew[ScalarVars::m_porosity])[dit], a_limit, a_radius);
+    const DataIndex& din = dit[ibox];
+    setVelZero(a_vel[din], (*m_scalarNew[ScalarVars::m_porosity])[din], a_limit, a_radius);
   }
 }
 
@@ -958,12 +1007,17 @@ void AMRLevelMushyLayer::setVelZero(LevelData<FluxBox>& a_vel, Real a_limit)
   LevelData<FluxBox> porosity(a_vel.disjointBoxLayout(), 1, a_vel.ghostVect());
   fillScalarFace(porosity, m_time, m_porosity, true);
 
-  for (DataIterator dit = a_vel.dataIterator(); dit.ok(); ++dit)
+  DataIterator dit = a_vel.dataIterator();
+  int nbox = dit.size();
+
+#pragma omp parallel for
+  for (int ibox = 0; ibox < nbox; ibox++)
   {
+    const DataIndex& din = dit[ibox];
 
     for (int dir=0; dir<SpaceDim; dir++)
     {
-      setVelZero(a_vel[dit][dir], porosity[dit][dir], a_limit);
+      setVelZero(a_vel[din][dir], porosity[din][dir], a_limit);
 
     }
   }
@@ -1073,13 +1127,18 @@ void AMRLevelMushyLayer::updateEnthalpyVariables()
 
 void AMRLevelMushyLayer::computeLambdaPorosity()
 {
-  for (DataIterator dit = m_scalarNew[ScalarVars::m_lambda]->dataIterator(); dit.ok(); ++dit)
+  DataIterator dit = m_scalarNew[ScalarVars::m_lambda]->dataIterator();
+  int nbox = dit.size();
+
+#pragma omp parallel for
+  for (int ibox = 0; ibox < nbox; ibox++)
   {
-    (*m_scalarNew[ScalarVars::m_lambda_porosity])[dit].copy((*m_scalarNew[ScalarVars::m_lambda])[dit]);
-    (*m_scalarNew[ScalarVars::m_lambda_porosity])[dit].divide((*m_scalarNew[ScalarVars::m_porosity])[dit]);
+    const DataIndex& din = dit[ibox];
+    (*m_scalarNew[ScalarVars::m_lambda_porosity])[din].copy((*m_scalarNew[ScalarVars::m_lambda])[din]);
+    (*m_scalarNew[ScalarVars::m_lambda_porosity])[din].divide((*m_scalarNew[ScalarVars::m_porosity])[din]);
 
-    (*m_scalarOld[ScalarVars::m_lambda_porosity])[dit].copy((*m_scalarOld[ScalarVars::m_lambda])[dit]);
-    (*m_scalarOld[ScalarVars::m_lambda_porosity])[dit].divide((*m_scalarOld[ScalarVars::m_porosity])[dit]);
+    (*m_scalarOld[ScalarVars::m_lambda_porosity])[din].copy((*m_scalarOld[ScalarVars::m_lambda])[din]);
+    (*m_scalarOld[ScalarVars::m_lambda_porosity])[din].divide((*m_scalarOld[ScalarVars::m_porosity])[din]);
   }
 }
 
@@ -1287,20 +1346,25 @@ void AMRLevelMushyLayer::calculatePermeability()
   fillScalars(porosityOld, m_time-m_dt, m_porosity, true);
   fillScalars(porosityNew, m_time, m_porosity, true);
 
-  for (DataIterator dit = m_grids.dataIterator(); dit.ok(); ++dit)
+  DataIterator dit = m_grids.dataIterator();
+  int nbox = dit.size();
+
+#pragma omp parallel for
+  for (int ibox = 0; ibox < nbox; ibox++)
   {
-    FArrayBox solidFraction((*m_scalarNew[ScalarVars::m_permeability])[dit].box(), 1);
+    const DataIndex& din = dit[ibox];
+    FArrayBox solidFraction((*m_scalarNew[ScalarVars::m_permeability])[din].box(), 1);
 
     //First do new timestep
     solidFraction.setVal(1.0);
-    solidFraction -= porosityNew[dit];
-    ::calculatePermeability((*m_scalarNew[ScalarVars::m_permeability])[dit],
+    solidFraction -= porosityNew[din];
+    ::calculatePermeability((*m_scalarNew[ScalarVars::m_permeability])[din],
                             solidFraction, m_parameters, m_dx);
 
     // Now do old timestep
     solidFraction.setVal(1.0);
-    solidFraction -= porosityOld[dit];
-    ::calculatePermeability((*m_scalarOld[ScalarVars::m_permeability])[dit],
+    solidFraction -= porosityOld[din];
+    ::calculatePermeability((*m_scalarOld[ScalarVars::m_permeability])[din],
                             solidFraction, m_parameters, m_dx);
   }
 
@@ -1452,123 +1516,31 @@ void AMRLevelMushyLayer::horizontallyAverage(Vector<Real>& globalAveraged, Level
 void AMRLevelMushyLayer::horizontallyAverage(LevelData<FArrayBox>& a_averaged, LevelData<FluxBox>& a_phi,
                                              Vector<Real>& globalAveraged)
 {
-  Box domBox = m_problem_domain.domainBox();
-
-  IntVect smallEnd =domBox.smallEnd();
-  int y_init = smallEnd[1];
-
-  int idir = SpaceDim-1;
+  CH_TIME("AMRLevelMushyLayer::horizontallyAverage");
 
-  // +2 because for N cells we have N+1 faces
-  Real length = m_numCells[SpaceDim-1]+2;
-  globalAveraged.resize(length, 0.0);
+  // Averages on each horizontal plane of faces, component by component
+  Vector<Real> averages;
+  ColumnReduction::sumPlanes(averages, a_phi, m_problem_domain);
 
-  for (int comp = 0; comp < a_phi.nComp(); comp++)
+  int numFaces = m_problem_domain.domainBox().size(SpaceDim-1) + 1;
+  Real scale = m_dx/m_opt.domainWidth;
+  for (int i = 0; i < averages.size(); i++)
   {
-    Vector<Real> averaged(length, 0.0);
-
-    // Ensure we initialise this to 0
-    for (int y_i = 0; y_i < globalAveraged.size(); y_i++)
-    {
-      globalAveraged[y_i] = 0;
-    }
-
-    Vector<Vector<Real> > allAveraged(numProc());
-    for (int i = 0; i<numProc(); i++)
-    {
-      allAveraged[i].resize(length);
-      allAveraged[i].assign(0.0); //= new Vector<Real>(length+2, 0.0);
-    }
-
-    DisjointBoxLayout dbl = a_phi.disjointBoxLayout();
-
-    for (DataIterator dit = a_phi.dataIterator(); dit.ok(); ++dit)
-    {
-
-      FArrayBox& fluxDir = a_phi[dit][idir];
-      Box box = fluxDir.box();
-
-      // To stop double counting of interior faces
-      // think this was actually causing us to not calculated fluxes at the top of boxes
-      if (box.hiVect()[1] < domBox.hiVect()[1])
-      {
-        box.growDir(idir, Side::Hi, -1);
-      }
-
-
-      for (BoxIterator bit(box); bit.ok(); ++bit)
-      {
-        IntVect iv = bit();
-        int y_i = iv[SpaceDim-1];
-        IntVect ivUp = iv + BASISV(idir);
-
-        IntVect ivFluxBox;
-
-        // This is a bit of a hack, but basically works.
-
-        if (fluxDir.box().contains(ivUp))
-        {
-
-          ivFluxBox = ivUp;
-        }
-        else
-        {
-          ivFluxBox = iv;
-        }
-
-        //averaged[y_i-y_init] += fluxDir(iv, comp)*m_dx/m_opt.domainWidth;
-        averaged[y_i-y_init] += fluxDir(ivFluxBox, comp)*m_dx/m_opt.domainWidth;
-
-      }
-    }
-
-    //  pout() << endl;
-
-    // Broadcast/gather to compute averages over whole domain
-    int srcProc = 0;
-
-    gather(allAveraged, averaged, srcProc);
-    if (procID() == srcProc)
-    {
-      for (int ivec = 0; ivec<numProc(); ivec++)
-      {
-        for (int y_i = 0; y_i < globalAveraged.size(); y_i++)
-        {
-          globalAveraged[y_i] += (allAveraged[ivec])[y_i];
-        }
-      }
-    }
-
-    broadcast(globalAveraged, srcProc);
-
-    //  pout() << averaged << endl;
-    //    if (s_verbosity > 10)
-    //    {
-    //      pout() << "Processor ID: " << procID() << endl;
-    //      pout() << "solute fluxes: " << globalAveraged << endl;
-    //    }
-
-    for (DataIterator dit = a_averaged.dataIterator(); dit.ok(); ++dit)
-    {
-      //      Box box = m_grids[dit];
-
-      // To get the top face
-      //      box.growDir(1, Side::Hi, 1);
-      Box b = a_averaged[dit].box();
-
-      for (BoxIterator bit(b); bit.ok(); ++bit)
-      {
-        IntVect iv = bit();
-        int y_i = iv[SpaceDim-1];
-        y_i = y_i - y_init;
-        a_averaged[dit](iv, comp) = globalAveraged[y_i];
-      }
-    }
-
-  } // end loop over components
+    averages[i] *= scale;
+  }
 
+  // Each cell gets the average over its top face
+  ColumnReduction::setFromProfile(a_averaged, averages, numFaces, m_problem_domain, 1);
   a_averaged.exchange();
 
+  // Same for the first component, with the top face repeated
+  globalAveraged.resize(numFaces+1);
+  globalAveraged.assign(0.0);
+  for (int k = 0; k < numFaces; k++)
+  {
+    globalAveraged[k] = averages[min(k+1, numFaces-1)];
+  }
+
 }
 
 void AMRLevelMushyLayer::horizontallyAverage(Vector<Real>& averageVector, LevelData<FArrayBox>& a_phi)
@@ -1585,81 +1557,169 @@ void AMRLevelMushyLayer::horizontallyAverage(LevelData<FArrayBox>& a_averaged, L
 
 void AMRLevelMushyLayer::horizontallyAverage(LevelData<FArrayBox>& a_averaged, LevelData<FArrayBox>& a_phi, Vector<Real>& globalAveraged)
 {
-  Box domBox = m_problem_domain.domainBox();
+  CH_TIME("AMRLevelMushyLayer::horizontallyAverage");
 
-  IntVect smallEnd = domBox.smallEnd();
-  int z_low = smallEnd[1];
+  // Averages on each horizontal plane of cells, component by component
+  Vector<Real> averages;
+  ColumnReduction::sumPlanes(averages, a_phi, m_problem_domain);
 
-  //  Real length = domBox.hiVect()[1] + 2 - domBox.loVect()[1];
-  Real length = m_numCells[SpaceDim-1]+1; // need an extra cell here
-  //  Real width = (domBox.hiVect()[0] + 1 - domBox.loVect()[0])*m_dx;
-  Real width = m_opt.domainWidth;
-  Vector<Real> averaged(length, 0.0);
+  int numCells = m_problem_domain.domainBox().size(SpaceDim-1);
+  Real scale = m_dx/m_opt.domainWidth;
+  for (int i = 0; i < averages.size(); i++)
+  {
+    averages[i] *= scale;
+  }
 
-  globalAveraged.resize(length, 0.0);
-  Vector<Vector<Real> > allAveraged(numProc());
+  ColumnReduction::setFromProfile(a_averaged, averages, numCells, m_problem_domain);
 
-  for (int i = 0; i<numProc(); i++)
+  // Averages of the first component, with an extra zero at the top
+  globalAveraged.resize(numCells+1);
+  globalAveraged.assign(0.0);
+  for (int k = 0; k < numCells; k++)
   {
-    allAveraged[i].resize(length);
-    allAveraged[i].assign(0.0); //= new Vector<Real>(length+2, 0.0);
+    globalAveraged[k] = averages[k];
   }
+}
 
-  for (DataIterator dit = a_phi.dataIterator(); dit.ok(); ++dit)
-  {
-    Box box = m_grids[dit];
+void AMRLevelMushyLayer::getBackupVars(Vector<int>& a_scalarVars, Vector<int>& a_vectorVars)
+{
+  // Only the prognostic variables - everything else is recomputed from these
+  a_scalarVars.resize(0);
+  a_scalarVars.push_back(ScalarVars::m_enthalpy);
+  a_scalarVars.push_back(ScalarVars::m_bulkConcentration);
+  a_scalarVars.push_back(ScalarVars::m_pressure);
+  a_scalarVars.push_back(ScalarVars::m_lambda);
+
+  a_vectorVars.resize(0);
+  a_vectorVars.push_back(VectorVars::m_fluidVel);
+}
 
-    box &= m_problem_domain.domainBox();
-    for (BoxIterator bit(box); bit.ok(); ++bit)
-    {
-      IntVect iv = bit();
-      int z_i = iv[SpaceDim-1];
-      averaged[z_i-z_low] += a_phi[dit](iv)*(m_dx/width);
-    }
+void AMRLevelMushyLayer::getNewTimeOnlyVars(Vector<int>& a_scalarVars, Vector<int>& a_vectorVars)
+{
+  // Fields which are written each step from the prognostic fields, but never read at the old time
+  a_scalarVars.resize(0);
+  a_scalarVars.push_back(ScalarVars::m_saltEqnSrcGodunov);
+  a_scalarVars.push_back(ScalarVars::m_enthalpySrc);
+  a_scalarVars.push_back(ScalarVars::m_divUadv);
+  a_scalarVars.push_back(ScalarVars::m_dHdt);
+  a_scalarVars.push_back(ScalarVars::m_dSdt);
+  a_scalarVars.push_back(ScalarVars::m_averageVerticalFlux);
+  a_scalarVars.push_back(ScalarVars::m_soluteFluxAnalytic);
+  a_scalarVars.push_back(ScalarVars::m_verticalFlux);
+  a_scalarVars.push_back(ScalarVars::m_divU);
+  a_scalarVars.push_back(ScalarVars::m_averageHeatFlux);
+  a_scalarVars.push_back(ScalarVars::m_streamfunction);
+  a_scalarVars.push_back(ScalarVars::m_FsVertDiffusion);
+  a_scalarVars.push_back(ScalarVars::m_FsVertFluid);
+  a_scalarVars.push_back(ScalarVars::m_FsVertFrame);
+  a_scalarVars.push_back(ScalarVars::m_divUcorr);
+  a_scalarVars.push_back(ScalarVars::m_pi);
+  a_scalarVars.push_back(ScalarVars::m_phi);
+  a_scalarVars.push_back(ScalarVars::m_MACBC);
+  a_scalarVars.push_back(ScalarVars::m_MACrhs);
+  a_scalarVars.push_back(ScalarVars::m_CCrhs);
+  a_scalarVars.push_back(ScalarVars::m_lightIntensity);
+
+  a_vectorVars.resize(0);
+  a_vectorVars.push_back(VectorVars::m_viscousSolveSrc);
+  a_vectorVars.push_back(VectorVars::m_UdelU);
+  a_vectorVars.push_back(VectorVars::m_dUdt);
+  a_vectorVars.push_back(VectorVars::m_FsDiffusion);
+  a_vectorVars.push_back(VectorVars::m_FsFluid);
+  a_vectorVars.push_back(VectorVars::m_Fs);
+  a_vectorVars.push_back(VectorVars::m_freestreamCorrection);
+  a_vectorVars.push_back(VectorVars::m_advectionImplicitSrc);
+  a_vectorVars.push_back(VectorVars::m_MACcorrection);
+  a_vectorVars.push_back(VectorVars::CCcorrection);
+  a_vectorVars.push_back(VectorVars::m_advSrcLapU);
+  a_vectorVars.push_back(VectorVars::m_advUpreProjection);
+  a_vectorVars.push_back(VectorVars::m_advVelCorr);
+}
 
-  }
+void AMRLevelMushyLayer::getDerivedVars(Vector<int>& a_scalarVars, Vector<int>& a_vectorVars)
+{
+  // Fields computed by scalarField() and vectorField() when asked for
+  a_scalarVars.resize(0);
+  a_scalarVars.push_back(ScalarVars::m_vorticity);
+  a_scalarVars.push_back(ScalarVars::m_Terr);
 
-  //  pout() << "HorizontallyAverage - got local averages, now broadcast/gather" << endl;
+  a_vectorVars.resize(0);
+  a_vectorVars.push_back(VectorVars::m_fluidVelErr);
+}
 
-  // Broadcast/gather to compute averages over whole domain
-  int srcProc = 0;
+RefCountedPtr<LevelData<FArrayBox> > AMRLevelMushyLayer::scalarField(int a_var) const
+{
+  if (!m_scalarNew[a_var].isNull())
+  {
+    return m_scalarNew[a_var];
+  }
 
-  gather(allAveraged, averaged, srcProc);
+  CH_TIME("AMRLevelMushyLayer::scalarField");
 
-  if (procID() == srcProc)
+  RefCountedPtr<LevelData<FArrayBox> > field = scratchData(1, IntVect::Zero);
+
+  if (a_var == ScalarVars::m_vorticity)
   {
-    for (int ivec = 0; ivec<numProc(); ivec++)
+    computeVorticity(*field);
+  }
+  else if (a_var == ScalarVars::m_Terr)
+  {
+    for (DataIterator dit = m_grids.dataIterator(); dit.ok(); ++dit)
     {
-      for (int y_i = 0; y_i < globalAveraged.size(); y_i++)
-      {
-        globalAveraged[y_i] += (allAveraged[ivec])[y_i];
-      }
+      (*field)[dit].copy((*m_scalarNew[ScalarVars::m_temperatureAnalytic])[dit]);
+      (*field)[dit].minus((*m_scalarNew[ScalarVars::m_temperature])[dit]);
     }
+  }
+  else
+  {
+    MayDay::Error("AMRLevelMushyLayer::scalarField - no way to compute this field");
+  }
 
+  return field;
+}
 
+RefCountedPtr<LevelData<FArrayBox> > AMRLevelMushyLayer::vectorField(int a_var) const
+{
+  if (!m_vectorNew[a_var].isNull())
+  {
+    return m_vectorNew[a_var];
   }
 
-  //  pout() << "HorizontallyAverage - completed gather" << endl;
+  CH_TIME("AMRLevelMushyLayer::vectorField");
+
+  RefCountedPtr<LevelData<FArrayBox> > field = scratchData(SpaceDim, IntVect::Zero);
 
-  broadcast(globalAveraged, srcProc);
+  if (a_var == VectorVars::m_fluidVelErr)
+  {
+    for (DataIterator dit = m_grids.dataIterator(); dit.ok(); ++dit)
+    {
+      (*field)[dit].copy((*m_vectorNew[VectorVars::m_fluidVel])[dit]);
+      (*field)[dit].minus((*m_vectorNew[VectorVars::m_fluidVelAnalytic])[dit]);
+    }
+  }
+  else
+  {
+    MayDay::Error("AMRLevelMushyLayer::vectorField - no way to compute this field");
+  }
 
-  //  pout() << "HorizontallyAverage - complete broadcast" << endl;
+  return field;
+}
 
-  for (DataIterator dit = m_scalarNew[ScalarVars::m_bulkConcentration]->dataIterator(); dit.ok(); ++dit)
+RefCountedPtr<LevelData<FArrayBox> > AMRLevelMushyLayer::scratchData(int a_nComp, const IntVect& a_ghost) const
+{
+  for (int i = 0; i < m_scratchPool.size(); i++)
   {
-    Box box = m_grids[dit];
-    for (int idir=0; idir<SpaceDim; idir++)
+    RefCountedPtr<LevelData<FArrayBox> >& scratch = m_scratchPool[i];
+    if (scratch.refCount() == 1 && scratch->nComp() == a_nComp && scratch->ghostVect() == a_ghost)
     {
-      box &= m_problem_domain.domainBox();
-      for (BoxIterator bit(box); bit.ok(); ++bit)
-      {
-        IntVect iv = bit();
-        int z_i = iv[SpaceDim-1];
-        z_i = z_i - z_low;
-        a_averaged[dit](iv) = globalAveraged[z_i];
-      }
+      return scratch;
     }
   }
+
+  m_scratchPool.push_back(RefCountedPtr<LevelData<FArrayBox> >(
+      new LevelData<FArrayBox>(m_grids, a_nComp, a_ghost)));
+
+  return m_scratchPool.back();
 }
 
 void AMRLevelMushyLayer::backupTimestep()
@@ -1671,16 +1731,26 @@ void AMRLevelMushyLayer::backupTimestep()
     pout() << "AMRLevelMushyLayer::backupTimestep " << endl;
   }
 
-  for (DataIterator dit = m_scalarNew[0]->dataIterator(); dit.ok(); ++dit)
+  Vector<int> backupVars, vectBackupVars;
+  getBackupVars(backupVars, vectBackupVars);
+
+  DataIterator dit = m_scalarNew[0]->dataIterator();
+  int nbox = dit.size();
+
+#pragma omp parallel for
+  for (int ibox = 0; ibox < nbox; ibox++)
   {
-    for (int var = 0; var < m_numScalarVars; var++)
+    const DataIndex& din = dit[ibox];
+    for (int i = 0; i < backupVars.size(); i++)
     {
-      (*m_scalarRestart[var])[dit].copy((*m_scalarNew[var])[dit]);
+      int var = backupVars[i];
+      (*m_scalarRestart[var])[din].copy((*m_scalarNew[var])[din]);
     }
 
-    for (int var = 0; var < m_numVectorVars; var++)
+    for (int i = 0; i < vectBackupVars.size(); i++)
     {
-      (*m_vectorRestart[var])[dit].copy((*m_vectorNew[var])[dit]);
+      int var = vectBackupVars[i];
+      (*m_vectorRestart[var])[din].copy((*m_vectorNew[var])[din]);
     }
   }
 
@@ -1695,36 +1765,33 @@ void AMRLevelMushyLayer::restartTimestepFromBackup(bool ignorePressure)
   {
     pout() << "AMRLevelMushyLayer::restartTimestepFromBackup"        << endl;
   }
-  Vector<int> restartVars;
-
-  // This should be all we need:
-  restartVars.push_back(ScalarVars::m_enthalpy);
-  restartVars.push_back(ScalarVars::m_bulkConcentration);
-  restartVars.push_back(ScalarVars::m_pressure);
-  restartVars.push_back(ScalarVars::m_lambda);
-
-  Vector<int> vectRestartVars;
-  vectRestartVars.push_back(VectorVars::m_fluidVel);
+  Vector<int> restartVars, vectRestartVars;
+  getBackupVars(restartVars, vectRestartVars);
 
   // Make sure we copy ghost cells
-  for (DataIterator dit = m_scalarNew[0]->dataIterator(); dit.ok(); ++dit)
+  DataIterator dit = m_scalarNew[0]->dataIterator();
+  int nbox = dit.size();
+
+#pragma omp parallel for
+  for (int ibox = 0; ibox < nbox; ibox++)
   {
+    const DataIndex& din = dit[ibox];
 
     for (int i = 0; i < restartVars.size(); i++)
     {
       int var = restartVars[i];
       if (! (var == ScalarVars::m_pressure && ignorePressure))
       {
-        (*m_scalarNew[var])[dit].copy((*m_scalarRestart[var])[dit]);
-        (*m_scalarOld[var])[dit].copy((*m_scalarRestart[var])[dit]);
+        (*m_scalarNew[var])[din].copy((*m_scalarRestart[var])[din]);
+        (*m_scalarOld[var])[din].copy((*m_scalarRestart[var])[din]);
       }
     }
 
     for (int i = 0; i < vectRestartVars.size(); i++)
     {
       int var = vectRestartVars[i];
-      (*m_vectorNew[var])[dit].copy((*m_vectorRestart[var])[dit]);
-      (*m_vectorOld[var])[dit].copy((*m_vectorRestart[var])[dit]);
+      (*m_vectorNew[var])[din].copy((*m_vectorRestart[var])[din]);
+      (*m_vectorOld[var])[din].copy((*m_vectorRestart[var])[din]);
 
     }
   }
@@ -1854,6 +1921,17 @@ int AMRLevelMushyLayer::multiCompAdvectDiffuse(LevelData<FArrayBox>& a_phi_old,
 
   BaseLevelHeatSolver<LevelData<FArrayBox>, FluxBox, LevelFluxRegister>* baseLevBE = NULL;
 
+  // Newton-Krylov does its V-cycles as a preconditioner, which the heat solver's counts don't see
+  NewtonKrylovFASMultiGrid* newtonKrylov = NULL;
+  if (!m_multiCompFASMG.isNull())
+  {
+    newtonKrylov = dynamic_cast<NewtonKrylovFASMultiGrid*>(&(*m_multiCompFASMG));
+  }
+  if (newtonKrylov != NULL)
+  {
+    newtonKrylov->resetStatistics();
+  }
+
   if (m_opt.timeIntegrationOrder == 2)
   {
     //       MayDay::Error("multiCompAdvectDiffuse - TGA not implemented yet");
@@ -1933,8 +2011,19 @@ int AMRLevelMushyLayer::multiCompAdvectDiffuse(LevelData<FArrayBox>& a_phi_old,
 
   Real residual = 0;
 
+  if (newtonKrylov != NULL && newtonKrylov->m_didNewtonSolve)
+  {
+    exitStatus = newtonKrylov->m_exitStatus;
+    residual = newtonKrylov->m_finalResidual;
+    int num_iter = newtonKrylov->m_numVCycles;
+
+    pout() << "  HC solve       (level " << m_level << "): exit status " << exitStatus << ", solver residual = " << residual << ", num MG iterations = " << num_iter
+        << " (" << newtonKrylov->m_newtonIterations << " Newton iterations)" << endl;
+
+    m_dtController.addSolve(num_iter, !(exitStatus == 2 || exitStatus == 4 || exitStatus == 6));
+  }
 #ifdef CH_FORK
-  if (baseLevBE != NULL)
+  else if (baseLevBE != NULL)
   {
     exitStatus = baseLevBE->exitStatus();
     residual = baseLevBE->finalResidual();
@@ -1943,6 +2032,8 @@ int AMRLevelMushyLayer::multiCompAdvectDiffuse(LevelData<FArrayBox>& a_phi_old,
     //           MAC Projection (level
     pout() << "  HC solve       (level " << m_level << "): exit status " << exitStatus << ", solver residual = " << residual << ", num MG iterations = " << num_iter << endl;
 
+    m_dtController.addSolve(num_iter, !(exitStatus == 2 || exitStatus == 4 || exitStatus == 6));
+
   }
 #endif
 
@@ -2440,10 +2531,14 @@ void AMRLevelMushyLayer::advectScalar(const int a_scalarVar, const int a_advecti
   Divergence::levelDivergenceMAC(update, flux, m_dx);
 
   // Add the source term to the old time solution
-  for (DataIterator dit = m_grids.dataIterator(); dit.ok(); ++dit)
+  int nbox = dit.size();
+
+#pragma omp parallel for
+  for (int ibox = 0; ibox < nbox; ibox++)
   {
-    update[dit].mult(m_dt);
-    (*m_scalarNew[a_scalarVar])[dit] -= update[dit];
+    const DataIndex& din = dit[ibox];
+    update[din].mult(m_dt);
+    (*m_scalarNew[a_scalarVar])[din] -= update[din];
 
   }
 
@@ -3212,8 +3307,7 @@ void AMRLevelMushyLayer::computeDiagnostics()
   // Now lets work out some chimney geometry:
   // - how big
   // - what spacing
-  bool doChimneyDiagnostics = false; // turn this off for now as it seems to be very slow
-  if (m_level == 0 && doChimneyDiagnostics)
+  if (m_level == 0 && m_opt.chimneyDiagnostics)
   {
     computeChimneyDiagnostics();
   }
@@ -3365,176 +3459,23 @@ Real AMRLevelMushyLayer::averageOverLiquidRegion(int a_var)
 
 void AMRLevelMushyLayer::computeChimneyDiagnostics()
 {
-  IntVectSet liquidIVs, mushyIVs;
-  for (DataIterator dit = m_grids.dataIterator(); dit.ok(); ++dit)
-  {
-    for (BoxIterator bit(m_grids[dit]); bit.ok(); ++bit)
-    {
-      IntVect iv = bit();
-      Real porosity = (*m_scalarNew[ScalarVars::m_porosity])[dit](iv);
-
-      // we use >= rather == because due to rounding errors we can get porosities very slightly above 1.0
-      if (porosity >= 1.0)
-      {
-        liquidIVs |= iv;
-      }
-      else
-      {
-        mushyIVs |= iv;
-      }
-    }
-  }
-
-  mushyIVs.grow(1);
-
-  Box solidBox = mushyIVs.minBox();
-  int lowestSolidRegion  =solidBox.smallEnd(1);
-  Box domainBox = m_problem_domain.domainBox();
+  CH_TIME("AMRLevelMushyLayer::computeChimneyDiagnostics");
 
-  IntVect topCorner;
-  for (int dir = 0; dir<SpaceDim; dir++)
-  {
-    if (dir == SpaceDim -1)
-    {
-      // Vertical direction
-      topCorner += BASISV(dir)*lowestSolidRegion;
-    }
-    else
-    {
-      topCorner += BASISV(dir)*domainBox.bigEnd(dir);
-    }
-  }
-
-  Box purelyLiquidBox(domainBox.smallEnd(), topCorner);
+  ChimneyLabeller chimneys;
+  chimneys.define(*m_scalarNew[ScalarVars::m_porosity], m_problem_domain, m_dx);
 
-  // get rid off all IVs in an entirely liquid region, below the mushy layer
-  liquidIVs -= purelyLiquidBox;
-  //    purelyLiquidBox -= solidBox;
-
-  // Start iterating in strips from the top of the domain.
-  // Any liquid regions are either added to an existing IVS (if contiguous) or start their own
-
-  //    Vector<IntVectSet*> channels;
-  Vector<Channel*> channels;
-
-  Box domBox = m_problem_domain.domainBox();
-  Box b = adjCellHi(m_problem_domain.domainBox(), 1, 1);
-  b.shift(1, -1);
-
-
-  while (domBox.contains(b))
-  {
-    for (BoxIterator bit(b); bit.ok(); ++bit)
-    {
-      IntVect iv = bit();
-      if (liquidIVs.contains(iv))
-      {
-        // Two options: 1) new channel, 2) existing channel
-        // Check if existing channel:
-        bool existingChannel = false;
-        for (int channel_i = 0; channel_i < channels.size(); channel_i++)
-        {
-          Channel& thisChannel = *channels[channel_i];
-
-          if (thisChannel.borders(iv))
-          {
-            // Only add the IntVect to the channel if it isn't finished
-            // i.e. if it hasn't reached the liquid yet.
-            if (!thisChannel.isFinished())
-            {
-              thisChannel |= iv;
-              //                pout() << iv << endl;
-            }
-            existingChannel = true;
-            continue;
-          }
-        }
-
-        // If we couldn't add IV to existing channel, make a new channel
-        // a new channel must border a mushy region!
-        bool bordersMush = mushyIVs.contains(iv);
-        if (!existingChannel && bordersMush)
-        {
-          //            pout() << "new channel - " << iv << endl;
-          Channel *newChannel = new Channel(iv);
-          channels.push_back(newChannel);
-        }
-      } // end if intvect is liquid
-    } // end loop over this box
-
-    // Check if we've entered the actual liquid - have the channel widths massively increased?
-    for (int channel_i = 0; channel_i < channels.size(); channel_i++)
-    {
-      Channel& thisChannel = *channels[channel_i];
-
-      if (thisChannel.isFinished())
-      {
-        continue;
-      }
-
-      // Compare the width at the lowest point and second lowest point
-      Real bottomWidth = thisChannel.width(Side::Lo, 0, m_dx);
-      Real penultimateBottomWidth = thisChannel.width(Side::Lo, 1, m_dx);
-
-      if (penultimateBottomWidth > 0.0
-          //            && bottomWidth/a_dx > 10 // require a certain number of cells, as small channels can indeed grow quickly
-          && bottomWidth > 3*penultimateBottomWidth)
-      {
-        // Want to end this channel at this point (and stop adding IVS), but can't do this until we create a channel class
-        thisChannel.removeBottomCells();
-        thisChannel.setFinished();
-      }
-    }
-
-    b.shift(1, -1);
-  } // end loop over boxes
-
-  // Only keep channels which are higher than wide?
-  Vector<Channel*> actualChannels;
-
-  for (int i = 0; i < channels.size(); i++)
-  {
-    Channel& thisChannel = *channels[i];
-    if (thisChannel.averageWidth(m_dx) < thisChannel.height(m_dx))
-    {
-      actualChannels.push_back(channels[i]);
-    }
-
-  }
-
-  // Finally - may want to merge channels if we had wierd branching going on
-
-
-  // Now we have the channels, can do statistics on them
-  Real averageChannelWidth = 0.0, averageChannelSpacing = 0.0;
-
-  Vector<Real> channelSpacing;
-  Channel::channelSpacing(channelSpacing, actualChannels, m_dx, m_problem_domain);
-  pout() << "Channel spacing: " << channelSpacing << endl;
-  for (int i = 0; i < channelSpacing.size(); i++)
-  {
-    averageChannelSpacing += channelSpacing[i];
-  }
-  averageChannelSpacing /= channelSpacing.size();
-
-  for (int i = 0; i < actualChannels.size(); i++)
+  if (s_verbosity >= 3)
   {
-
-    Channel& thisChannel = *actualChannels[i];
-
-    Real averageWidth = thisChannel.averageWidth(m_dx);
-    pout() << "Channel average width = " << averageWidth << endl;
-
-    averageChannelWidth += averageWidth;
-
+    pout() << "Found " << chimneys.numChimneys() << " chimneys, average width = " << chimneys.averageWidth()
+        << ", spacing = " << chimneys.averageSpacing() << ", depth = " << chimneys.averageDepth() << endl;
   }
-  averageChannelWidth /= actualChannels.size();
-
 
   if (m_level == 0)
   {
-    m_diagnostics.addDiagnostic(DiagnosticNames::diag_chimneySpacing, m_time, averageChannelSpacing);
-    m_diagnostics.addDiagnostic(DiagnosticNames::diag_chimneyWidth, m_time, averageChannelWidth);
+    m_diagnostics.addDiagnostic(DiagnosticNames::diag_chimneySpacing, m_time, chimneys.averageSpacing());
+    m_diagnostics.addDiagnostic(DiagnosticNames::diag_chimneyWidth, m_time, chimneys.averageWidth());
+    m_diagnostics.addDiagnostic(DiagnosticNames::diag_numChimneys, m_time, chimneys.numChimneys());
+    m_diagnostics.addDiagnostic(DiagnosticNames::diag_chimneyDepth, m_time, chimneys.averageDepth());
   }
 
 }
@@ -3569,15 +3510,26 @@ Real AMRLevelMushyLayer::computeDt(bool growdt)
     m_dt = m_dt/m_dtReduction;
   }
 
+  Real solnDt = computeDt(m_opt.cfl);
+
   // Shouldn't be growing this dt - amr handles this itself
   Real grownDt = m_dt;
-  if (growdt)
+  if (growdt && m_dtController.isDefined() && solnDt > 0)
+  {
+    // Let the controller pick the change in dt, based on how hard the solves were and how close we are to the CFL limit
+    Real factor = m_dtController.dtFactor(m_dt/solnDt);
+    grownDt = m_dt*factor;
+
+    if (s_verbosity >= 2)
+    {
+      pout() << "  Timestep controller (level " << m_level << "): dt factor = " << factor << endl;
+    }
+  }
+  else if (growdt)
   {
     grownDt = m_dt*m_opt.max_dt_growth;
   }
 
-  Real solnDt = computeDt(m_opt.cfl);
-
   Real newDt = min(grownDt, solnDt);
 
   return newDt;
@@ -3973,6 +3925,11 @@ int AMRLevelMushyLayer::getFinestLevel()
 void AMRLevelMushyLayer::fillVectorField(LevelData<FArrayBox>& a_vector,
                                          Real a_time, int a_var, bool doInterior, bool quadInterp)
 {
+  if (m_vectorNew[a_var].isNull())
+  {
+    MayDay::Error("AMRLevelMushyLayer::fillVectorField - field is computed on demand, use vectorField() instead");
+  }
+
   Interval vectorComps(0, SpaceDim - 1);
 
   Real old_time = m_time - m_dt;
@@ -4005,7 +3962,12 @@ void AMRLevelMushyLayer::fillVectorField(LevelData<FArrayBox>& a_vector,
 
   if (doInterior)
   {
-    if (abs(a_time - old_time) < TIME_EPS)
+    if (m_vectorOld[a_var].isNull())
+    {
+      // Only stored at the new time (see getNewTimeOnlyVars())
+      m_vectorNew[a_var]->copyTo(vectorComps, a_vector, vectorComps);
+    }
+    else if (abs(a_time - old_time) < TIME_EPS)
     {
       m_vectorOld[a_var]->copyTo(vectorComps, a_vector, vectorComps);
       //      for (DataIterator dit = m_grids.dataIterator(); dit.ok(); ++dit)
@@ -4048,8 +4010,8 @@ void AMRLevelMushyLayer::fillVectorField(LevelData<FArrayBox>& a_vector,
         // fill in coarse-fine BC data by conservative linear interp
         AMRLevelMushyLayer& crseLevel = *getCoarserLevel();
 
-        LevelData<FArrayBox>& oldCrseVector = *crseLevel.m_vectorOld[a_var];
         LevelData<FArrayBox>& newCrseVector = *crseLevel.m_vectorNew[a_var];
+        LevelData<FArrayBox>& oldCrseVector = crseLevel.m_vectorOld[a_var].isNull() ? newCrseVector : *crseLevel.m_vectorOld[a_var];
         const DisjointBoxLayout& crseGrids = oldCrseVector.getBoxes();
         const ProblemDomain& crseDomain = crseLevel.problemDomain();
         int nRefCrse = crseLevel.refRatio();
@@ -4656,10 +4618,18 @@ bool AMRLevelMushyLayer::crashed()
 
   Vector<int> vars;
   vars.append(ScalarVars::m_enthalpy);
-  vars.append(ScalarVars::m_vorticity);
   vars.append(ScalarVars::m_enthalpySrc);
   vars.append(ScalarVars::m_lambda);
 
+  // Vorticity is no longer stored, so look at the velocity it would have come from
+  Real maxVel = computeMax(*m_vectorNew[VectorVars::m_fluidVel], NULL, m_ref_ratio, Interval(0, SpaceDim-1));
+  Real minVel = computeMin(*m_vectorNew[VectorVars::m_fluidVel], NULL, m_ref_ratio, Interval(0, SpaceDim-1));
+  if (maxVel > 1e50 || minVel < -1e50)
+  {
+    pout() << "WARNING: abs|" << m_vectorVarNames[VectorVars::m_fluidVel] << "| > " << 1e50 << endl;
+    return true;
+  }
+
   for (int i=1; i<vars.size(); i++)
   {
     Real max = computeMax(*m_scalarNew[vars[i]], NULL, m_ref_ratio, Interval(0,0));
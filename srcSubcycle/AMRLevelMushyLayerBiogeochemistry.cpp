@@ -9,100 +9,97 @@
 #include "AMRLevelMushyLayer.H"
 #include "VCAMRPoissonOp2.H"
 #include "AMRScalarDiffusionOp.h"
+#include "LayoutIterator.H"
+#include "SPMD.H"
+#include "SetValLevel.H"
 
 
 void AMRLevelMushyLayer::computeRadianceIntensity()
 {
   // Compute radiation intensity by Beer-Lambert law (or something better)
+  // intensity = 10^{ - int_{top}^{z} T dz}
+  //
+  // The integral is a running sum down each column of cells (see ColumnScan), starting from the top
+  // of the domain, or from the coarser level's integral above the top of this level's grids
 
-  // only works in 2-D at the moment
-  CH_assert(SpaceDim==2);
-
-#if CH_SPACEDIM==2
+  CH_TIME("AMRLevelMushyLayer::computeRadianceIntensity");
 
-  // First need to compute transmittance at each point in space
-  LevelData<FArrayBox> attenuation(m_grids, 1, IntVect::Unit);
-  LevelData<FArrayBox> attenuationSum(m_grids, 1, IntVect::Unit);
+  int vertDir = SpaceDim-1;
+  int domainTop = m_problem_domain.domainBox().bigEnd(vertDir);
 
- Real liquid_attenuation = 0.01;
+  Real liquid_attenuation = 0.01;
   Real solid_attenuation = 1.0; // nondimensionalised
 
-  // T= (1-chi)*Ts + chi*Tl
-  // T = Ts + chi*(Tl-Ts)
-
-  for (DataIterator dit = attenuation.dataIterator(); dit.ok(); ++dit)
+  // Which boxes are above which only changes when we regrid
+  if (!m_radianceScan.isDefined(m_grids))
   {
-    FArrayBox& porosity = (*m_scalarNew[m_porosity])[dit];
-    attenuation[dit].setVal(liquid_attenuation-solid_attenuation);
-    attenuation[dit].mult(porosity, 0, 0, 1);
-    attenuation[dit].plus(solid_attenuation);
+    m_radianceScan.define(m_grids);
   }
 
-  attenuation.exchange();
-
-  // Integrate in columns
-  // intensity = 10^{ - int_{top}^{z} T dz}
-  attenuation.copyTo(attenuationSum); // fill top row
-  Box domBox = m_problem_domain.domainBox();
-  domBox.growHi(SpaceDim-1, -1);
-
-  int lo_i = domBox.smallEnd()[0];
-  int hi_i = domBox.bigEnd()[0];
-
-  for (int z_i=domBox.bigEnd()[SpaceDim-1]; z_i >= domBox.smallEnd()[SpaceDim-1]; z_i--)
+  // On finer levels, one layer of ghost cells gives us the coarse intensity just above each box
+  AMRLevelMushyLayer* amrMLcrse = getCoarserLevel();
+  int nRefCrse = 1;
+  LevelData<FArrayBox> crseIntensity;
+  if (amrMLcrse)
   {
-    // need to find which box contains this z_i
+    nRefCrse = amrMLcrse->m_ref_ratio;
 
-    for (DataIterator dit = attenuation.dataIterator(); dit.ok(); ++dit)
-       {
-         Box b = m_grids[dit];
-
-
-//         b.growLo(SpaceDim-1, -1);
-
-         IntVect iv_lo = IntVect(lo_i, z_i);
-
-         if (b.contains(iv_lo))
-         {
+    DisjointBoxLayout coarsenedGrids;
+    coarsen(coarsenedGrids, m_grids, nRefCrse);
+    crseIntensity.define(coarsenedGrids, 1, IntVect::Unit);
+    setValLevel(crseIntensity, 1.0);
+    amrMLcrse->m_scalarNew[ScalarVars::m_lightIntensity]->copyTo(crseIntensity);
+  }
 
-           IntVect iv_hi = IntVect(hi_i, z_i);
-           Box horizBox = Box(iv_lo, iv_hi);
+  // Attenuation over each cell, and the integral above the top of each box (if nothing on this level is above it)
+  LevelData<FArrayBox> attenuation(m_grids, 1, IntVect::Zero);
+  LevelData<FArrayBox> integralAbove(m_grids, 1, IntVect::Zero);
+  LevelData<FArrayBox> integral(m_grids, 1, IntVect::Zero);
 
-         for (BoxIterator bit = BoxIterator(horizBox); bit.ok(); ++bit)
-         {
-           IntVect iv = bit();
+  for (DataIterator dit = m_grids.dataIterator(); dit.ok(); ++dit)
+  {
+    const Box& box = m_grids[dit];
+    const FArrayBox& porosity = (*m_scalarNew[m_porosity])[dit];
 
-           IntVect ivUp = iv + BASISV(SpaceDim-1);
-           attenuationSum[dit](iv) = attenuationSum[dit](ivUp) + attenuation[dit](iv)*m_dx;
+    // T= (1-chi)*Ts + chi*Tl
+    // T = Ts + chi*(Tl-Ts)
+    for (BoxIterator bit(box); bit.ok(); ++bit)
+    {
+      IntVect iv = bit();
+      attenuation[dit](iv) = (solid_attenuation + porosity(iv)*(liquid_attenuation-solid_attenuation))*m_dx;
+    }
 
-         }
-         }
-       }
+    integralAbove[dit].setVal(0.0);
 
-    attenuationSum.exchange();
+    // Coarse intensity is at the bottom of each coarse cell, which is the top of this box
+    if (amrMLcrse && box.bigEnd(vertDir) < domainTop)
+    {
+      Box topRow = box;
+      topRow.setSmall(vertDir, box.bigEnd(vertDir));
 
+      for (BoxIterator bit(topRow); bit.ok(); ++bit)
+      {
+        IntVect ivAbove = bit() + BASISV(vertDir);
+        ivAbove.coarsen(nRefCrse);
+        integralAbove[dit](bit()) = -log10(crseIntensity[dit](ivAbove));
+      }
+    }
   }
 
+  m_radianceScan.sumDown(integral, attenuation, integralAbove);
 
-
-
-  // Compute intensity
-  for (DataIterator dit = attenuation.dataIterator(); dit.ok(); ++dit)
+  for (DataIterator dit = m_grids.dataIterator(); dit.ok(); ++dit)
   {
-    Box b = m_grids[dit];
-    for (BoxIterator bit = BoxIterator(b); bit.ok(); ++bit)
+    FArrayBox& intensity = (*m_scalarNew[ScalarVars::m_lightIntensity])[dit];
+    for (BoxIterator bit(m_grids[dit]); bit.ok(); ++bit)
     {
-      IntVect iv= bit();
-      (*m_scalarNew[ScalarVars::m_lightIntensity])[dit](iv) = pow(10, -attenuationSum[dit](iv));
+      IntVect iv = bit();
+      intensity(iv) = pow(10, -integral[dit](iv));
     }
-   }
-
-#endif
-
+  }
 
 }
 
-
 void AMRLevelMushyLayer::advectTracer(int a_tracerVar, LevelData<FArrayBox>& a_src)
 {
   LevelFluxRegister* coarserFRPtr = NULL;
@@ -12,12 +12,17 @@ void AMRLevelMushyLayer::computeViscosity()
 
       // Viscosity varies linearly with increasing solute concentration from 1.0 to max_viscosity
 
-      for (DataIterator dit = a_viscosity.dataIterator(); dit.ok(); ++dit)
+      DataIterator dit = a_viscosity.dataIterator();
+      int nbox = dit.size();
+
+#pragma omp parallel for
+      for (int ibox = 0; ibox < nbox; ibox++)
       {
-        FArrayBox& viscosity = a_viscosity[dit];
+        const DataIndex& din = dit[ibox];
+        FArrayBox& viscosity = a_viscosity[din];
 
         // Liquid concentration is between -composition ratio and 0
-        viscosity.copy(a_liquid_concentration[dit]);
+        viscosity.copy(a_liquid_concentration[din]);
 
         // This will make viscosity between 0 and 1.0
         viscosity.plus(m_parameters.compositionRatio);
@@ -200,9 +205,13 @@ void AMRLevelMushyLayer::fillAnalyticVel(LevelData<FArrayBox>& a_advVel)
 {
   DataIterator dit = m_grids.dataIterator();
 
-  for (dit.reset(); dit.ok(); ++dit)
+  int nbox = dit.size();
+
+#pragma omp parallel for
+  for (int ibox = 0; ibox < nbox; ibox++)
   {
-    FArrayBox& vel = a_advVel[dit];
+    const DataIndex& din = dit[ibox];
+    FArrayBox& vel = a_advVel[din];
     for (int dir=0; dir < SpaceDim; dir++)
     {
       fillAnalyticVel(vel, dir, dir, m_opt.projectAnalyticVel);
@@ -214,11 +223,15 @@ void AMRLevelMushyLayer::fillAnalyticVel(LevelData<FluxBox>& a_advVel)
 {
   DataIterator dit = m_grids.dataIterator();
 
-  for (dit.reset(); dit.ok(); ++dit)
+  int nbox = dit.size();
+
+#pragma omp parallel for
+  for (int ibox = 0; ibox < nbox; ibox++)
   {
+    const DataIndex& din = dit[ibox];
     for (int dir = 0; dir < SpaceDim; dir++)
     {
-      FArrayBox& velDir = a_advVel[dit][dir];
+      FArrayBox& velDir = a_advVel[din][dir];
       fillAnalyticVel(velDir, dir, 0, m_opt.projectAnalyticVel);
     }
   }
@@ -234,10 +247,14 @@ void AMRLevelMushyLayer::fillFixedPorosity(LevelData<FArrayBox>& a_porosity)
 
   Real innerRadius = m_opt.fixedPorosityFractionalInnerRadius*m_opt.domainWidth;
 
-  for (dit.reset(); dit.ok(); ++dit)
+  int nbox = dit.size();
+
+#pragma omp parallel for
+  for (int ibox = 0; ibox < nbox; ibox++)
   {
+    const DataIndex& din = dit[ibox];
 
-    BoxIterator bit(a_porosity[dit].box());
+    BoxIterator bit(a_porosity[din].box());
 
     for (bit.reset(); bit.ok(); ++bit)
     {
@@ -273,7 +290,7 @@ void AMRLevelMushyLayer::fillFixedPorosity(LevelData<FArrayBox>& a_porosity)
         porosity = min(porosity, maxPorosity);
 
         //initialDataPoiseuille(x, y, valNew,  m_porosity, -1);
-        a_porosity[dit](iv) = porosity;
+        a_porosity[din](iv) = porosity;
         //            (*m_scalarOld[ScalarVars::m_porosity])[dit](iv) = porosity;
 
       }
@@ -296,7 +313,7 @@ void AMRLevelMushyLayer::fillFixedPorosity(LevelData<FArrayBox>& a_porosity)
         porosity = max(porosity, 0.0);
 
         //initialDataPoiseuille(x, y, valNew,  m_porosity, -1);
-        a_porosity[dit](iv) = porosity;
+        a_porosity[din](iv) = porosity;
         //            (*m_scalarOld[ScalarVars::m_porosity])[dit](iv) = porosity;
 
       }
@@ -318,13 +335,13 @@ void AMRLevelMushyLayer::fillFixedPorosity(LevelData<FArrayBox>& a_porosity)
         porosity = max(porosity, 0.0);
 
         //initialDataPoiseuille(x, y, valNew,  m_porosity, -1);
-        a_porosity[dit](iv) = porosity;
+        a_porosity[din](iv) = porosity;
         //            (*m_scalarOld[ScalarVars::m_porosity])[dit](iv) = porosity;
       }
       else if (m_parameters.m_porosityFunction == ParamsPorosityFunctions::m_porosityConstant)
       {
         // Assume all boundary values are equal, and just pick one
-        a_porosity[dit](iv) = m_parameters.bcValPorosityLo[0];
+        a_porosity[din](iv) = m_parameters.bcValPorosityLo[0];
         //            (*m_scalarOld[ScalarVars::m_porosity])[dit](iv) = m_parameters.bcValPorosityLo[0];
       }
       else if (m_parameters.m_porosityFunction == ParamsPorosityFunctions::m_porosityTimeDependent)
@@ -342,7 +359,7 @@ void AMRLevelMushyLayer::fillFixedPorosity(LevelData<FArrayBox>& a_porosity)
         Real chi =  1-scale*pow(y/m_domainHeight, 2)*0.3*sin(M_PI*x/m_opt.domainWidth*2);
         chi = min(chi, 1.0);
         chi = max(chi, m_opt.lowerPorosityLimit);
-        a_porosity[dit](iv) = chi;
+        a_porosity[din](iv) = chi;
       }
 
     }
@@ -358,9 +375,14 @@ void AMRLevelMushyLayer::fillTCl(LevelData<FArrayBox>& a_phi, Real a_time,
   fillMultiComp(a_phi, a_time, m_temperature, m_liquidConcentration, doInterior, quadInterp, apply_bcs);
 
   BCHolder bc = m_physBCPtr->temperatureLiquidSalinityBC();
-  for (DataIterator dit = a_phi.dataIterator(); dit.ok(); ++dit)
+  DataIterator dit = a_phi.dataIterator();
+  int nbox = dit.size();
+
+#pragma omp parallel for
+  for (int ibox = 0; ibox < nbox; ibox++)
   {
-    bc(a_phi[dit], m_grids[dit], m_problem_domain, m_dx, false);
+    const DataIndex& din = dit[ibox];
+    bc(a_phi[din], m_grids[din], m_problem_domain, m_dx, false);
   }
 }
 
@@ -381,10 +403,15 @@ void AMRLevelMushyLayer::fillMultiComp(LevelData<FArrayBox>& a_phi, Real a_time,
   fillScalars(temp2, a_time, scal2, doInterior, quadInterp);
 
   // Need to do copying this way to transfer ghost cells
-  for (DataIterator dit = a_phi.dataIterator(); dit.ok(); ++dit)
+  DataIterator dit = a_phi.dataIterator();
+  int nbox = dit.size();
+
+#pragma omp parallel for
+  for (int ibox = 0; ibox < nbox; ibox++)
   {
-    a_phi[dit].copy(temp1[dit], 0, 0, 1);
-    a_phi[dit].copy(temp2[dit], 0, 1, 1);
+    const DataIndex& din = dit[ibox];
+    a_phi[din].copy(temp1[din], 0, 0, 1);
+    a_phi[din].copy(temp2[din], 0, 1, 1);
   }
 //
 //  fillScalars(a_phi, a_time, scal1, doInterior, quadInterp, 0, apply_bcs); // 0th component
@@ -401,9 +428,14 @@ void AMRLevelMushyLayer::fillHC(LevelData<FArrayBox>& a_phi, Real a_time,
   fillMultiComp(a_phi, a_time, ScalarVars::m_enthalpy, ScalarVars::m_bulkConcentration, doInterior, quadInterp, apply_bcs);
 
   BCHolder bc = m_physBCPtr->enthalpySalinityBC();
-  for (DataIterator dit = a_phi.dataIterator(); dit.ok(); ++dit)
+  DataIterator dit = a_phi.dataIterator();
+  int nbox = dit.size();
+
+#pragma omp parallel for
+  for (int ibox = 0; ibox < nbox; ibox++)
   {
-    bc(a_phi[dit], m_grids[dit], m_problem_domain, m_dx, false);
+    const DataIndex& din = dit[ibox];
+    bc(a_phi[din], m_grids[din], m_problem_domain, m_dx, false);
   }
 }
 
@@ -442,9 +474,13 @@ void AMRLevelMushyLayer::fillScalarFace(LevelData<FluxBox>& a_scal, Real a_time,
 
   // To make debugging easier
   DataIterator dit = temp.dataIterator();
-  for (dit.reset(); dit.ok(); ++dit)
+  int nbox = dit.size();
+
+#pragma omp parallel for
+  for (int ibox = 0; ibox < nbox; ibox++)
   {
-    a_scal[dit].setVal(0.0);
+    const DataIndex& din = dit[ibox];
+    a_scal[din].setVal(0.0);
   }
 
   if (smoothing > 0.0)
@@ -493,6 +529,11 @@ void AMRLevelMushyLayer::fillScalars(LevelData<FArrayBox>& a_scal, Real a_time,
     pout() << "AMRLevelMushyLayer::fillScalars - field: " << m_scalarVarNames[a_var] << ", level: " << m_level << endl;
   }
 
+  if (m_scalarNew[a_var].isNull())
+  {
+    MayDay::Error("AMRLevelMushyLayer::fillScalars - field is computed on demand, use scalarField() instead");
+  }
+
   //  const DisjointBoxLayout& levelGrids = m_grids;
   Interval scalComps = Interval(a_comp,a_comp);
   Interval srcComps = Interval(0,0);
@@ -508,7 +549,12 @@ void AMRLevelMushyLayer::fillScalars(LevelData<FArrayBox>& a_scal, Real a_time,
       pout() << "  AMRLevelMushyLayer::fillScalars - start interior filling, a_time:" << a_time << ", old_time: " << old_time << endl;
     }
 
-    if (abs(a_time - old_time) < TIME_EPS)
+    if (m_scalarOld[a_var].isNull())
+    {
+      // Only stored at the new time (see getNewTimeOnlyVars())
+      m_scalarNew[a_var]->copyTo(srcComps, a_scal, scalComps);
+    }
+    else if (abs(a_time - old_time) < TIME_EPS)
     {
       m_scalarOld[a_var]->copyTo(srcComps, a_scal, scalComps);
     } else if (abs(a_time - m_time) < TIME_EPS)
@@ -541,8 +587,8 @@ void AMRLevelMushyLayer::fillScalars(LevelData<FArrayBox>& a_scal, Real a_time,
     // fill in coarse-fine BC data by conservative linear interp
     AMRLevelMushyLayer& crseLevel = *getCoarserLevel();
 
-    LevelData<FArrayBox>& oldCrseScal = *(crseLevel.m_scalarOld[a_var]);
     LevelData<FArrayBox>& newCrseScal = *(crseLevel.m_scalarNew[a_var]);
+    LevelData<FArrayBox>& oldCrseScal = crseLevel.m_scalarOld[a_var].isNull() ? newCrseScal : *(crseLevel.m_scalarOld[a_var]);
 
     const DisjointBoxLayout& crseGrids = oldCrseScal.getBoxes();
     //    const ProblemDomain& crseDomain = crseLevel.problemDomain();
@@ -677,9 +723,13 @@ void AMRLevelMushyLayer::fillScalars(LevelData<FArrayBox>& a_scal, Real a_time,
 
     // loop over boxes
     DataIterator dit = a_scal.dataIterator();
-    for (dit.reset(); dit.ok(); ++dit)
+    int nbox = dit.size();
+
+#pragma omp parallel for
+    for (int ibox = 0; ibox < nbox; ibox++)
     {
-      thisBC(a_scal[dit], m_grids[dit], physDomain, m_dx, false); // inhomogeneous
+      const DataIndex& din = dit[ibox];
+      thisBC(a_scal[din], m_grids[din], physDomain, m_dx, false); // inhomogeneous
     }
 
   }
@@ -738,14 +788,18 @@ void AMRLevelMushyLayer::fillUnprojectedDarcyVelocity(LevelData<FluxBox>& a_advV
 
 //  int gravityDir = SpaceDim-1;
 
-  for (dit.reset(); dit.ok(); ++dit)
+  int nbox = dit.size();
+
+#pragma omp parallel for
+  for (int ibox = 0; ibox < nbox; ibox++)
   {
-    a_advVel[dit].setVal(0.0);
+    const DataIndex& din = dit[ibox];
+    a_advVel[din].setVal(0.0);
 
-    FArrayBox& fabVelz = a_advVel[dit][SpaceDim-1]; // for debugging
+    FArrayBox& fabVelz = a_advVel[din][SpaceDim-1]; // for debugging
 
-    fabVelz.plus(T_face[dit][SpaceDim-1],  m_parameters.m_buoyancyTCoeff);
-    fabVelz.plus(C_face[dit][SpaceDim-1], -m_parameters.m_buoyancySCoeff);
+    fabVelz.plus(T_face[din][SpaceDim-1],  m_parameters.m_buoyancyTCoeff);
+    fabVelz.plus(C_face[din][SpaceDim-1], -m_parameters.m_buoyancySCoeff);
 
     // Add the body force
 //    FArrayBox& bodyForce = (*m_vectorNew[VectorVars::m_bodyForce])[dit];
@@ -754,11 +808,11 @@ void AMRLevelMushyLayer::fillUnprojectedDarcyVelocity(LevelData<FluxBox>& a_advV
 
     for (int idir=0; idir<SpaceDim; idir++)
     {
-      a_advVel[dit][idir].mult(permeability_face[dit][idir]);
+      a_advVel[din][idir].mult(permeability_face[din][idir]);
 
       if (m_parameters.m_viscosityFunction != ViscosityFunction::uniformViscosity)
       {
-        a_advVel[dit][idir].divide(viscosity_face[dit][idir]);
+        a_advVel[din][idir].divide(viscosity_face[din][idir]);
       }
     }
 
@@ -777,13 +831,17 @@ void AMRLevelMushyLayer::fillPressureSrcTerm(LevelData<FArrayBox>& gradP,
 
   DataIterator dit = gradP.dataIterator();
 
-  for (dit.reset(); dit.ok(); ++dit)
+  int nbox = dit.size();
+
+#pragma omp parallel for
+  for (int ibox = 0; ibox < nbox; ibox++)
   {
+    const DataIndex& din = dit[ibox];
     if ((a_MACprojection && m_opt.scaleP_MAC) || (!a_MACprojection && m_opt.scaleP_CC))
     {
       for (int dir=0;dir<SpaceDim;dir++)
       {
-        gradP[dit].mult(pressureScale[dit], 0, dir);
+        gradP[din].mult(pressureScale[din], 0, dir);
       }
     }
   }
@@ -839,16 +897,21 @@ void AMRLevelMushyLayer::fillBuoyancy(LevelData<FArrayBox>& a_buoyancy,
                                       LevelData<FArrayBox>& a_porosity)
 {
 
-  for (DataIterator dit = a_buoyancy.dataIterator(); dit.ok(); ++dit)
+  DataIterator dit = a_buoyancy.dataIterator();
+  int nbox = dit.size();
+
+#pragma omp parallel for
+  for (int ibox = 0; ibox < nbox; ibox++)
   {
+    const DataIndex& din = dit[ibox];
     if (m_opt.buoyancy_zero_time >= 0 && m_time > m_opt.buoyancy_zero_time)
     {
-      a_buoyancy[dit].setVal(0);
+      a_buoyancy[din].setVal(0);
     }
     else
     {
-      fillBuoyancy(a_buoyancy[dit], a_temperature[dit], a_liquidConc[dit], a_porosity[dit],
-                   (*m_vectorNew[VectorVars::m_bodyForce])[dit]);
+      fillBuoyancy(a_buoyancy[din], a_temperature[din], a_liquidConc[din], a_porosity[din],
+                   (*m_vectorNew[VectorVars::m_bodyForce])[din]);
     }
   }
 }
@@ -39,14 +39,14 @@ void AMRLevelMushyLayer::writeAMRHierarchy(string filename)
     for (int vari = 0; vari < m_outputScalarVars.size(); vari++)
     {
       int thisVar = m_outputScalarVars[vari];
-      (*ml->m_scalarNew[thisVar]).copyTo(Interval(0, 0), *a_vectData[lev], Interval(startComp, startComp));
+      ml->scalarField(thisVar)->copyTo(Interval(0, 0), *a_vectData[lev], Interval(startComp, startComp));
       startComp = startComp+1;
     }
 
     for (int vari = 0; vari < m_outputVectorVars.size(); vari++)
     {
       int thisVar = m_outputVectorVars[vari];
-      (*ml->m_vectorNew[thisVar]).copyTo(Interval(0, SpaceDim-1), *a_vectData[lev], Interval(startComp, startComp+SpaceDim-1));
+      ml->vectorField(thisVar)->copyTo(Interval(0, SpaceDim-1), *a_vectData[lev], Interval(startComp, startComp+SpaceDim-1));
       startComp = startComp+SpaceDim;
     }
 
@@ -199,6 +199,7 @@ void
 AMRLevelMushyLayer::
 writeCheckpointLevel(HDF5Handle& a_handle) const
 {
+  CH_TIME("AMRLevelMushyLayer::writeCheckpointLevel");
   if (s_verbosity >= 3)
   {
     pout() << "AMRLevelMushyLayer::writeCheckpointLevel" << endl;
@@ -259,11 +260,19 @@ writeCheckpointLevel(HDF5Handle& a_handle) const
       pout() << "AMRLevelMushyLayer::writeCheckpointLevel - write scalar fields" << endl;
     }
 
+  // In asynchronous mode, snapshot the data now and write it once AMR has closed the file
   for (int i=0; i<numChkScalarComps; i++)
   {
     int var = m_chkScalarVars[i];
 
-    write(a_handle,*m_scalarNew[var],m_scalarVarNames[var]);
+    if (m_opt.asyncOutput)
+    {
+      s_asyncWriter.stageCopy(a_handle, label, m_scalarVarNames[var], *m_scalarNew[var]);
+    }
+    else
+    {
+      write(a_handle,*m_scalarNew[var],m_scalarVarNames[var]);
+    }
   }
 
 
@@ -275,7 +284,14 @@ writeCheckpointLevel(HDF5Handle& a_handle) const
   for (int i=0; i<numChkVectorComps; i++)
   {
     int var = m_chkVectorVars[i];
-    write(a_handle,*m_vectorNew[var],m_vectorVarNames[var]);
+    if (m_opt.asyncOutput)
+    {
+      s_asyncWriter.stageCopy(a_handle, label, m_vectorVarNames[var], *m_vectorNew[var]);
+    }
+    else
+    {
+      write(a_handle,*m_vectorNew[var],m_vectorVarNames[var]);
+    }
   }
 
   if (s_verbosity >= 3)
@@ -283,7 +299,14 @@ writeCheckpointLevel(HDF5Handle& a_handle) const
     pout() << "AMRLevelMushyLayer::writeCheckpointLevel - write adv vel" << endl;
   }
 
-  write(a_handle, m_advVel, "advVel");
+  if (m_opt.asyncOutput)
+  {
+    s_asyncWriter.stageCopy(a_handle, label, "advVel", m_advVel);
+  }
+  else
+  {
+    write(a_handle, m_advVel, "advVel");
+  }
 
   if (s_verbosity >= 3)
     {
@@ -600,18 +623,23 @@ writePlotHeader(HDF5Handle& a_handle) const
     pout() << "AMRLevelMushyLayer::writePlotHeader" << endl;
   }
 
+  // Only some fields may be due in this file
+  Vector<int> scalarVars, vectorVars;
+  getPlotVars(plotfileStep(a_handle), scalarVars, vectorVars);
+  int numComps = scalarVars.size() + SpaceDim*vectorVars.size();
+
   // Setup the number of components -- include space for error
   HDF5HeaderData header;
-  header.m_int["num_components"] = m_numOutputComps;
+  header.m_int["num_components"] = numComps;
 
   // Setup the component names
   char compStr[30];
-  Vector<string> varNames(m_numOutputComps);
-  getVarNames(varNames, m_outputScalarVars, m_outputVectorVars,
+  Vector<string> varNames(numComps);
+  getVarNames(varNames, scalarVars, vectorVars,
               m_scalarVarNames, m_vectorVarNames);
 
   int comp = 0;
-  for (comp = 0; comp < m_numOutputComps; ++comp)
+  for (comp = 0; comp < numComps; ++comp)
   {
     sprintf(compStr,"component_%d",comp);
     header.m_string[compStr] = varNames[comp];
@@ -637,12 +665,17 @@ void
 AMRLevelMushyLayer::
 writePlotLevel(HDF5Handle& a_handle) const
 {
+  CH_TIME("AMRLevelMushyLayer::writePlotLevel");
   if (s_verbosity >= 3)
   {
     pout() << "AMRLevelMushyLayer::writePlotLevel (level " << m_level << ")" << endl;
   }
 
 
+  // Work out which fields are due in this file (before we move to the level group)
+  Vector<int> scalarVars, vectorVars;
+  getPlotVars(plotfileStep(a_handle), scalarVars, vectorVars);
+
   // Setup the level string
   char levelStr[20];
   sprintf(levelStr,"%d",m_level);
@@ -680,41 +713,119 @@ writePlotLevel(HDF5Handle& a_handle) const
     write(a_handle,levelGrids);
 
 
-  // Write the data for this level
-  LevelData<FArrayBox> plotData(levelGrids, m_numOutputComps);
+  if (m_opt.plotSeparateFields)
+  {
+    // Write each field straight from its own level data, as in checkpoint files
+    for (int i=0; i < scalarVars.size(); i++)
+    {
+      int var = scalarVars[i];
+      RefCountedPtr<LevelData<FArrayBox> > scalar = scalarField(var);
+      const LevelData<FArrayBox>* field = &(*scalar);
+
+      // Subtract 1 from lambda before writing out. This needs a copy, but only of one field.
+      LevelData<FArrayBox> lambda;
+      if (var == m_lambda)
+      {
+        lambda.define(levelGrids, 1);
+        scalar->copyTo(lambda);
+        for (DataIterator dit = lambda.dataIterator(); dit.ok(); ++dit)
+        {
+          lambda[dit].plus(-1);
+        }
+        field = &lambda;
+      }
+
+      HDF5Compression compression = plotCompression(Vector<string>(1, m_scalarVarNames[var]));
 
-  // first copy data to plot data holder
+      if (m_opt.asyncOutput)
+      {
+        s_asyncWriter.stageCopy(a_handle, label, m_scalarVarNames[var], *field, compression);
+      }
+      else if (compression.active())
+      {
+        writeCompressed(a_handle, *field, m_scalarVarNames[var], compression);
+      }
+      else
+      {
+        write(a_handle, *field, m_scalarVarNames[var]);
+      }
+    }
+
+    for (int i=0; i < vectorVars.size(); i++)
+    {
+      int var = vectorVars[i];
+      RefCountedPtr<LevelData<FArrayBox> > vect = vectorField(var);
+      HDF5Compression compression = plotCompression(Vector<string>(1, m_vectorVarNames[var]));
 
+      if (m_opt.asyncOutput)
+      {
+        s_asyncWriter.stageCopy(a_handle, label, m_vectorVarNames[var], *vect, compression);
+      }
+      else if (compression.active())
+      {
+        writeCompressed(a_handle, *vect, m_vectorVarNames[var], compression);
+      }
+      else
+      {
+        write(a_handle, *vect, m_vectorVarNames[var]);
+      }
+    }
+  }
+  else
+  {
+    // Write the data for this level
+    int numComps = scalarVars.size() + SpaceDim*vectorVars.size();
+    LevelData<FArrayBox> plotData(levelGrids, numComps);
 
-    for (int i=0; i < m_outputScalarVars.size(); i++)
+    // first copy data to plot data holder
+    for (int i=0; i < scalarVars.size(); i++)
     {
-        m_scalarNew[m_outputScalarVars[i]]->copyTo(m_scalarNew[i]->interval(), plotData,
-                                                   Interval(i, i));
+      scalarField(scalarVars[i])->copyTo(Interval(0, 0), plotData, Interval(i, i));
 
-        // Subtract 1 from lambda before writing out
-        if (m_outputScalarVars[i] == m_lambda)
+      // Subtract 1 from lambda before writing out
+      if (scalarVars[i] == m_lambda)
+      {
+        for (DataIterator dit = plotData.dataIterator(); dit.ok(); ++dit)
         {
-          for (DataIterator dit = plotData.dataIterator(); dit.ok(); ++dit)
-          {
-            plotData[dit].plus(-1, i);
-          }
+          plotData[dit].plus(-1, i);
         }
+      }
     }
 
-
-
     Interval vecSrcComps(0, SpaceDim-1);
-    for (int i = 0; i<m_outputVectorVars.size(); i++)
+    for (int i = 0; i < vectorVars.size(); i++)
     {
-      int startComp = m_outputScalarVars.size() + (i*SpaceDim);
+      int startComp = scalarVars.size() + (i*SpaceDim);
       Interval destComps(startComp, startComp + SpaceDim-1);
 
-      m_vectorNew[m_outputVectorVars[i]]->copyTo(vecSrcComps, plotData, destComps);
-
+      vectorField(vectorVars[i])->copyTo(vecSrcComps, plotData, destComps);
     }
 
+    // All the fields share one dataset, so it's only single precision if they all are
+    Vector<string> fieldNames;
+    for (int i = 0; i < scalarVars.size(); i++)
+    {
+      fieldNames.push_back(m_scalarVarNames[scalarVars[i]]);
+    }
+    for (int i = 0; i < vectorVars.size(); i++)
+    {
+      fieldNames.push_back(m_vectorVarNames[vectorVars[i]]);
+    }
+    HDF5Compression compression = plotCompression(fieldNames);
 
-  write(a_handle,plotData,"data");
+    if (m_opt.asyncOutput)
+    {
+      s_asyncWriter.stageCopy(a_handle, label, "data", plotData, compression);
+    }
+    else if (compression.active())
+    {
+      writeCompressed(a_handle, plotData, "data", compression);
+    }
+    else
+    {
+      write(a_handle,plotData,"data");
+    }
+  }
 
 
   if (s_verbosity >= 5)
@@ -763,6 +874,79 @@ void AMRLevelMushyLayer::writePlotFile(int iter)
   handle.close();
 }
 
+int AMRLevelMushyLayer::plotfileStep(HDF5Handle& a_handle) const
+{
+  // AMR writes the iteration number to the root group before asking us for any data
+  a_handle.setGroup("/");
+
+  HDF5HeaderData header;
+  header.readFromFile(a_handle);
+
+  if (header.m_int.find("iteration") == header.m_int.end())
+  {
+    return 0;
+  }
+
+  return header.m_int["iteration"];
+}
+
+void AMRLevelMushyLayer::getPlotVars(int a_step, Vector<int>& a_scalarVars, Vector<int>& a_vectorVars) const
+{
+  a_scalarVars.resize(0);
+  a_vectorVars.resize(0);
+
+  for (int i = 0; i < m_outputScalarVars.size(); i++)
+  {
+    if (m_outputScalarIntervals[i] <= 1 || a_step % m_outputScalarIntervals[i] == 0)
+    {
+      a_scalarVars.push_back(m_outputScalarVars[i]);
+    }
+  }
+
+  for (int i = 0; i < m_outputVectorVars.size(); i++)
+  {
+    if (m_outputVectorIntervals[i] <= 1 || a_step % m_outputVectorIntervals[i] == 0)
+    {
+      a_vectorVars.push_back(m_outputVectorVars[i]);
+    }
+  }
+}
+
+HDF5Compression AMRLevelMushyLayer::plotCompression(const Vector<string>& a_fieldNames) const
+{
+  HDF5Compression compression;
+  compression.filter = m_opt.plotCompression;
+  compression.level = m_opt.plotCompressionLevel;
+  compression.lossyDigits = m_opt.plotLossyDigits;
+
+  compression.singlePrecision = (a_fieldNames.size() > 0);
+  for (int i = 0; i < a_fieldNames.size(); i++)
+  {
+    bool listed = false;
+    for (int j = 0; j < m_opt.plotSinglePrecisionVars.size(); j++)
+    {
+      const string& var = m_opt.plotSinglePrecisionVars[j];
+      if (var == "all" || findVarName(var, Vector<string>(1, a_fieldNames[i])) == 0)
+      {
+        listed = true;
+      }
+    }
+
+    if (!listed)
+    {
+      compression.singlePrecision = false;
+    }
+  }
+
+  return compression;
+}
+
+void AMRLevelMushyLayer::finishAsyncOutput()
+{
+  CH_TIME("AMRLevelMushyLayer::finishAsyncOutput");
+  s_asyncWriter.finish();
+}
+
 
 #endif
 
@@ -819,8 +1003,8 @@ void AMRLevelMushyLayer::computeVorticityStreamfunction()
 
   CH_TIME("AMRLevelMushyLayer::computeVorticityStreamfunction");
 
-  // First vorticity = curl (u)
-  computeVorticity();
+  // First vorticity = curl (u), which we only need on this level
+  RefCountedPtr<LevelData<FArrayBox> > vorticity = scalarField(ScalarVars::m_vorticity);
 
   // Now streamfunction psi - given by the solution to lap(psi) = - vorticity
 
@@ -864,16 +1048,17 @@ void AMRLevelMushyLayer::computeVorticityStreamfunction()
   solver.m_post = 4;
 
   // Construct RHS, including coarse BCs if necessary
+  // The solve only reads the RHS on this level, so the other levels don't need their vorticity
   Vector<LevelData<FArrayBox>* > amrPsi;
-  Vector<LevelData<FArrayBox>* > amrVorticity;
+  Vector<LevelData<FArrayBox>* > amrVorticity(nLevels, NULL);
 
   for (int lev = 0; lev < nLevels; lev++)
   {
     AMRLevelMushyLayer* ml = hierarchy[lev];
 
     amrPsi.push_back(&(*ml->m_scalarNew[ScalarVars::m_streamfunction]));
-    amrVorticity.push_back(&(*ml->m_scalarNew[ScalarVars::m_vorticity]));
   }
+  amrVorticity[m_level] = &(*vorticity);
 
   // now solve on this level
   solver.solve(amrPsi, amrVorticity, m_level,
@@ -881,7 +1066,7 @@ void AMRLevelMushyLayer::computeVorticityStreamfunction()
 
 }
 
-void AMRLevelMushyLayer::computeVorticity()
+void AMRLevelMushyLayer::computeVorticity(LevelData<FArrayBox>& a_vorticity) const
 {
   CH_TIME("AMRLevelMushyLayer::computeVorticity");
 
@@ -890,7 +1075,7 @@ void AMRLevelMushyLayer::computeVorticity()
   // this breaks the "const"-ness of the function,
   // but is necessary to ensure that boundary
   // conditions are properly set.
-  LevelData<FArrayBox>* velPtr = &(*m_vectorNew[VectorVars::m_fluidVel]);
+  const LevelData<FArrayBox>* velPtr = &(*m_vectorNew[VectorVars::m_fluidVel]);
   LevelData<FArrayBox>& vel =
       *(const_cast<LevelData<FArrayBox>*>(&*velPtr));
 
@@ -934,7 +1119,7 @@ void AMRLevelMushyLayer::computeVorticity()
         // will need to make a new data structure which has the write number of componenets for the dimensionality of the problem
 
         // and then compute vorticity
-//        FORT_COMPUTEVORT(CHF_FRA1((*m_scalarNew[ScalarVars::m_vorticity])[dit],dir),
+//        FORT_COMPUTEVORT(CHF_FRA1(a_vorticity[dit],dir),
 //                         CHF_CONST_FRA(vel[dit]),
 //                         CHF_BOX(grids[dit]),
 //                         CHF_CONST_REAL(m_dx),
@@ -944,7 +1129,7 @@ void AMRLevelMushyLayer::computeVorticity()
     else if (SpaceDim == 2)
     {
       int dir = 2;
-      FORT_COMPUTEVORT(CHF_FRA1((*m_scalarNew[ScalarVars::m_vorticity])[dit],0),
+      FORT_COMPUTEVORT(CHF_FRA1(a_vorticity[dit],0),
                        CHF_CONST_FRA(vel[dit]),
                        CHF_BOX(grids[dit]),
                        CHF_CONST_REAL(m_dx),
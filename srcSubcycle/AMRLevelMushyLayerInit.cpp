@@ -266,6 +266,59 @@ void AMRLevelMushyLayer::define(AMRLevel* a_coarserLevelPtr,
 
   }
 
+  // Replace the default output vars with any that have been explicitly requested
+  if (m_opt.plotScalarVars.size() > 0)
+  {
+    m_outputScalarVars.resize(0);
+    for (int i = 0; i < m_opt.plotScalarVars.size(); i++)
+    {
+      int var = findVarName(m_opt.plotScalarVars[i], m_scalarVarNames);
+      if (var < 0)
+      {
+        pout() << "Unknown scalar variable in main.plot_scalar_vars: " << m_opt.plotScalarVars[i] << endl;
+        MayDay::Error("Unknown scalar variable in main.plot_scalar_vars");
+      }
+      m_outputScalarVars.push_back(var);
+    }
+  }
+
+  if (m_opt.plotVectorVars.size() > 0)
+  {
+    m_outputVectorVars.resize(0);
+    for (int i = 0; i < m_opt.plotVectorVars.size(); i++)
+    {
+      int var = findVarName(m_opt.plotVectorVars[i], m_vectorVarNames);
+      if (var < 0)
+      {
+        pout() << "Unknown vector variable in main.plot_vector_vars: " << m_opt.plotVectorVars[i] << endl;
+        MayDay::Error("Unknown vector variable in main.plot_vector_vars");
+      }
+      m_outputVectorVars.push_back(var);
+    }
+  }
+
+  // By default, write every field to every plot file
+  m_outputScalarIntervals.resize(m_outputScalarVars.size(), 1);
+  m_outputVectorIntervals.resize(m_outputVectorVars.size(), 1);
+
+  if (m_opt.plotScalarIntervals.size() > 0)
+  {
+    if (m_opt.plotScalarIntervals.size() != m_outputScalarVars.size())
+    {
+      MayDay::Error("main.plot_scalar_intervals must have one entry for each of main.plot_scalar_vars");
+    }
+    m_outputScalarIntervals = m_opt.plotScalarIntervals;
+  }
+
+  if (m_opt.plotVectorIntervals.size() > 0)
+  {
+    if (m_opt.plotVectorIntervals.size() != m_outputVectorVars.size())
+    {
+      MayDay::Error("main.plot_vector_intervals must have one entry for each of main.plot_vector_vars");
+    }
+    m_outputVectorIntervals = m_opt.plotVectorIntervals;
+  }
+
   m_numOutputComps = m_outputScalarVars.size() + m_outputVectorVars.size()*SpaceDim;
 
   // Now sort out what we need for checkpoint files
@@ -312,6 +365,8 @@ void AMRLevelMushyLayer::defineCFInterp()
                                                  3, false);
     m_piecewiseLinearFillPatchScalarFour.define(m_grids, *crseGridsPtr,  1, crseDomain, nRefCrse,
                                                 4, false);
+    m_piecewiseLinearFillPatchVectorOne.define(m_grids, *crseGridsPtr,  SpaceDim, crseDomain, nRefCrse,
+                                               1, false);
 
   }
 }
@@ -622,13 +677,20 @@ void AMRLevelMushyLayer::defineUstarMultigrid()
   int nlevels = allGrids.size();
   int coarsestLevel  = 0;
 
-  Vector<RefCountedPtr<LevelData<FArrayBox> > > aCoef;
-  Vector<RefCountedPtr<LevelData<FluxBox> > > bCoef;
-  Vector<RefCountedPtr<LevelData<FArrayBox> > > cCoef;
+  // If the grid hierarchy hasn't changed since we last built the solvers,
+  // just refill the coefficients in place and keep the multigrid hierarchy
+  bool reuseSolvers = solverGridsUnchanged(m_uStarSolverGrids, allGrids);
 
-  aCoef.resize(nlevels);
-  bCoef.resize(nlevels);
-  cCoef.resize(nlevels);
+  if (!reuseSolvers)
+  {
+    m_uStarACoef.resize(nlevels);
+    m_uStarBCoef.resize(nlevels);
+    m_uStarCCoef.resize(nlevels);
+  }
+
+  Vector<RefCountedPtr<LevelData<FArrayBox> > >& aCoef = m_uStarACoef;
+  Vector<RefCountedPtr<LevelData<FluxBox> > >& bCoef = m_uStarBCoef;
+  Vector<RefCountedPtr<LevelData<FArrayBox> > >& cCoef = m_uStarCCoef;
 
   // I'm not sure we actually need this
   solverGrids.resize(nlevels);
@@ -654,13 +716,15 @@ void AMRLevelMushyLayer::defineUstarMultigrid()
 
     solverGrids[relativeLev] = levelGrids;
 
-    bCoef[relativeLev] = RefCountedPtr<LevelData<FluxBox> >(
-        new LevelData<FluxBox>(levelGrids, num_comp, ivGhost)); // = 1
-    aCoef[relativeLev] = RefCountedPtr<LevelData<FArrayBox> >(
-        new LevelData<FArrayBox>(levelGrids, num_comp, ivGhost)); // = 1
-    cCoef[relativeLev] = RefCountedPtr<LevelData<FArrayBox> >(
-        new LevelData<FArrayBox>(levelGrids, num_comp, ivGhost)); // = porosity.pi_0/(pi)
-
+    if (!reuseSolvers)
+    {
+      bCoef[relativeLev] = RefCountedPtr<LevelData<FluxBox> >(
+          new LevelData<FluxBox>(levelGrids, num_comp, ivGhost)); // = 1
+      aCoef[relativeLev] = RefCountedPtr<LevelData<FArrayBox> >(
+          new LevelData<FArrayBox>(levelGrids, num_comp, ivGhost)); // = 1
+      cCoef[relativeLev] = RefCountedPtr<LevelData<FArrayBox> >(
+          new LevelData<FArrayBox>(levelGrids, num_comp, ivGhost)); // = porosity.pi_0/(pi)
+    }
 
     // Only actually fill levels if they're at m_level or coarser
     if (lev <= m_level)
@@ -745,9 +809,22 @@ void AMRLevelMushyLayer::defineUstarMultigrid()
 
       BCHolder viscousBC = m_physBCPtr->velFuncBC(idir, m_opt.viscousBCs);
 
+      if (reuseSolvers)
+      {
+        // Operators already exist, just tell them the coefficients have changed
+        DarcyBrinkmanOpFactory* vcamrpop = dynamic_cast<DarcyBrinkmanOpFactory*>(&(*m_uStarOpFact[idir]));
+        CH_assert(vcamrpop != NULL);
+        vcamrpop->coefficientsChanged(viscousBC);
+
+        m_uStarAMRMG[idir]->setSolverParameters(m_opt.velMGNumSmooth, m_opt.velMGNumSmooth, m_opt.velMGNumSmooth,
+                                                m_opt.velMGNumMG, m_opt.VelMGMaxIter, m_opt.velMGTolerance, m_opt.velMGHang, m_opt.velMGNormThresh);
+        continue;
+      }
+
       RefCountedPtr<DarcyBrinkmanOpFactory> vcamrpop = RefCountedPtr<DarcyBrinkmanOpFactory>(new DarcyBrinkmanOpFactory());
       vcamrpop->define(lev0Dom, allGrids, refRat, lev0Dx, viscousBC,
                        0.0, aCoef, -1.0, bCoef, cCoef); // Note that we should set m_dt*etc in bCoef, not beta!
+      vcamrpop->m_relaxMode = m_opt.velMGRelaxMode;
 
       m_uStarOpFact[idir] = RefCountedPtr<AMRLevelOpFactory<LevelData<FArrayBox> > >(vcamrpop); // m_UstarVCAMRPOp[idir]);
 
@@ -758,6 +835,15 @@ void AMRLevelMushyLayer::defineUstarMultigrid()
                                               m_opt.velMGNumMG, m_opt.VelMGMaxIter, m_opt.velMGTolerance, m_opt.velMGHang, m_opt.velMGNormThresh);
     }
   }
+
+  if (!reuseSolvers)
+  {
+    // Integrators have to be rebuilt on top of the new multigrid solvers
+    m_uStarBE.resize(0);
+    m_uStarTGA.resize(0);
+  }
+
+  m_uStarSolverGrids = allGrids;
 }
 
 void AMRLevelMushyLayer::defineUstarSolver(     Vector<RefCountedPtr<LevelBackwardEuler> >& UstarBE,
@@ -779,16 +865,50 @@ void AMRLevelMushyLayer::defineUstarSolver(     Vector<RefCountedPtr<LevelBackwa
 
   defineUstarMultigrid();
 
-  UstarBE.resize(SpaceDim);
-  UstarTGA.resize(SpaceDim);
+  if (m_uStarBE.size() != SpaceDim || m_uStarTGA.size() != SpaceDim)
+  {
+    m_uStarBE.resize(SpaceDim);
+    m_uStarTGA.resize(SpaceDim);
+
+    for (int idir = 0; idir < SpaceDim; idir++)
+    {
+      // Now define Backward Euler for timestepping
+      m_uStarBE[idir] = RefCountedPtr<LevelBackwardEuler> (new LevelBackwardEuler(allGrids, refRat, lev0Dom, m_uStarOpFact[idir], m_uStarAMRMG[idir]));
+      m_uStarTGA[idir] = RefCountedPtr<LevelTGA> (new LevelTGA(allGrids, refRat, lev0Dom, m_uStarOpFact[idir], m_uStarAMRMG[idir]));
+    }
+  }
+
+  UstarBE = m_uStarBE;
+  UstarTGA = m_uStarTGA;
+}
 
-  for (int idir = 0; idir < SpaceDim; idir++)
+void AMRLevelMushyLayer::invalidateSolverCache()
+{
+  m_HCSolverGrids.resize(0);
+  m_uStarSolverGrids.resize(0);
+  m_uStarBE.resize(0);
+  m_uStarTGA.resize(0);
+}
+
+bool AMRLevelMushyLayer::solverGridsUnchanged(const Vector<DisjointBoxLayout>& a_cachedGrids,
+                                              const Vector<DisjointBoxLayout>& a_grids) const
+{
+  if (a_cachedGrids.size() == 0 || a_cachedGrids.size() != a_grids.size())
   {
-    // Now define Backward Euler for timestepping
-    UstarBE[idir] = RefCountedPtr<LevelBackwardEuler> (new LevelBackwardEuler(allGrids, refRat, lev0Dom, m_uStarOpFact[idir], m_uStarAMRMG[idir]));
-    UstarTGA[idir] = RefCountedPtr<LevelTGA> (new LevelTGA(allGrids, refRat, lev0Dom, m_uStarOpFact[idir], m_uStarAMRMG[idir]));
+    return false;
   }
 
+  // DisjointBoxLayout::operator== just checks whether the layouts share the same data,
+  // so this is cheap, and any level which has been regridded will compare unequal
+  for (int lev = 0; lev < a_grids.size(); lev++)
+  {
+    if (!(a_cachedGrids[lev] == a_grids[lev]))
+    {
+      return false;
+    }
+  }
+
+  return true;
 }
 
 
@@ -808,6 +928,16 @@ void AMRLevelMushyLayer::defineSolvers(Real a_time)
   IntVect ivGhost = m_numGhost * IntVect::Unit;
 
   s_botSolverHC.m_imax = m_opt.HCMultigridBottomSolveIterations;
+  m_directBotSolverHC.m_imax = m_opt.HCMultigridBottomSolveIterations;
+  m_directBotSolverHC.setNonlinear(true);
+  if (m_opt.HCMultigridUseRelaxBottomSolverForHC)
+  {
+    m_directBotSolverHC.setFallback(&s_botSolverHC);
+  }
+  else
+  {
+    m_directBotSolverHC.setFallback(&s_botSolverUStar);
+  }
 
   Vector<AMRLevelMushyLayer*> hierarchy;
   Vector<DisjointBoxLayout> grids;
@@ -830,7 +960,13 @@ void AMRLevelMushyLayer::defineSolvers(Real a_time)
 
   s_botSolverUStar.m_verbosity = max(m_opt.HCMultigridVerbosity - 2, 0);
   s_botSolverHC.m_verbosity = max(m_opt.HCMultigridVerbosity - 2, 0);
+  m_directBotSolverHC.m_verbosity = max(m_opt.HCMultigridVerbosity - 2, 0);
 
+  // If the grid hierarchy hasn't changed since we last built the solvers (i.e. no regridding),
+  // keep the operators and multigrid hierarchy and just update the coefficients in place
+  bool reuseSolvers = solverGridsUnchanged(m_HCSolverGrids, grids) && !m_HCOpFact.isNull();
+
+  if (!reuseSolvers)
   {
 
     CH_TIME("AMRLevelMushyLayer::defineSolvers::defineViscousOp");
@@ -868,16 +1004,14 @@ void AMRLevelMushyLayer::defineSolvers(Real a_time)
     pout() << "AMRLevelMushyLayer::defineSolvers - finished Ustar" << endl;
   }
 
-  Vector<RefCountedPtr<LevelData<FluxBox> > > porosityFace(numLevels);
-
-  Vector<RefCountedPtr<LevelData<FArrayBox> > > porosity(numLevels);
-
-  Vector<RefCountedPtr<LevelData<FArrayBox> > > enthalpy(numLevels);
-  Vector<RefCountedPtr<LevelData<FArrayBox> > > bulkConcentration(numLevels);
+  if (!reuseSolvers)
+  {
+    m_HCporosityFace.resize(numLevels);
+    m_HCaCoef.resize(numLevels);
+    m_HCbCoef.resize(numLevels);
+  }
 
-  Vector<RefCountedPtr<LevelData<FArrayBox> > > enthalpySolidus(numLevels);
-  Vector<RefCountedPtr<LevelData<FArrayBox> > > enthalpyLiquidus(numLevels);
-  Vector<RefCountedPtr<LevelData<FArrayBox> > > enthalpyEutectic(numLevels);
+  Vector<RefCountedPtr<LevelData<FluxBox> > >& porosityFace = m_HCporosityFace;
 
   //Get coarsest level
   AMRLevelMushyLayer* amrML = this;
@@ -892,15 +1026,10 @@ void AMRLevelMushyLayer::defineSolvers(Real a_time)
   while(amrML != NULL && lev < numLevels)
   {
 
-    porosityFace[lev] = RefCountedPtr<LevelData<FluxBox> >(new LevelData<FluxBox>(grids[lev], 1, IntVect::Zero));
-    //    porosity[lev] = RefCountedPtr<LevelData<FArrayBox> >(new LevelData<FArrayBox>(grids[lev], 1, ivGhost));
-
-//    enthalpy[lev] = RefCountedPtr<LevelData<FArrayBox> >(new LevelData<FArrayBox>(grids[lev], 1, ivGhost));
-//    bulkConcentration[lev] = RefCountedPtr<LevelData<FArrayBox> >(new LevelData<FArrayBox>(grids[lev], 1, ivGhost));
-
-    enthalpySolidus[lev] = RefCountedPtr<LevelData<FArrayBox> >(new LevelData<FArrayBox>(grids[lev], 1, ivGhost));
-    enthalpyLiquidus[lev] = RefCountedPtr<LevelData<FArrayBox> >(new LevelData<FArrayBox>(grids[lev], 1, ivGhost));
-    enthalpyEutectic[lev] = RefCountedPtr<LevelData<FArrayBox> >(new LevelData<FArrayBox>(grids[lev], 1, ivGhost));
+    if (!reuseSolvers)
+    {
+      porosityFace[lev] = RefCountedPtr<LevelData<FluxBox> >(new LevelData<FluxBox>(grids[lev], 1, IntVect::Zero));
+    }
 
     // Can only fill these at the current level or coarser
     bool secondOrder = true; // Should probably use quadratic CF interp here
@@ -921,11 +1050,6 @@ void AMRLevelMushyLayer::defineSolvers(Real a_time)
 
 //      amrML->fillScalars(*enthalpy[lev], a_time, ScalarVars::m_enthalpy, true , secondOrder);
 //      amrML->fillScalars(*bulkConcentration[lev], a_time, ScalarVars::m_bulkConcentration, true, secondOrder);
-
-      amrML->fillScalars(*enthalpySolidus[lev],a_time, ScalarVars::m_enthalpySolidus, true, secondOrder);
-      amrML->fillScalars(*enthalpyLiquidus[lev], a_time, ScalarVars::m_enthalpyLiquidus, true, secondOrder);
-      amrML->fillScalars(*enthalpyEutectic[lev],a_time, ScalarVars::m_enthalpyEutectic, true ,secondOrder);
-
     }
 
     amrML = amrML->getFinerLevel();
@@ -945,14 +1069,17 @@ void AMRLevelMushyLayer::defineSolvers(Real a_time)
   int Hcomp = 0;
   int Ccomp = 1;
 
-  Vector<RefCountedPtr<LevelData<FluxBox> > > bCoef(numLevels);
-  Vector<RefCountedPtr<LevelData<FArrayBox> > > aCoef(numLevels);
+  Vector<RefCountedPtr<LevelData<FluxBox> > >& bCoef = m_HCbCoef;
+  Vector<RefCountedPtr<LevelData<FArrayBox> > >& aCoef = m_HCaCoef;
 
   for (int lev=0; lev<numLevels; lev++)
   {
 
-    bCoef[lev] = RefCountedPtr<LevelData<FluxBox> >(new LevelData<FluxBox>(grids[lev], numComps, ivGhost));
-    aCoef[lev] = RefCountedPtr<LevelData<FArrayBox> >(new LevelData<FArrayBox>(grids[lev], numComps, ivGhost));
+    if (!reuseSolvers)
+    {
+      bCoef[lev] = RefCountedPtr<LevelData<FluxBox> >(new LevelData<FluxBox>(grids[lev], numComps, ivGhost));
+      aCoef[lev] = RefCountedPtr<LevelData<FArrayBox> >(new LevelData<FArrayBox>(grids[lev], numComps, ivGhost));
+    }
 
     for (DataIterator dit = bCoef[lev]->dataIterator(); dit.ok(); ++dit)
     {
@@ -999,11 +1126,25 @@ void AMRLevelMushyLayer::defineSolvers(Real a_time)
   // BCHolder HC_BC  = m_physBCPtr->enthalpySalinityBC(); // old version
   BCHolder HC_BC = m_physBCPtr->noFluxBC();
 
+  if (reuseSolvers)
+  {
+    // Existing operators pick up the new coefficients and (possibly time dependent) BCs
+    AMRNonLinearMultiCompOpFactory* HCop = dynamic_cast<AMRNonLinearMultiCompOpFactory*>(&(*m_HCOpFact));
+    CH_assert(HCop != NULL);
+    HCop->coefficientsChanged(HC_BC, temperature_Sl_BC);
+    m_directBotSolverHC.resetFactorisation();
+
+    m_multiCompFASMG->setSolverParameters(m_opt.HCMultigridNumSmoothDown, m_opt.HCMultigridNumSmoothUp, m_opt.HCMultigridNumSmoothUp, m_opt.HCMultigridNumMG,
+                                          m_opt.HCMultigridMaxIter, m_opt.HCMultigridTolerance, m_opt.HCMultigridHang, m_opt.HCMultigridNormThresh);
+    m_multiCompFASMG->m_verbosity = m_opt.HCMultigridVerbosity;
+
+    return;
+  }
+
 
   AMRNonLinearMultiCompOpFactory* HCop = new AMRNonLinearMultiCompOpFactory();
   HCop->define(lev0Dom, grids, refRat, lev0Dx, HC_BC,
                alpha, aCoef, beta, bCoef,
-               enthalpySolidus, enthalpyLiquidus, enthalpyEutectic,
                mlParamsPtr, temperature_Sl_BC,
                m_opt.HCMultigridRelaxMode, porosityEdgeBC, m_opt.apply_diagnostic_bcs);
 
@@ -1012,6 +1153,14 @@ void AMRLevelMushyLayer::defineSolvers(Real a_time)
     HCop->setSuperOptimised(true);
   }
 
+  HCop->setSweepsPerExchange(m_opt.HCMultigridSweepsPerExchange);
+
+  // Time the smoother on each box, to calibrate the load balancing cost model
+  if (m_opt.loadBalanceCostModel && m_opt.loadBalanceCalibrate)
+  {
+    HCop->timeSmoothing(m_grids);
+  }
+
   m_HCOpFact = RefCountedPtr<AMRLevelOpFactory<LevelData<FArrayBox> > >(HCop);
 
   int maxAMRlevels = hierarchy.size();
@@ -1024,10 +1173,25 @@ void AMRLevelMushyLayer::defineSolvers(Real a_time)
   {
     //FAS multigrid
 
-    m_multiCompFASMG = RefCountedPtr<AMRFASMultiGrid<LevelData<FArrayBox> > >(
-        new AMRFASMultiGrid<LevelData<FArrayBox> >());
+    if (m_opt.HCMultigridNewtonKrylov)
+    {
+      NewtonKrylovFASMultiGrid* newtonKrylovMG = new NewtonKrylovFASMultiGrid();
+      newtonKrylovMG->m_newtonMaxIter = m_opt.HCMultigridNewtonMaxIter;
+      newtonKrylovMG->m_krylovMaxIter = m_opt.HCMultigridKrylovMaxIter;
+      m_multiCompFASMG = RefCountedPtr<AMRFASMultiGrid<LevelData<FArrayBox> > >(newtonKrylovMG);
+    }
+    else
+    {
+      m_multiCompFASMG = RefCountedPtr<AMRFASMultiGrid<LevelData<FArrayBox> > >(
+          new AMRFASMultiGrid<LevelData<FArrayBox> >());
+    }
 
-    if (m_opt.HCMultigridUseRelaxBottomSolverForHC)
+    if (m_opt.HCMultigridDirectBottomSolver)
+    {
+      m_multiCompFASMG->define(lev0Dom, *m_HCOpFact, &m_directBotSolverHC,
+                               maxAMRlevels);
+    }
+    else if (m_opt.HCMultigridUseRelaxBottomSolverForHC)
     {
       m_multiCompFASMG->define(lev0Dom, *m_HCOpFact, &s_botSolverHC,
                                maxAMRlevels);
@@ -1061,6 +1225,8 @@ void AMRLevelMushyLayer::defineSolvers(Real a_time)
     MayDay::Error("Unknown multigrid type specified");
   }
 
+  m_HCSolverGrids = grids;
+
 }
 
 // Refactored this so we can call it in each timestep if necessary
@@ -1136,6 +1302,12 @@ void AMRLevelMushyLayer::define(MushyLayerOptions a_opt, MushyLayerParams a_para
   m_timestepReduced = false;
   m_timestepFailed = false;
 
+  if (m_opt.adaptiveDt)
+  {
+    m_dtController.define(m_opt.adaptiveDtTargetIterations, m_opt.adaptiveDtKI, m_opt.adaptiveDtKP,
+                          m_opt.adaptiveDtMinFactor, m_opt.max_dt_growth);
+  }
+
   m_adv_vel_centering = 0.5;
   m_dtReduction = -1;
 
@@ -1163,7 +1335,8 @@ void AMRLevelMushyLayer::define(MushyLayerOptions a_opt, MushyLayerParams a_para
     diag_timescale = 1.0;
   }
 
-  m_diagnostics.define(diag_timescale, s_verbosity, m_opt.steadyStateCondition/10);
+  m_diagnostics.define(diag_timescale, s_verbosity, m_opt.steadyStateCondition/10,
+                       m_opt.diagnosticsFormat, m_opt.diagnosticsFlushInterval);
 
   if (s_verbosity > 5)
   {
@@ -2142,11 +2315,9 @@ void AMRLevelMushyLayer::initialData()
 
     (*m_vectorNew[VectorVars::m_fluidVel])[dit].setVal(0.0);
     (*m_vectorOld[VectorVars::m_fluidVel])[dit].setVal(0.0);
-    (*m_dVector[VectorVars::m_fluidVel])[dit].setVal(0.0);
 
     (*m_vectorNew[VectorVars::m_bodyForce])[dit].setVal(m_parameters.body_force);
     (*m_vectorOld[VectorVars::m_bodyForce])[dit].setVal(m_parameters.body_force);
-    (*m_dVector[VectorVars::m_bodyForce])[dit].setVal(m_parameters.body_force);
 
     m_advVel[dit].setVal(0.0);
 
@@ -3323,7 +3494,7 @@ void AMRLevelMushyLayer::initialGrid(const Vector<Box>& a_newGrids)
   // Save original grids and load balance
   m_level_grids = a_newGrids;
   Vector<int> procs;
-  LoadBalance(procs, a_newGrids);
+  loadBalance(procs, a_newGrids);
   m_grids = DisjointBoxLayout(a_newGrids, procs, m_problem_domain);
 
   // We need to perform a check on the time here.
@@ -3364,7 +3535,6 @@ void AMRLevelMushyLayer::initDataStructures()
 
   m_vectorNew.resize(m_numVectorVars);
   m_vectorOld.resize(m_numVectorVars);
-  m_dVector.resize(m_numVectorVars);
   m_vectorRestart.resize(m_numVectorVars);
 }
 
@@ -3393,14 +3563,60 @@ void AMRLevelMushyLayer::createDataStructures()
   setValLevel(m_saltFluxBottom, 0.0);
   setValLevel(m_dPorosity_dt, 0.0);
 
+  // Derived fields which are never needed at the old time only get new time storage
+  Vector<int> newTimeOnlyVars, vectNewTimeOnlyVars;
+  getNewTimeOnlyVars(newTimeOnlyVars, vectNewTimeOnlyVars);
+
+  Vector<int> needOldScalar(m_numScalarVars, 1), needOldVector(m_numVectorVars, 1);
+  for (int i = 0; i < newTimeOnlyVars.size(); i++)
+  {
+    needOldScalar[newTimeOnlyVars[i]] = 0;
+  }
+  for (int i = 0; i < vectNewTimeOnlyVars.size(); i++)
+  {
+    needOldVector[vectNewTimeOnlyVars[i]] = 0;
+  }
+
+  // Fields we compute on demand don't get any storage
+  Vector<int> derivedVars, vectDerivedVars;
+  getDerivedVars(derivedVars, vectDerivedVars);
+
+  Vector<int> needNewScalar(m_numScalarVars, 1), needNewVector(m_numVectorVars, 1);
+  for (int i = 0; i < derivedVars.size(); i++)
+  {
+    needNewScalar[derivedVars[i]] = 0;
+    needOldScalar[derivedVars[i]] = 0;
+  }
+  for (int i = 0; i < vectDerivedVars.size(); i++)
+  {
+    needNewVector[vectDerivedVars[i]] = 0;
+    needOldVector[vectDerivedVars[i]] = 0;
+  }
+
+  // Scratch storage from the old grids is no use any more
+  m_scratchPool.resize(0);
+
   for (int scalarVar = 0; scalarVar < m_numScalarVars; scalarVar++)
   {
-    m_scalarNew[scalarVar] = RefCountedPtr<LevelData<FArrayBox> >(
-        new LevelData<FArrayBox>(m_grids, 1, ivGhost));
-    m_scalarOld[scalarVar] = RefCountedPtr<LevelData<FArrayBox> >(
-        new LevelData<FArrayBox>(m_grids, 1, ivGhost));
-    m_scalarRestart[scalarVar] = RefCountedPtr<LevelData<FArrayBox> >(
-        new LevelData<FArrayBox>(m_grids, 1, ivGhost));
+    if (needNewScalar[scalarVar])
+    {
+      m_scalarNew[scalarVar] = RefCountedPtr<LevelData<FArrayBox> >(
+          new LevelData<FArrayBox>(m_grids, 1, ivGhost));
+    }
+    else
+    {
+      m_scalarNew[scalarVar] = RefCountedPtr<LevelData<FArrayBox> >();
+    }
+
+    if (needOldScalar[scalarVar])
+    {
+      m_scalarOld[scalarVar] = RefCountedPtr<LevelData<FArrayBox> >(
+          new LevelData<FArrayBox>(m_grids, 1, ivGhost));
+    }
+    else
+    {
+      m_scalarOld[scalarVar] = RefCountedPtr<LevelData<FArrayBox> >();
+    }
   }
 
   for (int vectorVar = 0; vectorVar < m_numVectorVars; vectorVar++)
@@ -3415,14 +3631,43 @@ void AMRLevelMushyLayer::createDataStructures()
       ghost = ivGhost;
     }
 
-    m_vectorNew[vectorVar] = RefCountedPtr<LevelData<FArrayBox> >(
-        new LevelData<FArrayBox>(m_grids, SpaceDim, ghost));
-    m_vectorOld[vectorVar] = RefCountedPtr<LevelData<FArrayBox> >(
-        new LevelData<FArrayBox>(m_grids, SpaceDim, ghost));
-    m_dVector[vectorVar] = RefCountedPtr<LevelData<FArrayBox> >(
-        new LevelData<FArrayBox>(m_grids, SpaceDim, ghost));
+    if (needNewVector[vectorVar])
+    {
+      m_vectorNew[vectorVar] = RefCountedPtr<LevelData<FArrayBox> >(
+          new LevelData<FArrayBox>(m_grids, SpaceDim, ghost));
+    }
+    else
+    {
+      m_vectorNew[vectorVar] = RefCountedPtr<LevelData<FArrayBox> >();
+    }
+
+    if (needOldVector[vectorVar])
+    {
+      m_vectorOld[vectorVar] = RefCountedPtr<LevelData<FArrayBox> >(
+          new LevelData<FArrayBox>(m_grids, SpaceDim, ghost));
+    }
+    else
+    {
+      m_vectorOld[vectorVar] = RefCountedPtr<LevelData<FArrayBox> >();
+    }
+  }
+
+  // Only need space to back up the prognostic variables
+  Vector<int> backupVars, vectBackupVars;
+  getBackupVars(backupVars, vectBackupVars);
+
+  for (int i = 0; i < backupVars.size(); i++)
+  {
+    int scalarVar = backupVars[i];
+    m_scalarRestart[scalarVar] = RefCountedPtr<LevelData<FArrayBox> >(
+        new LevelData<FArrayBox>(m_grids, 1, m_scalarNew[scalarVar]->ghostVect()));
+  }
+
+  for (int i = 0; i < vectBackupVars.size(); i++)
+  {
+    int vectorVar = vectBackupVars[i];
     m_vectorRestart[vectorVar] = RefCountedPtr<LevelData<FArrayBox> >(
-        new LevelData<FArrayBox>(m_grids, SpaceDim, ghost));
+        new LevelData<FArrayBox>(m_grids, SpaceDim, m_vectorNew[vectorVar]->ghostVect()));
   }
 
   // When created, all our variables will have some bogus value 10^300
@@ -3774,6 +4019,8 @@ void AMRLevelMushyLayer::postInitialGrid(const bool a_restart)
       diagsToPrint.push_back(DiagnosticNames::diag_dTdt);
       diagsToPrint.push_back(DiagnosticNames::diag_chimneySpacing);
       diagsToPrint.push_back(DiagnosticNames::diag_chimneyWidth);
+      diagsToPrint.push_back(DiagnosticNames::diag_numChimneys);
+      diagsToPrint.push_back(DiagnosticNames::diag_chimneyDepth);
       diagsToPrint.push_back(DiagnosticNames::diag_HorizAvSalinity0);
       diagsToPrint.push_back(DiagnosticNames::diag_HorizAvSalinity20);
       diagsToPrint.push_back(DiagnosticNames::diag_HorizAvSalinity40);
@@ -3834,6 +4081,11 @@ void AMRLevelMushyLayer::shiftData(int dir, int distance)
 
   for (int scalarVar = 0; scalarVar < m_numScalarVars; scalarVar++)
   {
+    if (m_scalarNew[scalarVar].isNull())
+    {
+      continue;
+    }
+
     previousScal[scalarVar] = RefCountedPtr<LevelData<FArrayBox> >(
         new LevelData<FArrayBox>(m_grids, 1, ivGhost));
 
@@ -3843,6 +4095,11 @@ void AMRLevelMushyLayer::shiftData(int dir, int distance)
 
   for (int vectorVar = 0; vectorVar < m_numVectorVars; vectorVar++)
   {
+    if (m_vectorNew[vectorVar].isNull())
+    {
+      continue;
+    }
+
     previousVect[vectorVar] = RefCountedPtr<LevelData<FArrayBox> >(
         new LevelData<FArrayBox>(m_grids, SpaceDim, ivGhost));
 
@@ -3880,11 +4137,17 @@ void AMRLevelMushyLayer::shiftData(int dir, int distance)
 
       for (int scalarVar = 0; scalarVar < m_numScalarVars; scalarVar++)
       {
-        (*m_scalarNew[scalarVar])[dit](ivTo) = (*previousScal[scalarVar])[dit](ivFrom);
+        if (!m_scalarNew[scalarVar].isNull())
+        {
+          (*m_scalarNew[scalarVar])[dit](ivTo) = (*previousScal[scalarVar])[dit](ivFrom);
+        }
       }
       for (int var = 0; var < m_numVectorVars; var++)
       {
-        (*m_vectorNew[var])[dit](ivTo) = (*previousVect[var])[dit](ivFrom);
+        if (!m_vectorNew[var].isNull())
+        {
+          (*m_vectorNew[var])[dit](ivTo) = (*previousVect[var])[dit](ivFrom);
+        }
       }
     }
   }
@@ -3921,6 +4184,11 @@ void AMRLevelMushyLayer::reshapeData(DisjointBoxLayout newGrids, ProblemDomain n
   pout() << "Reshaping scalars" << endl;
   for (int scalarVar = 0; scalarVar < m_numScalarVars; scalarVar++)
   {
+    if (m_scalarNew[scalarVar].isNull())
+    {
+      continue;
+    }
+
     m_scalarNew[scalarVar]->copyTo(scalInterval, *previousScal, scalInterval);
     m_scalarNew[scalarVar]->define(newGrids, 1, ivGhost); //reshape
     previousScal->copyTo(scalInterval, *m_scalarNew[scalarVar], scalInterval); // copy back
@@ -3929,6 +4197,11 @@ void AMRLevelMushyLayer::reshapeData(DisjointBoxLayout newGrids, ProblemDomain n
   pout() << "Reshaping vectors" << endl;
   for (int vectorVar = 0; vectorVar < m_numVectorVars; vectorVar++)
   {
+    if (m_vectorNew[vectorVar].isNull())
+    {
+      continue;
+    }
+
     m_vectorNew[vectorVar]->copyTo(vectInterval, *previousVect, vectInterval);
     m_vectorNew[vectorVar]->define(newGrids, SpaceDim, ivGhost); //reshape
     previousVect->copyTo(vectInterval, *m_vectorNew[vectorVar], vectInterval); // copy back
@@ -3938,6 +4211,7 @@ void AMRLevelMushyLayer::reshapeData(DisjointBoxLayout newGrids, ProblemDomain n
   m_problem_domain = newDomain;
 
   m_grids = newGrids;
+  m_scratchPool.resize(0);
 
   // Extend in both directions as necessary
   for (int dir = 0; dir < SpaceDim; dir++)
@@ -3996,6 +4270,11 @@ void AMRLevelMushyLayer::reshapeData(DisjointBoxLayout newGrids, ProblemDomain n
             // Scalars
             for (int scalarVar = 0; scalarVar < m_numScalarVars; scalarVar++)
             {
+              if (m_scalarNew[scalarVar].isNull())
+              {
+                continue;
+              }
+
               FArrayBox& phi = (*m_scalarNew[scalarVar])[dit];
 
               phi.copy(phi, copyBox, 0, thisBorderBox, 0, 1);
@@ -4005,6 +4284,11 @@ void AMRLevelMushyLayer::reshapeData(DisjointBoxLayout newGrids, ProblemDomain n
             // Also need to do vectors in case U is time dependent
             for (int var = 0; var < m_numVectorVars; var++)
             {
+              if (m_vectorNew[var].isNull())
+              {
+                continue;
+              }
+
               FArrayBox& phi = (*m_vectorNew[var])[dit];
 
               phi.copy(phi, copyBox, 0, thisBorderBox, 0, SpaceDim);
@@ -1,4 +1,5 @@
 #include "AMRLevelMushyLayer.H"
+#include "DenseIntVectSet.H"
 
 void AMRLevelMushyLayer::setSmoothingCoeff(Real a_coeff)
 {
@@ -444,6 +445,8 @@ AMRLevelMushyLayer::defineRegridAMROp(AMRPoissonOpFactory& a_factory,
 
 void AMRLevelMushyLayer::tagCells(IntVectSet& a_tags)
 {
+  CH_TIME("AMRLevelMushyLayer::tagCells");
+
   if (s_verbosity >= 3)
   {
     pout() << "AMRLevelMushyLayer::tagCells " << m_level << endl;
@@ -470,29 +473,16 @@ void AMRLevelMushyLayer::tagCells(IntVectSet& a_tags)
   int finestLevel = ml->m_level;
 
 
-  // Compute liquid, mushy and inbetween cells - these will be useful
-  IntVectSet liquidCells;
+  // Evaluate the porosity based criteria in a single pass. Mushy cells are only
+  // needed by some refinement methods, so only collect them when required.
+  bool findMushy = (m_opt.refinementMethod != RefinementMethod::tagSpeed
+      && m_opt.refinementMethod != RefinementMethod::tagMushChannelsCompositeCriteria
+      && m_opt.refinementMethod != RefinementMethod::tagChannels
+      && m_opt.refinementMethod != RefinementMethod::tagScalar
+      && m_opt.refinementMethod != RefinementMethod::tagVector);
   IntVectSet mushyCells;
-  IntVectSet marginalCells;
-
-  for (DataIterator dit = m_grids.dataIterator(); dit.ok(); ++dit)
-  {
-    for (BoxIterator bit(m_grids[dit]); bit.ok(); ++bit)
-    {
-      if ((*m_scalarNew[ScalarVars::m_porosity])[dit](bit()) == 1.0)
-      {
-        liquidCells |= bit();
-      }
-      else if ((*m_scalarNew[ScalarVars::m_porosity])[dit](bit()) > m_opt.taggingMarginalPorosityLimit)
-      {
-        marginalCells |= bit();
-      }
-      else
-      {
-        mushyCells |= bit();
-      }
-    }
-  }
+  IntVectSet boundaryTags;
+  tagPorosityCriteria(mushyCells, boundaryTags, findMushy);
 
 
   if (m_opt.refinementMethod == RefinementMethod::tagSpeed) // m_opt.tag_velocity
@@ -546,17 +536,15 @@ void AMRLevelMushyLayer::tagCells(IntVectSet& a_tags)
                           CHF_BOX(b));
 
 
+          BaseFab<int> mask(b, 1);
           for (BoxIterator bit = BoxIterator(b); bit.ok(); ++bit)
           {
             IntVect iv = bit();
-            RealVect loc;
-            ::getLocation(iv, loc, m_dx);
 
-            if (taggingMetricFab(iv)*(1 - alpha*min(velocity(iv, SpaceDim-1) * (m_parameters.compositionRatio-bulkC(iv)), 0.0) ) > m_opt.refineThresh)
-            {
-              localTags |= iv;
-            }
+            mask(iv) = (taggingMetricFab(iv)*(1 - alpha*min(velocity(iv, SpaceDim-1) * (m_parameters.compositionRatio-bulkC(iv)), 0.0) ) > m_opt.refineThresh) ? 1 : 0;
           }
+
+          addMaskedCells(localTags, mask, b, 1);
         }
 
   }
@@ -575,19 +563,19 @@ void AMRLevelMushyLayer::tagCells(IntVectSet& a_tags)
       FArrayBox& porosity = (*m_scalarNew[m_porosity])[dit];
       FArrayBox& velocity = (*m_vectorNew[m_fluidVel])[dit];
 
+      BaseFab<int> mask(b, 1);
       for (BoxIterator bit = BoxIterator(b); bit.ok(); ++bit)
       {
         IntVect iv = bit();
         RealVect loc;
         ::getLocation(iv, loc, m_dx);
 
-        if (loc[1] > y_limit
+        mask(iv) = (loc[1] > y_limit
             && (porosity(iv) > porosity_limit
-                || abs(velocity(iv, 1)) > vel_limit ))
-        {
-          localTags |= iv;
-        }
+                || abs(velocity(iv, 1)) > vel_limit )) ? 1 : 0;
       }
+
+      addMaskedCells(localTags, mask, b, 1);
     }
 
     // Shrink the regrow tags invertical direction to get rid of individual odd cells
@@ -659,16 +647,13 @@ void AMRLevelMushyLayer::tagCells(IntVectSet& a_tags)
 
           Box b = concentrationVelocity[dit].box();
 
-          BoxIterator bit(b);
-          for (bit.begin(); bit.ok(); ++bit)
+          BaseFab<int> mask(b, 1);
+          for (BoxIterator bit(b); bit.ok(); ++bit)
           {
-            const IntVect& iv = bit();
-
-            if (concentrationVelocity[dit](iv) < -m_opt.refineThresh)
-            {
-              localTags |= iv;
-            }
+            mask(bit()) = (concentrationVelocity[dit](bit()) < -m_opt.refineThresh) ? 1 : 0;
           }
+
+          addMaskedCells(localTags, mask, b, 1);
         }
 
       }
@@ -811,30 +796,15 @@ void AMRLevelMushyLayer::tagCells(IntVectSet& a_tags)
   }
 
 
-  if (m_opt.tagMLboundary)
+  if (m_opt.tagMLboundary || m_opt.tagDomainBoundary)
   {
     if (s_verbosity >= 2)
     {
-      pout() << "AMRLevelMushyLayer::tagCells - also tag Mush-Liquid boundary " << endl;
+      pout() << "AMRLevelMushyLayer::tagCells - also tag Mush-Liquid boundary (" << m_opt.tagMLboundary
+          << ") and domain boundary (" << m_opt.tagDomainBoundary << ")" << endl;
     }
 
-
-
-    // Tag liquid-mush boundary and add to existing tags
-    tagMushLiquidBoundary(localTags);
-
-    // Tags cells with porosity < 1
-    //    tagMushyCells(localTags);
-  }
-
-  if (m_opt.tagDomainBoundary)
-  {
-    if (s_verbosity >= 2)
-    {
-      pout() << "AMRLevelMushyLayer::tagCells - also tag domain boundary " << endl;
-    }
-
-    tagBoundaryLayerCells(localTags);
+    localTags |= boundaryTags;
   }
 
   if (m_opt.tagCenterBoxSize > 0)
@@ -942,94 +912,105 @@ void AMRLevelMushyLayer::tagCells(IntVectSet& a_tags)
   a_tags = localTags;
 }
 
-void AMRLevelMushyLayer::tagMushyCells(IntVectSet& localTags)
+void AMRLevelMushyLayer::tagPorosityCriteria(IntVectSet& a_mushyCells, IntVectSet& a_boundaryTags,
+                                             bool a_findMushy)
 {
-  IntVectSet mushyCells;
+  CH_TIME("AMRLevelMushyLayer::tagPorosityCriteria");
 
-  for (DataIterator dit = m_grids.dataIterator(); dit.ok(); ++dit)
-  {
-    Box b = m_grids[dit];
-
-    FArrayBox& porosityFAB = (*m_scalarNew[ScalarVars::m_porosity])[dit];
-    for (BoxIterator bit(b); bit.ok(); ++bit)
-    {
-      IntVect iv = bit();
+  const int mushyBit = 1;
+  const int mushLiquidBit = 2;
+  const int domainBoundaryBit = 4;
 
+  bool tagMushLiquid = m_opt.tagMLboundary;
+  bool tagDomainBoundary = m_opt.tagDomainBoundary;
 
-      if (porosityFAB(iv) < 1)
-      {
-        mushyCells |=iv;
-      }
-    }
+  if (!a_findMushy && !tagMushLiquid && !tagDomainBoundary)
+  {
+    return;
   }
 
-  localTags |= mushyCells;
-}
-
-void AMRLevelMushyLayer::tagBoundaryLayerCells(IntVectSet& localTags)
-{
-  IntVectSet boundaryCells;
+  // Cells not in this box border the domain boundary
+  Box interiorBox(m_problem_domain.domainBox());
+  interiorBox.grow(-1);
 
-  Box domBox = m_problem_domain.domainBox();
-  Box interiorBox(domBox);
-  interiorBox.grow(-1); // contains all interior cells (ones we don't want to refine on)
+  const LevelData<FArrayBox>& porosity = *m_scalarNew[ScalarVars::m_porosity];
 
   for (DataIterator dit = m_grids.dataIterator(); dit.ok(); ++dit)
   {
-    Box b = m_grids[dit];
-
-    IntVectSet ivs(b);
+    const Box& b = m_grids[dit];
+    const FArrayBox& porosityFAB = porosity[dit];
 
-    // remove all ivs in the interior of the domain, leaving just those which border the domain boundary
-    ivs -= interiorBox;
+    // Only look for the mush-liquid boundary away from the box edges, so we
+    // never need porosity in ghost cells
+    Box bInterior(b);
+    bInterior.grow(-1);
 
-    //b -= interiorBox;
+    BaseFab<int> mask(b, 1);
+    mask.setVal(0);
 
-    boundaryCells |= ivs;
-
-  } // end loop over grids
-
-  localTags |= boundaryCells;
-
-}
-
-void AMRLevelMushyLayer::tagMushLiquidBoundary(IntVectSet& localTags)
-{
-  IntVectSet boundaryCells;
-
-  for (DataIterator dit = m_grids.dataIterator(); dit.ok(); ++dit)
-  {
-    Box b = m_grids[dit];
-    b.grow(-1); // shrink by 1 in all directions so we can search adjacent cells
-
-    FArrayBox& porosityFAB = (*m_scalarNew[ScalarVars::m_porosity])[dit];
     for (BoxIterator bit(b); bit.ok(); ++bit)
     {
-      IntVect iv = bit();
+      const IntVect& iv = bit();
+      Real thisPorosity = porosityFAB(iv);
+      int flags = 0;
 
-      bool nearbyCellIsLiquid = false;
-      // Check adjacent cells to see if one of them is liquid
-      for (int dir=0; dir<SpaceDim; dir++)
+      if (a_findMushy && thisPorosity != 1.0 && !(thisPorosity > m_opt.taggingMarginalPorosityLimit))
       {
-        IntVect ivUp =   iv + BASISV(dir);
-        IntVect ivDown = iv - BASISV(dir);
+        flags |= mushyBit;
+      }
 
-        if (porosityFAB(ivUp) == 1.0 || porosityFAB(ivDown) == 1.0)
+      if (tagMushLiquid && thisPorosity < 1.0 && bInterior.contains(iv))
+      {
+        // Check adjacent cells to see if one of them is liquid
+        for (int dir=0; dir<SpaceDim; dir++)
         {
-          nearbyCellIsLiquid = true;
+          if (porosityFAB(iv + BASISV(dir)) == 1.0 || porosityFAB(iv - BASISV(dir)) == 1.0)
+          {
+            flags |= mushLiquidBit;
+            break;
+          }
         }
       }
 
-      Real thisPorosity = porosityFAB(iv);
-      if (thisPorosity < 1.0 && nearbyCellIsLiquid)
+      if (tagDomainBoundary && !interiorBox.contains(iv))
       {
-        boundaryCells |= iv;
+        flags |= domainBoundaryBit;
       }
+
+      mask(iv) = flags;
+    }
+
+    if (a_findMushy)
+    {
+      addMaskedCells(a_mushyCells, mask, b, mushyBit);
+    }
+    if (tagMushLiquid || tagDomainBoundary)
+    {
+      addMaskedCells(a_boundaryTags, mask, b, mushLiquidBit | domainBoundaryBit);
     }
   }
+}
 
-  localTags |= boundaryCells;
+void AMRLevelMushyLayer::addMaskedCells(IntVectSet& a_tags, const BaseFab<int>& a_mask,
+                                        const Box& a_box, int a_bit)
+{
+  // Setting bits in a dense set is cheap, unlike adding cells one at a time to a_tags
+  DenseIntVectSet boxTags(a_box, false);
+  bool anyTagged = false;
 
+  for (BoxIterator bit(a_box); bit.ok(); ++bit)
+  {
+    if (a_mask(bit()) & a_bit)
+    {
+      boxTags |= bit();
+      anyTagged = true;
+    }
+  }
+
+  if (anyTagged)
+  {
+    a_tags |= IntVectSet(boxTags);
+  }
 }
 
 void AMRLevelMushyLayer::tagCenterCells(IntVectSet& localTags, Real radius)
@@ -1061,52 +1042,77 @@ void AMRLevelMushyLayer::tagCellsVar(IntVectSet& localTags, Real refineThresh,
                                      int taggingVectorVar,
                                      TaggingMethod taggingMethod,int comp)
 {
+  CH_TIME("AMRLevelMushyLayer::tagCellsVar");
+
   const DisjointBoxLayout& levelDomain =
       m_scalarNew[0]->disjointBoxLayout();
+
+  // Fields from getDerivedVars() have no storage of their own, so compute them into scratch
+  // storage with the same ghost cells as the stored fields
+  RefCountedPtr<LevelData<FArrayBox> > scalarTagField, vectorTagField;
+  if (taggingVar >= 0)
+  {
+    scalarTagField = m_scalarNew[taggingVar];
+    if (scalarTagField.isNull())
+    {
+      scalarTagField = scratchData(1, m_scalarNew[0]->ghostVect());
+      scalarField(taggingVar)->copyTo(*scalarTagField);
+    }
+  }
+
+  if (taggingVectorVar >= 0)
+  {
+    vectorTagField = m_vectorNew[taggingVectorVar];
+    if (vectorTagField.isNull())
+    {
+      vectorTagField = scratchData(SpaceDim, m_vectorNew[VectorVars::m_fluidVel]->ghostVect());
+      vectorField(taggingVectorVar)->copyTo(*vectorTagField);
+    }
+  }
+
   // If there is a coarser level interpolate undefined ghost cells
   if (m_hasCoarser)
   {
     const AMRLevelMushyLayer* amrGodCoarserPtr = getCoarserLevel();
 
-    if (taggingVar >= 0)
+    if (taggingVectorVar < 0 && taggingVar < 0)
     {
-
-      PiecewiseLinearFillPatch pwl(levelDomain,
-                                   amrGodCoarserPtr->m_scalarNew[0]->disjointBoxLayout(),
-                                   1, amrGodCoarserPtr->m_problem_domain,
-                                   amrGodCoarserPtr->m_ref_ratio, 1);
-
-      pwl.fillInterp(*m_scalarNew[taggingVar],
-                     *amrGodCoarserPtr->m_scalarNew[taggingVar],
-                     *amrGodCoarserPtr->m_scalarNew[taggingVar], 1.0, 0, 0, 1);
+      MayDay::Error("No valid tagging variable");
     }
 
-    if (taggingVectorVar >=0)
+    // The fill patch objects are redefined in levelSetup() whenever the grids change,
+    // so reuse them rather than building new ones every time we tag
+    if (!m_piecewiseLinearFillPatchScalarOne.isDefined()
+        || !m_piecewiseLinearFillPatchVectorOne.isDefined())
     {
-      PiecewiseLinearFillPatch pwl(levelDomain,
-                                   amrGodCoarserPtr->m_vectorNew[0]->disjointBoxLayout(),
-                                   SpaceDim, amrGodCoarserPtr->m_problem_domain,
-                                   amrGodCoarserPtr->m_ref_ratio, 1);
+      defineCFInterp();
+    }
 
-      pwl.fillInterp(*m_vectorNew[taggingVectorVar],
-                     *amrGodCoarserPtr->m_vectorNew[taggingVectorVar],
-                     *amrGodCoarserPtr->m_vectorNew[taggingVectorVar], 1.0, 0, 0, SpaceDim);
+    if (taggingVar >= 0)
+    {
+      RefCountedPtr<LevelData<FArrayBox> > coarseField = amrGodCoarserPtr->scalarField(taggingVar);
+      m_piecewiseLinearFillPatchScalarOne.fillInterp(*scalarTagField,
+                                                     *coarseField,
+                                                     *coarseField, 1.0, 0, 0, 1);
     }
 
-    if (taggingVectorVar < 0 && taggingVar < 0)
+    if (taggingVectorVar >=0)
     {
-      MayDay::Error("No valid tagging variable");
+      RefCountedPtr<LevelData<FArrayBox> > coarseField = amrGodCoarserPtr->vectorField(taggingVectorVar);
+      m_piecewiseLinearFillPatchVectorOne.fillInterp(*vectorTagField,
+                                                     *coarseField,
+                                                     *coarseField, 1.0, 0, 0, SpaceDim);
     }
   }
 
   if (taggingVar >= 0)
   {
-    m_scalarNew[taggingVar]->exchange(Interval(0, 1 - 1));
+    scalarTagField->exchange(Interval(0, 1 - 1));
   }
 
-  if (taggingVectorVar > 0)
+  if (taggingVectorVar >= 0)
   {
-    m_vectorNew[taggingVectorVar]->exchange(Interval(0, SpaceDim - 1));
+    vectorTagField->exchange(Interval(0, SpaceDim - 1));
   }
 
   // Compute undivided gradient
@@ -1120,19 +1126,19 @@ void AMRLevelMushyLayer::tagCellsVar(IntVectSet& localTags, Real refineThresh,
     UFab.setVal(0.0);
     if (taggingVar >= 0)
     {
-      UFab.plus((*m_scalarNew[taggingVar])[dit()]);
+      UFab.plus((*scalarTagField)[dit()]);
     }
     else
     {
       if (comp == -1)
       {
         // Get scalar magnitude of vector field
-        FORT_MAGNITUDEF(CHF_FRA1(UFab, 0), CHF_CONST_FRA((*m_vectorNew[taggingVectorVar])[dit()]),
+        FORT_MAGNITUDEF(CHF_FRA1(UFab, 0), CHF_CONST_FRA((*vectorTagField)[dit()]),
                         CHF_BOX(UFab.box()));
       }
       else
       {
-        UFab.plus((*m_vectorNew[taggingVectorVar])[dit()], comp, 0);
+        UFab.plus((*vectorTagField)[dit()], comp, 0);
       }
     }
 
@@ -1184,16 +1190,13 @@ void AMRLevelMushyLayer::tagCellsVar(IntVectSet& localTags, Real refineThresh,
 
 
     // Tag where gradient exceeds threshold
-    BoxIterator bit(b);
-    for (bit.begin(); bit.ok(); ++bit)
+    BaseFab<int> mask(b, 1);
+    for (BoxIterator bit(b); bit.ok(); ++bit)
     {
-      const IntVect& iv = bit();
-
-      if (taggingMetricFab(iv) >= refineThresh)
-      {
-        localTags |= iv;
-      }
+      mask(bit()) = (taggingMetricFab(bit()) >= refineThresh) ? 1 : 0;
     }
+
+    addMaskedCells(localTags, mask, b, 1);
   }
 }
 
@@ -1203,9 +1206,79 @@ void AMRLevelMushyLayer::tagCellsInit(IntVectSet& a_tags)
   tagCells(a_tags);
 }
 
+/*******/
+void AMRLevelMushyLayer::loadBalance(Vector<int>& a_procs, const Vector<Box>& a_boxes)
+{
+  CH_TIME("AMRLevelMushyLayer::loadBalance");
+
+  // New boxes don't have any data yet, so we estimate their porosity from the coarser level
+  AMRLevelMushyLayer* crseLevel = getCoarserLevel();
+
+  if (!m_opt.loadBalanceCostModel || crseLevel == NULL
+      || crseLevel->m_scalarNew.size() <= ScalarVars::m_porosity
+      || crseLevel->m_scalarNew[ScalarVars::m_porosity].isNull())
+  {
+    LoadBalance(a_procs, a_boxes);
+    return;
+  }
+
+  if (!m_boxCostModel.isDefined())
+  {
+    m_boxCostModel.define(m_opt.loadBalanceMushyCost, m_opt.loadBalanceSolidCost, m_opt.solidPorosity);
+  }
+
+  if (m_opt.loadBalanceCalibrate && m_boxCostModel.calibrate() && s_verbosity >= 2)
+  {
+    pout() << "AMRLevelMushyLayer::loadBalance (level " << m_level << ") - calibrated cell costs, mushy = "
+        << m_boxCostModel.cost(BoxCostModel::mushy) << ", solid = " << m_boxCostModel.cost(BoxCostModel::solid) << endl;
+  }
+
+  Vector<long long> loads;
+  m_boxCostModel.computeLoads(loads, a_boxes, *crseLevel->m_scalarNew[ScalarVars::m_porosity],
+                              crseLevel->m_ref_ratio);
+
+  LoadBalance(a_procs, loads, a_boxes);
+}
+
+/*******/
+void AMRLevelMushyLayer::recordBoxCosts()
+{
+  if (!m_opt.loadBalanceCostModel || !m_opt.loadBalanceCalibrate || m_HCOpFact.isNull()
+      || !m_boxCostModel.isDefined())
+  {
+    return;
+  }
+
+  AMRNonLinearMultiCompOpFactory* HCop = dynamic_cast<AMRNonLinearMultiCompOpFactory*>(&(*m_HCOpFact));
+  if (HCop == NULL)
+  {
+    return;
+  }
+
+  // Times are in the same order as the boxes in our DataIterator
+  Vector<Real> boxTimes;
+  HCop->smoothingTimes(boxTimes);
+  DataIterator dit = m_grids.dataIterator();
+  if (boxTimes.size() != dit.size())
+  {
+    return;
+  }
+
+  for (int ibox = 0; ibox < dit.size(); ibox++)
+  {
+    if (boxTimes[ibox] > 0)
+    {
+      Real counts[BoxCostModel::numCellTypes] = {0.0};
+      m_boxCostModel.countCells(counts, (*m_scalarNew[ScalarVars::m_porosity])[dit[ibox]], m_grids[dit[ibox]]);
+      m_boxCostModel.addSample(boxTimes[ibox], counts);
+    }
+  }
+}
+
 /*******/
 void AMRLevelMushyLayer::regrid(const Vector<Box>& a_newGrids)
 {
+  CH_TIME("AMRLevelMushyLayer::regrid");
   // Always print when we regrid
   if (s_verbosity >= 0)
   {
@@ -1234,6 +1307,12 @@ void AMRLevelMushyLayer::regrid(const Vector<Box>& a_newGrids)
     return;
   }
 
+  // Solvers built on the old grids can't be reused
+  invalidateSolverCache();
+
+  // Learn from how long the old boxes took before we replace them
+  recordBoxCosts();
+
   // Check if old grids existed
 //  if (m_grids.size() == 0)
 //  {
@@ -1251,7 +1330,7 @@ void AMRLevelMushyLayer::regrid(const Vector<Box>& a_newGrids)
 
   // Save original grids and load balance
   Vector<int> procs;
-  LoadBalance(procs, m_level_grids);
+  loadBalance(procs, m_level_grids);
   m_grids = DisjointBoxLayout(m_level_grids, procs, m_problem_domain);
 
   // Save data for later
@@ -1271,16 +1350,30 @@ void AMRLevelMushyLayer::regrid(const Vector<Box>& a_newGrids)
 
   for (int scalarVar = 0; scalarVar < m_numScalarVars; scalarVar++)
   {
-    scalarNew_OldGrids[scalarVar] = RefCountedPtr<LevelData<FArrayBox> >(
-        new LevelData<FArrayBox>(old_grids, 1, iv_ghost));
+    // Fields computed on demand have nothing to keep
+    if (m_scalarNew[scalarVar].isNull())
+    {
+      continue;
+    }
 
-    scalarOld_OldGrids[scalarVar] = RefCountedPtr<LevelData<FArrayBox> >(
+    scalarNew_OldGrids[scalarVar] = RefCountedPtr<LevelData<FArrayBox> >(
         new LevelData<FArrayBox>(old_grids, 1, iv_ghost));
 
     for (ditOld.reset(); ditOld.ok(); ++ditOld)
     {
       (*scalarNew_OldGrids[scalarVar])[ditOld].copy((*m_scalarNew[scalarVar])[ditOld]);
-      (*scalarOld_OldGrids[scalarVar])[ditOld].copy((*m_scalarOld[scalarVar])[ditOld]);
+    }
+
+    // Fields without old time data stay null
+    if (!m_scalarOld[scalarVar].isNull())
+    {
+      scalarOld_OldGrids[scalarVar] = RefCountedPtr<LevelData<FArrayBox> >(
+          new LevelData<FArrayBox>(old_grids, 1, iv_ghost));
+
+      for (ditOld.reset(); ditOld.ok(); ++ditOld)
+      {
+        (*scalarOld_OldGrids[scalarVar])[ditOld].copy((*m_scalarOld[scalarVar])[ditOld]);
+      }
     }
 
     //    m_scalarNew[scalarVar]->copyTo(m_scalarNew[scalarVar]->interval(),
@@ -1293,16 +1386,28 @@ void AMRLevelMushyLayer::regrid(const Vector<Box>& a_newGrids)
 
   for (int vectorVar = 0; vectorVar < m_numVectorVars; vectorVar++)
   {
-    vectorNew_OldGrids[vectorVar] = RefCountedPtr<LevelData<FArrayBox> >(
-        new LevelData<FArrayBox>(old_grids, SpaceDim, iv_ghost));
+    if (m_vectorNew[vectorVar].isNull())
+    {
+      continue;
+    }
 
-    vectorOld_OldGrids[vectorVar] = RefCountedPtr<LevelData<FArrayBox> >(
+    vectorNew_OldGrids[vectorVar] = RefCountedPtr<LevelData<FArrayBox> >(
         new LevelData<FArrayBox>(old_grids, SpaceDim, iv_ghost));
 
     for (ditOld.reset(); ditOld.ok(); ++ditOld)
     {
       (*vectorNew_OldGrids[vectorVar])[ditOld].copy((*m_vectorNew[vectorVar])[ditOld]);
-      (*vectorOld_OldGrids[vectorVar])[ditOld].copy((*m_vectorOld[vectorVar])[ditOld]);
+    }
+
+    if (!m_vectorOld[vectorVar].isNull())
+    {
+      vectorOld_OldGrids[vectorVar] = RefCountedPtr<LevelData<FArrayBox> >(
+          new LevelData<FArrayBox>(old_grids, SpaceDim, iv_ghost));
+
+      for (ditOld.reset(); ditOld.ok(); ++ditOld)
+      {
+        (*vectorOld_OldGrids[vectorVar])[ditOld].copy((*m_vectorOld[vectorVar])[ditOld]);
+      }
     }
 
     //    m_vectorNew[vectorVar]->copyTo(m_vectorNew[vectorVar]->interval(),
@@ -1344,19 +1449,30 @@ void AMRLevelMushyLayer::regrid(const Vector<Box>& a_newGrids)
     for (int scalarVar = 0; scalarVar < m_numScalarVars;
         scalarVar++)
     {
+      if (m_scalarNew[scalarVar].isNull())
+      {
+        continue;
+      }
+
       if (m_opt.scalarHOinterp)
       {
         scalarInterp4.interpToFine(*m_scalarNew[scalarVar],
                                    *(amrMushyLayerCoarserPtr->m_scalarNew[scalarVar]));
-        scalarInterp4.interpToFine(*m_scalarOld[scalarVar],
-                                   *(amrMushyLayerCoarserPtr->m_scalarOld[scalarVar]));
+        if (!m_scalarOld[scalarVar].isNull())
+        {
+          scalarInterp4.interpToFine(*m_scalarOld[scalarVar],
+                                     *(amrMushyLayerCoarserPtr->m_scalarOld[scalarVar]));
+        }
       }
       else
       {
         scalarInterp.interpToFine(*m_scalarNew[scalarVar],
                                   *(amrMushyLayerCoarserPtr->m_scalarNew[scalarVar]));
-        scalarInterp.interpToFine(*m_scalarOld[scalarVar],
-                                  *(amrMushyLayerCoarserPtr->m_scalarOld[scalarVar]));
+        if (!m_scalarOld[scalarVar].isNull())
+        {
+          scalarInterp.interpToFine(*m_scalarOld[scalarVar],
+                                    *(amrMushyLayerCoarserPtr->m_scalarOld[scalarVar]));
+        }
       }
 
     }
@@ -1364,20 +1480,30 @@ void AMRLevelMushyLayer::regrid(const Vector<Box>& a_newGrids)
     for (int vectorVar = 0; vectorVar < m_numVectorVars;
         vectorVar++)
     {
+      if (m_vectorNew[vectorVar].isNull())
+      {
+        continue;
+      }
 
       if (m_opt.vectorHOinterp)
       {
         vectorInterp4.interpToFine(*m_vectorNew[vectorVar],
                                    *(amrMushyLayerCoarserPtr->m_vectorNew[vectorVar]));
-        vectorInterp4.interpToFine(*m_vectorOld[vectorVar],
-                                   *(amrMushyLayerCoarserPtr->m_vectorOld[vectorVar]));
+        if (!m_vectorOld[vectorVar].isNull())
+        {
+          vectorInterp4.interpToFine(*m_vectorOld[vectorVar],
+                                     *(amrMushyLayerCoarserPtr->m_vectorOld[vectorVar]));
+        }
       }
       else
       {
         vectorInterp.interpToFine(*m_vectorNew[vectorVar],
                                   *(amrMushyLayerCoarserPtr->m_vectorNew[vectorVar]));
-        vectorInterp.interpToFine(*m_vectorOld[vectorVar],
-                                  *(amrMushyLayerCoarserPtr->m_vectorOld[vectorVar]));
+        if (!m_vectorOld[vectorVar].isNull())
+        {
+          vectorInterp.interpToFine(*m_vectorOld[vectorVar],
+                                    *(amrMushyLayerCoarserPtr->m_vectorOld[vectorVar]));
+        }
       }
 
     }
@@ -1388,29 +1514,44 @@ void AMRLevelMushyLayer::regrid(const Vector<Box>& a_newGrids)
 
   for (int scalarVar = 0; scalarVar < m_numScalarVars; scalarVar++)
   {
+    if (m_scalarNew[scalarVar].isNull())
+    {
+      continue;
+    }
 
     scalarNew_OldGrids[scalarVar]->copyTo(
         scalarNew_OldGrids[scalarVar]->interval(),
         *m_scalarNew[scalarVar],
         m_scalarNew[scalarVar]->interval());
 
-    scalarOld_OldGrids[scalarVar]->copyTo(
-        scalarOld_OldGrids[scalarVar]->interval(),
-        *m_scalarOld[scalarVar],
-        m_scalarOld[scalarVar]->interval());
+    if (!m_scalarOld[scalarVar].isNull())
+    {
+      scalarOld_OldGrids[scalarVar]->copyTo(
+          scalarOld_OldGrids[scalarVar]->interval(),
+          *m_scalarOld[scalarVar],
+          m_scalarOld[scalarVar]->interval());
+    }
   }
 
   for (int vectorVar = 0; vectorVar < m_numVectorVars; vectorVar++)
   {
+    if (m_vectorNew[vectorVar].isNull())
+    {
+      continue;
+    }
+
     vectorNew_OldGrids[vectorVar]->copyTo(
         vectorNew_OldGrids[vectorVar]->interval(),
         *m_vectorNew[vectorVar],
         m_vectorNew[vectorVar]->interval());
 
-    vectorOld_OldGrids[vectorVar]->copyTo(
-        vectorOld_OldGrids[vectorVar]->interval(),
-        *m_vectorOld[vectorVar],
-        m_vectorOld[vectorVar]->interval());
+    if (!m_vectorOld[vectorVar].isNull())
+    {
+      vectorOld_OldGrids[vectorVar]->copyTo(
+          vectorOld_OldGrids[vectorVar]->interval(),
+          *m_vectorOld[vectorVar],
+          m_vectorOld[vectorVar]->interval());
+    }
   }
 
   // Re calculate analytic solns on new grid
@@ -1457,6 +1598,11 @@ void AMRLevelMushyLayer::refine(Real ref_ratio, DisjointBoxLayout a_grids, Probl
 
   for (int scalarVar = 0; scalarVar < m_numScalarVars; scalarVar++)
   {
+    if (m_scalarNew[scalarVar].isNull())
+    {
+      continue;
+    }
+
 //    m_scalarNew[scalarVar]->copyTo(scalInterval, *previousScal, scalInterval);
     fillScalars(*previousScal, m_time, scalarVar, true, true);
     m_scalarNew[scalarVar]->define(a_grids, 1, ivGhost); //reshape
@@ -1472,6 +1618,11 @@ void AMRLevelMushyLayer::refine(Real ref_ratio, DisjointBoxLayout a_grids, Probl
 
   for (int vectorVar = 0; vectorVar < m_numVectorVars; vectorVar++)
   {
+    if (m_vectorNew[vectorVar].isNull())
+    {
+      continue;
+    }
+
     m_vectorNew[vectorVar]->copyTo(vectInterval, *previousVect, vectInterval);
     m_vectorNew[vectorVar]->define(a_grids, SpaceDim, ivGhost); //reshape
     if (m_opt.regrid_linear_interp)
@@ -1487,10 +1638,12 @@ void AMRLevelMushyLayer::refine(Real ref_ratio, DisjointBoxLayout a_grids, Probl
   //  ProblemDomain oldDomain = m_problem_domain;
   m_problem_domain = a_domain;
   m_grids = a_grids;
+  m_scratchPool.resize(0);
 }
 
 void AMRLevelMushyLayer::postRegrid(int a_base_level)
 {
+  CH_TIME("AMRLevelMushyLayer::postRegrid");
   if (s_verbosity >= 3)
   {
     pout() << "AMRLevelMushyLayer::postRegrid (level " << m_level << ")" << endl;
@@ -1538,6 +1691,7 @@ void AMRLevelMushyLayer::postRegrid(int a_base_level)
 
   //Need to ensure this is done on the base level
   levelSetup();
+  invalidateSolverCache();
   defineSolvers(m_time); // not entirely sure time this should be
 
   if (m_level == 0 && m_opt.doProjection)
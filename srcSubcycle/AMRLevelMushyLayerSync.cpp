@@ -367,10 +367,18 @@ void AMRLevelMushyLayer::postTimeStep()
       {
         mlPtr->m_timestepFailed = timestepFailed; // Store this on every level
 
+        if (timestepFailed)
+        {
+          mlPtr->m_dtController.rejectStep();
+        }
+
         // Try turning this off - just halve dt
         if (m_opt.solverFailRestartMethod == m_restartResetData)
         {
-          restartTimestepFromBackup(); // why was this turned off?
+          mlPtr->restartTimestepFromBackup(); // why was this turned off?
+
+          // Derived fields weren't backed up, so recompute them from the restored state
+          mlPtr->updateEnthalpyVariables();
         }
 
         // Always halve dt
@@ -430,6 +438,10 @@ void AMRLevelMushyLayer::postTimeStep()
     for (int scalarVar = 0; scalarVar < m_numScalarVars;
         scalarVar++)
     {
+      if (m_scalarNew[scalarVar].isNull())
+      {
+        continue;
+      }
 
       fineAMRMLPtr->m_coarseAverageScalar.averageToCoarse(
           *m_scalarNew[scalarVar],
@@ -440,6 +452,11 @@ void AMRLevelMushyLayer::postTimeStep()
     for (int vectorVar = 0; vectorVar < m_numVectorVars;
         vectorVar++)
     {
+      if (m_vectorNew[vectorVar].isNull())
+      {
+        continue;
+      }
+
       fineAMRMLPtr->m_coarseAverageVector.averageToCoarse(
           *m_vectorNew[vectorVar],
           *(fineAMRMLPtr->m_vectorNew[vectorVar]));
@@ -743,16 +760,7 @@ void AMRLevelMushyLayer::postTimeStep()
     AMRLevelMushyLayer* AMRmlptr = this;
     while (AMRmlptr != NULL)
     {
-      DataIterator dit = (*AMRmlptr->m_vectorNew[VectorVars::m_fluidVelErr]).dataIterator();
-      for (dit.reset(); dit.ok(); ++dit)
-      {
-        (*AMRmlptr->m_vectorNew[VectorVars::m_fluidVelErr])[dit].setVal(0);
-        (*AMRmlptr->m_vectorNew[VectorVars::m_fluidVelErr])[dit].plus((*AMRmlptr->m_vectorNew[VectorVars::m_fluidVel])[dit]);
-        (*AMRmlptr->m_vectorNew[VectorVars::m_fluidVelErr])[dit].minus((*AMRmlptr->m_vectorNew[VectorVars::m_fluidVelAnalytic])[dit]);
-
-        (*AMRmlptr->m_scalarNew[ScalarVars::m_Terr])[dit].copy((*AMRmlptr->m_scalarNew[ScalarVars::m_temperatureAnalytic])[dit]);
-        (*AMRmlptr->m_scalarNew[ScalarVars::m_Terr])[dit].minus((*AMRmlptr->m_scalarNew[ScalarVars::m_temperature])[dit]);
-      }
+      // Errors against the analytic solutions are computed when they're plotted (see getDerivedVars())
 
       // Backup data from this timestep
       AMRmlptr->backupTimestep();
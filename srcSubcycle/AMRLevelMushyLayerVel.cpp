@@ -298,7 +298,7 @@ void AMRLevelMushyLayer::calculateTimeIndAdvectionVel(Real time, LevelData<FluxB
     a_advVel.exchange();
     int exitStatus = m_projection.levelMacProject(a_advVel, m_dt, crsePressurePtr, pressureScalePtr,
                                  crsePressureScalePtr, pressureScaleEdgePtr, crsePressureScaleEdgePtr,
-                                 alreadyHasPressure, correctScale);
+                                 alreadyHasPressure, correctScale, time);
 
     correctScale = correctScale/10;
 //    correctScale = 0.0;
@@ -310,6 +310,8 @@ void AMRLevelMushyLayer::calculateTimeIndAdvectionVel(Real time, LevelData<FluxB
     pout() << "  MAC Projection (level "<< m_level << "): exit status = " << exitStatus
         << ", max(div u) = " << maxDivU << ", min pressure = " << minPressure << endl;
 
+    m_dtController.addSolve(-1, !(exitStatus == 2 || exitStatus == 4 || exitStatus == 6));
+
 
 
     proj_i++;
@@ -523,9 +525,13 @@ AMRLevelMushyLayer::computeAdvectionVelocities(LevelData<FArrayBox>& advectionSo
       // traceAdvectionVel will replce m_advVel with the upwinded U_to_advect
       if ( m_opt.advectionMethod == m_porosityInAdvection)
       {
-        for (dit.reset(); dit.ok(); ++dit)
+        int nbox = dit.size();
+
+#pragma omp parallel for
+        for (int ibox = 0; ibox < nbox; ibox++)
         {
-          m_advVel[dit].mult((*porosityFaceAvPtr)[dit], m_advVel[dit].box(), 0, 0);
+          const DataIndex& din = dit[ibox];
+          m_advVel[din].mult((*porosityFaceAvPtr)[din], m_advVel[din].box(), 0, 0);
         }
       }
 
@@ -769,9 +775,13 @@ void AMRLevelMushyLayer::computeCCvelocity(const LevelData<FArrayBox>& advection
   }
 
   //Put Ustar into U for projection
-  for (dit.reset(); dit.ok(); ++dit)
+  int nbox = dit.size();
+
+#pragma omp parallel for
+  for (int ibox = 0; ibox < nbox; ibox++)
   {
-    (*m_vectorNew[uvar])[dit].copy((*m_vectorNew[ustarVar])[dit]);
+    const DataIndex& din = dit[ibox];
+    (*m_vectorNew[uvar])[din].copy((*m_vectorNew[ustarVar])[din]);
   }
 
   // need to do physical boundary conditions and exchanges
@@ -794,10 +804,14 @@ void AMRLevelMushyLayer::computeCCvelocity(const LevelData<FArrayBox>& advection
       fillPressureSrcTerm(gradP, pressureScale, old_time-a_dt/2, a_MACprojection);
 
 
-      for (dit.reset(); dit.ok(); ++dit)
+      int nbox = dit.size();
+
+#pragma omp parallel for
+      for (int ibox = 0; ibox < nbox; ibox++)
       {
-        gradP[dit] *= a_dt ;
-        (*m_vectorNew[uvar])[dit] += gradP[dit];
+        const DataIndex& din = dit[ibox];
+        gradP[din] *= a_dt ;
+        (*m_vectorNew[uvar])[din] += gradP[din];
       }
     }
 
@@ -806,9 +820,11 @@ void AMRLevelMushyLayer::computeCCvelocity(const LevelData<FArrayBox>& advection
                  m_dx, false); // inhomogeneous
   m_vectorNew[uvar]->exchange();
 
-  for (dit.reset(); dit.ok(); ++dit)
+#pragma omp parallel for
+  for (int ibox = 0; ibox < nbox; ibox++)
   {
-    (*m_vectorNew[uPreprojectionVar])[dit].copy((*m_vectorNew[uvar])[dit]);
+    const DataIndex& din = dit[ibox];
+    (*m_vectorNew[uPreprojectionVar])[din].copy((*m_vectorNew[uvar])[din]);
   }
 
 
@@ -1016,9 +1032,13 @@ void AMRLevelMushyLayer::computeLapVel(LevelData<FArrayBox>& a_lapVel,
       BCHolder bc = m_physBCPtr->extrapolationFuncBC(m_opt.lapVelBCOrder);
       const DisjointBoxLayout& grids = a_lapVel.getBoxes();
       DataIterator dit = a_lapVel.dataIterator();
-      for (dit.reset(); dit.ok(); ++dit)
+      int nbox = dit.size();
+
+#pragma omp parallel for
+      for (int ibox = 0; ibox < nbox; ibox++)
       {
-        bc(a_lapVel[dit], grids[dit], m_problem_domain, m_dx, false); // not homogeneous
+        const DataIndex& din = dit[ibox];
+        bc(a_lapVel[din], grids[din], m_problem_domain, m_dx, false); // not homogeneous
       }
     }
   }
@@ -1487,6 +1507,7 @@ void AMRLevelMushyLayer::computeAdvectionVelSourceTerm(LevelData<FArrayBox>& a_s
 
   //Apply BCs to grad(P) term - extrapolation
   DataIterator dit = m_grids.dataIterator();
+  int nbox = dit.size();
   BCHolder bcExtrap = m_physBCPtr->extrapFuncBC();
 
   //  m_projection.gradPiBCs(pressure, true);
@@ -1528,9 +1549,12 @@ void AMRLevelMushyLayer::computeAdvectionVelSourceTerm(LevelData<FArrayBox>& a_s
 //    if (recomputeLapVel)
 //    {
       computeLapVel(viscous, velOld, crseVelPtr);
-      for (dit.reset(); dit.ok(); ++dit)
+
+#pragma omp parallel for
+      for (int ibox = 0; ibox < nbox; ibox++)
       {
-        (*m_vectorNew[VectorVars::m_advSrcLapU])[dit].copy(viscous[dit]);
+        const DataIndex& din = dit[ibox];
+        (*m_vectorNew[VectorVars::m_advSrcLapU])[din].copy(viscous[din]);
       }
 
 //    }
@@ -1545,9 +1569,11 @@ void AMRLevelMushyLayer::computeAdvectionVelSourceTerm(LevelData<FArrayBox>& a_s
   }
   else
   {
-    for (dit.reset(); dit.ok(); ++dit)
+#pragma omp parallel for
+    for (int ibox = 0; ibox < nbox; ibox++)
     {
-      viscous[dit].setVal(0.0);
+      const DataIndex& din = dit[ibox];
+      viscous[din].setVal(0.0);
     }
   }
 
@@ -1556,55 +1582,60 @@ void AMRLevelMushyLayer::computeAdvectionVelSourceTerm(LevelData<FArrayBox>& a_s
 
 
 
-  for (dit.reset(); dit.ok(); ++dit)
+
+#pragma omp parallel for
+  for (int ibox = 0; ibox < nbox; ibox++)
   {
-    darcy[dit].setVal(0.0);
-    darcy[dit] += velOld[dit];
+    const DataIndex& din = dit[ibox];
+    darcy[din].setVal(0.0);
+    darcy[din] += velOld[din];
 
     // Divide each component of this term by the (scalar) permeability
     for (int dir = 0; dir < SpaceDim; dir++)
     {
-      darcy[dit].divide(permeability[dit],
-                        darcy[dit].box(), 0, dir);
+      darcy[din].divide(permeability[din],
+                        darcy[din].box(), 0, dir);
 
-      darcy[dit].mult(porosity[dit],
-                      darcy[dit].box(), 0, dir);
+      darcy[din].mult(porosity[din],
+                      darcy[din].box(), 0, dir);
 
       //TODO: add viscosity in here
 
 
     }
 
-    darcy[dit].mult(m_parameters.m_darcyCoeff);
-    viscous[dit].mult(m_parameters.m_viscosityCoeff);
+    darcy[din].mult(m_parameters.m_darcyCoeff);
+    viscous[din].mult(m_parameters.m_viscosityCoeff);
 
   }
 
   // Finally, set darcy src term=0 near CF interface
   setVelZero(darcy, m_opt.advVelsrcChiLimit, 2); // set to zero up to 2 cells from interface
 
-  for (dit.reset(); dit.ok(); ++dit)
+#pragma omp parallel for
+  for (int ibox = 0; ibox < nbox; ibox++)
   {
-    a_src[dit].setVal(0.0);
+    const DataIndex& din = dit[ibox];
+    a_src[din].setVal(0.0);
 
     if (viscousSrc)
     {
-      a_src[dit] += viscous[dit];
+      a_src[din] += viscous[din];
     }
 
     if (m_opt.advVelPressureSrc)
     {
-      a_src[dit] -= pressure[dit];
+      a_src[din] -= pressure[din];
     }
 
     if (m_opt.advVelBuoyancySrc)
     {
-      a_src[dit] += buoyancy[dit];
+      a_src[din] += buoyancy[din];
     }
 
     if (darcySrc)
     {
-      a_src[dit] -= darcy[dit];
+      a_src[din] -= darcy[din];
     }
 
 
@@ -1618,23 +1649,25 @@ void AMRLevelMushyLayer::computeAdvectionVelSourceTerm(LevelData<FArrayBox>& a_s
 
     Gradient::levelGradientCC(extraSrc, porosity, m_dx, extraSrc.ghostVect()[0]);
 
-    for (DataIterator dit = extraSrc.dataIterator(); dit.ok(); ++dit)
+#pragma omp parallel for
+    for (int ibox = 0; ibox < nbox; ibox++)
     {
+      const DataIndex& din = dit[ibox];
       for (int dir=0; dir < SpaceDim; dir++)
       {
         // Make u.grad(porosity)
-        extraSrc[dit].mult(velOld[dit], dir, dir);
+        extraSrc[din].mult(velOld[din], dir, dir);
 
         // Make u.grad(porosity)/porosity^2
-        extraSrc[dit].divide(porosity[dit], 0, dir);
-        extraSrc[dit].divide(porosity[dit], 0, dir);
+        extraSrc[din].divide(porosity[din], 0, dir);
+        extraSrc[din].divide(porosity[din], 0, dir);
 
         // Make (u.grad(porosity)/porosity^2)u
-        extraSrc[dit].mult(velOld[dit], dir, dir);
+        extraSrc[din].mult(velOld[din], dir, dir);
       }
 
       // Add this extra source term to the full source term
-      a_src[dit].plus(extraSrc[dit], 0, 0, SpaceDim);
+      a_src[din].plus(extraSrc[din], 0, 0, SpaceDim);
     }
   }
   else if (m_opt.advectionMethod == m_porosityInAdvection)
@@ -1643,28 +1676,30 @@ void AMRLevelMushyLayer::computeAdvectionVelSourceTerm(LevelData<FArrayBox>& a_s
 
     LevelData<FArrayBox> extraSrc(m_grids, SpaceDim, IntVect::Unit);
 
-    for (DataIterator dit = extraSrc.dataIterator(); dit.ok(); ++dit)
+#pragma omp parallel for
+    for (int ibox = 0; ibox < nbox; ibox++)
     {
+      const DataIndex& din = dit[ibox];
 
-      extraSrc[dit].setVal(0.0);
+      extraSrc[din].setVal(0.0);
 
       for (int dir=0; dir < SpaceDim; dir++)
       {
-        extraSrc[dit].plus(m_dPorosity_dt[dit], 0, dir);
+        extraSrc[din].plus(m_dPorosity_dt[din], 0, dir);
 
         // Make u (dchi/dt)
-        extraSrc[dit].mult(velOld[dit], dir, dir);
+        extraSrc[din].mult(velOld[din], dir, dir);
 
         // Make u (dchi/dt)/porosity^2
-        extraSrc[dit].divide(porosity[dit], 0, dir);
-        extraSrc[dit].divide(porosity[dit], 0, dir);
+        extraSrc[din].divide(porosity[din], 0, dir);
+        extraSrc[din].divide(porosity[din], 0, dir);
 
         // Also need to scale the original source term
-        a_src[dit].divide(porosity[dit], 0, dir);
+        a_src[din].divide(porosity[din], 0, dir);
       }
 
       // Add this extra source term to the full source term
-      a_src[dit].minus(extraSrc[dit], 0, 0, SpaceDim);
+      a_src[din].minus(extraSrc[din], 0, 0, SpaceDim);
 
     }
   }
@@ -1680,13 +1715,15 @@ void AMRLevelMushyLayer::computeAdvectionVelSourceTerm(LevelData<FArrayBox>& a_s
 
   a_src.exchange();
 
-  for (dit.reset(); dit.ok(); ++dit)
+#pragma omp parallel for
+  for (int ibox = 0; ibox < nbox; ibox++)
   {
+    const DataIndex& din = dit[ibox];
     // This source term is centered at step n, so store it in vectorOld.
-    (*m_vectorOld[VectorVars::m_advectionSrc])[dit].copy(a_src[dit], 0, 0, SpaceDim);
+    (*m_vectorOld[VectorVars::m_advectionSrc])[din].copy(a_src[din], 0, 0, SpaceDim);
 
     // Also need to store in vectorNew so that we can interpolate in time when subcycling
-    (*m_vectorNew[VectorVars::m_advectionSrc])[dit].copy(a_src[dit], 0, 0, SpaceDim);
+    (*m_vectorNew[VectorVars::m_advectionSrc])[din].copy(a_src[din], 0, 0, SpaceDim);
   }
 
   if (crseVelPtr != NULL)
@@ -1727,12 +1764,16 @@ void AMRLevelMushyLayer::computeUDelU(LevelData<FArrayBox>& U_adv_src, const Lev
       LevelData<FluxBox> porosityFace(m_grids, 1, IntVect::Unit);
 
       fillScalarFace(porosityFace, a_oldTime, m_porosity, true);
-      for (DataIterator dit = UdelU_porosity.dataIterator(); dit.ok(); ++dit)
+      int nbox = dit.size();
+
+#pragma omp parallel for
+      for (int ibox = 0; ibox < nbox; ibox++)
       {
-        vel_chi[dit].copy(m_advVel[dit]);
+        const DataIndex& din = dit[ibox];
+        vel_chi[din].copy(m_advVel[din]);
         for (int dir=0; dir<SpaceDim; dir++)
         {
-          vel_chi[dit].divide(porosityFace[dit], porosityFace[dit].box(), 0,0);
+          vel_chi[din].divide(porosityFace[din], porosityFace[din].box(), 0,0);
         }
       }
 
@@ -1741,9 +1782,11 @@ void AMRLevelMushyLayer::computeUDelU(LevelData<FArrayBox>& U_adv_src, const Lev
       ccVel.exchange();
 
       Gradient::levelGradientCC(UdelU_porosity, vel_chi, m_dx);
-      for (DataIterator dit = UdelU_porosity.dataIterator(); dit.ok(); ++dit)
+#pragma omp parallel for
+      for (int ibox = 0; ibox < nbox; ibox++)
       {
-        UdelU_porosity[dit].mult(ccVel[dit]);
+        const DataIndex& din = dit[ibox];
+        UdelU_porosity[din].mult(ccVel[din]);
       }
 
       Real maxUdelU = ::computeMax(UdelU_porosity, NULL,1, Interval(0, SpaceDim-1));
@@ -1761,9 +1804,13 @@ void AMRLevelMushyLayer::computeUDelU(LevelData<FArrayBox>& U_adv_src, const Lev
   else
   {
     // Don't want this term
-    for (dit.reset(); dit.ok(); ++dit)
+    int nbox = dit.size();
+
+#pragma omp parallel for
+    for (int ibox = 0; ibox < nbox; ibox++)
     {
-      UdelU_porosity[dit].setVal(0.0);
+      const DataIndex& din = dit[ibox];
+      UdelU_porosity[din].setVal(0.0);
     }
   }
 
@@ -1772,9 +1819,13 @@ void AMRLevelMushyLayer::computeUDelU(LevelData<FArrayBox>& U_adv_src, const Lev
 
   UdelU_porosity.copyTo(U_adv_src);
 
-  for (dit.reset(); dit.ok(); ++dit)
+  int nbox = dit.size();
+
+#pragma omp parallel for
+  for (int ibox = 0; ibox < nbox; ibox++)
   {
-    (*m_vectorNew[VectorVars::m_UdelU])[dit].copy(UdelU_porosity[dit], 0, 0, SpaceDim);
+    const DataIndex& din = dit[ibox];
+    (*m_vectorNew[VectorVars::m_UdelU])[din].copy(UdelU_porosity[din], 0, 0, SpaceDim);
   }
 
 }
@@ -1865,41 +1916,47 @@ void AMRLevelMushyLayer::computeUstarSrc(LevelData<FArrayBox>& src,
   //  fillBuoyancy(buoyancy_src, src_time);
 
   // Finally the buoyancy bit
-  for (dit.reset(); dit.ok(); ++dit)
+  int nbox = dit.size();
+
+#pragma omp parallel for
+  for (int ibox = 0; ibox < nbox; ibox++)
   {
+    const DataIndex& din = dit[ibox];
 
 
-    darcy_src[dit].copy(U_old[dit]);
+    darcy_src[din].copy(U_old[din]);
 
     for (int dir = 0; dir < SpaceDim; dir++)
     {
-      darcy_src[dit].mult(porosity_centred[dit], 0, dir, 1);
-      darcy_src[dit].divide(permeability_centred[dit], darcy_src[dit].box(), 0, dir, 1);
+      darcy_src[din].mult(porosity_centred[din], 0, dir, 1);
+      darcy_src[din].divide(permeability_centred[din], darcy_src[din].box(), 0, dir, 1);
       //todo: add viscosity in here
     }
-    darcy_src[dit].mult(m_parameters.m_darcyCoeff);
+    darcy_src[din].mult(m_parameters.m_darcyCoeff);
 
   }
 
   //Put it all together
-  for (dit.reset(); dit.ok(); ++dit)
+#pragma omp parallel for
+  for (int ibox = 0; ibox < nbox; ibox++)
   {
+    const DataIndex& din = dit[ibox];
 
-    src[dit].setVal(0.0);
+    src[din].setVal(0.0);
 
     if (m_opt.CCBuoyancySrc)
     {
-      src[dit] += buoyancy_src[dit];
+      src[din] += buoyancy_src[din];
     }
 
     if (advSrc)
     {
-      src[dit] -= U_adv_src[dit];
+      src[din] -= U_adv_src[din];
     }
 
     if (m_usePrevPressureForUStar || pressureSrc)
     {
-      src[dit] -= P_src[dit];
+      src[din] -= P_src[din];
     }
 
 //    if (m_opt.explicitDarcyTerm || m_opt.CCDarcySrc)
@@ -1958,9 +2015,14 @@ void AMRLevelMushyLayer::predictVelocities(LevelData<FArrayBox>& a_uDelU,
     velBC.applyBCs(traceVel, levelGrids, m_problem_domain, m_dx, false); // not homogeneous
   }
 
-  for (DataIterator dit = a_advVel.dataIterator(); dit.ok(); ++dit)
+  DataIterator dit = a_advVel.dataIterator();
+  int nbox = dit.size();
+
+#pragma omp parallel for
+  for (int ibox = 0; ibox < nbox; ibox++)
   {
-    advectionVelocity[dit].copy(a_advVel[dit]);
+    const DataIndex& din = dit[ibox];
+    advectionVelocity[din].copy(a_advVel[din]);
 
     if ( m_opt.advectionMethod == m_noPorosity )
     {
@@ -1970,16 +2032,16 @@ void AMRLevelMushyLayer::predictVelocities(LevelData<FArrayBox>& a_uDelU,
         || m_opt.advectionMethod == m_porosityInAdvection)
     {
 
-      advectionVelocity[dit].divide(porosityFace[dit], porosityFace[dit].box(), 0, 0);
+      advectionVelocity[din].divide(porosityFace[din], porosityFace[din].box(), 0, 0);
       for (int dir=0; dir<SpaceDim; dir++)
       {
-        traceVel[dit].divide(porosity[dit], porosity[dit].box(), 0, dir);
+        traceVel[din].divide(porosity[din], porosity[din].box(), 0, dir);
       }
     }
 
     for (int dir=0; dir<SpaceDim; dir++)
     {
-      advectionVelocity[dit][dir].mult(m_parameters.m_advectionCoeff);
+      advectionVelocity[din][dir].mult(m_parameters.m_advectionCoeff);
     }
   }
 
@@ -2014,11 +2076,16 @@ void AMRLevelMushyLayer::predictVelocities(LevelData<FArrayBox>& a_uDelU,
     // Get the true pressure correction (scaled with chi if appropriate)
     if (m_opt.scaleP_MAC)
     {
-      for (DataIterator dit=gradPhi.dataIterator(); dit.ok(); ++dit)
+      DataIterator dit = gradPhi.dataIterator();
+      int nbox = dit.size();
+
+#pragma omp parallel for
+      for (int ibox = 0; ibox < nbox; ibox++)
       {
+        const DataIndex& din = dit[ibox];
         for (int dir=0; dir<SpaceDim; dir++)
         {
-          gradPhi[dit].mult(pressureScale[dit], pressureScale[dit].box(), 0, dir);
+          gradPhi[din].mult(pressureScale[din], pressureScale[din].box(), 0, dir);
         }
       }
     }
@@ -2037,19 +2104,22 @@ void AMRLevelMushyLayer::predictVelocities(LevelData<FArrayBox>& a_uDelU,
 
     U_chi_advected.exchange();
 
-    for (DataIterator dit = U_chi_advected.dataIterator(); dit.ok(); ++dit)
+    DataIterator dit = U_chi_advected.dataIterator();
+    int nbox = dit.size();
+
+#pragma omp parallel for
+    for (int ibox = 0; ibox < nbox; ibox++)
     {
+      const DataIndex& din = dit[ibox];
       for (int dir=0; dir<SpaceDim; dir++)
       {
-        EdgeToCell(U_chi_advected[dit], dir, (*m_vectorNew[VectorVars::m_U_porosity])[dit], 0, dir);
+        EdgeToCell(U_chi_advected[din], dir, (*m_vectorNew[VectorVars::m_U_porosity])[din], 0, dir);
       }
     }
 
   } // FluxBox goes out of scope, memory reclaimed.
 
   // now loop over grids to compute advection and update flux registers
-  DataIterator dit = a_uDelU.dataIterator();
-
   // for nonconservative update, also need a cell-centered
   // advection velocity -- get this by averaging edge-centered
   // advection velocity to cell centers.  this one shouldn't need
@@ -2065,12 +2135,14 @@ void AMRLevelMushyLayer::predictVelocities(LevelData<FArrayBox>& a_uDelU,
   LevelData<FluxBox> momentumFlux(U_chi_advected.disjointBoxLayout(), SpaceDim, U_chi_advected.ghostVect());
   U_chi_advected.copyTo(Interval(0, SpaceDim-1), momentumFlux, Interval(0, SpaceDim-1));
 
-  for (dit.reset(); dit.ok(); ++dit)
+#pragma omp parallel for
+  for (int ibox = 0; ibox < nbox; ibox++)
   {
+    const DataIndex& din = dit[ibox];
     for (int dir = 0; dir < SpaceDim; dir++)
     {
-      FArrayBox& thisFlux = momentumFlux[dit][dir];
-      FArrayBox& thisAdvVel = a_advVel[dit][dir];
+      FArrayBox& thisFlux = momentumFlux[din][dir];
+      FArrayBox& thisAdvVel = a_advVel[din][dir];
 
       // now need to loop over traced velocity components
       for (int velComp = 0; velComp < SpaceDim; ++velComp)
@@ -2087,12 +2159,16 @@ void AMRLevelMushyLayer::predictVelocities(LevelData<FArrayBox>& a_uDelU,
   else
   {
 
-    for (dit.reset(); dit.ok(); ++dit)
+    int nbox = dit.size();
+
+#pragma omp parallel for
+    for (int ibox = 0; ibox < nbox; ibox++)
     {
-      FluxBox& thisU_chiHalf = U_chi_advected[dit];
-      FArrayBox& thisCellAdvVel = cellAdvVel[dit];
-      const Box& thisBox = levelGrids[dit];
-      FArrayBox& this_uDelU = a_uDelU[dit];
+      const DataIndex& din = dit[ibox];
+      FluxBox& thisU_chiHalf = U_chi_advected[din];
+      FArrayBox& thisCellAdvVel = cellAdvVel[din];
+      const Box& thisBox = levelGrids[din];
+      FArrayBox& this_uDelU = a_uDelU[din];
       this_uDelU.setVal(0.0);
 
       // to do this in a dimensionality independent way,
@@ -2291,14 +2367,19 @@ void AMRLevelMushyLayer::traceAdvectionVel(LevelData<FluxBox>& a_advVel,
 
 void AMRLevelMushyLayer::computeInflowOutflowAdvVel()
 {
-  for (DataIterator dit = m_totalAdvVel.dataIterator(); dit.ok(); ++dit)
+  DataIterator dit = m_totalAdvVel.dataIterator();
+  int nbox = dit.size();
+
+#pragma omp parallel for
+  for (int ibox = 0; ibox < nbox; ibox++)
   {
+    const DataIndex& din = dit[ibox];
     for (int idir = 0; idir<SpaceDim; idir++)
     {
 
-      m_totalAdvVel[dit][idir].copy(m_advVel[dit][idir]);
+      m_totalAdvVel[din][idir].copy(m_advVel[din][idir]);
 
-      m_totalAdvVel[dit][idir].plus(m_frameAdvVel[dit][idir]);
+      m_totalAdvVel[din][idir].plus(m_frameAdvVel[din][idir]);
     }
   }
 }
@@ -2401,7 +2482,8 @@ void AMRLevelMushyLayer::correctEdgeCentredVelocity(LevelData<FluxBox>& a_advVel
       else
       {
         exitStatus = m_projection.levelMacProject(a_advVel, a_dt, crsePressurePtr, pressureScalePtr, crsePressureScalePtr,
-                                                  pressureScaleEdgePtrOneGhost, crsePressureScaleEdgePtr, false, 1.0);
+                                                  pressureScaleEdgePtrOneGhost, crsePressureScaleEdgePtr, false, 1.0,
+                                                  old_time);
       }
 
       Divergence::levelDivergenceMAC(*m_scalarNew[ScalarVars::m_divUadv], a_advVel, m_dx);
@@ -2409,6 +2491,8 @@ void AMRLevelMushyLayer::correctEdgeCentredVelocity(LevelData<FluxBox>& a_advVel
       maxDivU = ::computeNorm(*m_scalarNew[ScalarVars::m_divUadv], NULL, 1, m_dx, Interval(0,0), 0);
       pout() << "  MAC Projection (#" << projNum << " on level "<< m_level << "), exit status = " << exitStatus << ", max(div u) = " << maxDivU << endl;
 
+      m_dtController.addSolve(-1, !(exitStatus == 2 || exitStatus == 4 || exitStatus == 6));
+
 
     }
 
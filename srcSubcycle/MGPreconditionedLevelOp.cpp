@@ -0,0 +1,157 @@
+#ifdef CH_LANG_CC
+/*
+ *      _______              __
+ *     / ___/ /  ___  __ _  / /  ___
+ *    / /__/ _ \/ _ \/  V \/ _ \/ _ \
+ *    \___/_//_/\___/_/_/_/_.__/\___/
+ *    Please refer to Copyright.txt, in Chombo's root directory.
+ */
+#endif
+
+#include "MGPreconditionedLevelOp.H"
+#include "CH_Timer.H"
+
+MGPreconditionedLevelOp::MGPreconditionedLevelOp()
+{
+  m_solver = NULL;
+  m_op = NULL;
+  m_level = 0;
+  m_phiCoarse = NULL;
+}
+
+MGPreconditionedLevelOp::~MGPreconditionedLevelOp()
+{
+}
+
+void MGPreconditionedLevelOp::define(AMRMultiGrid<LevelData<FArrayBox> >* a_solver,
+                                     int                                  a_level,
+                                     const LevelData<FArrayBox>*          a_phiCoarse)
+{
+  CH_assert(a_solver != NULL);
+  CH_assert((a_level == 0) == (a_phiCoarse == NULL));
+
+  m_solver = a_solver;
+  m_level = a_level;
+  m_phiCoarse = a_phiCoarse;
+  m_op = m_solver->getAMROperators()[m_level];
+
+  if (m_phiCoarse != NULL)
+  {
+    m_zeroCoarse.define(m_phiCoarse->disjointBoxLayout(), m_phiCoarse->nComp(), m_phiCoarse->ghostVect());
+    for (DataIterator dit = m_zeroCoarse.dataIterator(); dit.ok(); ++dit)
+    {
+      m_zeroCoarse[dit].setVal(0.0);
+    }
+  }
+}
+
+void MGPreconditionedLevelOp::residual(LevelData<FArrayBox>&       a_lhs,
+                                       const LevelData<FArrayBox>& a_phi,
+                                       const LevelData<FArrayBox>& a_rhs,
+                                       bool                        a_homogeneous)
+{
+  if (m_phiCoarse != NULL)
+  {
+    // Setting the ghost cells of phi doesn't change its value
+    LevelData<FArrayBox>& phi = const_cast<LevelData<FArrayBox>&>(a_phi);
+    m_op->AMRResidualNF(a_lhs, phi, a_homogeneous ? m_zeroCoarse : *m_phiCoarse, a_rhs, a_homogeneous);
+  }
+  else
+  {
+    m_op->residual(a_lhs, a_phi, a_rhs, a_homogeneous);
+  }
+}
+
+void MGPreconditionedLevelOp::preCond(LevelData<FArrayBox>&       a_cor,
+                                      const LevelData<FArrayBox>& a_residual)
+{
+  CH_TIME("MGPreconditionedLevelOp::preCond");
+
+  Vector<LevelData<FArrayBox>* > corVect(m_level+1, NULL);
+  Vector<LevelData<FArrayBox>* > resVect(m_level+1, NULL);
+  if (m_level > 0)
+  {
+    corVect[m_level-1] = &m_zeroCoarse;
+  }
+  corVect[m_level] = &a_cor;
+  resVect[m_level] = const_cast<LevelData<FArrayBox>*>(&a_residual);
+
+  // Just one iteration, quietly
+  int iterMax = m_solver->m_iterMax;
+  int verbosity = m_solver->m_verbosity;
+  m_solver->m_iterMax = 1;
+  m_solver->m_verbosity = 0;
+
+  m_solver->solve(corVect, resVect, m_level, m_level,
+                  true,  // start from zero
+                  true); // homogeneous
+
+  m_solver->m_iterMax = iterMax;
+  m_solver->m_verbosity = verbosity;
+}
+
+void MGPreconditionedLevelOp::applyOp(LevelData<FArrayBox>&       a_lhs,
+                                      const LevelData<FArrayBox>& a_phi,
+                                      bool                        a_homogeneous)
+{
+  if (m_phiCoarse != NULL)
+  {
+    LevelData<FArrayBox>& phi = const_cast<LevelData<FArrayBox>&>(a_phi);
+    m_op->AMROperatorNF(a_lhs, phi, a_homogeneous ? m_zeroCoarse : *m_phiCoarse, a_homogeneous);
+  }
+  else
+  {
+    m_op->applyOp(a_lhs, a_phi, a_homogeneous);
+  }
+}
+
+void MGPreconditionedLevelOp::create(LevelData<FArrayBox>&       a_lhs,
+                                     const LevelData<FArrayBox>& a_rhs)
+{
+  m_op->create(a_lhs, a_rhs);
+}
+
+void MGPreconditionedLevelOp::assign(LevelData<FArrayBox>&       a_lhs,
+                                     const LevelData<FArrayBox>& a_rhs)
+{
+  m_op->assign(a_lhs, a_rhs);
+}
+
+Real MGPreconditionedLevelOp::dotProduct(const LevelData<FArrayBox>& a_1,
+                                         const LevelData<FArrayBox>& a_2)
+{
+  return m_op->dotProduct(a_1, a_2);
+}
+
+void MGPreconditionedLevelOp::incr(LevelData<FArrayBox>&       a_lhs,
+                                   const LevelData<FArrayBox>& a_x,
+                                   Real                        a_scale)
+{
+  m_op->incr(a_lhs, a_x, a_scale);
+}
+
+void MGPreconditionedLevelOp::axby(LevelData<FArrayBox>&       a_lhs,
+                                   const LevelData<FArrayBox>& a_x,
+                                   const LevelData<FArrayBox>& a_y,
+                                   Real                        a_a,
+                                   Real                        a_b)
+{
+  m_op->axby(a_lhs, a_x, a_y, a_a, a_b);
+}
+
+void MGPreconditionedLevelOp::scale(LevelData<FArrayBox>& a_lhs,
+                                    const Real&           a_scale)
+{
+  m_op->scale(a_lhs, a_scale);
+}
+
+Real MGPreconditionedLevelOp::norm(const LevelData<FArrayBox>& a_x,
+                                   int                         a_ord)
+{
+  return m_op->norm(a_x, a_ord);
+}
+
+void MGPreconditionedLevelOp::setToZero(LevelData<FArrayBox>& a_lhs)
+{
+  m_op->setToZero(a_lhs);
+}
@@ -16,6 +16,8 @@
 #include "CoarseAverage.H"
 #include "computeNorm.H"
 #include "mushyLayerOpt.h"
+#include "AsyncHDF5Writer.H"
+#include "HDF5Compression.H"
 
 #include "NamespaceHeader.H"
 
@@ -98,6 +100,81 @@ getAMRFactory(RefCountedPtr<AMRLevelMushyLayerFactory>&  a_fact)
   opt.plotfile_prefix = "plt";
   ppMain.query("plot_prefix", opt.plotfile_prefix);
 
+  opt.asyncOutput = false;
+  ppMain.query("asyncOutput", opt.asyncOutput);
+#ifdef CH_USE_HDF5
+  std::string asyncReason;
+  if (opt.asyncOutput && !AsyncHDF5Writer::supported(asyncReason))
+  {
+    pout() << "Can't write output asynchronously (" << asyncReason << "), writing synchronously instead" << endl;
+    opt.asyncOutput = false;
+  }
+#else
+  opt.asyncOutput = false;
+#endif
+
+  if (ppMain.contains("plot_scalar_vars"))
+  {
+    std::vector<string> vars;
+    ppMain.getarr("plot_scalar_vars", vars, 0, ppMain.countval("plot_scalar_vars"));
+    opt.plotScalarVars = Vector<string>(vars);
+  }
+  if (ppMain.contains("plot_scalar_intervals"))
+  {
+    std::vector<int> intervals;
+    ppMain.getarr("plot_scalar_intervals", intervals, 0, ppMain.countval("plot_scalar_intervals"));
+    opt.plotScalarIntervals = Vector<int>(intervals);
+  }
+  if (ppMain.contains("plot_vector_vars"))
+  {
+    std::vector<string> vars;
+    ppMain.getarr("plot_vector_vars", vars, 0, ppMain.countval("plot_vector_vars"));
+    opt.plotVectorVars = Vector<string>(vars);
+  }
+  if (ppMain.contains("plot_vector_intervals"))
+  {
+    std::vector<int> intervals;
+    ppMain.getarr("plot_vector_intervals", intervals, 0, ppMain.countval("plot_vector_intervals"));
+    opt.plotVectorIntervals = Vector<int>(intervals);
+  }
+
+  opt.plotSeparateFields = false;
+  ppMain.query("plotSeparateFields", opt.plotSeparateFields);
+
+  string plotCompression = "none";
+  ppMain.query("plotCompression", plotCompression);
+  opt.plotCompressionLevel = 4;
+  ppMain.query("plotCompressionLevel", opt.plotCompressionLevel);
+  opt.plotLossyDigits = -1;
+  ppMain.query("plotLossyDigits", opt.plotLossyDigits);
+  if (ppMain.contains("plot_single_precision_vars"))
+  {
+    std::vector<string> vars;
+    ppMain.getarr("plot_single_precision_vars", vars, 0, ppMain.countval("plot_single_precision_vars"));
+    opt.plotSinglePrecisionVars = Vector<string>(vars);
+  }
+
+#ifdef CH_USE_HDF5
+  opt.plotCompression = HDF5Compression::filterFromName(plotCompression);
+  if (opt.plotCompression < 0)
+  {
+    MayDay::Error("Unknown main.plotCompression, should be none, deflate or zstd");
+  }
+
+  HDF5Compression compression;
+  compression.filter = opt.plotCompression;
+  compression.lossyDigits = opt.plotLossyDigits;
+  std::string compressionReason;
+  if (!compression.check(compressionReason))
+  {
+    pout() << "Plot file compression: " << compressionReason << endl;
+    opt.plotCompression = compression.filter;
+    opt.plotLossyDigits = compression.lossyDigits;
+  }
+#else
+  opt.plotCompression = 0;
+#endif
+
   opt.minimalOutput = false;
   opt.debug = false;
   ppMain.query("debug", opt.debug);
@@ -163,6 +240,17 @@ getAMRFactory(RefCountedPtr<AMRLevelMushyLayerFactory>&  a_fact)
   opt.max_dt_growth = 1.1;
   ppMain.query("max_dt_growth", opt.max_dt_growth);
 
+  opt.adaptiveDt = false;
+  ppMain.query("adaptiveDt", opt.adaptiveDt);
+  opt.adaptiveDtTargetIterations = 10;
+  ppMain.query("adaptiveDtTargetIterations", opt.adaptiveDtTargetIterations);
+  opt.adaptiveDtKI = 0.3;
+  ppMain.query("adaptiveDtKI", opt.adaptiveDtKI);
+  opt.adaptiveDtKP = 0.2;
+  ppMain.query("adaptiveDtKP", opt.adaptiveDtKP);
+  opt.adaptiveDtMinFactor = 0.5;
+  ppMain.query("adaptiveDtMinFactor", opt.adaptiveDtMinFactor);
+
   opt.init_dt_scale = 0.1;
   ppMain.query("init_dt_scale", opt.init_dt_scale);
 
@@ -391,6 +479,18 @@ getAMRFactory(RefCountedPtr<AMRLevelMushyLayerFactory>&  a_fact)
   opt.tagBufferSize = 4;
   ppMain.query("tag_buffer_size", opt.tagBufferSize);
 
+  opt.loadBalanceCostModel = false;
+  ppMain.query("loadBalanceCostModel", opt.loadBalanceCostModel);
+
+  opt.loadBalanceMushyCost = 2.5;
+  ppMain.query("loadBalanceMushyCost", opt.loadBalanceMushyCost);
+
+  opt.loadBalanceSolidCost = 1.0;
+  ppMain.query("loadBalanceSolidCost", opt.loadBalanceSolidCost);
+
+  opt.loadBalanceCalibrate = true;
+  ppMain.query("loadBalanceCalibrate", opt.loadBalanceCalibrate);
+
   opt.doProjection=true;
   ppMain.query("doProjection", opt.doProjection);
 
@@ -595,6 +695,27 @@ getAMRFactory(RefCountedPtr<AMRLevelMushyLayerFactory>&  a_fact)
   opt.diagnostics_period = -1;
   ppMain.query("diagnostics_period", opt.diagnostics_period);
 
+  string diagnosticsFormat = "text";
+  ppMain.query("diagnosticsFormat", diagnosticsFormat);
+  if (diagnosticsFormat == "text")
+  {
+    opt.diagnosticsFormat = DiagnosticFormats::diagFormat_text;
+  }
+  else if (diagnosticsFormat == "binary")
+  {
+    opt.diagnosticsFormat = DiagnosticFormats::diagFormat_binary;
+  }
+  else
+  {
+    MayDay::Error("Unknown main.diagnosticsFormat, should be text or binary");
+  }
+
+  opt.diagnosticsFlushInterval = 100;
+  ppMain.query("diagnosticsFlushInterval", opt.diagnosticsFlushInterval);
+
+  opt.chimneyDiagnostics = false;
+  ppMain.query("chimneyDiagnostics", opt.chimneyDiagnostics);
+
   /**
    * Solver options
    */
@@ -646,6 +767,7 @@ getAMRFactory(RefCountedPtr<AMRLevelMushyLayerFactory>&  a_fact)
   opt.velMGNormThresh=1e-10;
   opt.velMGNumMG=1;
   opt.VelMGMaxIter=10;
+  opt.velMGRelaxMode = 1; // 1=GSRB, 2=overlapped GSRB
 
   ppVelMultigrid.query("num_smooth", opt.velMGNumSmooth);
   ppVelMultigrid.query("tolerance",  opt.velMGTolerance);
@@ -653,6 +775,7 @@ getAMRFactory(RefCountedPtr<AMRLevelMushyLayerFactory>&  a_fact)
   ppVelMultigrid.query("num_mg",     opt.velMGNumMG);
   ppVelMultigrid.query("norm_thresh", opt.velMGNormThresh);
   ppVelMultigrid.query("max_iter",  opt.VelMGMaxIter);
+  ppVelMultigrid.query("relaxMode", opt.velMGRelaxMode);
 
   opt.HCMultigridNumSmoothUp=4;
   opt.HCMultigridNumSmoothDown=1;
@@ -663,8 +786,13 @@ getAMRFactory(RefCountedPtr<AMRLevelMushyLayerFactory>&  a_fact)
   opt.HCMultigridTolerance=1e-10;
   opt.HCMultigridHang=1e-10;
   opt.HCMultigridNormThresh=1e-10;
-  opt.HCMultigridRelaxMode = 1; // 1=GSRB, 4=jacobi
+  opt.HCMultigridRelaxMode = 1; // 1=GSRB, 2=overlapped GSRB, 3=lazy GSRB, 4=jacobi, 6=deep halo GSRB
+  opt.HCMultigridSweepsPerExchange = 2;
   opt.HCMultigridUseRelaxBottomSolverForHC = true;
+  opt.HCMultigridDirectBottomSolver = false;
+  opt.HCMultigridNewtonKrylov = false;
+  opt.HCMultigridNewtonMaxIter = 10;
+  opt.HCMultigridKrylovMaxIter = 20;
 
   HCMultigrid.query("num_smooth_up", opt.HCMultigridNumSmoothUp);
   HCMultigrid.query("num_mg", opt.HCMultigridNumMG);
@@ -675,8 +803,13 @@ getAMRFactory(RefCountedPtr<AMRLevelMushyLayerFactory>&  a_fact)
   HCMultigrid.query("verbosity", opt.HCMultigridVerbosity);
   HCMultigrid.query("numSmoothDown", opt.HCMultigridNumSmoothDown);
   HCMultigrid.query("relaxMode", opt.HCMultigridRelaxMode);
+  HCMultigrid.query("sweepsPerExchange", opt.HCMultigridSweepsPerExchange);
   HCMultigrid.query("bottomSolveIterations", opt.HCMultigridBottomSolveIterations);
   HCMultigrid.query("useRelaxBottomSolver", opt.HCMultigridUseRelaxBottomSolverForHC);
+  HCMultigrid.query("directBottomSolver", opt.HCMultigridDirectBottomSolver);
+  HCMultigrid.query("newtonKrylov", opt.HCMultigridNewtonKrylov);
+  HCMultigrid.query("newtonMaxIter", opt.HCMultigridNewtonMaxIter);
+  HCMultigrid.query("krylovMaxIter", opt.HCMultigridKrylovMaxIter);
 
 //  opt.noMultigrid = false;
 //  opt.noMultigridIter = 100;
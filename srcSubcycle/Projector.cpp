@@ -29,6 +29,7 @@
 #include "RelaxSolver.H"
 #include "computeNorm.H"
 #include "BoxIterator.H"
+#include "MGPreconditionedLevelOp.H"
 
 #ifdef CH_USE_HDF5
 #include "CH_HDF5.H"
@@ -61,7 +62,11 @@ Real Projector::s_lambda_timestep = 0.0;
 bool Projector::pp_init = false;
 int  Projector::s_verbosity = 2;
 int Projector::s_bottomSolveMaxIter = 20;
+bool Projector::s_direct_bottom_solver = false;
 int Projector::s_multigrid_relaxation = 1; // 1 for gsrb, 4 for jacobi
+int Projector::s_solver_type = 0; // 0 for multigrid, 1 for BiCGStab
+int Projector::s_initial_guess_history = 0;
+Real Projector::s_discretisation_tolerance = 0.0;
 
 /// first define quick-n-easy access functions
 
@@ -311,6 +316,8 @@ Projector::Projector()
   m_dx = -1;
   m_fineProjPtr = NULL;
   m_BiCGBottomSolverLevel = NULL;
+  m_directBottomSolverLevel = NULL;
+  m_VCOpBeta = 0.0;
   m_sumVDrhs = 0.0;
   m_usePiAdvectionBCs = true;
   m_phiScale=1.0;
@@ -337,6 +344,12 @@ Projector::~Projector()
     delete m_bottomSolverLevel;
     m_bottomSolverLevel = NULL;
   }
+
+  if (m_directBottomSolverLevel != NULL)
+  {
+    delete m_directBottomSolverLevel;
+    m_directBottomSolverLevel = NULL;
+  }
   // everything else should be automatic here
 }
 
@@ -570,8 +583,12 @@ void Projector::variableSetUp()
   ppProjection.query("maxIter", s_iterMax);
   ppProjection.query("relax_bottom_solver", s_relax_bottom_solver);
   ppProjection.query("bottomSolveMaxIter", s_bottomSolveMaxIter);
+  ppProjection.query("directBottomSolver", s_direct_bottom_solver);
   ppProjection.query("solverHang", s_solver_hang);
   ppProjection.query("mg_relaxation", s_multigrid_relaxation);
+  ppProjection.query("solverType", s_solver_type);
+  ppProjection.query("initialGuessHistory", s_initial_guess_history);
+  ppProjection.query("discretisationTolerance", s_discretisation_tolerance);
 
   tempBool = (int) s_constantLambdaScaling;
   ppProjection.query("constantLambdaScaling", tempBool);
@@ -995,7 +1012,8 @@ int Projector::levelMacProject(LevelData<FluxBox>& a_uEdge,
                                   const RefCountedPtr<LevelData<FluxBox> > a_pressureScaleEdgePtr,
                                   const RefCountedPtr<LevelData<FluxBox> > a_crsePressureScaleEdgePtr,
                                   bool alreadyHasPhi,
-                                  Real correctScale)
+                                  Real correctScale,
+                                  Real a_time)
 {
   if (s_verbosity >= 5)
   {
@@ -1065,7 +1083,8 @@ int Projector::levelMacProject(LevelData<FluxBox>& a_uEdge,
 
 
   int exitStatus = solveMGlevel(m_phi, a_crsePressurePtr, MACrhs(), a_pressureScalePtr, a_crsePressureScalePtr,
-               a_pressureScaleEdgePtr, a_crsePressureScaleEdgePtr);
+               a_pressureScaleEdgePtr, a_crsePressureScaleEdgePtr,
+               false, &m_phiHistory, a_time);
 
   // now correct
 
@@ -1270,7 +1289,8 @@ int Projector::levelMacProject(LevelData<FluxBox>& a_uEdge,
   // now solve for phi
   int exitStatus = solveMGlevel(m_phi, pressureBCPtr, MACrhs(),
                a_porosityPtr, a_crsePorosityPtr,
-               a_porosityEdgePtr, a_crsePorosityEdgePtr);
+               a_porosityEdgePtr, a_crsePorosityEdgePtr,
+               false, &m_phiHistory, a_oldTime);
 
   // now correct
 
@@ -1597,7 +1617,8 @@ void Projector::LevelProject(LevelData<FArrayBox>& a_velocity,
   solveMGlevel(m_Pi, crsePiPtr, CCrhs(),
                a_porosityPtr, a_crsePorosityPtr,
                a_porosityEdgePtr, a_crsePorosityEdgePtr,
-               true); // cell centred
+               true, // cell centred
+               &m_PiHistory, a_newTime);
 
   // apply appropriate physical BC's
   BCHolder bcHolder = m_physBCPtr->gradPiFuncBC(); // this is what CC project used to use
@@ -3007,18 +3028,24 @@ void Projector::defineMultiGrid(AMRMultiGrid<LevelData<FArrayBox> >& a_solver,
 
   makeBottomSolvers();
 
+  LinearSolver<LevelData<FArrayBox> >* bottomSolver = m_bottomSolverLevel;
+  if (s_direct_bottom_solver)
+  {
+    bottomSolver = m_directBottomSolverLevel;
+  }
+
   if (m_scaleSyncCorrection)
   {
     a_solver.define(baseDomain,
                     opFact,
-                    m_bottomSolverLevel,
+                    bottomSolver,
                     finestLevel+1);
   }
   else
   {
     a_solver.define(baseDomain,
                     localPoissonOpFactory,
-                    m_bottomSolverLevel,
+                    bottomSolver,
                     finestLevel+1);
   }
 
@@ -3078,6 +3105,8 @@ void Projector::defineSolverMGLevelVCOp(
     bool cellCentred,
     Real beta)
 {
+  CH_TIME("Projector::defineSolverMGLevelVCOp");
+
   if (s_verbosity >= 5)
   {
     pout() << "CCProjector::defineSolverMGLevelVCOp "            << endl;
@@ -3095,79 +3124,67 @@ void Projector::defineSolverMGLevelVCOp(
     numSolverLevels= 2;
   }
 
-  m_aCoef.resize(numSolverLevels);
-  m_bCoef.resize(numSolverLevels);
-  m_bCoefCC.resize(numSolverLevels);
+  // If the grids haven't changed since we last defined the solver, keep the multigrid hierarchy and
+  // just update the coefficients in place
+  bool reuseSolver = (m_VCOpGrids.size() == numSolverLevels && m_allGrids.size() == numSolverLevels
+      && m_VCOpBeta == beta);
+  for (int lev = 0; lev < m_VCOpGrids.size() && reuseSolver; lev++)
+  {
+    reuseSolver = (m_VCOpGrids[lev] == m_allGrids[lev]);
+  }
 
-  ProblemDomain baseDomain(m_domain); // on this level
+  if (!reuseSolver)
+  {
+    m_aCoef.resize(numSolverLevels);
+    m_bCoef.resize(numSolverLevels);
 
-  Real alpha=0;
+    for (int lev = 0; lev < numSolverLevels; lev++)
+    {
+      m_aCoef[lev] = RefCountedPtr<LevelData<FArrayBox> >(new LevelData<FArrayBox>(m_allGrids[lev], 1, IntVect::Unit));
+      setValLevel(*m_aCoef[lev], 1.0);
 
-  Real dxCrse=m_dx;
+      m_bCoef[lev] = RefCountedPtr<LevelData<FluxBox> >(new LevelData<FluxBox>(m_allGrids[lev], 1, IntVect::Unit));
+    }
+  }
 
-  if (a_crsePorosityEdgePtr != NULL)
+  // b = -beta*porosity on faces
+  const RefCountedPtr<LevelData<FluxBox> > porosityEdge[2] = {
+      (numSolverLevels == 2) ? a_crsePorosityEdgePtr : a_porosityEdgePtr, a_porosityEdgePtr};
+  for (int lev = 0; lev < numSolverLevels; lev++)
   {
-    m_aCoef[0] = RefCountedPtr<LevelData<FArrayBox> >(new LevelData<FArrayBox>(m_allGrids[0], 1, IntVect::Unit));
-    m_aCoef[1] = RefCountedPtr<LevelData<FArrayBox> >(new LevelData<FArrayBox>(m_allGrids[1], 1, IntVect::Unit));
-    //    m_bCoefCC[1] = RefCountedPtr<LevelData<FArrayBox> >(new LevelData<FArrayBox>(m_allGrids[1], 1, 2*IntVect::Unit));
-    setValLevel(*m_aCoef[0], 1.0);
-    setValLevel(*m_aCoef[1], 1.0);
-
-    //    m_bCoef[0] = a_crsePorosityEdgePtr;
-    //    m_bCoef[1] = a_porosityEdgePtr;
-    m_bCoef[0] = RefCountedPtr<LevelData<FluxBox> >(new LevelData<FluxBox>(m_allGrids[0], 1, IntVect::Unit));
-    m_bCoef[1] = RefCountedPtr<LevelData<FluxBox> >(new LevelData<FluxBox>(m_allGrids[1], 1, IntVect::Unit));
-    m_bCoefCC[0] = RefCountedPtr<LevelData<FArrayBox> >(new LevelData<FArrayBox>(m_allGrids[0], 1, IntVect::Unit));
-    m_bCoefCC[1] = RefCountedPtr<LevelData<FArrayBox> >(new LevelData<FArrayBox>(m_allGrids[1], 1, IntVect::Unit));
-
-    //    a_porosityEdgePtr->copyTo(m_bCoef[0]);
-    for (DataIterator dit=m_bCoef[0]->dataIterator(); dit.ok(); ++dit)
+    for (DataIterator dit=m_bCoef[lev]->dataIterator(); dit.ok(); ++dit)
     {
-      (*m_bCoef[0])[dit].copy((*a_crsePorosityEdgePtr)[dit]);
-      //      (*m_bCoef[0])[dit].setVal(1.0);
-      //      (*m_bCoefCC[0])[dit].setVal(1.0);
-
-      //      (*m_bCoefCC[0])[dit].mult(-beta);
-
+      (*m_bCoef[lev])[dit].copy((*porosityEdge[lev])[dit]);
       for (int dir=0; dir<SpaceDim; dir++)
       {
-        (*m_bCoef[0])[dit][dir].mult(-beta);
+        (*m_bCoef[lev])[dit][dir].mult(-beta);
       }
     }
+  }
 
-    for (DataIterator dit=m_bCoef[1]->dataIterator(); dit.ok(); ++dit)
+  if (reuseSolver)
+  {
+    m_projectionOpFact.coefficientsChanged(m_physBCPtr->LevelPressureFuncBC());
+    if (m_directBottomSolverLevel != NULL)
     {
-      (*m_bCoef[1])[dit].copy((*a_porosityEdgePtr)[dit]);
-      //      (*m_bCoef[1])[dit].setVal(1.0);
-      for (int dir=0; dir<SpaceDim; dir++)
-      {
-        (*m_bCoef[1])[dit][dir].mult(-beta);
-      }
+      m_directBottomSolverLevel->resetFactorisation();
     }
 
-    //    m_bCoefCC[0] = a_crsePorosityPtr;
-    //    m_bCoefCC[1] = a_porosityPtr;
+    setSolverParameters();
+    return;
+  }
+
+  ProblemDomain baseDomain(m_domain); // on this level
+
+  Real alpha=0;
+
+  Real dxCrse=m_dx;
 
+  if (a_crsePorosityEdgePtr != NULL)
+  {
     baseDomain.coarsen(m_nRefCrse);
     dxCrse = m_nRefCrse * m_dx;
   }
-  else
-  {
-    m_aCoef[0] = RefCountedPtr<LevelData<FArrayBox> >(new LevelData<FArrayBox>(m_allGrids[0], 1, IntVect::Unit));
-    setValLevel(*m_aCoef[0], 1.0);
-    //    m_bCoef[0] = a_porosityEdgePtr;
-    m_bCoef[0] = RefCountedPtr<LevelData<FluxBox> >(new LevelData<FluxBox>(m_allGrids[0], 1, IntVect::Unit));
-    for (DataIterator dit=m_bCoef[0]->dataIterator(); dit.ok(); ++dit)
-    {
-      (*m_bCoef[0])[dit].copy((*a_porosityEdgePtr)[dit]);
-      //      (*m_bCoef[0])[dit].setVal(1.0);
-      for (int dir=0; dir<SpaceDim; dir++)
-      {
-        (*m_bCoef[0])[dit][dir].mult(-beta);
-      }
-    }
-    //    m_bCoefCC[0] = a_porosityPtr;
-  }
 
 
   Vector<int> refRatios(1, m_nRefCrse);
@@ -3179,40 +3196,45 @@ void Projector::defineSolverMGLevelVCOp(
     pout() << "CCProjector::defineSolverMGlevel - define multigrids" << endl;
   }
 
-//  VCAMRPoissonOp2Factory faceOpFact;
   int average_type = CoarseAverage::arithmetic;
   ParmParse pp("projection");
   pp.query("average_type", average_type);
-  AMRProjectionOpFactory faceOpFact;
 
-  faceOpFact.define(baseDomain,
-                    m_allGrids,
-                    refRatios,
-                    dxCrse,
-                    m_physBCPtr->LevelPressureFuncBC(),
-                    alpha, m_aCoef, beta, m_bCoef,
-                    average_type);
-  faceOpFact.m_relaxMode = s_multigrid_relaxation;
+  m_projectionOpFact.define(baseDomain,
+                            m_allGrids,
+                            refRatios,
+                            dxCrse,
+                            m_physBCPtr->LevelPressureFuncBC(),
+                            alpha, m_aCoef, beta, m_bCoef,
+                            average_type);
+  m_projectionOpFact.m_relaxMode = s_multigrid_relaxation;
 
-  if (s_relax_bottom_solver)
+  if (s_direct_bottom_solver)
   {
     m_solverMGlevel.define(baseDomain, // on either this level or coarser level
-                           faceOpFact,
+                           m_projectionOpFact,
+                           m_directBottomSolverLevel,
+                           numSolverLevels);
+  }
+  else if (s_relax_bottom_solver)
+  {
+    m_solverMGlevel.define(baseDomain, // on either this level or coarser level
+                           m_projectionOpFact,
                            m_bottomSolverLevel,
                            numSolverLevels);
   }
   else
   {
     m_solverMGlevel.define(baseDomain, // on either this level or coarser level
-                           faceOpFact,
+                           m_projectionOpFact,
                            m_BiCGBottomSolverLevel,
                            numSolverLevels);
   }
 
   setSolverParameters();
 
-
-  //  m_numMG, m_normThresh;
+  m_VCOpGrids = m_allGrids;
+  m_VCOpBeta = beta;
 }
 void Projector::makeBottomSolvers()
 {
@@ -3222,6 +3244,9 @@ void Projector::makeBottomSolvers()
   }
 
 
+  // m_solverMGlevel's bottom solver is about to be deleted, so it can't be reused
+  m_VCOpGrids.resize(0);
+
   //Delete previous bottom solver -- Kris R.
   if (m_BiCGBottomSolverLevel != NULL)
   {
@@ -3235,6 +3260,12 @@ void Projector::makeBottomSolvers()
     m_bottomSolverLevel = NULL;
   }
 
+  if (m_directBottomSolverLevel != NULL)
+  {
+    delete m_directBottomSolverLevel;
+    m_directBottomSolverLevel = NULL;
+  }
+
   BiCGStabSolver<LevelData<FArrayBox> >* newBottomPtr = new BiCGStabSolver<LevelData<FArrayBox> >;
   RelaxSolver<LevelData<FArrayBox> >* newRelaxBottomPtr = new RelaxSolver<LevelData<FArrayBox> >;
   newRelaxBottomPtr->m_verbosity = max(s_verbosity-2, 0);
@@ -3245,6 +3276,12 @@ void Projector::makeBottomSolvers()
 
   m_BiCGBottomSolverLevel = newBottomPtr;
   m_bottomSolverLevel = newRelaxBottomPtr;
+
+  // Linear, so one iteration should do unless the matrix is badly conditioned
+  m_directBottomSolverLevel = new DirectBottomSolver;
+  m_directBottomSolverLevel->m_verbosity = max(s_verbosity-2, 0);
+  m_directBottomSolverLevel->m_imax = s_bottomSolveMaxIter;
+  m_directBottomSolverLevel->setFallback(m_bottomSolverLevel);
 }
 void Projector::setSolverParameters()
 {
@@ -3280,6 +3317,9 @@ void Projector::defineSolverMGlevel(const DisjointBoxLayout& a_grids,
 
   AMRPoissonOpFactory localPoissonOpFactory;
 
+  // m_solverMGlevel won't have variable coefficients any more
+  m_VCOpGrids.resize(0);
+
   m_allGrids = Vector<DisjointBoxLayout>(numSolverLevels);
 
   if (a_crseGridsPtr != NULL)
@@ -3349,7 +3389,14 @@ void Projector::defineSolverMGlevel(const DisjointBoxLayout& a_grids,
     pout() << "CCProjector::defineSolverMGlevel - define multigrids" << endl;
   }
 
-  if (s_relax_bottom_solver)
+  if (s_direct_bottom_solver)
+  {
+    m_solverMGlevel.define(baseDomain, // on either this level or coarser level
+                           localPoissonOpFactory,
+                           m_directBottomSolverLevel,
+                           numSolverLevels);
+  }
+  else if (s_relax_bottom_solver)
   {
     m_solverMGlevel.define(baseDomain, // on either this level or coarser level
                            localPoissonOpFactory,
@@ -3390,7 +3437,9 @@ int Projector::solveMGlevel(LevelData<FArrayBox>&   a_phi,
                                const RefCountedPtr<LevelData<FArrayBox> > a_crsePressureScalePtr,
                                const RefCountedPtr<LevelData<FluxBox> > a_pressureScaleEdgePtr,
                                const RefCountedPtr<LevelData<FluxBox> > a_crsePressureScaleEdgePtr,
-                               bool cellCentred)
+                               bool cellCentred,
+                               PressureSolveHistory* a_history,
+                               Real a_time)
 {
   if (s_verbosity >= 5)
   {
@@ -3453,11 +3502,80 @@ int Projector::solveMGlevel(LevelData<FArrayBox>&   a_phi,
   }
 
 
-  // l_max = maxLevel, l_base = maxLevel
-  m_solverMGlevel.solve(phiVect, rhsVect, maxLevel, maxLevel,
-                        false); // don't initialize to zero
+  // Operator on this level, for computing residuals and Krylov solves
+  MGPreconditionedLevelOp levelOp;
+  levelOp.define(&m_solverMGlevel, maxLevel, a_phiCoarsePtr);
+
+  Real initialResidual = -1;
+  if (a_history != NULL && s_initial_guess_history > 0 && a_time >= 0)
+  {
+    initialResidual = warmStart(a_phi, a_rhs, levelOp, *a_history, a_time);
+  }
+
+  LevelData<FArrayBox> resid;
+  if (initialResidual < 0 && (s_discretisation_tolerance > 0 || s_solver_type == 1))
+  {
+    levelOp.create(resid, a_rhs);
+    levelOp.residual(resid, a_phi, a_rhs, false);
+    initialResidual = levelOp.norm(resid, 0);
+  }
+
+  // There's no point solving much beyond the accuracy of the discretisation
+  Real solverTolerance = m_solverMGlevel.m_eps;
+  Real tolerance = solverTolerance;
+  if (s_discretisation_tolerance > 0 && initialResidual > 0)
+  {
+    Real numCells = m_domain.domainBox().longside();
+    Real truncationError = levelOp.norm(a_rhs, 0)/(numCells*numCells);
+    tolerance = max(tolerance, s_discretisation_tolerance*truncationError/initialResidual);
+  }
+
+  int exitStatus = 0;
+
+  if (s_solver_type == 1)
+  {
+    CH_TIME("Projector::solveMGlevel::BiCGStab");
+
+    BiCGStabSolver<LevelData<FArrayBox> > krylovSolver;
+    krylovSolver.define(&levelOp, false); // inhomogeneous
+    krylovSolver.m_verbosity = max(s_verbosity-2, 0);
+    krylovSolver.m_imax = s_iterMax;
+    krylovSolver.m_eps = tolerance;
+    krylovSolver.m_normType = 0;
+
+    krylovSolver.solve(a_phi, a_rhs);
+
+    // Report the outcome like AMRMultiGrid: 1 if converged, 2 if not
+    if (!resid.isDefined())
+    {
+      levelOp.create(resid, a_rhs);
+    }
+    levelOp.residual(resid, a_phi, a_rhs, false);
+    Real finalResidual = levelOp.norm(resid, 0);
+    exitStatus = (finalResidual <= tolerance*initialResidual) ? 1 : 2;
+
+    if (s_verbosity >= 3)
+    {
+      pout() << "  Projector::solveMGlevel - BiCGStab residual " << initialResidual << " -> " << finalResidual
+          << ", tolerance = " << tolerance << endl;
+    }
+  }
+  else
+  {
+    m_solverMGlevel.m_eps = tolerance;
 
+    // l_max = maxLevel, l_base = maxLevel
+    m_solverMGlevel.solve(phiVect, rhsVect, maxLevel, maxLevel,
+                          false); // don't initialize to zero
 
+    m_solverMGlevel.m_eps = solverTolerance;
+    exitStatus = m_solverMGlevel.m_exitStatus;
+  }
+
+  if (a_history != NULL)
+  {
+    recordSolution(*a_history, a_phi, a_time);
+  }
 
 //  if (s_verbosity >= 2
 //      || m_solverMGlevel.m_exitStatus != 0)
@@ -3474,5 +3592,111 @@ int Projector::solveMGlevel(LevelData<FArrayBox>&   a_phi,
 
   //	int exitStatus = m_solverMGlevel.m_exitStatus;
 
-  return m_solverMGlevel.m_exitStatus;
+  return exitStatus;
+}
+
+Real Projector::warmStart(LevelData<FArrayBox>&            a_phi,
+                          const LevelData<FArrayBox>&      a_rhs,
+                          LinearOp<LevelData<FArrayBox> >& a_op,
+                          const PressureSolveHistory&      a_history,
+                          Real                             a_time)
+{
+  CH_TIME("Projector::warmStart");
+
+  const DisjointBoxLayout& grids = a_phi.disjointBoxLayout();
+  int numPoints = min(s_initial_guess_history, (int)a_history.m_solutions.size());
+
+  // Only extrapolate forwards in time, from solutions on these grids
+  if (numPoints == 0 || a_time <= a_history.m_times[0]
+      || !(a_history.m_solutions[0]->disjointBoxLayout() == grids))
+  {
+    return -1;
+  }
+
+  // Lagrange polynomial through the previous solutions
+  LevelData<FArrayBox> guess;
+  a_op.create(guess, a_phi);
+  a_op.setToZero(guess);
+
+  for (int i = 0; i < numPoints; i++)
+  {
+    Real weight = 1.0;
+    for (int j = 0; j < numPoints; j++)
+    {
+      if (j != i)
+      {
+        weight *= (a_time - a_history.m_times[j])/(a_history.m_times[i] - a_history.m_times[j]);
+      }
+    }
+
+    const LevelData<FArrayBox>& solution = *a_history.m_solutions[i];
+    for (DataIterator dit = grids.dataIterator(); dit.ok(); ++dit)
+    {
+      guess[dit].plus(solution[dit], grids[dit], grids[dit], weight, 0, 0, guess.nComp());
+    }
+  }
+
+  // Extrapolation can be worse than nothing (e.g. if the flow changes suddenly), so check
+  LevelData<FArrayBox> resid;
+  a_op.create(resid, a_rhs);
+
+  a_op.residual(resid, a_phi, a_rhs, false);
+  Real currentResidual = a_op.norm(resid, 0);
+
+  a_op.residual(resid, guess, a_rhs, false);
+  Real guessResidual = a_op.norm(resid, 0);
+
+  if (s_verbosity >= 3)
+  {
+    pout() << "  Projector::warmStart - initial residual " << currentResidual
+        << ", extrapolated from " << numPoints << " previous solutions " << guessResidual << endl;
+  }
+
+  if (guessResidual < currentResidual)
+  {
+    a_op.assign(a_phi, guess);
+    return guessResidual;
+  }
+
+  return currentResidual;
+}
+
+void Projector::recordSolution(PressureSolveHistory&       a_history,
+                               const LevelData<FArrayBox>& a_phi,
+                               Real                        a_time)
+{
+  if (s_initial_guess_history <= 0 || a_time < 0)
+  {
+    return;
+  }
+
+  const DisjointBoxLayout& grids = a_phi.disjointBoxLayout();
+
+  // Forget solutions on old grids, or from later times (if a timestep is being redone)
+  if (a_history.m_solutions.size() > 0
+      && (!(a_history.m_solutions[0]->disjointBoxLayout() == grids) || a_time < a_history.m_times[0]))
+  {
+    a_history.m_solutions.clear();
+    a_history.m_times.clear();
+  }
+
+  // Further solves at the same time (e.g. repeated projections) are corrections to the first one
+  if (a_history.m_times.size() > 0 && a_time == a_history.m_times[0])
+  {
+    return;
+  }
+
+  RefCountedPtr<LevelData<FArrayBox> > solution(new LevelData<FArrayBox>(grids, a_phi.nComp()));
+  a_phi.copyTo(*solution);
+
+  Vector<RefCountedPtr<LevelData<FArrayBox> > > solutions(1, solution);
+  Vector<Real> times(1, a_time);
+  for (int i = 0; i < a_history.m_solutions.size() && solutions.size() < s_initial_guess_history; i++)
+  {
+    solutions.push_back(a_history.m_solutions[i]);
+    times.push_back(a_history.m_times[i]);
+  }
+
+  a_history.m_solutions = solutions;
+  a_history.m_times = times;
 }
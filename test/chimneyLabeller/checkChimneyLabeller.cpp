@@ -0,0 +1,148 @@
+#ifdef CH_LANG_CC
+/*
+ *      _______              __
+ *     / ___/ /  ___  __ _  / /  ___
+ *    / /__/ _ \/ _ \/  V \/ _ \/ _ \
+ *    \___/_//_/\___/_/_/_/_.__/\___/
+ *    Please refer to Copyright.txt, in Chombo's root directory.
+ */
+#endif
+
+// Checks ChimneyLabeller on synthetic mushy layers with a known number of chimneys, with both flat and
+// non-flat mush-liquid interfaces, split over several boxes (and ranks, if run in parallel).
+// Exits with an error if the chimneys aren't found.
+
+#include "parstream.H"
+#include "BRMeshRefine.H"
+#include "LoadBalance.H"
+#include "BoxIterator.H"
+#include "SPMD.H"
+
+#include "ChimneyLabeller.H"
+
+#include <cmath>
+#include <string>
+
+#include "UsingNamespace.H"
+
+/// Mushy layer above liquid, with the interface at a_meanHeight + a_amplitude*sin(...), and square chimneys
+/// a_chimneyWidth cells across, every a_chimneySpacing cells, which reach a_chimneyTop
+static void syntheticPorosity(LevelData<FArrayBox>& a_porosity, const Box& a_domBox, int a_meanHeight,
+                              Real a_amplitude, int a_chimneyWidth, int a_chimneySpacing, int a_chimneyTop)
+{
+  int vertDir = SpaceDim-1;
+
+  const DisjointBoxLayout& grids = a_porosity.disjointBoxLayout();
+  for (DataIterator dit = a_porosity.dataIterator(); dit.ok(); ++dit)
+  {
+    FArrayBox& porosity = a_porosity[dit];
+    for (BoxIterator bit(grids[dit]); bit.ok(); ++bit)
+    {
+      IntVect iv = bit();
+
+      Real height = a_meanHeight;
+      bool inChimney = true;
+      for (int dir = 0; dir < SpaceDim-1; dir++)
+      {
+        height += a_amplitude*sin(2*M_PI*(iv[dir] + 0.5)/a_domBox.size(dir) + dir);
+        inChimney = inChimney && (iv[dir] % a_chimneySpacing) < a_chimneyWidth;
+      }
+
+      bool liquid = iv[vertDir] < floor(height + 0.5) || (inChimney && iv[vertDir] < a_chimneyTop);
+      porosity(iv) = liquid ? 1.0 : 0.5;
+    }
+  }
+}
+
+/// Label the chimneys in a synthetic mushy layer, and check we find the ones we put there
+static bool checkCase(const std::string& a_name, Real a_amplitude, bool a_periodic, int a_maxBoxSize)
+{
+  int vertDir = SpaceDim-1;
+
+  const int numChimneysPerDir = 4;
+  const int chimneySpacing = 16;
+  const int chimneyWidth = 2;
+  const int height = 64;
+
+  IntVect hiEnd = (numChimneysPerDir*chimneySpacing - 1)*IntVect::Unit;
+  hiEnd[vertDir] = height - 1;
+  Box domBox(IntVect::Zero, hiEnd);
+
+  bool isPeriodic[SpaceDim];
+  for (int dir = 0; dir < SpaceDim; dir++)
+  {
+    isPeriodic[dir] = a_periodic && dir != vertDir;
+  }
+  ProblemDomain domain(domBox, isPeriodic);
+
+  Vector<Box> boxes;
+  domainSplit(domBox, boxes, a_maxBoxSize);
+  Vector<int> procs;
+  LoadBalance(procs, boxes);
+  DisjointBoxLayout grids(boxes, procs, domain);
+
+  LevelData<FArrayBox> porosity(grids, 1);
+  syntheticPorosity(porosity, domBox, 20, a_amplitude, chimneyWidth, chimneySpacing, 50);
+
+  Real dx = 1.0/domBox.size(0);
+  ChimneyLabeller chimneys;
+  chimneys.define(porosity, domain, dx);
+
+  int expectedChimneys = 1;
+  for (int dir = 0; dir < SpaceDim-1; dir++)
+  {
+    expectedChimneys *= numChimneysPerDir;
+  }
+
+  // Stair steps in the interface can leave a cell or two off the bottom of a chimney, so allow a little slack
+  Real expectedWidth = chimneyWidth*dx;
+  bool passed = (chimneys.numChimneys() == expectedChimneys)
+                    && std::abs(chimneys.averageWidth() - expectedWidth) < 0.1*expectedWidth;
+
+  Real expectedSpacing = chimneySpacing*dx;
+  passed = passed && std::abs(chimneys.averageSpacing() - expectedSpacing) < 0.1*expectedSpacing;
+
+  pout() << (passed ? "PASSED " : "FAILED ") << a_name << ": " << chimneys.numChimneys() << " chimneys (expected "
+      << expectedChimneys << "), width " << chimneys.averageWidth()/dx << " cells (expected " << chimneyWidth
+      << "), spacing " << chimneys.averageSpacing()/dx << " cells, depth " << chimneys.averageDepth()/dx
+      << " cells" << endl;
+
+  return passed;
+}
+
+int main(int a_argc, char* a_argv[])
+{
+#ifdef CH_MPI
+  MPI_Init(&a_argc, &a_argv);
+#endif
+  bool passed = true;
+  { // scoping trick
+
+    // Check with boxes smaller than and the same size as the chimney spacing
+    for (int maxBoxSize = 8; maxBoxSize <= 16; maxBoxSize *= 2)
+    {
+      for (int periodic = 0; periodic <= 1; periodic++)
+      {
+        std::string suffix = std::string(periodic ? ", periodic" : "") + ", max box size " + (maxBoxSize == 8 ? "8" : "16");
+
+        // Flat interface
+        passed = checkCase("flat interface" + suffix, 0.0, periodic, maxBoxSize) && passed;
+
+        // Interface varying by 16 rows, so the liquid beneath its shallow parts is above its deepest parts
+        passed = checkCase("non-flat interface" + suffix, 8.0, periodic, maxBoxSize) && passed;
+      }
+    }
+
+  } // end scoping trick
+
+  if (!passed)
+  {
+    MayDay::Error("ChimneyLabeller check failed");
+  }
+
+#ifdef CH_MPI
+  MPI_Finalize();
+#endif
+
+  return 0;
+}
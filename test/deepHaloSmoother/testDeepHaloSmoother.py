@@ -0,0 +1,115 @@
+# Regression test for the deep halo enthalpy-bulk concentration smoother
+#
+# Runs the small problem in inputs with the default smoother (HCMultigrid.relaxMode=1), then with the
+# deep halo smoother (HCMultigrid.relaxMode=6) for a few values of HCMultigrid.sweepsPerExchange, and checks
+# that the final enthalpy, bulk concentration and porosity are the same. The boxes are 8 cells across, so
+# sweepsPerExchange=8 needs halos deeper than the boxes and should fall back to the default smoother.
+#
+# $ python testDeepHaloSmoother.py [-n <num processors>] [-o <output dir>] [-t <tolerance>]
+#
+# Exits with a non-zero status if any run fails or differs from the default smoother.
+# Needs both test/ and plotting/ (for PltFile) on the PYTHONPATH.
+
+from __future__ import print_function
+
+import getopt
+import os
+import subprocess
+import sys
+
+import numpy as np
+
+from PltFile import PltFile
+from mushyLayerRunUtils import read_inputs, write_inputs, get_executable_name, get_final_plot_file
+
+# Smoother settings to compare against the default
+CASES = [{'name': 'halo2', 'HCMultigrid.relaxMode': 6, 'HCMultigrid.sweepsPerExchange': 2},
+         {'name': 'halo3', 'HCMultigrid.relaxMode': 6, 'HCMultigrid.sweepsPerExchange': 3},
+         {'name': 'halo8-fallback', 'HCMultigrid.relaxMode': 6, 'HCMultigrid.sweepsPerExchange': 8}]
+
+FIELDS = ['Enthalpy', 'Bulk concentration', 'Porosity']
+
+
+def usage():
+    print('testDeepHaloSmoother.py [-n <num processors>] [-o <output dir>] [-t <tolerance>]')
+    print('  -t  largest difference from the default smoother allowed in any field (default 1e-10)')
+
+
+def run(name, extra_params, output_dir, num_proc):
+    """ Run the test problem with extra_params, and return the final plot file (or None if it failed) """
+
+    test_dir = os.path.dirname(os.path.abspath(__file__))
+    params = read_inputs(os.path.join(test_dir, 'inputs'))
+    params.update(extra_params)
+
+    run_dir = os.path.join(output_dir, name)
+    if not os.path.exists(run_dir):
+        os.makedirs(run_dir)
+
+    write_inputs(os.path.join(run_dir, 'inputs'), params)
+
+    cmd = [get_executable_name(exec_name='mushyLayer2d', return_full_path=True), 'inputs']
+    if num_proc > 1:
+        cmd = ['mpirun', '-np', str(num_proc)] + cmd
+
+    with open(os.path.join(run_dir, 'run.out'), 'w') as out:
+        status = subprocess.call(cmd, cwd=run_dir, stdout=out, stderr=subprocess.STDOUT)
+
+    plot_file = get_final_plot_file(run_dir)
+    if status != 0 or plot_file is None:
+        print('%s failed (exit code %d), see %s' % (name, status, os.path.join(run_dir, 'run.out')))
+        return None
+
+    pf = PltFile(os.path.join(run_dir, plot_file))
+    pf.load_data()
+    return pf
+
+
+def test_deep_halo_smoother(argv):
+
+    output_dir = os.path.join(os.getcwd(), 'deepHaloSmoother')
+    num_proc = 1
+    tolerance = 1e-10
+
+    try:
+        opts, args = getopt.getopt(argv, "n:o:t:h")
+    except getopt.GetoptError as err:
+        print(str(err))
+        usage()
+        sys.exit(2)
+
+    for opt, arg in opts:
+        if opt == '-n':
+            num_proc = int(arg)
+        elif opt == '-o':
+            output_dir = arg
+        elif opt == '-t':
+            tolerance = float(arg)
+        elif opt == '-h':
+            usage()
+            sys.exit(0)
+
+    reference = run('default', {'HCMultigrid.relaxMode': 1}, output_dir, num_proc)
+    if reference is None:
+        sys.exit(1)
+
+    passed = True
+    for case in CASES:
+        params = dict((k, v) for k, v in case.items() if k != 'name')
+        pf = run(case['name'], params, output_dir, num_proc)
+        if pf is None:
+            passed = False
+            continue
+
+        for field in FIELDS:
+            diff = np.nanmax(np.abs(np.array(pf.get_level_data(field)) - np.array(reference.get_level_data(field))))
+            ok = diff <= tolerance
+            passed = passed and ok
+            print('%-16s %-20s max difference %.3e %s' % (case['name'], field, diff, 'PASSED' if ok else 'FAILED'))
+
+    if not passed:
+        sys.exit(1)
+
+
+if __name__ == "__main__":
+    test_deep_halo_smoother(sys.argv[1:])
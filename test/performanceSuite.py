@@ -0,0 +1,387 @@
+# Performance regression suite
+#
+# Runs a fixed set of small simulations, based on the inputs in /params/ and /examples/, parses the
+# Chombo timer output (time.table) of each into per-phase timings, and compares them against a stored
+# baseline. Everything runs locally, so this can be run on a single linux box before merging changes:
+#
+# $ python performanceSuite.py -u            # (re)create the baseline
+# $ python performanceSuite.py               # compare against the baseline
+#
+# See the usage message for the other options.
+
+from __future__ import print_function
+
+import getopt
+import json
+import os
+import re
+import socket
+import subprocess
+import sys
+import time
+
+from mushyLayerRunUtils import read_inputs, write_inputs, get_executable_name, get_mushy_layer_dir, \
+    get_current_vcs_revision
+
+# Each case runs a reduced version of some inputs file, for a fixed number of steps
+# so that the amount of work is the same every time.
+# Cases cover uniform meshes and AMR with 2 and 3 levels, Darcy and Darcy-Brinkman flow, and 2D and 3D.
+CASES = [
+    {'name': 'darcy-uniform-2d',
+     'inputs': 'examples/seaice_darcyliquid/inputs',
+     'dim': 2,
+     'params': {'main.num_cells': '64 64 1',
+                'main.max_level': 0,
+                'main.max_grid_size': 32}},
+
+    {'name': 'darcy-amr2-2d',
+     'inputs': 'params/mushyLayerDarcy.parameters',
+     'dim': 2,
+     'params': {'main.num_cells': '32 32 1',
+                'main.max_level': 1,
+                'main.ref_ratio': '2 2 2',
+                'main.max_grid_size': 16}},
+
+    {'name': 'darcybrinkman-uniform-2d',
+     'inputs': 'examples/mushylayer_darcybrinkman/inputs',
+     'dim': 2,
+     'params': {'main.num_cells': '64 64 1',
+                'main.max_level': 0,
+                'main.max_grid_size': 32}},
+
+    {'name': 'darcybrinkman-amr3-2d',
+     'inputs': 'examples/mushylayer_darcybrinkman/inputs',
+     'dim': 2,
+     'params': {'main.num_cells': '32 32 1',
+                'main.max_level': 2,
+                'main.ref_ratio': '2 2 2',
+                'main.max_grid_size': 16}},
+
+    {'name': 'darcybrinkman-amr2-3d',
+     'inputs': 'examples/mushylayer_darcybrinkman_3d/inputs',
+     'dim': 3,
+     'params': {'main.num_cells': '16 16 16',
+                'main.max_level': 1,
+                'main.ref_ratio': '2 2 2',
+                'main.max_grid_size': 16}},
+]
+
+# Parameters applied to every case so that runs are short, deterministic, and exercise regridding and I/O
+COMMON_PARAMS = {'main.max_step': 20,
+                 'main.max_time': 1e10,
+                 'main.steady_state': 1e-20,
+                 'main.regrid_interval': '4 4 4',
+                 'main.block_factor': 4,
+                 'main.plot_interval': 10,
+                 'main.plot_period': 0,
+                 'main.checkpoint_interval': 10,
+                 'main.verbosity': 1,
+                 'main.output_folder': '.'}
+
+# Timers which make up each phase of a timestep. Timers of a phase which are called from within another timer
+# of the same phase are only counted once. Phases can overlap, e.g. the advective fluxes are computed as part of
+# the enthalpy-bulk concentration solve.
+PHASES = {'advection': ['AMRLevelMushyLayer::computeAdvectionVelocities()',
+                        'AMRLevelMushyLayer::computeScalarAdvectiveFlux',
+                        'AMRLevelMushyLayer::computeUstar'],
+          'hc_solve': ['AMRLevelMushyLayer::advectDiffuseScalar'],
+          'projection': ['AMRLevelMushyLayer::levelProject',
+                         'CCProjector::levelProject'],
+          'sync': ['AMRLevelMushyLayer::postTimeStep'],
+          'regrid': ['AMR::regrid',
+                     'AMRLevelMushyLayer::tagCells',
+                     'AMRLevelMushyLayer::regrid',
+                     'AMRLevelMushyLayer::postRegrid'],
+          'io': ['AMR::writePlotFile',
+                 'AMR::writeCheckpointFile',
+                 'AMRLevelMushyLayer::writePlotLevel',
+                 'AMRLevelMushyLayer::writeCheckpointLevel',
+                 'AMRLevelMushyLayer::finishAsyncOutput']}
+
+# Header line for a timer, e.g. '[12]AMRLevelMushyLayer::advance 10.50201 40'
+TIMER_HEADER = re.compile(r'^\[(\d+)\]\s*(.+?)\s+([-+0-9.eE]+)\s+(\d+)\s*$')
+
+# Line for a child of the previous timer, e.g. '    85.3%    8.9590       40 AMRLevelMushyLayer::advectDiffuseScalar [15]'
+TIMER_CHILD = re.compile(r'^\s+[0-9.]+%\s+[-+0-9.eE]+\s+\d+\s+(.+?)\s+\[(\d+)\]\s*$')
+
+
+def usage():
+    print('performanceSuite.py [-b <baseline file>] [-u] [-c <case1,case2,...>] [-o <output dir>] '
+          '[-n <num processors>] [-r <repeats>] [-t <tolerance>] [-m <min seconds>] [-e <executable dir>]')
+    print('  -u  write the results to the baseline file, rather than comparing against it')
+    print('  -r  run each case this many times and keep the fastest, to reduce noise (default 3)')
+    print('  -t  fractional slowdown of a phase which counts as a regression (default 0.1)')
+    print('  -m  ignore phases which take less than this many seconds in the baseline (default 0.05)')
+    print('Cases: ' + ', '.join([c['name'] for c in CASES]))
+
+
+def parse_time_table(filename):
+    """ Parse a Chombo time.table file into a dict of timer id -> {'name', 'time', 'count', 'children'} """
+
+    timers = {}
+    current = None
+
+    with open(filename, 'r') as f:
+        for line in f:
+            m = TIMER_HEADER.match(line)
+            if m:
+                timer_id = int(m.group(1))
+                if timer_id in timers:
+                    # The full call tree at the end of the file repeats timers we already have
+                    current = None
+                    continue
+
+                timers[timer_id] = {'name': m.group(2).strip(),
+                                    'time': float(m.group(3)),
+                                    'count': int(m.group(4)),
+                                    'children': []}
+                current = timer_id
+                continue
+
+            m = TIMER_CHILD.match(line)
+            if m and current is not None:
+                timers[current]['children'].append(int(m.group(2)))
+
+    return timers
+
+
+def phase_timings(timers):
+    """ Sum the timers belonging to each phase, counting nested timers of the same phase once """
+
+    parents = {}
+    for timer_id, timer in timers.items():
+        for child in timer['children']:
+            parents[child] = timer_id
+
+    def in_phase(timer_id, phase):
+        return timers[timer_id]['name'] in PHASES[phase]
+
+    def has_ancestor_in_phase(timer_id, phase):
+        parent = parents.get(timer_id)
+        while parent is not None and parent in timers:
+            if in_phase(parent, phase):
+                return True
+            parent = parents.get(parent)
+        return False
+
+    timings = {}
+    for phase in PHASES:
+        timings[phase] = sum([timer['time'] for timer_id, timer in timers.items()
+                              if in_phase(timer_id, phase) and not has_ancestor_in_phase(timer_id, phase)])
+
+    # The root timer covers the whole run
+    roots = [timer_id for timer_id in timers if timer_id not in parents]
+    timings['total'] = sum([timers[r]['time'] for r in roots])
+
+    return timings
+
+
+def find_time_table(directory):
+    """ time.table for serial runs, time.table.<rank> for MPI runs (rank 0 is used) """
+    for name in ['time.table.0', 'time.table']:
+        path = os.path.join(directory, name)
+        if os.path.exists(path):
+            return path
+    return None
+
+
+def run_case(case, exec_dir, output_dir, num_proc):
+    """ Run a case once, and return its phase timings """
+
+    mushy_layer_dir = get_mushy_layer_dir()
+
+    params = read_inputs(os.path.join(mushy_layer_dir, case['inputs']))
+    params.update(COMMON_PARAMS)
+    params.update(case['params'])
+
+    # Remove any extra dimensions from num_cells etc. for 2D runs
+    for key in ['main.num_cells', 'main.periodic_bc']:
+        if key in params:
+            params[key] = ' '.join(str(params[key]).split()[:case['dim']])
+
+    run_dir = os.path.join(output_dir, case['name'])
+    if not os.path.exists(run_dir):
+        os.makedirs(run_dir)
+
+    # Don't pick up timings from a previous run
+    for f in os.listdir(run_dir):
+        if f.startswith('time.table') or f.startswith('pout'):
+            os.remove(os.path.join(run_dir, f))
+
+    inputs_file = os.path.join(run_dir, 'inputs')
+    write_inputs(inputs_file, params)
+
+    executable = get_executable_name(exec_dir, 'mushyLayer%dd' % case['dim'], return_full_path=True)
+    cmd = [executable, 'inputs']
+    if num_proc > 1:
+        cmd = ['mpirun', '-np', str(num_proc)] + cmd
+
+    # Setting CH_TIMER makes Chombo write out time.table
+    env = dict(os.environ)
+    env['CH_TIMER'] = '1'
+
+    start = time.time()
+    with open(os.path.join(run_dir, 'run.out'), 'w') as out:
+        status = subprocess.call(cmd, cwd=run_dir, env=env, stdout=out, stderr=subprocess.STDOUT)
+    wall_time = time.time() - start
+
+    if status != 0:
+        print('Case %s failed (exit code %d), see %s' % (case['name'], status, os.path.join(run_dir, 'run.out')))
+        return None
+
+    time_table = find_time_table(run_dir)
+    if not time_table:
+        print('Case %s did not write a time.table - was Chombo compiled with timers turned off?' % case['name'])
+        return None
+
+    timings = phase_timings(parse_time_table(time_table))
+    timings['wall'] = wall_time
+
+    return timings
+
+
+def compare(results, baseline, tolerance, min_seconds):
+    """ Return a list of (case, phase, baseline time, new time) for every phase which has slowed down """
+
+    regressions = []
+    for case_name in sorted(results):
+        if case_name not in baseline:
+            print('%s: not in baseline' % case_name)
+            continue
+
+        for phase in sorted(results[case_name]):
+            old = baseline[case_name].get(phase)
+            new = results[case_name][phase]
+            if old is None or old < min_seconds:
+                continue
+
+            change = (new - old) / old
+            flag = ''
+            if change > tolerance:
+                flag = '  <-- REGRESSION'
+                regressions.append((case_name, phase, old, new))
+
+            print('%-28s %-12s %10.3f %10.3f %+8.1f%%%s' % (case_name, phase, old, new, 100 * change, flag))
+
+    return regressions
+
+
+def performance_suite(argv):
+
+    test_dir = os.path.dirname(os.path.abspath(__file__))
+    baseline_file = os.path.join(test_dir, 'performanceBaseline.json')
+    update_baseline = False
+    case_names = [c['name'] for c in CASES]
+    output_dir = os.path.join(os.getcwd(), 'performanceSuite')
+    exec_dir = ''
+    num_proc = 1
+    repeats = 3
+    tolerance = 0.1
+    min_seconds = 0.05
+
+    try:
+        opts, args = getopt.getopt(argv, "b:uc:o:n:r:t:m:e:h")
+    except getopt.GetoptError as err:
+        print(str(err))
+        usage()
+        sys.exit(2)
+
+    for opt, arg in opts:
+        if opt == '-b':
+            baseline_file = arg
+        elif opt == '-u':
+            update_baseline = True
+        elif opt == '-c':
+            case_names = arg.split(',')
+        elif opt == '-o':
+            output_dir = arg
+        elif opt == '-n':
+            num_proc = int(arg)
+        elif opt == '-r':
+            repeats = int(arg)
+        elif opt == '-t':
+            tolerance = float(arg)
+        elif opt == '-m':
+            min_seconds = float(arg)
+        elif opt == '-e':
+            exec_dir = arg
+        elif opt == '-h':
+            usage()
+            sys.exit(0)
+
+    cases = [c for c in CASES if c['name'] in case_names]
+    if len(cases) != len(case_names):
+        print('Unknown case in: ' + ', '.join(case_names))
+        usage()
+        sys.exit(2)
+
+    results = {}
+    failed = False
+    for case in cases:
+        print('Running %s (%d repeats)' % (case['name'], repeats))
+
+        # Keep the fastest time for each phase, which is the least affected by whatever else the machine is doing
+        best = None
+        for i in range(repeats):
+            timings = run_case(case, exec_dir, output_dir, num_proc)
+            if timings is None:
+                failed = True
+                break
+
+            if best is None:
+                best = timings
+            else:
+                for phase in timings:
+                    best[phase] = min(best[phase], timings[phase])
+
+        if best is not None:
+            results[case['name']] = best
+
+    results_file = os.path.join(output_dir, 'performanceResults.json')
+    with open(results_file, 'w') as f:
+        json.dump(results, f, indent=2, sort_keys=True)
+    print('Timings written to %s' % results_file)
+
+    if update_baseline:
+        baseline = {}
+        if os.path.exists(baseline_file):
+            with open(baseline_file, 'r') as f:
+                baseline = json.load(f)
+        baseline.update(results)
+        baseline['_info'] = {'host': socket.gethostname(),
+                             'revision': get_current_vcs_revision(),
+                             'num_proc': num_proc,
+                             'date': time.strftime('%Y-%m-%d')}
+
+        with open(baseline_file, 'w') as f:
+            json.dump(baseline, f, indent=2, sort_keys=True)
+        print('Baseline written to %s' % baseline_file)
+
+        sys.exit(1 if failed else 0)
+
+    if not os.path.exists(baseline_file):
+        print('No baseline found at %s, create one with -u' % baseline_file)
+        sys.exit(1)
+
+    with open(baseline_file, 'r') as f:
+        baseline = json.load(f)
+
+    info = baseline.get('_info', {})
+    if info.get('host') and info['host'] != socket.gethostname():
+        print('Warning: baseline was created on %s, timings may not be comparable' % info['host'])
+
+    print('%-28s %-12s %10s %10s %9s' % ('case', 'phase', 'baseline', 'new', 'change'))
+    regressions = compare(results, baseline, tolerance, min_seconds)
+
+    if regressions:
+        print('%d phase(s) slower than the baseline by more than %d%%' % (len(regressions), 100 * tolerance))
+        sys.exit(1)
+
+    if failed:
+        sys.exit(1)
+
+    print('No performance regressions')
+
+
+if __name__ == "__main__":
+    performance_suite(sys.argv[1:])